@@ -0,0 +1,521 @@
+﻿/*****************************************************************************************//**
+ * @file			YmAmbisonic.h
+ * @brief			アンビソニックバス描画 (音源ごとのエンコード + バス 1 本のバイノーラルデコード)
+ * @attention		音源数に比例する処理をゲイン乗算だけにし、畳込みをバス全体で固定回数にする。
+ *
+ *					  音源ごと : (order+1)^2 チャンネルへのゲイン付き加算 (YmAmbisonicEncoder)
+ *					  バスごと : FFT (order+1)^2 回 + 複素積和 2(order+1)^2 回 + 逆 FFT 2 回
+ *
+ *					・チャンネル順・正規化は ambiX (ACN / SN3D)。Unity のアンビソニッククリップと同じ。
+ *					  軸は X:前, Y:左, Z:上 で、YmVector3 (x:右, y:上, z:前) から変換して使う。
+ *					・デコーダは HRTF セットの測定方向に対する最小二乗デコード行列 (正則化付き) を
+ *					  チャンネルごとに HRTF スペクトルへ畳み込んでおき、チャンネル x 左右のフィルタとして持つ
+ *					  (仮想スピーカー = 測定方向)。HRTF が order 次以下で表せる範囲では音源ごとの描画と一致する。
+ *					  maxRe 指定時は max-rE の次数重み (エネルギー正規化) を掛ける (定位のにじみを抑えるが音量は変わる)。
+ *					・バスはリスナー座標で描画すること (音場の回転は行わない)。
+ *					・使い方: BeginBlock() -> AddSource() x 音源数 (または GetChannel() に直接加算) -> Render()
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+
+#if YM_USE_AMBISONIC
+
+#include <string.h>
+#include <math.h>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+#include "private/YmFft.h"
+#include "private/YmHrtfGrid.h"
+#include "private/YmHrtfPack.h"
+#include "private/YmSimdDispatch.h"
+
+#define YM_AMBISONIC_MAX_ORDER			3								///< 対応する最大次数
+#define YM_AMBISONIC_MAX_CHANNELS		((YM_AMBISONIC_MAX_ORDER + 1)*(YM_AMBISONIC_MAX_ORDER + 1))
+#define YM_AMBISONIC_REGULARIZATION		1.0e-3							///< デコード行列の正則化 (対角の平均に対する比)
+
+namespace YmAmbisonic {
+
+/// 次数 -> チャンネル数
+inline YmUInt32 GetNumChannels(YmUInt32 order)
+{
+	return (order + 1)*(order + 1);
+}
+
+/// ACN チャンネル番号 -> 次数
+inline YmUInt32 GetChannelOrder(YmUInt32 acn)
+{
+	YmUInt32 l = 0;
+	while ((l + 1)*(l + 1) <= acn) l++;
+	return l;
+}
+
+/***********************************************************************//**
+ * @brief		方向に対するエンコード係数 (実球面調和関数, ACN / SN3D)
+ * @param[in]	dir		単位ベクトル (YmVector3 の座標系)
+ * @param[out]	coef	[GetNumChannels(order)]
+ **************************************************************************/
+inline void GetCoefficients(YmUInt32 order, const YmVector3& dir, YmReal32* coef)
+{
+	// ambiX の軸へ変換
+	const YmReal32 x = dir.z;
+	const YmReal32 y = -dir.x;
+	const YmReal32 z = dir.y;
+
+	coef[0] = 1.0f;
+	if (order < 1) return;
+	coef[1] = y;
+	coef[2] = z;
+	coef[3] = x;
+	if (order < 2) return;
+	const YmReal32 r3 = 1.7320508f;		// sqrt(3)
+	coef[4] = r3*x*y;
+	coef[5] = r3*y*z;
+	coef[6] = 0.5f*(3.0f*z*z - 1.0f);
+	coef[7] = r3*x*z;
+	coef[8] = 0.5f*r3*(x*x - y*y);
+	if (order < 3) return;
+	const YmReal32 r58 = 0.7905694f;	// sqrt(5/8)
+	const YmReal32 r15 = 3.8729833f;	// sqrt(15)
+	const YmReal32 r38 = 0.6123724f;	// sqrt(3/8)
+	coef[9]  = r58*y*(3.0f*x*x - y*y);
+	coef[10] = r15*x*y*z;
+	coef[11] = r38*y*(5.0f*z*z - 1.0f);
+	coef[12] = 0.5f*z*(5.0f*z*z - 3.0f);
+	coef[13] = r38*x*(5.0f*z*z - 1.0f);
+	coef[14] = 0.5f*r15*z*(x*x - y*y);
+	coef[15] = r58*x*(x*x - 3.0f*y*y);
+}
+
+/***********************************************************************//**
+ * @brief		max-rE の次数重み (拡散音場のエネルギーを保つよう正規化)
+ * @param[out]	weight	[order + 1]
+ **************************************************************************/
+inline void GetMaxReWeights(YmUInt32 order, YmReal32* weight)
+{
+	// P_l(cos(137.9° / (N + 1.51)))
+	const double c = cos(137.9*YMH_DEG2RAD / (order + 1.51));
+	double p0 = 1.0, p1 = c;
+	double energy = 0.0, energyRe = 0.0;
+	for (YmUInt32 l = 0; l <= order; l++)
+	{
+		double p;
+		if (l == 0)		p = 1.0;
+		else if (l == 1)	p = c;
+		else
+		{
+			p = ((2.0*l - 1.0)*c*p1 - (l - 1.0)*p0) / l;
+			p0 = p1;
+			p1 = p;
+		}
+		weight[l] = (YmReal32)p;
+		energy += 2.0*l + 1.0;
+		energyRe += (2.0*l + 1.0)*p*p;
+	}
+	const YmReal32 scale = (YmReal32)sqrt(energy / energyRe);
+	for (YmUInt32 l = 0; l <= order; l++) weight[l] *= scale;
+}
+
+} // namespace YmAmbisonic
+
+/***********************************************************************//**
+ * @brief			音源 1 つ分のエンコーダ (前ブロックの係数を保持してブロック内で補間する)
+ **************************************************************************/
+class YmAmbisonicEncoder
+{
+public:
+	YmAmbisonicEncoder() : m_order(1), m_isFirst(true) { memset(m_coef, 0, sizeof(m_coef)); }
+
+	bool Init(YmUInt32 order)
+	{
+		if (order > YM_AMBISONIC_MAX_ORDER) return false;
+		m_order = order;
+		Reset();
+		return true;
+	}
+
+	/// 次のブロックは補間せずに始める (音源の再生開始時など)
+	void Reset(void)
+	{
+		m_isFirst = true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		バスへの加算
+	 * @param[in]	in			入力 (numSamples サンプル, mono)
+	 * @param[in]	dir			リスナー座標の方向 (単位ベクトル)
+	 * @param[in]	gain		音量・距離減衰をまとめた線形ゲイン
+	 * @param[out]	bus			[GetNumChannels(order)] の各チャンネル先頭
+	 * @note		前ブロック末尾の係数からこのブロックの係数へ線形補間する (方向・ゲインのジッパーノイズ防止)。
+	 **************************************************************************/
+	void Encode(const YmReal32* in, const YmVector3& dir, YmReal32 gain, YmReal32* const* bus, YmUInt32 numSamples)
+	{
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		const YmUInt32 numChannels = YmAmbisonic::GetNumChannels(m_order);
+		YmReal32 coef[YM_AMBISONIC_MAX_CHANNELS];
+		YmAmbisonic::GetCoefficients(m_order, dir, coef);
+		for (YmUInt32 ch = 0; ch < numChannels; ch++) coef[ch] *= gain;
+		if (m_isFirst) memcpy(m_coef, coef, sizeof(YmReal32)*numChannels);
+		m_isFirst = false;
+
+		for (YmUInt32 ch = 0; ch < numChannels; ch++)
+		{
+			if (m_coef[ch] == coef[ch])
+			{
+				if (coef[ch] != 0.0f) k.MixGain(bus[ch], in, coef[ch], numSamples);
+			}
+			else
+			{
+				k.MixGainRamp(bus[ch], in, m_coef[ch], coef[ch], numSamples);
+			}
+			m_coef[ch] = coef[ch];
+		}
+	}
+
+	YmUInt32 GetOrder(void) const	{ return m_order; }
+
+private:
+	YmUInt32	m_order;
+	bool		m_isFirst;
+	YmReal32	m_coef[YM_AMBISONIC_MAX_CHANNELS];	// 前ブロック末尾の係数 (ゲイン込み)
+};
+
+/***********************************************************************//**
+ * @brief			アンビソニックバス + バイノーラルデコーダ
+ **************************************************************************/
+class YmAmbisonicDecoder
+{
+public:
+	YmAmbisonicDecoder() : m_pAllocator(nullptr), m_order(0), m_numChannels(0), m_blockSize(0), m_fftSize(0), m_numBins(0),
+		m_specStride(0), m_pFilter(nullptr), m_pBus(nullptr), m_pSpec(nullptr), m_pEarSpec(nullptr), m_pTime(nullptr), m_pOverlap(nullptr)
+	{
+		memset(m_pChannel, 0, sizeof(m_pChannel));
+	}
+	~YmAmbisonicDecoder() { Term(); }
+
+	YmAmbisonicDecoder(const YmAmbisonicDecoder&) = delete;
+	YmAmbisonicDecoder& operator=(const YmAmbisonicDecoder&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	order			次数 (1～YM_AMBISONIC_MAX_ORDER)
+	 * @param[in]	blockSize		1 ブロックのサンプル数 (dspbuffersize)
+	 * @param[in]	numDirections	HRTF 方向数
+	 * @param[in]	irLength		HRIR 長
+	 * @param[in]	irLeft, irRight	HRIR [numDirections][irLength]
+	 * @param[in]	directions		測定方向 [numDirections] (単位ベクトル)
+	 * @param[in]	maxRe			max-rE の次数重みを掛ける (既定は掛けない)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 order, YmUInt32 blockSize, YmUInt32 numDirections, YmUInt32 irLength,
+		const YmReal32* irLeft, const YmReal32* irRight, const YmVector3* directions, bool maxRe = false)
+	{
+		Term();
+		if (blockSize == 0 || irLength == 0) return false;
+
+		YmUInt32 fftSize = 4;
+		while (fftSize < blockSize + irLength - 1) fftSize <<= 1;
+		YmHrtfTable table;
+		if (!InitBuffers(in_pAllocator, order, blockSize, fftSize)
+			|| !table.Init(in_pAllocator, m_fft, numDirections, irLength, irLeft, irRight)
+			|| !BuildFilters(table, directions, maxRe))
+		{
+			Term();
+			return false;
+		}
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		FFT 済みの HRTF テーブルで初期化
+	 * @param[in]	fftSize			テーブルの FFT サイズ (blockSize + irLength - 1 以上)
+	 * @param[in]	directions		測定方向 [table.GetNumDirections()] (単位ベクトル)
+	 * @note		フィルタはコピーして持つので、テーブルは初期化後に破棄してよい。
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 order, YmUInt32 blockSize, YmUInt32 fftSize,
+		const YmHrtfTable& table, const YmVector3* directions, bool maxRe = false)
+	{
+		Term();
+		if (blockSize == 0 || fftSize < blockSize || (fftSize & (fftSize - 1)) != 0
+			|| !InitBuffers(in_pAllocator, order, blockSize, fftSize)
+			|| table.GetNumBins() != m_numBins
+			|| !BuildFilters(table, directions, maxRe))
+		{
+			Term();
+			return false;
+		}
+		return true;
+	}
+
+#if YM_USE_HRTF_PACK
+	/***********************************************************************//**
+	 * @brief		HRTF パックで初期化
+	 * @return		blockSize がパックの FFT サイズに収まらない場合 false
+	 * @note		フィルタはコピーして持つので、パックは初期化後に閉じてよい。
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 order, YmUInt32 blockSize, const YmHrtfPack& pack, bool maxRe = false)
+	{
+		Term();
+		if (!pack.IsUsableFor(blockSize)) return false;
+		const YmUInt32 numDirections = pack.GetNumDirections();
+		YmVector3* directions = static_cast<YmVector3*>(alloc_memory_nozero(in_pAllocator, sizeof(YmVector3)*numDirections, 16));
+		if (directions == nullptr) return false;
+		for (YmUInt32 d = 0; d < numDirections; d++) directions[d] = pack.GetDirection(d);
+
+		YmHrtfTable table;
+		const bool ok = table.InitShared(pack.GetSpectra(), numDirections, pack.GetNumBins(), pack.GetSpecStride())
+			&& Init(in_pAllocator, order, blockSize, pack.GetFftSize(), table, directions, maxRe);
+		free_memory(in_pAllocator, directions);
+		return ok;
+	}
+#endif
+
+	void Term(void)
+	{
+		m_fft.Term();
+		free_memory(m_pAllocator, m_pFilter);
+		free_memory(m_pAllocator, m_pBus);
+		free_memory(m_pAllocator, m_pSpec);
+		free_memory(m_pAllocator, m_pEarSpec);
+		free_memory(m_pAllocator, m_pTime);
+		free_memory(m_pAllocator, m_pOverlap);
+		m_pFilter = nullptr;
+		m_pBus = nullptr;
+		m_pSpec = nullptr;
+		m_pEarSpec = nullptr;
+		m_pTime = nullptr;
+		m_pOverlap = nullptr;
+		memset(m_pChannel, 0, sizeof(m_pChannel));
+		m_numChannels = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ブロック開始 (バスのクリア)
+	 **************************************************************************/
+	void BeginBlock(void)
+	{
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++) memset(m_pChannel[ch], 0, sizeof(YmReal32)*m_blockSize);
+	}
+
+	/***********************************************************************//**
+	 * @brief		音源の追加
+	 * @param[in]	in			入力 (blockSize サンプル, mono)
+	 * @param[in]	encoder		音源ごとのエンコーダ (次数はデコーダ以下)
+	 * @param[in]	dir			リスナー座標の方向 (単位ベクトル)
+	 * @param[in]	gain		音量・距離減衰をまとめた線形ゲイン
+	 **************************************************************************/
+	bool AddSource(const YmReal32* in, YmAmbisonicEncoder& encoder, const YmVector3& dir, YmReal32 gain)
+	{
+		if (encoder.GetOrder() > m_order) return false;
+		encoder.Encode(in, dir, gain, m_pChannel, m_blockSize);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		インターリーブされたアンビソニック信号の加算 (Unity のアンビソニッククリップなど)
+	 * @param[in]	in				[blockSize][numChannels] (ACN / SN3D)
+	 * @note		デコーダの次数を超えるチャンネルは捨てる。
+	 **************************************************************************/
+	void AddInterleaved(const YmReal32* in, YmUInt32 numChannels)
+	{
+		const YmUInt32 num = YmMath::Min(numChannels, m_numChannels);
+		for (YmUInt32 ch = 0; ch < num; ch++)
+		{
+			YmReal32* dst = m_pChannel[ch];
+			for (YmUInt32 n = 0; n < m_blockSize; n++) dst[n] += in[(size_t)n*numChannels + ch];
+		}
+	}
+
+	/***********************************************************************//**
+	 * @brief		ブロックのレンダリング (blockSize サンプルのステレオ出力)
+	 **************************************************************************/
+	void Render(YmReal32* outLeft, YmReal32* outRight)
+	{
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		memset(m_pEarSpec, 0, sizeof(YmReal32)*m_specStride*2);
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+		{
+			m_fft.Forward(m_pChannel[ch], m_pSpec);
+			k.ComplexMulAdd(m_pEarSpec,                m_pSpec, GetFilter(ch, 0), m_numBins);
+			k.ComplexMulAdd(m_pEarSpec + m_specStride, m_pSpec, GetFilter(ch, 1), m_numBins);
+		}
+		OverlapAdd(m_pEarSpec,                m_pOverlap,              outLeft);
+		OverlapAdd(m_pEarSpec + m_specStride, m_pOverlap + m_fftSize, outRight);
+	}
+
+	/***********************************************************************//**
+	 * @brief		状態のリセット (残響テールの破棄)
+	 **************************************************************************/
+	void Reset(void)
+	{
+		BeginBlock();
+		memset(m_pOverlap, 0, sizeof(YmReal32)*m_fftSize*2);
+	}
+
+	/// チャンネル ch のバス (blockSize サンプル, BeginBlock() から Render() までの間に加算する)
+	YmReal32* GetChannel(YmUInt32 ch)				{ return m_pChannel[ch]; }
+	YmReal32* const* GetChannels(void)				{ return m_pChannel; }
+	const YmReal32* GetFilter(YmUInt32 ch, YmUInt32 ear) const	{ return m_pFilter + ((size_t)ch*2 + ear)*m_specStride; }
+	YmUInt32 GetOrder(void) const					{ return m_order; }
+	YmUInt32 GetNumChannels(void) const				{ return m_numChannels; }
+	YmUInt32 GetFftSize(void) const					{ return m_fftSize; }
+
+private:
+	// フィルタ以外の作業領域
+	bool InitBuffers(YmMemAlloc* in_pAllocator, YmUInt32 order, YmUInt32 blockSize, YmUInt32 fftSize)
+	{
+		if (order == 0 || order > YM_AMBISONIC_MAX_ORDER) return false;
+		if (!m_fft.Init(in_pAllocator, fftSize)) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_order = order;
+		m_numChannels = YmAmbisonic::GetNumChannels(order);
+		m_blockSize = blockSize;
+		m_fftSize = fftSize;
+		m_numBins = m_fft.GetNumBins();
+		m_specStride = (m_numBins*2 + 15) & ~15u;	// キャッシュライン単位
+
+		m_pFilter  = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_specStride*2*m_numChannels);
+		m_pBus     = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)fftSize*m_numChannels);
+		m_pSpec    = alloc_array_nozero<YmReal32>(m_pAllocator, m_specStride);
+		m_pEarSpec = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_specStride*2);
+		m_pTime    = alloc_array_nozero<YmReal32>(m_pAllocator, fftSize);
+		m_pOverlap = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)fftSize*2);
+		if (!m_pFilter || !m_pBus || !m_pSpec || !m_pEarSpec || !m_pTime || !m_pOverlap) return false;
+
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++) m_pChannel[ch] = m_pBus + (size_t)ch*fftSize;
+		memset(m_pBus, 0, sizeof(YmReal32)*fftSize*m_numChannels);		// 後半はゼロ詰めのまま使う
+		memset(m_pOverlap, 0, sizeof(YmReal32)*fftSize*2);
+		YmSimd::InitKernels();
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		チャンネル x 左右のデコードフィルタの作成
+	 * @note		Y = [測定方向][チャンネル] のエンコード係数に対し、M = (Y^T Y + λI)^-1 Y^T を求め、
+	 *				filter[ch] = Σ_d M[ch][d] * HRTF[d] とする (方向 s の音源に対する仮想スピーカーゲインは M^T Y(s))。
+	 **************************************************************************/
+	bool BuildFilters(const YmHrtfTable& table, const YmVector3* directions, bool maxRe)
+	{
+		const YmUInt32 numDirections = table.GetNumDirections();
+		const YmUInt32 K = m_numChannels;
+		if (directions == nullptr || numDirections == 0) return false;
+
+		double* y = static_cast<double*>(alloc_memory_nozero(m_pAllocator, sizeof(double)*numDirections*K, 16));	// [d][ch]
+		double* g = static_cast<double*>(alloc_memory(m_pAllocator, sizeof(double)*K*K, 16));
+		if (y == nullptr || g == nullptr)
+		{
+			free_memory(m_pAllocator, y);
+			free_memory(m_pAllocator, g);
+			return false;
+		}
+
+		// G = Y^T Y + λI
+		for (YmUInt32 d = 0; d < numDirections; d++)
+		{
+			YmVector3 dir = directions[d];
+			const YmReal32 len = YmMath::Abs(dir);
+			if (len > 0.0f) dir = dir / len;
+			YmReal32 coef[YM_AMBISONIC_MAX_CHANNELS];
+			YmAmbisonic::GetCoefficients(m_order, dir, coef);
+			double* row = y + (size_t)d*K;
+			for (YmUInt32 i = 0; i < K; i++) row[i] = coef[i];
+			for (YmUInt32 i = 0; i < K; i++)
+			{
+				for (YmUInt32 j = 0; j < K; j++) g[i*K + j] += row[i]*row[j];
+			}
+		}
+		double trace = 0.0;
+		for (YmUInt32 i = 0; i < K; i++) trace += g[i*K + i];
+		const double lambda = YM_AMBISONIC_REGULARIZATION*trace / K;
+		for (YmUInt32 i = 0; i < K; i++) g[i*K + i] += lambda;
+
+		// G = L L^T (正定値なので必ず分解できる)
+		for (YmUInt32 j = 0; j < K; j++)
+		{
+			double s = g[j*K + j];
+			for (YmUInt32 p = 0; p < j; p++) s -= g[j*K + p]*g[j*K + p];
+			g[j*K + j] = sqrt(s);
+			for (YmUInt32 i = j + 1; i < K; i++)
+			{
+				double t = g[i*K + j];
+				for (YmUInt32 p = 0; p < j; p++) t -= g[i*K + p]*g[j*K + p];
+				g[i*K + j] = t / g[j*K + j];
+			}
+		}
+
+		YmReal32 weight[YM_AMBISONIC_MAX_ORDER + 1];
+		if (maxRe) YmAmbisonic::GetMaxReWeights(m_order, weight);
+		else for (YmUInt32 l = 0; l <= m_order; l++) weight[l] = 1.0f;
+
+		// 方向ごとに M[.][d] = G^-1 Y[d] を解き、HRTF を重み付き加算
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		memset(m_pFilter, 0, sizeof(YmReal32)*m_specStride*2*K);
+		for (YmUInt32 d = 0; d < numDirections; d++)
+		{
+			double m[YM_AMBISONIC_MAX_CHANNELS];
+			const double* row = y + (size_t)d*K;
+			for (YmUInt32 i = 0; i < K; i++)
+			{
+				double t = row[i];
+				for (YmUInt32 p = 0; p < i; p++) t -= g[i*K + p]*m[p];
+				m[i] = t / g[i*K + i];
+			}
+			for (YmUInt32 i = K; i-- > 0; )
+			{
+				double t = m[i];
+				for (YmUInt32 p = i + 1; p < K; p++) t -= g[p*K + i]*m[p];
+				m[i] = t / g[i*K + i];
+			}
+			for (YmUInt32 ch = 0; ch < K; ch++)
+			{
+				const YmReal32 gain = (YmReal32)m[ch]*weight[YmAmbisonic::GetChannelOrder(ch)];
+				if (gain == 0.0f) continue;
+				k.MixGain(m_pFilter + ((size_t)ch*2 + 0)*m_specStride, table.GetSpectrum(d, 0), gain, m_numBins*2);
+				k.MixGain(m_pFilter + ((size_t)ch*2 + 1)*m_specStride, table.GetSpectrum(d, 1), gain, m_numBins*2);
+			}
+		}
+		free_memory(m_pAllocator, y);
+		free_memory(m_pAllocator, g);
+		return true;
+	}
+
+	void OverlapAdd(const YmReal32* spec, YmReal32* overlap, YmReal32* out)
+	{
+		const YmUInt32 B = m_blockSize;
+		const YmUInt32 tail = m_fftSize - B;
+		m_fft.Inverse(spec, m_pTime);
+		for (YmUInt32 n = 0; n < B; n++) out[n] = m_pTime[n] + overlap[n];
+		for (YmUInt32 n = 0; n < tail; n++)
+		{
+			const YmReal32 prev = (n + B < tail) ? overlap[n + B] : 0.0f;
+			overlap[n] = prev + m_pTime[B + n];
+		}
+	}
+
+	YmMemAlloc*		m_pAllocator;
+	YmFft			m_fft;
+	YmUInt32		m_order;
+	YmUInt32		m_numChannels;
+	YmUInt32		m_blockSize;
+	YmUInt32		m_fftSize;
+	YmUInt32		m_numBins;
+	YmUInt32		m_specStride;		// 1 スペクトルの float 数 (16 の倍数)
+	YmReal32*		m_pFilter;			// [ch][ear][m_specStride]
+	YmReal32*		m_pBus;				// [ch][fftSize] (後半はゼロ詰め)
+	YmReal32*		m_pChannel[YM_AMBISONIC_MAX_CHANNELS];
+	YmReal32*		m_pSpec;
+	YmReal32*		m_pEarSpec;			// [ear][m_specStride]
+	YmReal32*		m_pTime;
+	YmReal32*		m_pOverlap;			// [ear][fftSize]
+};
+
+#endif // YM_USE_AMBISONIC
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -1,23 +1,26 @@
-﻿/*****************************************************************************************//**
- * @file			YmBase.h
- * @brief			共通インクルード
- * @attention		
- *
- *                 (C) 2018 Yamaha Corporation
- *                  Confidential
- ********************************************************************************************/
-
-#pragma once
-
-#include "private/YmTarget.h"
-#include "private/YmTypes.h"
-#include "private/YmMemory.h"
-#include "private/YmMath.h"
-
-#if YM_USE_SIMD
-	#include "private/YmSimd.h"
-#endif
-
-/*********************************************************************************************
-* EOF
-*********************************************************************************************/
+﻿/*****************************************************************************************//**
+ * @file			YmBase.h
+ * @brief			共通インクルード
+ * @attention		
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+
+#if YM_USE_SIMD
+	#include "private/YmSimd.h"
+	#include "private/YmSimdDispatch.h"
+#endif
+#include "private/YmMathBatch.h"
+#include "private/YmVectorArray.h"
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,429 @@
+﻿/*****************************************************************************************//**
+ * @file			YmBatchSpatializer.h
+ * @brief			複数音源の一括バイノーラル化 (1 DSP ティック分をまとめて処理)
+ * @attention		畳込みの線形性を利用し、同じ HRTF 方向の音源は時間軸で先に合算して
+ *					FFT を方向ごとに 1 回だけ行う。HRTF との積はステレオバスのスペクトルに
+ *					直接積和し、逆 FFT はバス全体で左右 1 回ずつ (オーバーラップ加算)。
+ *
+ *					  音源ごと : ゲイン付き加算のみ
+ *					  方向ごと : FFT 1 回 + 複素積和 2 回
+ *					  バスごと : 逆 FFT 2 回
+ *
+ *					FFT のバタフライと複素積和は、ブロックの先頭で取得した YmSimd のカーネルテーブルで行う。
+ *
+ *					使い方: BeginBlock() -> AddSource() x 音源数 -> Render()
+ *
+ *					HRTF セットを外部 (YmHrtfSelector) から渡す場合は、HRTF なしの Init() で初期化し、
+ *					BeginBlock(current, previous) でブロックごとにテーブルを指定する。
+ *					セット切替ブロックでは旧テーブルの方向に BANK_PREVIOUS で加算する
+ *					(方向スロットはバンクごとに別になる)。
+ *
+ *					YM_USE_SILENCE_BYPASS が 1 のターゲットでは、無音の入力は方向スロットを使わずに捨てる
+ *					(その方向の FFT が不要になる)。有音の方向がないブロックは逆 FFT を省き、
+ *					オーバーラップのテールだけを出力し、テールも尽きたら無音を出力するだけになる。
+ *
+ *					YM_USE_WORKER_POOL が 1 のターゲットでは、SetWorkerPool() で渡したプールで
+ *					方向ごとの FFT を並列に行う。HRTF との積和は join 後にスロット順で行うため、
+ *					出力はプールを使わない場合と一致する。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmFft.h"
+#include "private/YmHrtfGrid.h"
+#include "private/YmHrtfPack.h"
+#include "private/YmSimdDispatch.h"
+#include "private/YmSilence.h"
+#include "private/YmWorkerPool.h"
+
+class YmBatchSpatializer
+{
+public:
+	YmBatchSpatializer() : m_pAllocator(nullptr), m_pKernels(nullptr), m_pTables(), m_blockSize(0), m_fftSize(0), m_numBins(0), m_specStride(0),
+		m_maxSources(0), m_numDirections(0), m_numActive(0), m_tailBlocks(0), m_pDirToSlot(nullptr),
+		m_pSlotDir(nullptr), m_pSlotBuf(nullptr), m_pSpec(nullptr), m_pBusSpec(nullptr), m_pTime(nullptr), m_pOverlap(nullptr)
+#if YM_USE_WORKER_POOL
+		, m_pWorkerPool(nullptr), m_pSlotSpec(nullptr)
+#endif
+		{}
+	~YmBatchSpatializer() { Term(); }
+
+	YmBatchSpatializer(const YmBatchSpatializer&) = delete;
+	YmBatchSpatializer& operator=(const YmBatchSpatializer&) = delete;
+
+	/// 方向インデックスが参照する HRTF テーブル
+	enum Bank
+	{
+		BANK_CURRENT	= 0,	///< このブロックのテーブル
+		BANK_PREVIOUS	= 1,	///< 切替前のテーブル (フェードアウト用)
+		NUM_BANKS
+	};
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	blockSize		1 ブロックのサンプル数 (dspbuffersize)
+	 * @param[in]	maxSources		1 ブロックに加算できる最大音源数
+	 * @param[in]	numDirections	HRTF 方向数
+	 * @param[in]	irLength		HRIR 長
+	 * @param[in]	irLeft, irRight	HRIR [numDirections][irLength]
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxSources,
+		YmUInt32 numDirections, YmUInt32 irLength, const YmReal32* irLeft, const YmReal32* irRight)
+	{
+		Term();
+		if (blockSize == 0 || irLength == 0) return false;
+
+		YmUInt32 fftSize = 4;
+		while (fftSize < blockSize + irLength - 1) fftSize <<= 1;
+		if (!InitBuffers(in_pAllocator, blockSize, maxSources, numDirections, fftSize)
+			|| !m_hrtf.Init(in_pAllocator, m_fft, numDirections, irLength, irLeft, irRight))
+		{
+			Term();
+			return false;
+		}
+		m_pTables[BANK_CURRENT] = &m_hrtf;
+		return true;
+	}
+
+#if YM_USE_HRTF_PACK
+	/***********************************************************************//**
+	 * @brief		HRTF パックで初期化 (パックのスペクトルをコピーせずに参照する)
+	 * @param[in]	pack			Term() まで開いたままにすること
+	 * @return		blockSize がパックの FFT サイズに収まらない場合 false
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxSources, const YmHrtfPack& pack)
+	{
+		Term();
+		if (!pack.IsUsableFor(blockSize)) return false;
+		if (!InitBuffers(in_pAllocator, blockSize, maxSources, pack.GetNumDirections(), pack.GetFftSize())
+			|| !m_hrtf.InitShared(pack.GetSpectra(), pack.GetNumDirections(), pack.GetNumBins(), pack.GetSpecStride()))
+		{
+			Term();
+			return false;
+		}
+		m_pTables[BANK_CURRENT] = &m_hrtf;
+		return true;
+	}
+#endif
+
+	/***********************************************************************//**
+	 * @brief		HRTF なしで初期化 (テーブルは BeginBlock(current, previous) で渡す)
+	 * @param[in]	maxDirections	渡すテーブルの方向数の上限
+	 * @param[in]	fftSize			テーブルの FFT サイズ (blockSize + irLength - 1 以上)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxSources, YmUInt32 maxDirections, YmUInt32 fftSize)
+	{
+		Term();
+		if (blockSize == 0 || fftSize < blockSize || (fftSize & (fftSize - 1)) != 0
+			|| !InitBuffers(in_pAllocator, blockSize, maxSources, maxDirections, fftSize))
+		{
+			Term();
+			return false;
+		}
+		return true;
+	}
+
+	void Term(void)
+	{
+		m_fft.Term();
+		m_hrtf.Term();
+		free_memory(m_pAllocator, m_pDirToSlot);
+		free_memory(m_pAllocator, m_pSlotDir);
+		free_memory(m_pAllocator, m_pSlotBuf);
+		free_memory(m_pAllocator, m_pSpec);
+		free_memory(m_pAllocator, m_pBusSpec);
+		free_memory(m_pAllocator, m_pTime);
+		free_memory(m_pAllocator, m_pOverlap);
+#if YM_USE_WORKER_POOL
+		free_memory(m_pAllocator, m_pSlotSpec);
+		m_pSlotSpec = nullptr;
+		m_pWorkerPool = nullptr;
+#endif
+		m_pDirToSlot = nullptr;
+		m_pSlotDir = nullptr;
+		m_pSlotBuf = nullptr;
+		m_pSpec = nullptr;
+		m_pBusSpec = nullptr;
+		m_pTime = nullptr;
+		m_pOverlap = nullptr;
+		m_pKernels = nullptr;
+		m_pTables[BANK_CURRENT] = nullptr;
+		m_pTables[BANK_PREVIOUS] = nullptr;
+		m_numActive = 0;
+	}
+
+#if YM_USE_WORKER_POOL
+	/***********************************************************************//**
+	 * @brief		方向ごとの FFT を並列に行うワーカープールの設定 (Init() の後、非オーディオスレッドで呼ぶこと)
+	 * @param[in]	pool			nullptr で直列処理に戻す。Render() はプールを呼び出すスレッドから呼ぶこと
+	 * @return		未初期化、または方向ごとのスペクトル領域を確保できない場合 false
+	 **************************************************************************/
+	bool SetWorkerPool(YmWorkerPool* pool)
+	{
+		if (m_pSlotBuf == nullptr) return false;
+		if (pool != nullptr && m_pSlotSpec == nullptr)
+		{
+			m_pSlotSpec = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_specStride*m_maxSources);
+			if (m_pSlotSpec == nullptr) return false;
+		}
+		m_pWorkerPool = pool;
+		return true;
+	}
+#endif
+
+	/***********************************************************************//**
+	 * @brief		ブロック開始 (前ブロックの方向割当をクリア)
+	 * @note		カーネルテーブルはここで取り、このブロックの AddSource() / Render() で使う
+	 **************************************************************************/
+	void BeginBlock(void)
+	{
+		m_pKernels = &YmSimd::GetKernels();
+		for (YmUInt32 s = 0; s < m_numActive; s++)
+		{
+			m_pDirToSlot[m_pSlotDir[s]] = INVALID_SLOT;
+			memset(m_pSlotBuf + (size_t)s*m_fftSize, 0, sizeof(YmReal32)*m_blockSize);
+		}
+		m_numActive = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ブロック開始 (外部の HRTF テーブルを使う場合)
+	 * @param[in]	current			このブロックのテーブル
+	 * @param[in]	previous		セット切替ブロックのみ旧テーブル、それ以外は nullptr
+	 * @return		テーブルの方向数・FFT サイズが Init() と合わない場合 false (加算はすべて失敗する)
+	 **************************************************************************/
+	bool BeginBlock(const YmHrtfTable* current, const YmHrtfTable* previous)
+	{
+		BeginBlock();
+		m_pTables[BANK_CURRENT] = IsCompatible(current) ? current : nullptr;
+		m_pTables[BANK_PREVIOUS] = IsCompatible(previous) ? previous : nullptr;
+		return m_pTables[BANK_CURRENT] != nullptr && (previous == nullptr || m_pTables[BANK_PREVIOUS] != nullptr);
+	}
+
+	/***********************************************************************//**
+	 * @brief		音源の追加
+	 * @param[in]	in				入力 (blockSize サンプル, mono)
+	 * @param[in]	directionIndex	HRTF 方向
+	 * @param[in]	gain			音量・距離減衰をまとめた線形ゲイン
+	 * @return		同時方向数が maxSources を超えた場合 false
+	 **************************************************************************/
+	bool AddSource(const YmReal32* in, YmUInt32 directionIndex, YmReal32 gain)
+	{
+#if YM_USE_SILENCE_BYPASS
+		if (YmSilence::IsSilent(in, m_blockSize)) return true;
+#endif
+		const YmUInt32 slot = AcquireSlot(directionIndex, BANK_CURRENT);
+		if (slot == INVALID_SLOT) return false;
+		m_pKernels->MixGain(m_pSlotBuf + (size_t)slot*m_fftSize, in, gain, m_blockSize);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		音源の追加 (ブロック内でゲインを線形補間)
+	 * @param[in]	gainStart		前ブロック末尾のゲイン
+	 * @param[in]	gainEnd			このブロック末尾のゲイン
+	 * @param[in]	bank			directionIndex が指すテーブル
+	 * @note		ゲインの段差によるジッパーノイズを防ぐ。方向の切替は
+	 *				旧方向に gainStart -> 0、新方向に 0 -> gainEnd で 2 回呼ぶとクロスフェードになる。
+	 **************************************************************************/
+	bool AddSource(const YmReal32* in, YmUInt32 directionIndex, YmReal32 gainStart, YmReal32 gainEnd, Bank bank = BANK_CURRENT)
+	{
+#if YM_USE_SILENCE_BYPASS
+		if (YmSilence::IsSilent(in, m_blockSize)) return true;
+#endif
+		const YmUInt32 slot = AcquireSlot(directionIndex, bank);
+		if (slot == INVALID_SLOT) return false;
+		m_pKernels->MixGainRamp(m_pSlotBuf + (size_t)slot*m_fftSize, in, gainStart, gainEnd, m_blockSize);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ブロックのレンダリング (blockSize サンプルのステレオ出力)
+	 **************************************************************************/
+	void Render(YmReal32* outLeft, YmReal32* outRight)
+	{
+		const YmSimd::Kernels& k = *m_pKernels;
+		if (m_numActive == 0)
+		{
+			// 有音の方向なし: 逆 FFT を省いてテールのみ出力
+			if (m_tailBlocks == 0)
+			{
+				memset(outLeft, 0, sizeof(YmReal32)*m_blockSize);
+				memset(outRight, 0, sizeof(YmReal32)*m_blockSize);
+				return;
+			}
+			OverlapAdd(k, nullptr, m_pOverlap,             outLeft);
+			OverlapAdd(k, nullptr, m_pOverlap + m_fftSize, outRight);
+			m_tailBlocks--;
+			return;
+		}
+		m_tailBlocks = (m_fftSize - 1) / m_blockSize;
+
+		memset(m_pBusSpec, 0, sizeof(YmReal32)*m_specStride*2);
+#if YM_USE_WORKER_POOL
+		if (m_pWorkerPool != nullptr && m_numActive > 1)
+		{
+			m_pWorkerPool->ParallelFor(m_numActive, &YmBatchSpatializer::ForwardTask, this);
+			for (YmUInt32 s = 0; s < m_numActive; s++) MulAddSlot(k, s, m_pSlotSpec + (size_t)s*m_specStride);
+		}
+		else
+#endif
+		{
+			for (YmUInt32 s = 0; s < m_numActive; s++)
+			{
+				m_fft.Forward(m_pSlotBuf + (size_t)s*m_fftSize, m_pSpec, m_pSpec, k);
+				MulAddSlot(k, s, m_pSpec);
+			}
+		}
+		OverlapAdd(k, m_pBusSpec,                m_pOverlap,              outLeft);
+		OverlapAdd(k, m_pBusSpec + m_specStride, m_pOverlap + m_fftSize, outRight);
+	}
+
+	/***********************************************************************//**
+	 * @brief		状態のリセット (残響テールの破棄)
+	 **************************************************************************/
+	void Reset(void)
+	{
+		BeginBlock();
+		memset(m_pOverlap, 0, sizeof(YmReal32)*m_fftSize*2);
+		m_tailBlocks = 0;
+	}
+
+	YmUInt32 GetNumActiveDirections(void) const	{ return m_numActive; }
+	YmUInt32 GetFftSize(void) const					{ return m_fftSize; }
+
+private:
+	static const YmUInt32 INVALID_SLOT = 0xFFFFFFFFu;
+
+	// HRTF 以外の作業領域
+	bool InitBuffers(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxSources, YmUInt32 numDirections, YmUInt32 fftSize)
+	{
+		if (maxSources == 0 || numDirections == 0) return false;
+		if (!m_fft.Init(in_pAllocator, fftSize)) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_blockSize = blockSize;
+		m_fftSize = fftSize;
+		m_numBins = m_fft.GetNumBins();
+		m_specStride = (m_numBins*2 + 15) & ~15u;	// キャッシュライン単位
+		m_maxSources = maxSources;
+		m_numDirections = numDirections;
+
+		m_pDirToSlot = alloc_array_nozero<YmUInt32>(m_pAllocator, (size_t)numDirections*NUM_BANKS);
+		m_pSlotDir   = alloc_array_nozero<YmUInt32>(m_pAllocator, maxSources);
+		m_pSlotBuf   = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)fftSize*maxSources);
+		m_pSpec      = alloc_array_nozero<YmReal32>(m_pAllocator, m_specStride);
+		m_pBusSpec   = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_specStride*2);
+		m_pTime      = alloc_array_nozero<YmReal32>(m_pAllocator, fftSize);
+		m_pOverlap   = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)fftSize*2);
+		if (!m_pDirToSlot || !m_pSlotDir || !m_pSlotBuf || !m_pSpec || !m_pBusSpec || !m_pTime || !m_pOverlap) return false;
+
+		for (YmUInt32 d = 0; d < numDirections*NUM_BANKS; d++) m_pDirToSlot[d] = INVALID_SLOT;
+		memset(m_pSlotBuf, 0, sizeof(YmReal32)*fftSize*maxSources);
+		memset(m_pOverlap, 0, sizeof(YmReal32)*fftSize*2);
+		m_numActive = 0;
+		m_tailBlocks = 0;
+		YmSimd::InitKernels();
+		m_pKernels = &YmSimd::GetKernels();
+		return true;
+	}
+
+	// 方向に対応する加算スロット (なければ割り当てる)
+	YmUInt32 AcquireSlot(YmUInt32 directionIndex, Bank bank)
+	{
+		const YmHrtfTable* table = m_pTables[bank];
+		if (table == nullptr || directionIndex >= table->GetNumDirections()) return INVALID_SLOT;
+		const YmUInt32 key = bank*m_numDirections + directionIndex;
+		YmUInt32 slot = m_pDirToSlot[key];
+		if (slot == INVALID_SLOT)
+		{
+			if (m_numActive >= m_maxSources) return INVALID_SLOT;
+			slot = m_numActive++;
+			m_pDirToSlot[key] = slot;
+			m_pSlotDir[slot] = key;
+		}
+		return slot;
+	}
+
+	// スロットのスペクトルと HRTF の積をバスに加算
+	void MulAddSlot(const YmSimd::Kernels& k, YmUInt32 slot, const YmReal32* spec)
+	{
+		const YmUInt32 key = m_pSlotDir[slot];
+		const YmUInt32 bank = (key >= m_numDirections) ? BANK_PREVIOUS : BANK_CURRENT;
+		const YmHrtfTable* table = m_pTables[bank];
+		const YmUInt32 d = key - bank*m_numDirections;
+		k.ComplexMulAdd(m_pBusSpec,                spec, table->GetSpectrum(d, 0), m_numBins);
+		k.ComplexMulAdd(m_pBusSpec + m_specStride, spec, table->GetSpectrum(d, 1), m_numBins);
+	}
+
+#if YM_USE_WORKER_POOL
+	// ワーカーでのスロット 1 つの FFT (スロットのスペクトル領域を作業領域にも使う)
+	static void ForwardTask(void* context, YmUInt32 slot)
+	{
+		YmBatchSpatializer* self = static_cast<YmBatchSpatializer*>(context);
+		YmReal32* spec = self->m_pSlotSpec + (size_t)slot*self->m_specStride;
+		self->m_fft.Forward(self->m_pSlotBuf + (size_t)slot*self->m_fftSize, spec, spec, *self->m_pKernels);
+	}
+#endif
+
+	bool IsCompatible(const YmHrtfTable* table) const
+	{
+		return table != nullptr && table->GetNumDirections() <= m_numDirections && table->GetNumBins() == m_numBins;
+	}
+
+	// spec が nullptr なら今回のスペクトルは 0 (テールの送りのみ)
+	void OverlapAdd(const YmSimd::Kernels& k, const YmReal32* spec, YmReal32* overlap, YmReal32* out)
+	{
+		const YmUInt32 B = m_blockSize;
+		const YmUInt32 tail = m_fftSize - B;
+		if (spec == nullptr)
+		{
+			memcpy(out, overlap, sizeof(YmReal32)*B);
+			for (YmUInt32 n = 0; n < tail; n++) overlap[n] = (n + B < tail) ? overlap[n + B] : 0.0f;
+			return;
+		}
+		m_fft.Inverse(spec, m_pTime, k);
+		for (YmUInt32 n = 0; n < B; n++) out[n] = m_pTime[n] + overlap[n];
+		// overlap[0..tail) を B だけ詰め、今回のテールを加える
+		for (YmUInt32 n = 0; n < tail; n++)
+		{
+			const YmReal32 prev = (n + B < tail) ? overlap[n + B] : 0.0f;
+			overlap[n] = prev + m_pTime[B + n];
+		}
+	}
+
+	YmMemAlloc*		m_pAllocator;
+	const YmSimd::Kernels*	m_pKernels;		// BeginBlock() で取ったカーネルテーブル
+	YmFft			m_fft;
+	YmHrtfTable		m_hrtf;				// [dir][ear][m_specStride] (HRTF 付きの Init() のみ)
+	const YmHrtfTable*	m_pTables[NUM_BANKS];
+	YmUInt32		m_blockSize;
+	YmUInt32		m_fftSize;
+	YmUInt32		m_numBins;
+	YmUInt32		m_specStride;		// 1 スペクトルの float 数 (16 の倍数)
+	YmUInt32		m_maxSources;
+	YmUInt32		m_numDirections;
+	YmUInt32		m_numActive;		// 今回のブロックで使用中の方向数
+	YmUInt32		m_tailBlocks;		// オーバーラップのテールが残るブロック数
+	YmUInt32*		m_pDirToSlot;		// [bank][dir] -> slot
+	YmUInt32*		m_pSlotDir;			// [slot] -> bank*m_numDirections + dir
+	YmReal32*		m_pSlotBuf;			// [slot][fftSize] (後半はゼロ詰め)
+	YmReal32*		m_pSpec;
+	YmReal32*		m_pBusSpec;			// [ear][m_specStride]
+	YmReal32*		m_pTime;
+	YmReal32*		m_pOverlap;			// [ear][fftSize]
+#if YM_USE_WORKER_POOL
+	YmWorkerPool*	m_pWorkerPool;
+	YmReal32*		m_pSlotSpec;		// [slot][m_specStride] (プール使用時のみ)
+#endif
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,259 @@
+﻿/*****************************************************************************************//**
+ * @file			YmCommandQueue.h
+ * @brief			ゲームスレッド -> オーディオスレッドのパラメータ / 位置更新コマンドキュー (SPSC ロックフリー)
+ * @attention		書込み側 1 スレッド (ゲームスレッド)、読出し側 1 スレッド (オーディオスレッド) 専用。
+ *
+ *					・コマンドは固定長 (32 バイト) で、位置・姿勢など複数の float を 1 コマンドで運ぶ。
+ *					  読出し側には Publish() 済みのコマンドしか見えないため、値が途中で欠けることはない。
+ *					・Reserve() で書き込んだコマンドは Publish() でまとめて公開する。
+ *					  1 フレーム分 (数百件) の変更でも atomic の書込みは 1 回で済む。
+ *					・tick は UnityAudioEffectState::currdsptick と同じサンプル時刻。
+ *					  オーディオスレッドは毎コールバック SetDspTick() で現在時刻を公開し、
+ *					  ゲームスレッドは GetDspTick() を基準に時刻を付ける。
+ *					  YM_COMMAND_IMMEDIATE (0) は次のブロックの先頭で適用する。
+ *					・読出し側は GetNextOffset() でブロック内の適用位置を求め、そこまで処理してから
+ *					  Drain() で適用する (サンプル単位)。キューは FIFO なので tick は単調増加で付けること
+ *					  (先頭より前の tick を持つ後続コマンドは、先頭の適用まで遅れる)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+
+#define YM_COMMAND_IMMEDIATE		0ull	///< 次のブロック先頭で適用
+#define YM_COMMAND_CACHE_LINE		64
+
+/***********************************************************************//**
+ * @brief			コマンド種別
+ **************************************************************************/
+enum YmCommandType
+{
+	YM_COMMAND_SET_FLOAT = 0,		///< param 番のパラメータに value[0] を設定 (SetFloatParameter 相当)
+	YM_COMMAND_SET_POSITION,		///< 音源位置 value[0..2] = x, y, z [m]
+	YM_COMMAND_SET_ORIENTATION,		///< 姿勢 (クォータニオン) value[0..3] = x, y, z, w
+	YM_COMMAND_RESET,				///< 音源状態のリセット
+	YM_COMMAND_USER = 0x100,		///< 以降はアプリケーション定義
+};
+
+/***********************************************************************//**
+ * @brief			コマンド (32 バイト)
+ **************************************************************************/
+struct YmCommand
+{
+	YmUInt64	tick;			///< 適用時刻 (currdsptick 基準のサンプル時刻)
+	YmUInt16	type;			///< YmCommandType
+	YmUInt16	param;			///< パラメータ番号 (YM_COMMAND_SET_FLOAT)
+	YmUInt32	target;			///< 対象 (音源 ID 等)
+	YmReal32	value[4];
+};
+
+class YmCommandQueue
+{
+public:
+	YmCommandQueue() : m_pAllocator(nullptr), m_pRing(nullptr), m_mask(0), m_writePos(0), m_reservePos(0), m_cachedReadPos(0),
+		m_readPos(0), m_cachedWritePos(0), m_dspTick(0) {}
+	~YmCommandQueue() { Term(); }
+
+	YmCommandQueue(const YmCommandQueue&) = delete;
+	YmCommandQueue& operator=(const YmCommandQueue&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	capacity	コマンド数 (2 のべき乗に切り上げる)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 capacity)
+	{
+		Term();
+		if (capacity == 0 || capacity > 0x40000000u) return false;
+		YmUInt32 size = 1;
+		while (size < capacity) size <<= 1;
+
+		m_pRing = static_cast<YmCommand*>(alloc_memory(in_pAllocator, sizeof(YmCommand)*size, YM_COMMAND_CACHE_LINE));
+		if (m_pRing == nullptr) return false;
+		m_pAllocator = in_pAllocator;
+		m_mask = size - 1;
+		Clear();
+		return true;
+	}
+
+	void Term(void)
+	{
+		if (m_pRing == nullptr) return;
+		free_memory(m_pAllocator, m_pRing);
+		m_pAllocator = nullptr;
+		m_pRing = nullptr;
+		m_mask = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		全コマンドの破棄 (両スレッドが止まっているときのみ)
+	 **************************************************************************/
+	void Clear(void)
+	{
+		m_writePos.store(0, std::memory_order_relaxed);
+		m_readPos.store(0, std::memory_order_relaxed);
+		m_reservePos = 0;
+		m_cachedReadPos = 0;
+		m_cachedWritePos = 0;
+	}
+
+	//--- 書込み側 (ゲームスレッド)
+
+	/***********************************************************************//**
+	 * @brief		コマンド領域の確保 (Publish() まで読出し側には見えない)
+	 * @return		満杯なら nullptr
+	 **************************************************************************/
+	YmCommand* Reserve(void)
+	{
+		if (m_reservePos - m_cachedReadPos > m_mask)
+		{
+			m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+			if (m_reservePos - m_cachedReadPos > m_mask) return nullptr;
+		}
+		return &m_pRing[m_reservePos++ & m_mask];
+	}
+
+	/***********************************************************************//**
+	 * @brief		Reserve() したコマンドをまとめて公開
+	 **************************************************************************/
+	void Publish(void)
+	{
+		m_writePos.store(m_reservePos, std::memory_order_release);
+	}
+
+	/***********************************************************************//**
+	 * @brief		1 コマンドの書込みと公開
+	 * @return		満杯なら false (コマンドは捨てられる)
+	 **************************************************************************/
+	bool Push(const YmCommand& command)
+	{
+		YmCommand* p = Reserve();
+		if (p == nullptr) return false;
+		*p = command;
+		Publish();
+		return true;
+	}
+
+	bool PushFloat(YmUInt64 tick, YmUInt32 target, YmUInt16 param, YmReal32 value)
+	{
+		YmCommand* p = Reserve();
+		if (p == nullptr) return false;
+		Set(*p, tick, YM_COMMAND_SET_FLOAT, target, param);
+		p->value[0] = value;
+		Publish();
+		return true;
+	}
+
+	bool PushPosition(YmUInt64 tick, YmUInt32 target, const YmVector3& pos)
+	{
+		YmCommand* p = Reserve();
+		if (p == nullptr) return false;
+		Set(*p, tick, YM_COMMAND_SET_POSITION, target, 0);
+		p->value[0] = pos.x;
+		p->value[1] = pos.y;
+		p->value[2] = pos.z;
+		Publish();
+		return true;
+	}
+
+	//--- 読出し側 (オーディオスレッド)
+
+	/***********************************************************************//**
+	 * @brief		現在のサンプル時刻を公開 (コールバック先頭で currdsptick を渡す)
+	 **************************************************************************/
+	void SetDspTick(YmUInt64 tick)				{ m_dspTick.store(tick, std::memory_order_relaxed); }
+
+	/***********************************************************************//**
+	 * @brief		先頭コマンドの参照 (なければ nullptr)
+	 **************************************************************************/
+	const YmCommand* Peek(void)
+	{
+		const YmUInt32 pos = m_readPos.load(std::memory_order_relaxed);
+		if (pos == m_cachedWritePos)
+		{
+			m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+			if (pos == m_cachedWritePos) return nullptr;
+		}
+		return &m_pRing[pos & m_mask];
+	}
+
+	/***********************************************************************//**
+	 * @brief		先頭コマンドの破棄 (Peek() が nullptr 以外を返した後に呼ぶ)
+	 **************************************************************************/
+	void Pop(void)
+	{
+		m_readPos.store(m_readPos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/***********************************************************************//**
+	 * @brief		次のコマンドのブロック内適用位置
+	 * @param[in]	blockTick	ブロック先頭の時刻 (currdsptick)
+	 * @param[in]	blockSize	ブロック長
+	 * @return		適用位置 [0, blockSize]。ブロック内になければ blockSize
+	 **************************************************************************/
+	YmUInt32 GetNextOffset(YmUInt64 blockTick, YmUInt32 blockSize)
+	{
+		const YmCommand* p = Peek();
+		if (p == nullptr) return blockSize;
+		if (p->tick <= blockTick) return 0;
+		const YmUInt64 offset = p->tick - blockTick;
+		return (offset < blockSize) ? (YmUInt32)offset : blockSize;
+	}
+
+	/***********************************************************************//**
+	 * @brief		tick <= untilTick のコマンドを順に適用
+	 * @param[in]	func	void (const YmCommand&)
+	 * @return		適用したコマンド数
+	 **************************************************************************/
+	template <class F> YmUInt32 Drain(YmUInt64 untilTick, F&& func)
+	{
+		YmUInt32 count = 0;
+		for (;;)
+		{
+			const YmCommand* p = Peek();
+			if (p == nullptr || p->tick > untilTick) break;
+			func(*p);
+			Pop();
+			count++;
+		}
+		return count;
+	}
+
+	//--- 両スレッド
+
+	YmUInt64 GetDspTick(void) const				{ return m_dspTick.load(std::memory_order_relaxed); }
+	YmUInt32 GetCapacity(void) const			{ return m_mask + 1; }
+	YmUInt32 GetNumPending(void) const			{ return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire); }
+
+private:
+	static void Set(YmCommand& command, YmUInt64 tick, YmUInt16 type, YmUInt32 target, YmUInt16 param)
+	{
+		command.tick = tick;
+		command.type = type;
+		command.param = param;
+		command.target = target;
+	}
+
+	// 書込み側と読出し側の変数はキャッシュラインを分ける
+	YmMemAlloc*				m_pAllocator;
+	YmCommand*				m_pRing;
+	YmUInt32				m_mask;
+	YmUInt8					m_pad0[YM_COMMAND_CACHE_LINE];
+	std::atomic<YmUInt32>	m_writePos;			// 公開済み位置 (書込み側が更新)
+	YmUInt32				m_reservePos;		// 書込み側のみ
+	YmUInt32				m_cachedReadPos;	// 書込み側のみ
+	YmUInt8					m_pad1[YM_COMMAND_CACHE_LINE];
+	std::atomic<YmUInt32>	m_readPos;			// 読出し位置 (読出し側が更新)
+	YmUInt32				m_cachedWritePos;	// 読出し側のみ
+	std::atomic<YmUInt64>	m_dspTick;			// 読出し側が更新
+	YmUInt8					m_pad2[YM_COMMAND_CACHE_LINE];
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
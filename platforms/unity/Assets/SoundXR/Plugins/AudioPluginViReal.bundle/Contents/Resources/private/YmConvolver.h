@@ -0,0 +1,350 @@
+﻿/*****************************************************************************************//**
+ * @file			YmConvolver.h
+ * @brief			時間軸 / 周波数軸畳込のインスタンス単位の切替
+ * @attention		両方式を常にコンパイルし、Init() 時に方式を決める。
+ *					MODE_AUTO ではフィルタ長とブロック長 (UnityAudioEffectState::dspbuffersize) から
+ *					EstimateCost() で安い方を選ぶ。短いブロック・短いフィルタでは時間軸、
+ *					長いブロック・長いフィルタでは周波数軸 (YmPartitionedConvolver) になる。
+ *
+ *					YM_USE_HYBRID_CONV が 0 のターゲットでは、MODE_AUTO は YmTarget.h の
+ *					YM_USE_FREQ_DOMAIN / YM_USE_TIME_DOMAIN に従う (従来の動作)。
+ *
+ *					再生中のフィルタ変更 (ヘッドトラッキング・音源移動) は UpdateFilters() で行い、
+ *					次のブロックで新旧の出力をクロスフェードする。フェードしないブロックの負荷は変わらない。
+ *					フェード中の更新は捨てずに 1 つだけ保留し (最後の更新が残る)、フェードが終わり次第適用する。
+ *					YmDirectionGate で方向変化が閾値未満の更新を間引く。
+ *
+ *					YM_USE_SILENCE_BYPASS が 1 のターゲットでは、入力の無音がフィルタ長以上続いた
+ *					ブロックの畳込みを省略する (YmSilenceGate)。次の有音ブロックで状態をリセットして即座に再開する。
+ *					省略中の UpdateFilters() はクロスフェードせず、再開ブロックから新フィルタのみで処理する
+ *					(直前の出力が無音のため)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+#include "private/YmPartitionedConvolver.h"
+#include "private/YmSilence.h"
+
+#define YM_CONV_MAX_PARTITION_BLOCKS	16		///< 周波数軸の最大分割長 (ブロック長の倍数)
+#define YM_CONV_DIRECTION_THRESHOLD_DEG	1.0f	///< フィルタを更新する方向変化の既定閾値 [deg]
+
+/*****************************************************************************************//**
+ * @brief		方向変化の閾値判定
+ * @attention	最後に Commit() した方向とのなす角が閾値を超えたときだけ IsChanged() が true になる。
+ *				毎ブロック少しずつ動く場合も、累積で閾値を超えた時点で更新される。
+ ********************************************************************************************/
+class YmDirectionGate
+{
+public:
+	explicit YmDirectionGate(YmReal32 thresholdDeg = YM_CONV_DIRECTION_THRESHOLD_DEG) : m_valid(false)
+	{
+		SetThreshold(thresholdDeg);
+	}
+
+	void SetThreshold(YmReal32 thresholdDeg)	{ m_cosThreshold = cosf(thresholdDeg*YMH_DEG2RAD); }
+	void Reset(void)							{ m_valid = false; }
+
+	/***********************************************************************//**
+	 * @brief		方向が閾値を超えて変化したか
+	 * @param[in]	dir		方向 (正規化不要、ゼロベクトルは変化なし扱い)
+	 **************************************************************************/
+	bool IsChanged(const YmVector3& dir) const
+	{
+		if (!m_valid) return true;
+		const YmReal32 d2 = YmMath::Abs2(dir);
+		if (d2 <= 0.0f) return false;
+		const YmReal32 dot = YmMath::InnerProduct(dir, m_dir);
+		// dot/|dir| < cos(th)  (|m_dir| = 1)
+		return (dot < 0.0f) || (dot*dot < m_cosThreshold*m_cosThreshold*d2);
+	}
+
+	/***********************************************************************//**
+	 * @brief		フィルタに反映した方向を記録
+	 **************************************************************************/
+	void Commit(const YmVector3& dir)
+	{
+		const YmReal32 d = YmMath::Abs(dir);
+		if (d <= 0.0f) return;
+		m_dir = dir/d;
+		m_valid = true;
+	}
+
+private:
+	YmVector3	m_dir;
+	YmReal32	m_cosThreshold;
+	bool		m_valid;
+};
+
+class YmConvolver
+{
+public:
+	enum Mode
+	{
+		MODE_AUTO = 0,
+		MODE_TIME,			///< 時間軸 (直接 FIR)
+		MODE_FREQ,			///< 周波数軸 (分割畳込)
+	};
+
+	YmConvolver() : m_pAllocator(nullptr), m_mode(MODE_TIME), m_blockSize(0), m_maxLength(0), m_numChannels(0),
+		m_bank(0), m_prevBank(1), m_fading(false), m_pCoef(nullptr), m_pHist(nullptr), m_pFade(nullptr) {}
+	~YmConvolver() { Term(); }
+
+	YmConvolver(const YmConvolver&) = delete;
+	YmConvolver& operator=(const YmConvolver&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	blockSize	ブロック長 (dspbuffersize)
+	 * @param[in]	maxLength	フィルタ長の上限
+	 * @param[in]	numChannels	フィルタチャンネル数 (入力は共通)
+	 * @param[in]	mode		方式 (MODE_AUTO で自動選択)
+	 * @note		MODE_FREQ はブロック長が 2 のべき乗の場合のみ使える。MODE_AUTO では
+	 *				2 のべき乗でないブロック長 (192, 480 等) や周波数軸の初期化に失敗した場合に時間軸になる。
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxLength, YmUInt32 numChannels, Mode mode = MODE_AUTO)
+	{
+		Term();
+		if (blockSize == 0 || maxLength == 0 || numChannels == 0 || numChannels > YM_CONV_MAX_CHANNELS) return false;
+
+		YmSimd::InitKernels();
+		m_pAllocator = in_pAllocator;
+		m_blockSize = blockSize;
+		m_maxLength = maxLength;
+		m_numChannels = numChannels;
+		m_mode = (mode == MODE_AUTO) ? SelectMode(blockSize, maxLength, numChannels) : mode;
+		m_silence.SetTailLength(maxLength - 1);
+		m_silence.Reset();
+
+		if (m_mode == MODE_FREQ)
+		{
+			if (m_freq.Init(in_pAllocator, blockSize, maxLength, numChannels, 0, blockSize*YM_CONV_MAX_PARTITION_BLOCKS)) return true;
+			if (mode != MODE_AUTO)
+			{
+				Term();
+				return false;
+			}
+			m_freq.Term();
+			m_mode = MODE_TIME;
+		}
+
+		m_pCoef = alloc_array<YmReal32>(in_pAllocator, (size_t)maxLength*numChannels*3);
+		m_pHist = alloc_array<YmReal32>(in_pAllocator, (size_t)maxLength - 1 + blockSize);
+		m_pFade = alloc_array<YmReal32>(in_pAllocator, blockSize);
+		if (!m_pCoef || !m_pHist || !m_pFade)
+		{
+			Term();
+			return false;
+		}
+		return true;
+	}
+
+	void Term(void)
+	{
+		m_freq.Term();
+		free_memory(m_pAllocator, m_pCoef);
+		free_memory(m_pAllocator, m_pHist);
+		free_memory(m_pAllocator, m_pFade);
+		m_pCoef = nullptr;
+		m_pHist = nullptr;
+		m_pFade = nullptr;
+		m_numChannels = 0;
+		m_bank = 0;
+		m_prevBank = 1;
+		m_fading = false;
+	}
+
+	/***********************************************************************//**
+	 * @brief		フィルタの設定 (即座に置き換わる、初期設定用)
+	 **************************************************************************/
+	void SetFilter(YmUInt32 ch, const YmReal32* ir, YmUInt32 length)
+	{
+		if (ch >= m_numChannels) return;
+		if (m_mode == MODE_FREQ)
+		{
+			m_freq.SetFilter(ch, ir, length);
+			return;
+		}
+		WriteCoef(m_bank, ch, ir, length);
+	}
+
+	/***********************************************************************//**
+	 * @brief		全チャンネルのフィルタをクロスフェードで更新
+	 * @param[in]	irs		インパルス応答 [numChannels]
+	 * @param[in]	length	長さ (maxLength を超える分は切り捨て)
+	 * @return		未初期化なら false
+	 * @note		MODE_TIME は次の 1 ブロック、MODE_FREQ は各セグメントの次の計算区間でフェードする。
+	 *				フェード中の更新は保留して、フェードが終わり次第適用する (保留は最後の 1 つのみ)。
+	 *				MODE_FREQ では FFT を伴うため、ブロック長が大きい場合は非オーディオスレッド推奨。
+	 **************************************************************************/
+	bool UpdateFilters(const YmReal32* const* irs, YmUInt32 length)
+	{
+		if (m_mode == MODE_FREQ) return m_freq.UpdateFilters(irs, length);
+		if (m_numChannels == 0) return false;
+		// 現在・旧のどちらでもない面に書き込む。まだ処理していないフェードは旧フィルタのまま新フィルタだけ差し替える
+		const YmUInt32 next = 3 - m_bank - m_prevBank;
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++) WriteCoef(next, ch, irs[ch], length);
+		if (!m_fading) m_prevBank = m_bank;
+		m_bank = next;
+		m_fading = true;
+		return true;
+	}
+
+	bool IsFading(void) const				{ return (m_mode == MODE_FREQ) ? m_freq.IsFading() : m_fading; }
+	/// 出力に反映され始めていない更新があるか (次の UpdateFilters() で置き換わる)
+	bool IsUpdatePending(void) const		{ return (m_mode == MODE_FREQ) ? m_freq.IsUpdatePending() : m_fading; }
+
+	/***********************************************************************//**
+	 * @brief		1 ブロックの処理
+	 * @param[in]	in		入力 [blockSize]
+	 * @param[out]	out		出力 [numChannels][blockSize]
+	 **************************************************************************/
+	void Process(const YmReal32* in, YmReal32* const* out)
+	{
+#if YM_USE_SILENCE_BYPASS
+		if (m_silence.Update(in, m_blockSize))
+		{
+			for (YmUInt32 ch = 0; ch < m_numChannels; ch++) memset(out[ch], 0, sizeof(YmReal32)*m_blockSize);
+			return;
+		}
+		if (m_silence.IsResuming()) ResetState();
+#endif
+		if (m_mode == MODE_FREQ)
+		{
+			m_freq.Process(in, out);
+			return;
+		}
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		const YmUInt32 hist = m_maxLength - 1;
+		memcpy(m_pHist + hist, in, sizeof(YmReal32)*m_blockSize);
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+		{
+			k.Fir(out[ch], m_pHist, GetCoef(m_bank, ch), m_blockSize, m_maxLength);
+		}
+		if (m_fading)
+		{
+			// 旧フィルタの出力から 1 ブロックで線形クロスフェード
+			const YmReal32 step = 1.0f / (YmReal32)m_blockSize;
+			for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+			{
+				k.Fir(m_pFade, m_pHist, GetCoef(m_prevBank, ch), m_blockSize, m_maxLength);
+				YmReal32* dst = out[ch];
+				for (YmUInt32 n = 0; n < m_blockSize; n++) dst[n] = m_pFade[n] + (dst[n] - m_pFade[n])*(YmReal32)(n + 1)*step;
+			}
+			m_fading = false;
+		}
+		memmove(m_pHist, m_pHist + m_blockSize, sizeof(YmReal32)*hist);
+	}
+
+	void Reset(void)
+	{
+		ResetState();
+		m_silence.Reset();
+	}
+
+	/// 無音とみなす入力のピーク (負の値で無音の省略をしない)
+	void SetSilenceThreshold(YmReal32 threshold)	{ m_silence.SetThreshold(threshold); }
+	/// 直前のブロックの畳込みを省略したか (プロファイル用)
+	bool IsBypassed(void) const				{ return m_silence.IsBypassed(); }
+
+	Mode GetMode(void) const				{ return m_mode; }
+	YmUInt32 GetBlockSize(void) const		{ return m_blockSize; }
+	YmUInt32 GetNumChannels(void) const		{ return m_numChannels; }
+
+	/***********************************************************************//**
+	 * @brief		1 サンプルあたりの概算コスト (積和換算)
+	 * @note		時間軸の積和は SIMD 幅で割る。FFT はスカラー実装として
+	 *				N/2*log2(N) バタフライ x 約 5 演算で見積もる。
+	 *				周波数軸は一様分割 (分割長 = ブロック長) の場合で見積もる (非一様ではこれ以下)。
+	 **************************************************************************/
+	static YmReal32 EstimateCost(Mode mode, YmUInt32 blockSize, YmUInt32 length, YmUInt32 numChannels)
+	{
+		if (mode == MODE_TIME)
+		{
+			return (YmReal32)length*numChannels/(YmReal32)GetSimdWidth();
+		}
+		YmUInt32 log2n = 0;
+		while ((1u << log2n) < blockSize*2) log2n++;
+		const YmReal32 fft = 5.0f*(YmReal32)blockSize*(YmReal32)log2n;		// 2B 点実数 FFT
+		const YmUInt32 numPartitions = (length + blockSize - 1)/blockSize;
+		const YmReal32 mac = 4.0f*(YmReal32)(blockSize + 1)*numPartitions/(YmReal32)GetSimdWidth();
+		return ((1 + numChannels)*fft + numChannels*mac)/(YmReal32)blockSize;
+	}
+
+	/***********************************************************************//**
+	 * @brief		MODE_AUTO の選択結果
+	 **************************************************************************/
+	static Mode SelectMode(YmUInt32 blockSize, YmUInt32 length, YmUInt32 numChannels)
+	{
+		// 周波数軸 (YmPartitionedConvolver) は 2 のべき乗のブロック長のみ
+		if (blockSize == 0 || (blockSize & (blockSize - 1)) != 0) return MODE_TIME;
+#if YM_USE_HYBRID_CONV
+		return (EstimateCost(MODE_FREQ, blockSize, length, numChannels) < EstimateCost(MODE_TIME, blockSize, length, numChannels)) ? MODE_FREQ : MODE_TIME;
+#elif YM_USE_FREQ_DOMAIN
+		(void)blockSize; (void)length; (void)numChannels;
+		return MODE_FREQ;
+#else
+		(void)blockSize; (void)length; (void)numChannels;
+		return MODE_TIME;
+#endif
+	}
+
+private:
+	void ResetState(void)
+	{
+		if (m_mode == MODE_FREQ)
+		{
+			m_freq.Reset();
+			return;
+		}
+		if (m_pHist) memset(m_pHist, 0, sizeof(YmReal32)*(m_maxLength - 1 + m_blockSize));
+		m_fading = false;
+	}
+
+	YmReal32* GetCoef(YmUInt32 bank, YmUInt32 ch) const	{ return m_pCoef + ((size_t)bank*m_numChannels + ch)*m_maxLength; }
+
+	void WriteCoef(YmUInt32 bank, YmUInt32 ch, const YmReal32* ir, YmUInt32 length)
+	{
+		if (length > m_maxLength) length = m_maxLength;
+		YmReal32* coef = GetCoef(bank, ch);
+		for (YmUInt32 k = 0; k < m_maxLength; k++)
+		{
+			coef[m_maxLength - 1 - k] = (k < length) ? ir[k] : 0.0f;
+		}
+	}
+
+	static YmUInt32 GetSimdWidth(void)
+	{
+		switch (YmSimd::GetKernels().tier)
+		{
+		case YmSimd::TIER_AVX512:	return 16;
+		case YmSimd::TIER_AVX2:		return 8;
+		case YmSimd::TIER_SCALAR:	return 1;
+		default:					return 4;
+		}
+	}
+
+	YmMemAlloc*				m_pAllocator;
+	Mode					m_mode;
+	YmUInt32				m_blockSize;
+	YmUInt32				m_maxLength;
+	YmUInt32				m_numChannels;
+	YmPartitionedConvolver	m_freq;			// MODE_FREQ
+	YmUInt32				m_bank;			// MODE_TIME 現在の係数面
+	YmUInt32				m_prevBank;		// MODE_TIME フェード元の係数面
+	bool					m_fading;		// MODE_TIME 次のブロックでクロスフェードする
+	YmReal32*				m_pCoef;		// MODE_TIME [bank(3)][ch][maxLength] (逆順)
+	YmReal32*				m_pHist;		// MODE_TIME [maxLength-1 + blockSize]
+	YmReal32*				m_pFade;		// MODE_TIME 旧フィルタの出力 [blockSize]
+	YmSilenceGate			m_silence;		// 無音の継続 (YM_USE_SILENCE_BYPASS)
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
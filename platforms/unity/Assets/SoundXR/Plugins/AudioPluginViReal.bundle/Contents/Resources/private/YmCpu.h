@@ -0,0 +1,132 @@
+﻿/*****************************************************************************************//**
+ * @file			YmCpu.h
+ * @brief			実行時 CPU 機能判定
+ * @attention		判定結果は初回呼び出し時に一度だけ取得し、以降はキャッシュを返す
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTypes.h"
+
+#if defined(_M_X64)||defined(_M_IX86)||defined(__x86_64__)||defined(__i386__)
+	#define YM_CPU_X86						1
+#else
+	#define YM_CPU_X86						0
+#endif
+
+#if YM_CPU_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#elif defined(__GNUC__)||defined(__clang__)
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace YmCpu {
+
+/***********************************************************************//**
+ * @brief			CPU 機能フラグ
+ **************************************************************************/
+enum Feature : YmUInt32
+{
+	FEATURE_SSE3		= 1u << 0,
+	FEATURE_SSSE3		= 1u << 1,
+	FEATURE_SSE41		= 1u << 2,
+	FEATURE_AVX			= 1u << 3,
+	FEATURE_AVX2		= 1u << 4,
+	FEATURE_FMA			= 1u << 5,
+	FEATURE_AVX512F		= 1u << 6,
+	FEATURE_NEON		= 1u << 7,
+};
+
+#if YM_CPU_X86
+/***********************************************************************//**
+ * @brief			cpuid / xgetbv
+ **************************************************************************/
+inline void Cpuid(YmUInt32 leaf, YmUInt32 subleaf, YmUInt32 regs[4])
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; i++) regs[i] = (YmUInt32)r[i];
+#else
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	regs[0] = a; regs[1] = b; regs[2] = c; regs[3] = d;
+#endif
+}
+
+inline YmUInt64 Xgetbv(YmUInt32 index)
+{
+#if defined(_MSC_VER)
+	return (YmUInt64)_xgetbv(index);
+#else
+	YmUInt32 eax = 0, edx = 0;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return ((YmUInt64)edx << 32) | eax;
+#endif
+}
+#endif
+
+/***********************************************************************//**
+ * @brief			CPU 機能の判定
+ * @note			AVX 以上は OS がレジスタ退避に対応しているか (XCR0) も確認する
+ **************************************************************************/
+inline YmUInt32 DetectFeatures(void)
+{
+	YmUInt32 features = 0;
+#if YM_CPU_X86
+	YmUInt32 regs[4];
+	Cpuid(0, 0, regs);
+	const YmUInt32 maxLeaf = regs[0];
+	if (maxLeaf < 1) return features;
+
+	Cpuid(1, 0, regs);
+	const YmUInt32 ecx1 = regs[2];
+	if (ecx1 & (1u << 0))  features |= FEATURE_SSE3;
+	if (ecx1 & (1u << 9))  features |= FEATURE_SSSE3;
+	if (ecx1 & (1u << 19)) features |= FEATURE_SSE41;
+
+	// OSXSAVE が無効なら AVX 系は使用不可
+	if (!(ecx1 & (1u << 27))) return features;
+	const YmUInt64 xcr0 = Xgetbv(0);
+	const bool osAvx    = (xcr0 & 0x06) == 0x06;	// XMM | YMM
+	const bool osAvx512 = (xcr0 & 0xE6) == 0xE6;	// XMM | YMM | opmask | ZMM
+	if (!osAvx) return features;
+
+	if (ecx1 & (1u << 28)) features |= FEATURE_AVX;
+	if (ecx1 & (1u << 12)) features |= FEATURE_FMA;
+	if (maxLeaf >= 7)
+	{
+		Cpuid(7, 0, regs);
+		if (regs[1] & (1u << 5)) features |= FEATURE_AVX2;
+		if (osAvx512 && (regs[1] & (1u << 16))) features |= FEATURE_AVX512F;
+	}
+#elif defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
+	features |= FEATURE_NEON;
+#endif
+	return features;
+}
+
+/***********************************************************************//**
+ * @brief			CPU 機能の取得 (キャッシュ)
+ **************************************************************************/
+inline YmUInt32 GetFeatures(void)
+{
+	static const YmUInt32 s_features = DetectFeatures();
+	return s_features;
+}
+
+inline bool HasFeatures(YmUInt32 mask)
+{
+	return (GetFeatures() & mask) == mask;
+}
+
+} // namespace YmCpu
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,229 @@
+﻿/*****************************************************************************************//**
+ * @file			YmFft.h
+ * @brief			実数 FFT (2 のべき乗長)
+ * @attention		スペクトルは (re,im) インターリーブで N/2+1 ビン。
+ *					Forward() -> Inverse() で元の信号に戻る (逆変換側で 1/N を掛ける)。
+ *					作業領域を内部に持つため、1 インスタンスを複数スレッドから同時に使わないこと
+ *					(作業領域を渡す Forward() のみ、スレッドごとに別の領域を渡せば同時に呼べる)。
+ *					バタフライは YmSimd のカーネルテーブル (FftRadix2) で処理する。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <math.h>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmSimdDispatch.h"
+
+class YmFft
+{
+public:
+	YmFft() : m_pAllocator(nullptr), m_size(0), m_half(0), m_pWork(nullptr), m_pTwiddle(nullptr), m_pRealTwiddle(nullptr), m_pBitRev(nullptr) {}
+	~YmFft() { Term(); }
+
+	YmFft(const YmFft&) = delete;
+	YmFft& operator=(const YmFft&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化
+	 * @param[in]	size	FFT 長 (4 以上の 2 のべき乗)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 size)
+	{
+		Term();
+		if (size < 4 || (size & (size - 1)) != 0) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_size = size;
+		m_half = size / 2;
+		m_pWork        = alloc_array_nozero<YmReal32>(in_pAllocator, 2*m_half);
+		m_pTwiddle     = alloc_array_nozero<YmReal32>(in_pAllocator, 4*(m_half - 1));
+		m_pRealTwiddle = alloc_array_nozero<YmReal32>(in_pAllocator, m_half + 2);
+		m_pBitRev      = alloc_array_nozero<YmUInt32>(in_pAllocator, m_half);
+		if (!m_pWork || !m_pTwiddle || !m_pRealTwiddle || !m_pBitRev)
+		{
+			Term();
+			return false;
+		}
+
+		// 複素 FFT (長さ M = N/2) の回転因子 e^{-2πik/M}。
+		// 段ごとに連続して使えるよう、区間の半分の長さ half の段は [half-1, 2*half-1) に
+		// k = j*M/(2*half) (j < half) の値を並べる。逆変換用の共役はその後ろ [M-1, 2M-2) に置く
+		YmReal32* inverse = m_pTwiddle + 2*(m_half - 1);
+		for (YmUInt32 half = 1; half < m_half; half <<= 1)
+		{
+			const YmUInt32 step = m_half / (2*half);
+			for (YmUInt32 j = 0; j < half; j++)
+			{
+				const YmUInt32 k = j*step;
+				const YmReal64 w = -2.0*3.14159265358979323846*k/m_half;
+				const YmUInt32 i = half - 1 + j;
+				m_pTwiddle[2*i]   = (YmReal32)cos(w);
+				m_pTwiddle[2*i+1] = (YmReal32)sin(w);
+				inverse[2*i]      = m_pTwiddle[2*i];
+				inverse[2*i+1]    = -m_pTwiddle[2*i+1];
+			}
+		}
+		// 実数化用の回転因子 e^{-2πik/N}, k <= M/2
+		for (YmUInt32 k = 0; k <= m_half/2; k++)
+		{
+			const YmReal64 w = -2.0*3.14159265358979323846*k/m_size;
+			m_pRealTwiddle[2*k]   = (YmReal32)cos(w);
+			m_pRealTwiddle[2*k+1] = (YmReal32)sin(w);
+		}
+		YmUInt32 bits = 0;
+		while ((1u << bits) < m_half) bits++;
+		for (YmUInt32 i = 0; i < m_half; i++)
+		{
+			YmUInt32 r = 0;
+			for (YmUInt32 b = 0; b < bits; b++) r |= ((i >> b) & 1u) << (bits - 1 - b);
+			m_pBitRev[i] = r;
+		}
+		return true;
+	}
+
+	void Term(void)
+	{
+		free_memory(m_pAllocator, m_pWork);
+		free_memory(m_pAllocator, m_pTwiddle);
+		free_memory(m_pAllocator, m_pRealTwiddle);
+		free_memory(m_pAllocator, m_pBitRev);
+		m_pWork = nullptr;
+		m_pTwiddle = nullptr;
+		m_pRealTwiddle = nullptr;
+		m_pBitRev = nullptr;
+		m_size = 0;
+		m_half = 0;
+	}
+
+	YmUInt32 GetSize(void) const		{ return m_size; }
+	YmUInt32 GetNumBins(void) const		{ return m_half + 1; }
+
+	/***********************************************************************//**
+	 * @brief		順変換 (実数 N 点 -> 複素 N/2+1 ビン)
+	 **************************************************************************/
+	void Forward(const YmReal32* in, YmReal32* spec)
+	{
+		Forward(in, spec, m_pWork, YmSimd::GetKernels());
+	}
+
+	/***********************************************************************//**
+	 * @brief		順変換 (作業領域を呼び出し側で持つ)
+	 * @param[in]	work	作業領域 [N] (spec と同じ領域でもよい。in とは重ならないこと)
+	 * @param[in]	kernels	バタフライに使うカーネル
+	 **************************************************************************/
+	void Forward(const YmReal32* in, YmReal32* spec, YmReal32* work, const YmSimd::Kernels& kernels) const
+	{
+		const YmUInt32 M = m_half;
+		// z[n] = x[2n] + i x[2n+1] をビット反転順に並べる
+		for (YmUInt32 n = 0; n < M; n++)
+		{
+			const YmUInt32 r = m_pBitRev[n];
+			work[2*r]   = in[2*n];
+			work[2*r+1] = in[2*n+1];
+		}
+		Butterfly(work, false, kernels);
+
+		// X[k] = E[k] + W^k O[k]
+		// (ビン k, M-k は Z[k], Z[M-k] のみから決まるので、spec == work でも上書きの順序は問題ない)
+		const YmReal32* Z = work;
+		const YmReal32 z0 = Z[0], z1 = Z[1];
+		spec[0] = z0 + z1;		spec[1] = 0.0f;
+		spec[2*M] = z0 - z1;	spec[2*M+1] = 0.0f;
+		for (YmUInt32 k = 1; k <= M/2; k++)
+		{
+			const YmUInt32 j = M - k;
+			const YmReal32 ar = Z[2*k], ai = Z[2*k+1];
+			const YmReal32 br = Z[2*j], bi = -Z[2*j+1];		// conj(Z[M-k])
+			const YmReal32 er = 0.5f*(ar + br), ei = 0.5f*(ai + bi);
+			const YmReal32 or_ = 0.5f*(ai - bi), oi = -0.5f*(ar - br);	// (Zk - Zc)/(2i)
+			YmReal32 wr, wi;
+			GetRealTwiddle(k, wr, wi);
+			const YmReal32 tr = wr*or_ - wi*oi, ti = wr*oi + wi*or_;
+			spec[2*k]   = er + tr;
+			spec[2*k+1] = ei + ti;
+			// X[M-k] = conj(E[k]) + W^{M-k} conj(O[k]) = conj(E[k] - W^k O[k])
+			spec[2*j]   = er - tr;
+			spec[2*j+1] = -(ei - ti);
+		}
+	}
+
+	/***********************************************************************//**
+	 * @brief		逆変換 (複素 N/2+1 ビン -> 実数 N 点, 1/N 正規化込み)
+	 **************************************************************************/
+	void Inverse(const YmReal32* spec, YmReal32* out)
+	{
+		Inverse(spec, out, YmSimd::GetKernels());
+	}
+
+	/***********************************************************************//**
+	 * @brief		逆変換 (バタフライに使うカーネルを指定)
+	 **************************************************************************/
+	void Inverse(const YmReal32* spec, YmReal32* out, const YmSimd::Kernels& kernels)
+	{
+		const YmUInt32 M = m_half;
+		// Z[k] = E[k] + i O[k]
+		YmReal32* Z = m_pWork;
+		for (YmUInt32 k = 0; k <= M/2; k++)
+		{
+			const YmUInt32 j = M - k;
+			const YmReal32 ar = spec[2*k], ai = spec[2*k+1];
+			const YmReal32 br = spec[2*j], bi = -spec[2*j+1];		// conj(X[M-k])
+			const YmReal32 er = 0.5f*(ar + br), ei = 0.5f*(ai + bi);
+			const YmReal32 dr = 0.5f*(ar - br), di = 0.5f*(ai - bi);
+			YmReal32 wr, wi;
+			GetRealTwiddle(k, wr, wi);
+			const YmReal32 or_ = dr*wr + di*wi, oi = di*wr - dr*wi;	// D * conj(W^k)
+			const YmUInt32 rk = m_pBitRev[k];
+			Z[2*rk]   = er - oi;
+			Z[2*rk+1] = ei + or_;
+			if (j != k && j < M)
+			{
+				// E, O は実数列の DFT なので E[M-k] = conj(E[k]), O[M-k] = conj(O[k])
+				const YmUInt32 rj = m_pBitRev[j];
+				Z[2*rj]   = er + oi;
+				Z[2*rj+1] = or_ - ei;
+			}
+		}
+		Butterfly(Z, true, kernels);
+		const YmReal32 scale = 1.0f/(YmReal32)M;
+		for (YmUInt32 n = 0; n < M; n++)
+		{
+			out[2*n]   = Z[2*n]*scale;
+			out[2*n+1] = Z[2*n+1]*scale;
+		}
+	}
+
+private:
+	inline void GetRealTwiddle(YmUInt32 k, YmReal32& wr, YmReal32& wi) const
+	{
+		wr = m_pRealTwiddle[2*k];
+		wi = m_pRealTwiddle[2*k+1];
+	}
+
+	// ビット反転済みデータに対する基数 2 バタフライ (長さ M 複素)
+	void Butterfly(YmReal32* data, bool inverse, const YmSimd::Kernels& kernels) const
+	{
+		const YmUInt32 M = m_half;
+		const YmReal32* twiddle = inverse ? m_pTwiddle + 2*(M - 1) : m_pTwiddle;
+		for (YmUInt32 half = 1; half < M; half <<= 1)
+		{
+			kernels.FftRadix2(data, twiddle + 2*(half - 1), M, half);
+		}
+	}
+
+	YmMemAlloc*		m_pAllocator;
+	YmUInt32		m_size;			// N
+	YmUInt32		m_half;			// M = N/2
+	YmReal32*		m_pWork;		// M 複素
+	YmReal32*		m_pTwiddle;		// 段ごとの回転因子 M-1 複素 x (順, 逆)
+	YmReal32*		m_pRealTwiddle;	// M/2+1 複素
+	YmUInt32*		m_pBitRev;		// M
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
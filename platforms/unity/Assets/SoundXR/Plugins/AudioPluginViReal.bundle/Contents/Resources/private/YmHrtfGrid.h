@@ -0,0 +1,614 @@
+﻿/*****************************************************************************************//**
+ * @file			YmHrtfGrid.h
+ * @brief			HRTF 方向の補間グリッド (定数時間の 3 点検索) と周波数領域 HRTF テーブル
+ * @attention		YmHrtfGrid
+ *					  測定方向 (単位球上の点) の凸包 = 球面 Delaunay 三角形分割を Init() で構築し、
+ *					  方向ベクトルを含む三角形の 3 頂点と重心座標の重みを返す。
+ *					  検索はキューブマップのセルから開始三角形を引き、隣接三角形をたどる
+ *					  (セルは三角形より細かく取るので、通常 0～1 歩で終わる)。
+ *					  測定方向の偏り (下方向の欠落など) で原点が凸包の外に出ないよう、
+ *					  30° 以内に測定点のない座標軸方向には仮想点を置き、最も近い測定方向に対応付ける。
+ *
+ *					YmHrtfTable
+ *					  HRIR を FFT 済みのスペクトル [dir][ear] としてキャッシュライン境界に並べて保持する。
+ *					  InitShared() では同じ並びの外部領域 (YmHrtfPack) をコピーせずに参照する。
+ *					  Interpolate() は YmHrtfWeights の 3 点を周波数領域で重み付き加算する
+ *					  (時間領域の HRIR 補間と等価)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmLargeMemory.h"
+#include "private/YmMath.h"
+#include "private/YmFft.h"
+#include "private/YmSimdDispatch.h"
+
+#define YM_HRTF_GRID_MAX_RESOLUTION		64		///< キューブマップ 1 面あたりの分割数の上限
+#define YM_HRTF_GRID_VIRTUAL_COS		0.866f	///< 仮想点を置く条件 (最も近い測定点との角度 > 30°)
+
+/***********************************************************************//**
+ * @brief			補間の重み
+ * @note			index が重複する場合がある (仮想点を含む三角形)。重みの合計は 1。
+ **************************************************************************/
+struct YmHrtfWeights
+{
+	YmUInt32	index[3];		///< HRTF 方向番号
+	YmReal32	weight[3];		///< 重み
+};
+
+/***********************************************************************//**
+ * @brief			方向 -> 3 点補間の検索グリッド
+ **************************************************************************/
+class YmHrtfGrid
+{
+public:
+	YmHrtfGrid() : m_pAllocator(nullptr), m_pTriangles(nullptr), m_pCellStart(nullptr),
+		m_numDirections(0), m_numTriangles(0), m_resolution(0) {}
+	~YmHrtfGrid() { Term(); }
+
+	YmHrtfGrid(const YmHrtfGrid&) = delete;
+	YmHrtfGrid& operator=(const YmHrtfGrid&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと。計算量は O(numDirections^2))
+	 * @param[in]	directions		測定方向 [numDirections] (長さは任意、リスナー座標系)
+	 * @param[in]	resolution		キューブマップ 1 面の分割数 (0: 三角形数から自動)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, const YmVector3* directions, YmUInt32 numDirections, YmUInt32 resolution = 0)
+	{
+		Term();
+		if (directions == nullptr || numDirections == 0) return false;
+		m_pAllocator = in_pAllocator;
+		m_numDirections = numDirections;
+		if (!BuildTriangles(directions, numDirections))
+		{
+			Term();
+			return false;
+		}
+
+		if (resolution == 0)
+		{
+			// セル数 ≒ 三角形数 x 4
+			resolution = 1;
+			while (6*resolution*resolution < m_numTriangles*4) resolution++;
+		}
+		m_resolution = YmMath::Min<YmUInt32>(YmMath::Max<YmUInt32>(resolution, 1), YM_HRTF_GRID_MAX_RESOLUTION);
+		const YmUInt32 numCells = 6*m_resolution*m_resolution;
+		m_pCellStart = alloc_array_nozero<YmUInt32>(m_pAllocator, numCells);
+		if (m_pCellStart == nullptr)
+		{
+			Term();
+			return false;
+		}
+		YmUInt32 start = 0;
+		for (YmUInt32 c = 0; c < numCells; c++)
+		{
+			YmReal32 d[3], w[3];
+			GetCellCenter(c, d);
+			start = Locate(d, start, w);
+			m_pCellStart[c] = start;
+		}
+		return true;
+	}
+
+	/// 初期化 (測定方向を極座標で渡す)
+	bool Init(YmMemAlloc* in_pAllocator, const YmPolar3* directions, YmUInt32 numDirections, YmUInt32 resolution = 0)
+	{
+		if (directions == nullptr || numDirections == 0) return false;
+		YmVector3* rect = static_cast<YmVector3*>(alloc_memory_nozero(in_pAllocator, sizeof(YmVector3)*numDirections, 16));
+		if (rect == nullptr) return false;
+		for (YmUInt32 i = 0; i < numDirections; i++) rect[i] = YmMath::PolarToRect(directions[i].azim, directions[i].elev, 1.0f);
+		const bool ok = Init(in_pAllocator, rect, numDirections, resolution);
+		free_memory(in_pAllocator, rect);
+		return ok;
+	}
+
+	void Term(void)
+	{
+		free_memory(m_pAllocator, m_pTriangles);
+		free_memory(m_pAllocator, m_pCellStart);
+		m_pTriangles = nullptr;
+		m_pCellStart = nullptr;
+		m_numDirections = 0;
+		m_numTriangles = 0;
+		m_resolution = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		方向を含む三角形の 3 点と重みを求める (オーディオスレッド可)
+	 * @param[in]	dir		リスナー座標系の方向 (正規化不要、0 ベクトルは正面扱い)
+	 **************************************************************************/
+	void Lookup(const YmVector3& dir, YmHrtfWeights& out) const
+	{
+		YmReal32 d[3] = { dir.x, dir.y, dir.z };
+		if (YmMath::Max(YmMath::Max(fabsf(d[0]), fabsf(d[1])), fabsf(d[2])) < 1.e-20f)
+		{
+			d[0] = 0.0f; d[1] = 0.0f; d[2] = 1.0f;
+		}
+		YmReal32 w[3];
+		const Triangle& t = m_pTriangles[Locate(d, m_pCellStart[GetCell(d)], w)];
+
+		// 境界上の微小な負の重みを切り捨てて正規化
+		YmReal32 sum = 0.0f;
+		for (int k = 0; k < 3; k++)
+		{
+			w[k] = YmMath::Max(w[k], 0.0f);
+			sum += w[k];
+		}
+		const YmReal32 r = (sum > 0.0f) ? 1.0f/sum : 0.0f;
+		for (int k = 0; k < 3; k++)
+		{
+			out.index[k] = t.vertex[k];
+			out.weight[k] = (sum > 0.0f) ? w[k]*r : ((k == 0) ? 1.0f : 0.0f);
+		}
+	}
+
+	YmUInt32 GetNumDirections(void) const	{ return m_numDirections; }
+	YmUInt32 GetNumTriangles(void) const	{ return m_numTriangles; }
+	YmUInt32 GetResolution(void) const		{ return m_resolution; }
+
+private:
+	/// 三角形 (64 バイト = 1 キャッシュライン)
+	struct Triangle
+	{
+		YmReal32	inv[9];			// [v0 v1 v2]^-1 (行 k と方向の内積が重み k)
+		YmUInt32	vertex[3];		// HRTF 方向番号
+		YmUInt32	neighbor[3];	// 頂点 k の対辺で隣接する三角形
+		YmUInt32	reserved;
+	};
+
+	static void Weights(const Triangle& t, const YmReal32 d[3], YmReal32 w[3])
+	{
+		for (int k = 0; k < 3; k++) w[k] = t.inv[3*k]*d[0] + t.inv[3*k+1]*d[1] + t.inv[3*k+2]*d[2];
+	}
+
+	/// 隣接をたどって d を含む三角形を探す
+	YmUInt32 Locate(const YmReal32 d[3], YmUInt32 start, YmReal32 w[3]) const
+	{
+		YmUInt32 t = start;
+		for (YmUInt32 step = 0; step < m_numTriangles; step++)
+		{
+			Weights(m_pTriangles[t], d, w);
+			int k = (w[1] < w[0]) ? 1 : 0;
+			if (w[2] < w[k]) k = 2;
+			if (w[k] >= -1.e-6f) return t;
+			t = m_pTriangles[t].neighbor[k];
+		}
+		// 巡回した場合 (縮退した分割) は全探索で最も内側の三角形
+		YmUInt32 best = 0;
+		YmReal32 bestMin = -3.4e38f;
+		for (YmUInt32 i = 0; i < m_numTriangles; i++)
+		{
+			YmReal32 v[3];
+			Weights(m_pTriangles[i], d, v);
+			const YmReal32 m = YmMath::Min(YmMath::Min(v[0], v[1]), v[2]);
+			if (m > bestMin) { bestMin = m; best = i; }
+		}
+		Weights(m_pTriangles[best], d, w);
+		return best;
+	}
+
+	/// キューブマップのセル番号 [face][v][u]
+	YmUInt32 GetCell(const YmReal32 d[3]) const
+	{
+		int axis = (fabsf(d[1]) > fabsf(d[0])) ? 1 : 0;
+		if (fabsf(d[2]) > fabsf(d[axis])) axis = 2;
+		const YmReal32 r = 1.0f / fabsf(d[axis]);
+		const YmUInt32 face = (YmUInt32)axis*2 + ((d[axis] < 0.0f) ? 1 : 0);
+		const YmReal32 R = (YmReal32)m_resolution;
+		const YmUInt32 iu = YmMath::Min<YmUInt32>((YmUInt32)YmMath::Max(0.0f, (d[(axis+1)%3]*r + 1.0f)*0.5f*R), m_resolution - 1);
+		const YmUInt32 iv = YmMath::Min<YmUInt32>((YmUInt32)YmMath::Max(0.0f, (d[(axis+2)%3]*r + 1.0f)*0.5f*R), m_resolution - 1);
+		return (face*m_resolution + iv)*m_resolution + iu;
+	}
+
+	void GetCellCenter(YmUInt32 cell, YmReal32 d[3]) const
+	{
+		const YmUInt32 iu = cell % m_resolution;
+		const YmUInt32 iv = (cell / m_resolution) % m_resolution;
+		const YmUInt32 face = cell / (m_resolution*m_resolution);
+		const int axis = (int)(face / 2);
+		d[axis] = (face & 1) ? -1.0f : 1.0f;
+		d[(axis+1)%3] = ((YmReal32)iu + 0.5f)*2.0f/(YmReal32)m_resolution - 1.0f;
+		d[(axis+2)%3] = ((YmReal32)iv + 0.5f)*2.0f/(YmReal32)m_resolution - 1.0f;
+	}
+
+	//--- 凸包の構築 (倍精度、一時領域は構築後に解放)
+	struct Hull
+	{
+		YmReal64	(*p)[3];		// 頂点 (単位ベクトル)
+		YmUInt32*	map;			// 頂点 -> HRTF 方向番号
+		YmUInt32	(*fv)[3];		// 面の頂点 (外から見て左回り)
+		YmUInt32	(*fn)[3];		// 面の隣接 (頂点 k の対辺)
+		YmUInt32*	mark;			// 0: 未使用, 1: 有効, 2: 可視 (削除予定)
+		YmUInt32*	stack;
+		YmUInt32*	freeList;
+		YmUInt32*	startFace;		// 地平線の辺の始点 -> 新しい面
+		YmUInt32*	endFace;		// 地平線の辺の終点 -> 新しい面
+		YmUInt32	(*horizon)[3];	// a, b, 外側の面
+		YmUInt32	numFaces;		// 確保済みの面 (未使用含む)
+		YmUInt32	numFree;
+	};
+
+	static YmReal64 Orient(const YmReal64* a, const YmReal64* b, const YmReal64* c, const YmReal64* p)
+	{
+		const YmReal64 u[3] = { b[0]-a[0], b[1]-a[1], b[2]-a[2] };
+		const YmReal64 v[3] = { c[0]-a[0], c[1]-a[1], c[2]-a[2] };
+		const YmReal64 w[3] = { p[0]-a[0], p[1]-a[1], p[2]-a[2] };
+		return (u[1]*v[2]-u[2]*v[1])*w[0] + (u[2]*v[0]-u[0]*v[2])*w[1] + (u[0]*v[1]-u[1]*v[0])*w[2];
+	}
+
+	static YmUInt32 NewFace(Hull& h, YmUInt32 a, YmUInt32 b, YmUInt32 c)
+	{
+		const YmUInt32 f = (h.numFree > 0) ? h.freeList[--h.numFree] : h.numFaces++;
+		h.fv[f][0] = a; h.fv[f][1] = b; h.fv[f][2] = c;
+		h.fn[f][0] = h.fn[f][1] = h.fn[f][2] = 0;
+		h.mark[f] = 1;
+		return f;
+	}
+
+	bool BuildTriangles(const YmVector3* directions, YmUInt32 numDirections)
+	{
+		const YmUInt32 maxPoints = numDirections + 6;
+		const YmUInt32 maxFaces = 2*maxPoints + 8;
+		const size_t size = sizeof(YmReal64)*3*maxPoints + sizeof(YmUInt32)*(3*maxPoints + maxFaces*(6 + 3 + 3));
+		YmUInt8* block = static_cast<YmUInt8*>(alloc_memory(m_pAllocator, size, 16));
+		if (block == nullptr) return false;
+
+		Hull h;
+		YmUInt8* q = block;
+		h.p         = reinterpret_cast<YmReal64(*)[3]>(q);	q += sizeof(YmReal64)*3*maxPoints;
+		h.map       = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxPoints;
+		h.startFace = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxPoints;
+		h.endFace   = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxPoints;
+		h.fv        = reinterpret_cast<YmUInt32(*)[3]>(q);	q += sizeof(YmUInt32)*3*maxFaces;
+		h.fn        = reinterpret_cast<YmUInt32(*)[3]>(q);	q += sizeof(YmUInt32)*3*maxFaces;
+		h.mark      = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxFaces;
+		h.stack     = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxFaces;
+		h.freeList  = reinterpret_cast<YmUInt32*>(q);		q += sizeof(YmUInt32)*maxFaces;
+		h.horizon   = reinterpret_cast<YmUInt32(*)[3]>(q);
+		h.numFaces = 0;
+		h.numFree = 0;
+
+		// 測定方向 (重複は除く) + 仮想点
+		YmUInt32 numPoints = 0;
+		for (YmUInt32 i = 0; i < numDirections; i++)
+		{
+			const YmReal64 x = directions[i].x, y = directions[i].y, z = directions[i].z;
+			const YmReal64 len = sqrt(x*x + y*y + z*z);
+			if (len < 1.e-20) continue;
+			YmReal64* p = h.p[numPoints];
+			p[0] = x/len; p[1] = y/len; p[2] = z/len;
+			bool dup = false;
+			for (YmUInt32 j = 0; j < numPoints && !dup; j++) dup = (p[0]*h.p[j][0] + p[1]*h.p[j][1] + p[2]*h.p[j][2] > 1.0 - 1.e-12);
+			if (!dup) h.map[numPoints++] = i;
+		}
+		const YmUInt32 numReal = numPoints;
+		for (int axis = 0; axis < 6 && numReal > 0; axis++)
+		{
+			const YmReal64 s = (axis & 1) ? -1.0 : 1.0;
+			YmReal64 best = -2.0;
+			YmUInt32 nearest = 0;
+			for (YmUInt32 i = 0; i < numReal; i++)
+			{
+				if (h.p[i][axis/2]*s > best) { best = h.p[i][axis/2]*s; nearest = i; }
+			}
+			if (best > YM_HRTF_GRID_VIRTUAL_COS) continue;
+			h.p[numPoints][0] = h.p[numPoints][1] = h.p[numPoints][2] = 0.0;
+			h.p[numPoints][axis/2] = s;
+			h.map[numPoints++] = h.map[nearest];
+		}
+
+		// 等間隔の測定グリッドは同一円周上の 4 点が多く凸包が縮退するため、
+		// 1e-6 程度の決定的な揺らぎを加えて一般位置にする (重みへの影響は float の丸め以下)
+		YmUInt32 seed = 0x12345678u;
+		for (YmUInt32 i = 0; i < numPoints; i++)
+		{
+			YmReal64 len = 0.0;
+			for (int k = 0; k < 3; k++)
+			{
+				seed = seed*1664525u + 1013904223u;
+				h.p[i][k] += ((YmReal64)(seed >> 8) / 16777216.0 - 0.5)*2.e-6;
+				len += h.p[i][k]*h.p[i][k];
+			}
+			len = 1.0 / sqrt(len);
+			for (int k = 0; k < 3; k++) h.p[i][k] *= len;
+		}
+
+		const bool ok = BuildHull(h, numPoints) && StoreTriangles(h);
+		free_memory(m_pAllocator, block);
+		return ok;
+	}
+
+	static bool BuildHull(Hull& h, YmUInt32 numPoints)
+	{
+		const YmReal64 eps = 1.e-12;
+		if (numPoints < 4) return false;
+
+		// 初期四面体: 0 と最遠点、その直線から最遠の点、その平面から最遠の点
+		YmUInt32 i0 = 0, i1 = 0, i2 = 0, i3 = 0;
+		YmReal64 best = 0.0;
+		for (YmUInt32 i = 1; i < numPoints; i++)
+		{
+			const YmReal64 d = (h.p[i][0]-h.p[0][0])*(h.p[i][0]-h.p[0][0]) + (h.p[i][1]-h.p[0][1])*(h.p[i][1]-h.p[0][1]) + (h.p[i][2]-h.p[0][2])*(h.p[i][2]-h.p[0][2]);
+			if (d > best) { best = d; i1 = i; }
+		}
+		best = 0.0;
+		for (YmUInt32 i = 1; i < numPoints; i++)
+		{
+			const YmReal64 u[3] = { h.p[i1][0]-h.p[i0][0], h.p[i1][1]-h.p[i0][1], h.p[i1][2]-h.p[i0][2] };
+			const YmReal64 v[3] = { h.p[i][0]-h.p[i0][0], h.p[i][1]-h.p[i0][1], h.p[i][2]-h.p[i0][2] };
+			const YmReal64 c[3] = { u[1]*v[2]-u[2]*v[1], u[2]*v[0]-u[0]*v[2], u[0]*v[1]-u[1]*v[0] };
+			const YmReal64 d = c[0]*c[0] + c[1]*c[1] + c[2]*c[2];
+			if (d > best) { best = d; i2 = i; }
+		}
+		best = 0.0;
+		for (YmUInt32 i = 1; i < numPoints; i++)
+		{
+			const YmReal64 d = fabs(Orient(h.p[i0], h.p[i1], h.p[i2], h.p[i]));
+			if (d > best) { best = d; i3 = i; }
+		}
+		if (best < 1.e-9) return false;		// 全点が同一平面上
+		if (Orient(h.p[i0], h.p[i1], h.p[i2], h.p[i3]) > 0.0) { const YmUInt32 t = i1; i1 = i2; i2 = t; }
+
+		// 外から見て左回りの 4 面と隣接
+		const YmUInt32 f0 = NewFace(h, i0, i1, i2);
+		const YmUInt32 f1 = NewFace(h, i0, i3, i1);
+		const YmUInt32 f2 = NewFace(h, i1, i3, i2);
+		const YmUInt32 f3 = NewFace(h, i2, i3, i0);
+		const YmUInt32 faces[4] = { f0, f1, f2, f3 };
+		for (int a = 0; a < 4; a++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				const YmUInt32 e0 = h.fv[faces[a]][(k+1)%3], e1 = h.fv[faces[a]][(k+2)%3];
+				for (int b = 0; b < 4; b++)
+				{
+					if (a == b) continue;
+					for (int j = 0; j < 3; j++)
+					{
+						if (h.fv[faces[b]][(j+1)%3] == e1 && h.fv[faces[b]][(j+2)%3] == e0) h.fn[faces[a]][k] = faces[b];
+					}
+				}
+			}
+		}
+
+		// 残りの点を 1 点ずつ追加
+		for (YmUInt32 i = 0; i < numPoints; i++)
+		{
+			if (i == i0 || i == i1 || i == i2 || i == i3) continue;
+			const YmReal64* p = h.p[i];
+
+			YmUInt32 seed = 0xFFFFFFFFu;
+			for (YmUInt32 f = 0; f < h.numFaces; f++)
+			{
+				if (h.mark[f] == 1 && Orient(h.p[h.fv[f][0]], h.p[h.fv[f][1]], h.p[h.fv[f][2]], p) > eps) { seed = f; break; }
+			}
+			if (seed == 0xFFFFFFFFu) continue;		// 重複点 (既存の点と一致)
+
+			// 可視面を連結成分として集める
+			YmUInt32 numStack = 0, numHorizon = 0;
+			h.mark[seed] = 2;
+			h.stack[numStack++] = seed;
+			for (YmUInt32 s = 0; s < numStack; s++)
+			{
+				const YmUInt32 f = h.stack[s];
+				for (int k = 0; k < 3; k++)
+				{
+					const YmUInt32 o = h.fn[f][k];
+					if (h.mark[o] == 2) continue;
+					if (Orient(h.p[h.fv[o][0]], h.p[h.fv[o][1]], h.p[h.fv[o][2]], p) > eps)
+					{
+						h.mark[o] = 2;
+						h.stack[numStack++] = o;
+					}
+					else
+					{
+						h.horizon[numHorizon][0] = h.fv[f][(k+1)%3];
+						h.horizon[numHorizon][1] = h.fv[f][(k+2)%3];
+						h.horizon[numHorizon][2] = o;
+						numHorizon++;
+					}
+				}
+			}
+			for (YmUInt32 s = 0; s < numStack; s++)
+			{
+				h.mark[h.stack[s]] = 0;
+				h.freeList[h.numFree++] = h.stack[s];
+			}
+
+			// 地平線の辺と新しい点で面を張る
+			for (YmUInt32 e = 0; e < numHorizon; e++)
+			{
+				const YmUInt32 a = h.horizon[e][0], b = h.horizon[e][1], o = h.horizon[e][2];
+				const YmUInt32 nf = NewFace(h, a, b, i);
+				h.fn[nf][2] = o;
+				// 外側の面の辺 b->a を新しい面に付け替える (可視面の番号は再利用済みの場合があるので辺で照合)
+				for (int j = 0; j < 3; j++)
+				{
+					if (h.fv[o][(j+1)%3] == b && h.fv[o][(j+2)%3] == a) h.fn[o][j] = nf;
+				}
+				h.startFace[a] = nf;
+				h.endFace[b] = nf;
+				h.stack[e] = nf;
+			}
+			// 新しい面どうしの隣接 (a,b,i) : 辺 b-i は b から始まる面、辺 i-a は a で終わる面
+			for (YmUInt32 e = 0; e < numHorizon; e++)
+			{
+				const YmUInt32 nf = h.stack[e];
+				h.fn[nf][0] = h.startFace[h.fv[nf][1]];
+				h.fn[nf][1] = h.endFace[h.fv[nf][0]];
+			}
+		}
+		return true;
+	}
+
+	bool StoreTriangles(const Hull& h)
+	{
+		// 有効な面を詰めて番号を振り直す
+		YmUInt32* remap = h.stack;
+		YmUInt32 n = 0;
+		for (YmUInt32 f = 0; f < h.numFaces; f++) remap[f] = (h.mark[f] == 1) ? n++ : 0xFFFFFFFFu;
+		m_pTriangles = alloc_array_nozero<Triangle>(m_pAllocator, n);
+		if (m_pTriangles == nullptr) return false;
+		m_numTriangles = n;
+
+		for (YmUInt32 f = 0; f < h.numFaces; f++)
+		{
+			if (remap[f] == 0xFFFFFFFFu) continue;
+			Triangle& t = m_pTriangles[remap[f]];
+			const YmReal64* a = h.p[h.fv[f][0]];
+			const YmReal64* b = h.p[h.fv[f][1]];
+			const YmReal64* c = h.p[h.fv[f][2]];
+			// 列 a, b, c の行列の逆行列 = 余因子 / det (行 k は他の 2 列の外積)
+			const YmReal64 r0[3] = { b[1]*c[2]-b[2]*c[1], b[2]*c[0]-b[0]*c[2], b[0]*c[1]-b[1]*c[0] };
+			const YmReal64 r1[3] = { c[1]*a[2]-c[2]*a[1], c[2]*a[0]-c[0]*a[2], c[0]*a[1]-c[1]*a[0] };
+			const YmReal64 r2[3] = { a[1]*b[2]-a[2]*b[1], a[2]*b[0]-a[0]*b[2], a[0]*b[1]-a[1]*b[0] };
+			const YmReal64 det = a[0]*r0[0] + a[1]*r0[1] + a[2]*r0[2];
+			const YmReal64 r = (fabs(det) > 1.e-30) ? 1.0/det : 0.0;
+			for (int k = 0; k < 3; k++)
+			{
+				t.inv[k]   = (YmReal32)(r0[k]*r);
+				t.inv[3+k] = (YmReal32)(r1[k]*r);
+				t.inv[6+k] = (YmReal32)(r2[k]*r);
+				t.vertex[k] = h.map[h.fv[f][k]];
+				t.neighbor[k] = remap[h.fn[f][k]];
+			}
+			t.reserved = 0;
+		}
+		return true;
+	}
+
+	YmMemAlloc*		m_pAllocator;
+	Triangle*		m_pTriangles;
+	YmUInt32*		m_pCellStart;		// セル -> 開始三角形
+	YmUInt32		m_numDirections;
+	YmUInt32		m_numTriangles;
+	YmUInt32		m_resolution;
+};
+
+/***********************************************************************//**
+ * @brief			周波数領域 HRTF テーブル [dir][ear][bin]
+ * @note			1 スペクトルは (re,im) x GetNumBins() で、キャッシュライン単位の
+ *					GetSpecStride() 間隔に並ぶ。
+ **************************************************************************/
+class YmHrtfTable
+{
+public:
+	YmHrtfTable() : m_pAllocator(nullptr), m_pSpec(nullptr), m_isShared(false), m_numDirections(0), m_numBins(0), m_specStride(0) {}
+	~YmHrtfTable() { Term(); }
+
+	YmHrtfTable(const YmHrtfTable&) = delete;
+	YmHrtfTable& operator=(const YmHrtfTable&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	fft				変換に使う FFT (サイズ >= irLength)
+	 * @param[in]	irLeft, irRight	HRIR [numDirections][irLength]
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmFft& fft, YmUInt32 numDirections, YmUInt32 irLength,
+		const YmReal32* irLeft, const YmReal32* irRight)
+	{
+		Term();
+		const YmUInt32 fftSize = fft.GetSize();
+		if (numDirections == 0 || irLength == 0 || irLength > fftSize) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_numDirections = numDirections;
+		m_numBins = fft.GetNumBins();
+		m_specStride = (m_numBins*2 + 15) & ~15u;
+		// 方向数の多いセットは数 MB になるため OS のページを直接使う (ゼロページなので memset も不要)
+		const size_t specBytes = sizeof(YmReal32)*m_specStride*2*numDirections;
+		m_pSpec = static_cast<YmReal32*>(alloc_large_memory(in_pAllocator, specBytes,
+			YM_MEM_ZERO | ((specBytes >= YM_MEM_HUGE_PAGE_MIN_SIZE) ? YM_MEM_HUGE_PAGES : 0)));
+		YmReal32* time = alloc_array_nozero<YmReal32>(in_pAllocator, fftSize);
+		if (m_pSpec == nullptr || time == nullptr)
+		{
+			free_memory(in_pAllocator, time);
+			Term();
+			return false;
+		}
+		for (YmUInt32 d = 0; d < numDirections; d++)
+		{
+			for (YmUInt32 ear = 0; ear < 2; ear++)
+			{
+				const YmReal32* ir = ((ear == 0) ? irLeft : irRight) + (size_t)d*irLength;
+				memset(time, 0, sizeof(YmReal32)*fftSize);
+				memcpy(time, ir, sizeof(YmReal32)*irLength);
+				fft.Forward(time, m_pSpec + ((size_t)d*2 + ear)*m_specStride);
+			}
+		}
+		free_memory(in_pAllocator, time);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		変換済みスペクトルを参照して初期化 (コピーしない)
+	 * @param[in]	spec			[numDirections][2][specStride] (64 バイト境界, Term() まで有効なこと)
+	 * @note		YmHrtfPack でマップしたファイルをそのまま使う場合など。
+	 **************************************************************************/
+	bool InitShared(const YmReal32* spec, YmUInt32 numDirections, YmUInt32 numBins, YmUInt32 specStride)
+	{
+		Term();
+		if (spec == nullptr || numDirections == 0 || numBins == 0 || specStride < numBins*2 || (specStride & 15) != 0) return false;
+		if ((reinterpret_cast<size_t>(spec) & 63) != 0) return false;
+		m_pSpec = const_cast<YmReal32*>(spec);	// 書き込むのは Init() のみ
+		m_isShared = true;
+		m_numDirections = numDirections;
+		m_numBins = numBins;
+		m_specStride = specStride;
+		return true;
+	}
+
+	void Term(void)
+	{
+		if (!m_isShared) free_large_memory(m_pAllocator, m_pSpec);
+		m_pSpec = nullptr;
+		m_isShared = false;
+		m_numDirections = 0;
+		m_numBins = 0;
+		m_specStride = 0;
+	}
+
+	const YmReal32* GetSpectrum(YmUInt32 dir, YmUInt32 ear) const
+	{
+		return m_pSpec + ((size_t)dir*2 + ear)*m_specStride;
+	}
+
+	/***********************************************************************//**
+	 * @brief		3 点の重み付き和 (dstLeft, dstRight は GetNumBins() 組の複素数)
+	 **************************************************************************/
+	void Interpolate(const YmHrtfWeights& w, YmReal32* dstLeft, YmReal32* dstRight) const
+	{
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		memset(dstLeft, 0, sizeof(YmReal32)*m_numBins*2);
+		memset(dstRight, 0, sizeof(YmReal32)*m_numBins*2);
+		for (int i = 0; i < 3; i++)
+		{
+			if (w.weight[i] <= 0.0f) continue;
+			k.MixGain(dstLeft,  GetSpectrum(w.index[i], 0), w.weight[i], m_numBins*2);
+			k.MixGain(dstRight, GetSpectrum(w.index[i], 1), w.weight[i], m_numBins*2);
+		}
+	}
+
+	YmUInt32 GetNumDirections(void) const	{ return m_numDirections; }
+	YmUInt32 GetNumBins(void) const			{ return m_numBins; }
+	YmUInt32 GetSpecStride(void) const		{ return m_specStride; }
+
+private:
+	YmMemAlloc*		m_pAllocator;
+	YmReal32*		m_pSpec;
+	bool			m_isShared;			// InitShared() で外部の領域を参照
+	YmUInt32		m_numDirections;
+	YmUInt32		m_numBins;
+	YmUInt32		m_specStride;		// キャッシュライン単位
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
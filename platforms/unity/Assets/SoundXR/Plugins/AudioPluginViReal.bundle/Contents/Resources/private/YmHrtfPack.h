@@ -0,0 +1,324 @@
+﻿/*****************************************************************************************//**
+ * @file			YmHrtfPack.h
+ * @brief			HRTF パック (周波数領域 HRTF のバイナリ形式) の読込・書出し
+ * @attention		パックは YmHrtfTable と同じ並びのスペクトル [dir][ear][specStride] を
+ *					そのまま格納するため、Open() はファイルを読み取り専用でマップするだけで
+ *					FFT も変換も行わない。マップしたページは OS のページキャッシュを共有するので、
+ *					同じパックを開くインスタンス・プロセスが増えてもヒープ上の複製はできない。
+ *
+ *					ファイル構成 (リトルエンディアン, 各セクションは 64 バイト境界):
+ *					  YmHrtfPackHeader	64 バイト
+ *					  方向				YmReal32 [numDirections][3] (単位ベクトル, YmVector3 の座標系)
+ *					  スペクトル		YmReal32 [numDirections][2][specStride] ((re,im) x numBins, 残りはゼロ)
+ *
+ *					スペクトルは fftSize の YmFft で変換したものなので、
+ *					blockSize + irLength - 1 <= fftSize となるブロックサイズでのみ使える。
+ *					マップした領域は Close() まで有効。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmHrtfGrid.h"
+
+#if YM_USE_HRTF_PACK
+
+#if defined(YM_TARGET_WWISE)
+	#define YM_HRTF_PACK_USE_FILE_MAPPING	0	///< Attach() のみ使用可
+#elif defined(__linux__)||defined(__APPLE__)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#define YM_HRTF_PACK_USE_MMAP			1
+	#define YM_HRTF_PACK_USE_FILE_MAPPING	1
+#elif defined(_WIN32)||defined(_WIN64)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#define YM_HRTF_PACK_USE_FILE_MAPPING	1
+#else
+	#define YM_HRTF_PACK_USE_FILE_MAPPING	0	///< Attach() のみ使用可
+#endif
+
+#define YM_HRTF_PACK_MAGIC			0x50485259u		///< "YRHP"
+#define YM_HRTF_PACK_VERSION		1
+#define YM_HRTF_PACK_ALIGN			64				///< セクションのアライメント
+
+/***********************************************************************//**
+ * @brief			パックのヘッダ (ファイル先頭 64 バイト)
+ **************************************************************************/
+struct YmHrtfPackHeader
+{
+	YmUInt32	magic;				///< YM_HRTF_PACK_MAGIC
+	YmUInt16	version;			///< YM_HRTF_PACK_VERSION
+	YmUInt16	headerSize;			///< sizeof(YmHrtfPackHeader)
+	YmUInt32	sampleRate;
+	YmUInt32	numDirections;
+	YmUInt32	irLength;			///< 変換前の HRIR 長
+	YmUInt32	fftSize;
+	YmUInt32	numBins;			///< fftSize/2 + 1
+	YmUInt32	specStride;			///< 1 スペクトルの float 数 (16 の倍数)
+	YmUInt64	directionOffset;
+	YmUInt64	spectrumOffset;
+	YmUInt64	fileSize;
+	YmUInt32	contentHash;		///< 方向・スペクトルの FNV-1a (セットの識別用, 読込時は検証しない)
+	YmUInt32	headerHash;			///< このフィールドより前の FNV-1a
+};
+static_assert(sizeof(YmHrtfPackHeader) == 64, "YmHrtfPackHeader must be 64 bytes");
+
+class YmHrtfPack
+{
+public:
+	YmHrtfPack() : m_pData(nullptr), m_mappedSize(0), m_pHeader(nullptr), m_pDirections(nullptr), m_pSpectra(nullptr) {}
+	~YmHrtfPack() { Close(); }
+
+	YmHrtfPack(const YmHrtfPack&) = delete;
+	YmHrtfPack& operator=(const YmHrtfPack&) = delete;
+
+#if YM_HRTF_PACK_USE_FILE_MAPPING
+	/***********************************************************************//**
+	 * @brief		パックファイルを読み取り専用でマップする (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	path			ファイルパス (UTF-8)
+	 * @return		ファイルがない、または形式が不正な場合 false
+	 **************************************************************************/
+	bool Open(const char* path)
+	{
+		Close();
+		size_t size = 0;
+		void* data = MapFile(path, size);
+		if (data == nullptr) return false;
+		m_pData = data;
+		m_mappedSize = size;
+		if (!Parse(data, size))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+#endif
+
+	/***********************************************************************//**
+	 * @brief		メモリ上のパックを参照する (コピーしない)
+	 * @param[in]	data			64 バイト境界のパック全体 (Close() まで有効なこと)
+	 * @note		ファイルマップのないプラットフォームや、アセットとして読み込んだ場合に使う。
+	 **************************************************************************/
+	bool Attach(const void* data, size_t size)
+	{
+		Close();
+		if (!Parse(data, size))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close(void)
+	{
+#if YM_HRTF_PACK_USE_FILE_MAPPING
+		if (m_mappedSize != 0) UnmapFile(m_pData, m_mappedSize);
+#endif
+		m_pData = nullptr;
+		m_mappedSize = 0;
+		m_pHeader = nullptr;
+		m_pDirections = nullptr;
+		m_pSpectra = nullptr;
+	}
+
+	bool IsOpen(void) const					{ return m_pHeader != nullptr; }
+	YmUInt32 GetSampleRate(void) const		{ return m_pHeader->sampleRate; }
+	YmUInt32 GetNumDirections(void) const	{ return m_pHeader->numDirections; }
+	YmUInt32 GetIrLength(void) const		{ return m_pHeader->irLength; }
+	YmUInt32 GetFftSize(void) const			{ return m_pHeader->fftSize; }
+	YmUInt32 GetNumBins(void) const			{ return m_pHeader->numBins; }
+	YmUInt32 GetSpecStride(void) const		{ return m_pHeader->specStride; }
+	YmUInt32 GetContentHash(void) const		{ return m_pHeader->contentHash; }
+	const YmReal32* GetSpectra(void) const	{ return m_pSpectra; }
+
+	YmVector3 GetDirection(YmUInt32 dir) const
+	{
+		const YmReal32* v = m_pDirections + (size_t)dir*3;
+		return YmVector3(v[0], v[1], v[2]);
+	}
+
+	/***********************************************************************//**
+	 * @brief		パックで使えるブロックサイズか
+	 **************************************************************************/
+	bool IsUsableFor(YmUInt32 blockSize) const
+	{
+		return IsOpen() && blockSize != 0 && blockSize + m_pHeader->irLength - 1 <= m_pHeader->fftSize;
+	}
+
+	/***********************************************************************//**
+	 * @brief		YmHrtfTable の内容をパックとして書き出す (ツール用)
+	 * @param[in]	table			fftSize の YmFft で初期化したテーブル
+	 * @param[in]	directions		測定方向 [table.GetNumDirections()] (単位ベクトル)
+	 **************************************************************************/
+	static bool Write(const char* path, const YmHrtfTable& table, const YmVector3* directions,
+		YmUInt32 irLength, YmUInt32 fftSize, YmUInt32 sampleRate)
+	{
+		const YmUInt32 numDirections = table.GetNumDirections();
+		if (numDirections == 0 || table.GetNumBins() != fftSize/2 + 1) return false;
+
+		YmHrtfPackHeader header;
+		memset(&header, 0, sizeof(header));
+		header.magic = YM_HRTF_PACK_MAGIC;
+		header.version = YM_HRTF_PACK_VERSION;
+		header.headerSize = (YmUInt16)sizeof(YmHrtfPackHeader);
+		header.sampleRate = sampleRate;
+		header.numDirections = numDirections;
+		header.irLength = irLength;
+		header.fftSize = fftSize;
+		header.numBins = table.GetNumBins();
+		header.specStride = table.GetSpecStride();
+		header.directionOffset = sizeof(YmHrtfPackHeader);
+		header.spectrumOffset = AlignUp(header.directionOffset + sizeof(YmReal32)*3*numDirections);
+		header.fileSize = header.spectrumOffset + sizeof(YmReal32)*header.specStride*2*numDirections;
+
+		const size_t dirBytes = (size_t)(header.spectrumOffset - header.directionOffset);
+		YmReal32* dirs = static_cast<YmReal32*>(alloc_memory(nullptr, dirBytes, YM_SIMD_WIDE_ALIGNMENT));
+		if (dirs == nullptr) return false;
+		for (YmUInt32 d = 0; d < numDirections; d++)
+		{
+			dirs[d*3 + 0] = directions[d].x;
+			dirs[d*3 + 1] = directions[d].y;
+			dirs[d*3 + 2] = directions[d].z;
+		}
+		const size_t specBytes = sizeof(YmReal32)*header.specStride*2*numDirections;
+		header.contentHash = Fnv1a(table.GetSpectrum(0, 0), specBytes, Fnv1a(dirs, dirBytes, FNV_BASIS));
+		header.headerHash = Fnv1a(&header, offsetof(YmHrtfPackHeader, headerHash), FNV_BASIS);
+
+		FILE* fp = fopen(path, "wb");
+		bool ok = (fp != nullptr);
+		if (ok)
+		{
+			ok = fwrite(&header, sizeof(header), 1, fp) == 1
+				&& fwrite(dirs, dirBytes, 1, fp) == 1
+				&& fwrite(table.GetSpectrum(0, 0), specBytes, 1, fp) == 1;
+			ok = (fclose(fp) == 0) && ok;
+		}
+		free_memory(nullptr, dirs);
+		return ok;
+	}
+
+private:
+	static const YmUInt32 FNV_BASIS = 2166136261u;
+
+	static YmUInt64 AlignUp(YmUInt64 offset)
+	{
+		return (offset + YM_HRTF_PACK_ALIGN - 1) & ~(YmUInt64)(YM_HRTF_PACK_ALIGN - 1);
+	}
+
+	static YmUInt32 Fnv1a(const void* data, size_t size, YmUInt32 hash)
+	{
+		const YmUInt8* p = static_cast<const YmUInt8*>(data);
+		for (size_t i = 0; i < size; i++) hash = (hash ^ p[i])*16777619u;
+		return hash;
+	}
+
+	// ヘッダの検証とセクションの解決 (データ本体には触れない)
+	bool Parse(const void* data, size_t size)
+	{
+		if (data == nullptr || (reinterpret_cast<size_t>(data) & (YM_HRTF_PACK_ALIGN - 1)) != 0) return false;
+		if (size < sizeof(YmHrtfPackHeader)) return false;
+		const YmHrtfPackHeader* h = static_cast<const YmHrtfPackHeader*>(data);
+		if (h->magic != YM_HRTF_PACK_MAGIC || h->version != YM_HRTF_PACK_VERSION || h->headerSize != sizeof(YmHrtfPackHeader)) return false;
+		if (h->headerHash != Fnv1a(h, offsetof(YmHrtfPackHeader, headerHash), FNV_BASIS)) return false;
+		if (h->numDirections == 0 || h->irLength == 0 || h->irLength > h->fftSize) return false;
+		if (h->fftSize < 4 || (h->fftSize & (h->fftSize - 1)) != 0 || h->numBins != h->fftSize/2 + 1) return false;
+		if (h->specStride < h->numBins*2 || (h->specStride & 15) != 0) return false;
+		if (h->fileSize > size) return false;
+
+		// 積・和がオーバーフローしないよう、先に方向数をファイルサイズで抑えてから
+		// セクションの範囲を引き算で検証する (ヘッダの値は信用しない)
+		const YmUInt64 fileSize = h->fileSize;
+		const YmUInt64 specBytesPerDir = (YmUInt64)sizeof(YmReal32)*2*h->specStride;
+		if (h->numDirections > fileSize/specBytesPerDir) return false;
+		const YmUInt64 dirBytes = (YmUInt64)sizeof(YmReal32)*3*h->numDirections;
+		const YmUInt64 specBytes = specBytesPerDir*h->numDirections;
+		if ((h->directionOffset & (YM_HRTF_PACK_ALIGN - 1)) != 0 || (h->spectrumOffset & (YM_HRTF_PACK_ALIGN - 1)) != 0) return false;
+		if (h->directionOffset < sizeof(YmHrtfPackHeader) || h->directionOffset > h->spectrumOffset) return false;
+		if (dirBytes > h->spectrumOffset - h->directionOffset) return false;
+		if (h->spectrumOffset > fileSize || specBytes > fileSize - h->spectrumOffset) return false;
+
+		const YmUInt8* base = static_cast<const YmUInt8*>(data);
+		m_pHeader = h;
+		m_pDirections = reinterpret_cast<const YmReal32*>(base + h->directionOffset);
+		m_pSpectra = reinterpret_cast<const YmReal32*>(base + h->spectrumOffset);
+		return true;
+	}
+
+#if YM_HRTF_PACK_USE_FILE_MAPPING
+	static void* MapFile(const char* path, size_t& size)
+	{
+#if defined(YM_HRTF_PACK_USE_MMAP)
+		const int fd = open(path, O_RDONLY);
+		if (fd < 0) return nullptr;
+		struct stat st;
+		void* p = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			size = (size_t)st.st_size;
+			p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		}
+		close(fd);	// マップはファイルを閉じても有効
+		return (p != MAP_FAILED) ? p : nullptr;
+#else
+		wchar_t wpath[MAX_PATH];
+		if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH) == 0) return nullptr;
+		HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return nullptr;
+		LARGE_INTEGER fileSize;
+		void* p = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);	// ビューが残っている間はマッピングも有効
+				size = (size_t)fileSize.QuadPart;
+			}
+		}
+		CloseHandle(file);
+		return p;
+#endif
+	}
+
+	static void UnmapFile(const void* data, size_t size)
+	{
+#if defined(YM_HRTF_PACK_USE_MMAP)
+		munmap(const_cast<void*>(data), size);
+#else
+		(void)size;
+		UnmapViewOfFile(data);
+#endif
+	}
+#endif
+
+	const void*					m_pData;
+	size_t						m_mappedSize;		// 0: Attach() で参照
+	const YmHrtfPackHeader*		m_pHeader;
+	const YmReal32*				m_pDirections;		// [dir][3]
+	const YmReal32*				m_pSpectra;			// [dir][ear][specStride]
+};
+
+#endif // YM_USE_HRTF_PACK
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
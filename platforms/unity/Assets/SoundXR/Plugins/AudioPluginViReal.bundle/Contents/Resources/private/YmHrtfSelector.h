@@ -0,0 +1,519 @@
+﻿/*****************************************************************************************//**
+ * @file			YmHrtfSelector.h
+ * @brief			HRTF セットの実行時切替 (バックグラウンド準備 + アトミックな公開)
+ * @attention		Request*() で受け付けたセットは専用のローダースレッドで準備する
+ *					(パックのマップとページの先読み、または HRIR の FFT、補間グリッドの構築)。
+ *					準備できたセットはポインタの交換で公開し、オーディオスレッドは
+ *					ブロック先頭の Update() で受け取るだけなので、ロックも確保も待ちも発生しない。
+ *
+ *					切替ブロックでは Update() が previous に旧セットを返す。各音源を
+ *					旧セットの方向に gain -> 0 (BANK_PREVIOUS)、新セットの方向に 0 -> gain で
+ *					YmBatchSpatializer に加算すると 1 ブロックでクロスフェードする。
+ *					旧セットは次のブロックでローダースレッドに返され、そこで解放される
+ *					(返却待ちの間に届いた次のセットは 1 ブロック遅れて切り替わる)。
+ *
+ *					全セットの FFT サイズは Init() で固定する。方向数・並びはセットごとに異なってよい。
+ *					Init() にホストのサンプリング周波数 (UnityAudioEffectState::samplerate) を渡すと、
+ *					異なる周波数で測定 / 書出しされたセットはローダースレッドで一度だけ変換する
+ *					(YmResampler::ResampleIr())。オーディオスレッドの処理はホストの周波数のまま。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+
+#if YM_USE_HRTF_SELECTOR
+
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+#include "private/YmFft.h"
+#include "private/YmHrtfGrid.h"
+#include "private/YmHrtfPack.h"
+#include "private/YmResampler.h"
+
+#define YM_HRTF_SELECTOR_MAX_PATH		1024	///< パックのパス長の上限 (終端を含む)
+#define YM_HRTF_SELECTOR_COLLECT_MS		20		///< 旧セットを回収する間隔 [ms]
+
+/***********************************************************************//**
+ * @brief			準備済みの HRTF セット (公開後は読み取り専用)
+ **************************************************************************/
+class YmHrtfSet
+{
+public:
+	YmHrtfSet() : m_pAllocator(nullptr), m_pDirections(nullptr), m_id(0), m_irLength(0), m_hasGrid(false) {}
+	~YmHrtfSet() { Term(); }
+
+	YmHrtfSet(const YmHrtfSet&) = delete;
+	YmHrtfSet& operator=(const YmHrtfSet&) = delete;
+
+	const YmHrtfTable& GetTable(void) const	{ return m_table; }
+	YmUInt32 GetId(void) const				{ return m_id; }
+	YmUInt32 GetNumDirections(void) const	{ return m_table.GetNumDirections(); }
+	YmUInt32 GetIrLength(void) const		{ return m_irLength; }
+
+	/***********************************************************************//**
+	 * @brief		方向の補間重み (オーディオスレッド可)
+	 * @note		グリッドを構築できなかったセット (方向が少ない等) は最近傍 1 点を返す。
+	 **************************************************************************/
+	void Lookup(const YmVector3& dir, YmHrtfWeights& out) const
+	{
+		if (m_hasGrid)
+		{
+			m_grid.Lookup(dir, out);
+			return;
+		}
+		YmUInt32 best = 0;
+		YmReal32 bestDot = -2.0f;
+		for (YmUInt32 d = 0; d < GetNumDirections(); d++)
+		{
+			const YmReal32 dot = YmMath::InnerProduct(m_pDirections[d], dir);
+			if (dot > bestDot) { bestDot = dot; best = d; }
+		}
+		out.index[0] = out.index[1] = out.index[2] = best;
+		out.weight[0] = 1.0f;
+		out.weight[1] = out.weight[2] = 0.0f;
+	}
+
+private:
+	friend class YmHrtfSelector;
+
+	// 方向の複製と補間グリッド (テーブルの準備後に呼ぶ)
+	bool InitDirections(YmMemAlloc* in_pAllocator, const YmVector3* directions)
+	{
+		const YmUInt32 n = GetNumDirections();
+		m_pAllocator = in_pAllocator;
+		m_pDirections = alloc_array_nozero<YmVector3>(in_pAllocator, n);
+		if (m_pDirections == nullptr) return false;
+		for (YmUInt32 d = 0; d < n; d++) m_pDirections[d] = directions[d];
+		m_hasGrid = m_grid.Init(in_pAllocator, m_pDirections, n);
+		return true;
+	}
+
+	void Term(void)
+	{
+		m_grid.Term();
+		m_table.Term();
+#if YM_USE_HRTF_PACK
+		m_pack.Close();
+#endif
+		free_memory(m_pAllocator, m_pDirections);
+		m_pDirections = nullptr;
+		m_hasGrid = false;
+	}
+
+	YmMemAlloc*		m_pAllocator;
+#if YM_USE_HRTF_PACK
+	YmHrtfPack		m_pack;				// パック由来のセットのみ (m_table が参照)
+#endif
+	YmHrtfTable		m_table;
+	YmHrtfGrid		m_grid;
+	YmVector3*		m_pDirections;
+	YmUInt32		m_id;
+	YmUInt32		m_irLength;
+	bool			m_hasGrid;
+};
+
+class YmHrtfSelector
+{
+public:
+	YmHrtfSelector() : m_pAllocator(nullptr), m_blockSize(0), m_fftSize(0), m_sampleRate(0), m_pRequest(nullptr), m_nextId(1),
+		m_quit(false), m_pending(nullptr), m_retired(nullptr), m_lastReady(0), m_lastFailed(0), m_touch(0), m_numSets(0),
+		m_pCurrent(nullptr), m_pPrevious(nullptr), m_isRunning(false) {}
+	~YmHrtfSelector() { Term(); }
+
+	YmHrtfSelector(const YmHrtfSelector&) = delete;
+	YmHrtfSelector& operator=(const YmHrtfSelector&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		ローダースレッドの起動 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	blockSize		YmBatchSpatializer のブロックサイズ
+	 * @param[in]	fftSize			全セット共通の FFT サイズ (変換後の blockSize + irLength - 1 以上)
+	 * @param[in]	sampleRate		ホストのサンプリング周波数 (0: 変換しない)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 fftSize, YmUInt32 sampleRate = 0)
+	{
+		Term();
+		if (blockSize == 0 || fftSize < blockSize) return false;
+		if (!m_fft.Init(in_pAllocator, fftSize)) return false;
+		m_pAllocator = in_pAllocator;
+		m_blockSize = blockSize;
+		m_fftSize = fftSize;
+		m_sampleRate = sampleRate;
+		m_quit = false;
+		m_thread = std::thread(&YmHrtfSelector::LoaderMain, this);
+		m_isRunning = true;
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ローダースレッドの停止と全セットの解放 (オーディオスレッド停止後に呼ぶこと)
+	 **************************************************************************/
+	void Term(void)
+	{
+		if (m_isRunning)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_quit = true;
+			}
+			m_cv.notify_all();
+			m_thread.join();
+			m_isRunning = false;
+		}
+		DeleteRequest(m_pRequest);
+		m_pRequest = nullptr;
+		DeleteSet(m_pending.exchange(nullptr));
+		DeleteSet(m_retired.exchange(nullptr));
+		DeleteSet(m_pPrevious);
+		DeleteSet(m_pCurrent);
+		m_pPrevious = nullptr;
+		m_pCurrent = nullptr;
+		m_fft.Term();
+	}
+
+#if YM_USE_HRTF_PACK
+	/***********************************************************************//**
+	 * @brief		HRTF パックへの切替要求 (非オーディオスレッド, すぐに戻る)
+	 * @return		要求 ID (IsReady() / IsFailed() で状態を確認する)。受付不可なら 0
+	 * @note		未処理の要求は新しい要求で置き換えられる (失敗扱い)。
+	 **************************************************************************/
+	YmUInt32 RequestPack(const char* path)
+	{
+		const size_t len = strlen(path);
+		if (!m_isRunning || len >= YM_HRTF_SELECTOR_MAX_PATH) return 0;
+		Request* req = NewRequest();
+		if (req == nullptr) return 0;
+		memcpy(req->path, path, len + 1);
+		return Submit(req);
+	}
+#endif
+
+	/***********************************************************************//**
+	 * @brief		HRIR からの切替要求 (非オーディオスレッド, 入力は複製してすぐに戻る)
+	 * @param[in]	directions		測定方向 [numDirections] (単位ベクトル)
+	 * @param[in]	irLeft, irRight	HRIR [numDirections][irLength]
+	 * @param[in]	sampleRate		HRIR のサンプリング周波数 (0: ホストと同じ)
+	 **************************************************************************/
+	YmUInt32 RequestIr(YmUInt32 numDirections, YmUInt32 irLength, const YmVector3* directions,
+		const YmReal32* irLeft, const YmReal32* irRight, YmUInt32 sampleRate = 0)
+	{
+		if (!m_isRunning || numDirections == 0 || irLength == 0 || m_blockSize + GetHostIrLength(irLength, sampleRate) - 1 > m_fftSize) return 0;
+		Request* req = NewRequest();
+		if (req == nullptr) return 0;
+		const size_t irCount = (size_t)numDirections*irLength;
+		req->numDirections = numDirections;
+		req->irLength = irLength;
+		req->sampleRate = sampleRate;
+		req->pDirections = alloc_array_nozero<YmVector3>(m_pAllocator, numDirections);
+		req->pIr = alloc_array_nozero<YmReal32>(m_pAllocator, irCount*2);
+		if (req->pDirections == nullptr || req->pIr == nullptr)
+		{
+			DeleteRequest(req);
+			return 0;
+		}
+		for (YmUInt32 d = 0; d < numDirections; d++) req->pDirections[d] = directions[d];
+		memcpy(req->pIr, irLeft, sizeof(YmReal32)*irCount);
+		memcpy(req->pIr + irCount, irRight, sizeof(YmReal32)*irCount);
+		return Submit(req);
+	}
+
+	// 最後に公開した / 失敗した要求か (非オーディオスレッドでのポーリング用)
+	bool IsReady(YmUInt32 id) const		{ return m_lastReady.load(std::memory_order_acquire) == id; }
+	bool IsFailed(YmUInt32 id) const	{ return m_lastFailed.load(std::memory_order_acquire) == id; }
+
+	/***********************************************************************//**
+	 * @brief		ブロック先頭での切替 (オーディオスレッド, ロックフリー)
+	 * @param[out]	current			このブロックで使うセット (最初のセットが公開されるまで nullptr)
+	 * @param[out]	previous		切替ブロックのみ旧セット、それ以外は nullptr
+	 * @return		このブロックで切り替わった場合 true
+	 **************************************************************************/
+	bool Update(const YmHrtfSet*& current, const YmHrtfSet*& previous)
+	{
+		if (m_pPrevious != nullptr)
+		{
+			// 前ブロックでクロスフェードを終えた旧セットを返却 (回収前なら次のブロックで再試行)
+			YmHrtfSet* expected = nullptr;
+			if (m_retired.compare_exchange_strong(expected, m_pPrevious, std::memory_order_release, std::memory_order_relaxed))
+			{
+				m_pPrevious = nullptr;
+			}
+		}
+
+		bool switched = false;
+		if (m_pPrevious == nullptr && m_pending.load(std::memory_order_relaxed) != nullptr)
+		{
+			YmHrtfSet* next = m_pending.exchange(nullptr, std::memory_order_acquire);
+			if (next != nullptr)
+			{
+				m_pPrevious = m_pCurrent;
+				m_pCurrent = next;
+				switched = true;
+			}
+		}
+		current = m_pCurrent;
+		previous = switched ? m_pPrevious : nullptr;
+		return switched;
+	}
+
+	YmUInt32 GetFftSize(void) const		{ return m_fftSize; }
+	YmUInt32 GetSampleRate(void) const	{ return m_sampleRate; }
+
+	// 保持しているセットの数 (公開待ち・返却待ち・解放待ちを含む, 診断用)
+	YmUInt32 GetNumSets(void) const		{ return m_numSets.load(std::memory_order_acquire); }
+
+private:
+	struct Request
+	{
+		YmUInt32	id;
+		YmUInt32	numDirections;		// 0: パック
+		YmUInt32	irLength;
+		YmUInt32	sampleRate;			// 0: ホストと同じ
+		YmVector3*	pDirections;
+		YmReal32*	pIr;				// [ear][dir][irLength]
+		char		path[YM_HRTF_SELECTOR_MAX_PATH];
+	};
+
+	Request* NewRequest(void)
+	{
+		return alloc_array<Request>(m_pAllocator, 1);	// ゼロ初期化
+	}
+
+	void DeleteRequest(Request* req)
+	{
+		if (req == nullptr) return;
+		free_memory(m_pAllocator, req->pDirections);
+		free_memory(m_pAllocator, req->pIr);
+		free_memory(m_pAllocator, req);
+	}
+
+	// セットは alloc_array_nozero() と配置 new で作る (例外を無効にしたビルドでも確保の失敗を返り値で扱える)
+	YmHrtfSet* NewSet(void)
+	{
+		YmHrtfSet* mem = alloc_array_nozero<YmHrtfSet>(m_pAllocator, 1);
+		if (mem == nullptr) return nullptr;
+		m_numSets.fetch_add(1, std::memory_order_acq_rel);
+		return new (mem) YmHrtfSet();
+	}
+
+	void DeleteSet(YmHrtfSet* set)
+	{
+		if (set == nullptr) return;
+		set->~YmHrtfSet();
+		free_memory(m_pAllocator, set);
+		m_numSets.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	YmUInt32 Submit(Request* req)
+	{
+		Request* superseded = nullptr;
+		YmUInt32 id = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			id = m_nextId++;
+			req->id = id;
+			superseded = m_pRequest;
+			m_pRequest = req;
+		}
+		m_cv.notify_one();
+		if (superseded != nullptr)
+		{
+			m_lastFailed.store(superseded->id, std::memory_order_release);
+			DeleteRequest(superseded);
+		}
+		return id;	// req はローダースレッドが解放済みの場合がある
+	}
+
+	bool NeedsResample(YmUInt32 sampleRate) const
+	{
+		return m_sampleRate != 0 && sampleRate != 0 && sampleRate != m_sampleRate;
+	}
+
+	YmUInt32 GetHostIrLength(YmUInt32 irLength, YmUInt32 sampleRate) const
+	{
+		return NeedsResample(sampleRate) ? YmResampler::GetResampledLength(irLength, sampleRate, m_sampleRate) : irLength;
+	}
+
+	// HRIR [ear][dir][irLength] をホストの周波数に変換してテーブルを作る
+	bool InitResampledTable(YmHrtfSet* set, YmUInt32 numDirections, YmUInt32 irLength, YmUInt32 sampleRate, const YmReal32* ir)
+	{
+		const YmUInt32 length = GetHostIrLength(irLength, sampleRate);
+		if (m_blockSize + length - 1 > m_fftSize) return false;
+		const size_t count = (size_t)numDirections*length;
+		YmReal32* resampled = alloc_array_nozero<YmReal32>(m_pAllocator, count*2);
+		if (resampled == nullptr) return false;
+		bool ok = true;
+		for (YmUInt32 i = 0; ok && i < numDirections*2; i++)
+		{
+			ok = YmResampler::ResampleIr(m_pAllocator, ir + (size_t)i*irLength, irLength, sampleRate, resampled + (size_t)i*length, m_sampleRate);
+		}
+		set->m_irLength = length;
+		ok = ok && set->m_table.Init(m_pAllocator, m_fft, numDirections, length, resampled, resampled + count);
+		free_memory(m_pAllocator, resampled);
+		return ok;
+	}
+
+	// ローダースレッドでのセットの準備 (失敗時 nullptr)
+	YmHrtfSet* Prepare(const Request& req)
+	{
+		YmHrtfSet* set = NewSet();
+		if (set == nullptr) return nullptr;
+		set->m_id = req.id;
+		bool ok = false;
+		if (req.numDirections != 0)
+		{
+			const size_t irCount = (size_t)req.numDirections*req.irLength;
+			set->m_irLength = req.irLength;
+			ok = (NeedsResample(req.sampleRate)
+				? InitResampledTable(set, req.numDirections, req.irLength, req.sampleRate, req.pIr)
+				: set->m_table.Init(m_pAllocator, m_fft, req.numDirections, req.irLength, req.pIr, req.pIr + irCount))
+				&& set->InitDirections(m_pAllocator, req.pDirections);
+		}
+#if YM_USE_HRTF_PACK
+		else if (set->m_pack.Open(req.path) && NeedsResample(set->m_pack.GetSampleRate()))
+		{
+			ok = PrepareResampledPack(set);
+		}
+		else if (set->m_pack.IsOpen() && set->m_pack.GetFftSize() == m_fftSize && set->m_pack.IsUsableFor(m_blockSize))
+		{
+			const YmHrtfPack& pack = set->m_pack;
+			set->m_irLength = pack.GetIrLength();
+			ok = set->m_table.InitShared(pack.GetSpectra(), pack.GetNumDirections(), pack.GetNumBins(), pack.GetSpecStride());
+			if (ok)
+			{
+				// オーディオスレッドでページフォルトを起こさないよう、全ページを先に読んでおく
+				const YmUInt8* p = reinterpret_cast<const YmUInt8*>(pack.GetSpectra());
+				const size_t bytes = sizeof(YmReal32)*pack.GetSpecStride()*2*pack.GetNumDirections();
+				YmUInt32 sum = 0;
+				for (size_t i = 0; i < bytes; i += 4096) sum += p[i];
+				m_touch.store(sum, std::memory_order_relaxed);
+
+				YmVector3* dirs = alloc_array_nozero<YmVector3>(m_pAllocator, pack.GetNumDirections());
+				ok = (dirs != nullptr);
+				if (ok)
+				{
+					for (YmUInt32 d = 0; d < pack.GetNumDirections(); d++) dirs[d] = pack.GetDirection(d);
+					ok = set->InitDirections(m_pAllocator, dirs);
+				}
+				free_memory(m_pAllocator, dirs);
+			}
+		}
+#endif
+		if (!ok)
+		{
+			DeleteSet(set);
+			return nullptr;
+		}
+		return set;
+	}
+
+#if YM_USE_HRTF_PACK
+	// 周波数の異なるパック: スペクトルを HRIR に戻して変換し、自前のテーブルにする (パックは閉じる)
+	bool PrepareResampledPack(YmHrtfSet* set)
+	{
+		const YmHrtfPack& pack = set->m_pack;
+		const YmUInt32 numDirections = pack.GetNumDirections();
+		const YmUInt32 irLength = pack.GetIrLength();
+		YmFft fft;
+		YmReal32* time = nullptr;
+		YmReal32* ir = nullptr;
+		YmVector3* dirs = nullptr;
+		bool ok = fft.Init(m_pAllocator, pack.GetFftSize());
+		if (ok)
+		{
+			time = alloc_array_nozero<YmReal32>(m_pAllocator, pack.GetFftSize());
+			ir = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)numDirections*irLength*2);
+			dirs = alloc_array_nozero<YmVector3>(m_pAllocator, numDirections);
+			ok = (time != nullptr && ir != nullptr && dirs != nullptr);
+		}
+		for (YmUInt32 d = 0; ok && d < numDirections; d++)
+		{
+			for (YmUInt32 ear = 0; ear < 2; ear++)
+			{
+				fft.Inverse(pack.GetSpectra() + ((size_t)d*2 + ear)*pack.GetSpecStride(), time);
+				memcpy(ir + ((size_t)ear*numDirections + d)*irLength, time, sizeof(YmReal32)*irLength);
+			}
+			dirs[d] = pack.GetDirection(d);
+		}
+		ok = ok && InitResampledTable(set, numDirections, irLength, pack.GetSampleRate(), ir)
+			&& set->InitDirections(m_pAllocator, dirs);
+		set->m_pack.Close();
+		free_memory(m_pAllocator, time);
+		free_memory(m_pAllocator, ir);
+		free_memory(m_pAllocator, dirs);
+		return ok;
+	}
+#endif
+
+	void LoaderMain(void)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (!m_quit)
+		{
+			m_cv.wait_for(lock, std::chrono::milliseconds(YM_HRTF_SELECTOR_COLLECT_MS));
+			Request* req = m_pRequest;
+			m_pRequest = nullptr;
+			lock.unlock();
+
+			DeleteSet(m_retired.exchange(nullptr, std::memory_order_acquire));
+			if (req != nullptr)
+			{
+				YmHrtfSet* set = Prepare(*req);
+				if (set != nullptr)
+				{
+					// オーディオスレッドが受け取る前に上書きしたセットは一度も使われていない
+					DeleteSet(m_pending.exchange(set, std::memory_order_acq_rel));
+					m_lastReady.store(req->id, std::memory_order_release);
+				}
+				else
+				{
+					m_lastFailed.store(req->id, std::memory_order_release);
+				}
+				DeleteRequest(req);
+			}
+			lock.lock();
+		}
+	}
+
+	YmMemAlloc*					m_pAllocator;
+	YmFft						m_fft;				// ローダースレッド専用
+	YmUInt32					m_blockSize;
+	YmUInt32					m_fftSize;
+	YmUInt32					m_sampleRate;		// 0: 変換しない
+
+	// 要求 (非オーディオスレッド -> ローダー, m_mutex で保護)
+	std::thread					m_thread;
+	std::mutex					m_mutex;
+	std::condition_variable		m_cv;
+	Request*					m_pRequest;
+	YmUInt32					m_nextId;
+	bool						m_quit;
+
+	// ローダー <-> オーディオスレッド
+	std::atomic<YmHrtfSet*>		m_pending;			// 公開済み・未受取
+	std::atomic<YmHrtfSet*>		m_retired;			// 返却済み・未解放
+	std::atomic<YmUInt32>		m_lastReady;
+	std::atomic<YmUInt32>		m_lastFailed;
+	std::atomic<YmUInt32>		m_touch;			// ページ先読みの結果 (最適化で消されないように)
+	std::atomic<YmUInt32>		m_numSets;			// NewSet() - DeleteSet()
+
+	// オーディオスレッド専用
+	YmHrtfSet*					m_pCurrent;
+	YmHrtfSet*					m_pPrevious;		// 切替ブロックの旧セット (返却待ちを含む)
+	bool						m_isRunning;
+};
+
+#endif // YM_USE_HRTF_SELECTOR
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,147 @@
+﻿/*****************************************************************************************//**
+ * @file			YmLargeMemory.h
+ * @brief			大容量メモリの確保 (OS から直接ページを確保する)
+ * @attention		mmap / VirtualAlloc を使うため、OS のヘッダはこのファイルでのみ読み込む
+ *					(YmMemory.h を読み込むだけのファイルに windows.h のマクロを持ち込まない)。
+ *					Windows では WIN32_LEAN_AND_MEAN / NOMINMAX を定義してから読み込む。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+
+#if defined(YM_TARGET_WWISE)
+	// Wwise ではメモリを必ずプラグインアロケータ経由で確保する
+#elif defined (_WIN32)||defined(_WIN64)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#elif defined(__linux__)||defined(__APPLE__)
+	#include <sys/mman.h>
+	#define YM_MEM_USE_MMAP				1
+#endif
+
+/***********************************************************************//**
+ * large allocation (大容量 HRTF セット等)
+ * @note	アロケータ未登録時は OS から直接ページを確保する (mmap / VirtualAlloc)。
+ *			OS のゼロページを使うため YM_MEM_ZERO でも memset は行わず、
+ *			ページは初回アクセス時に割り当てられる。
+ *			YM_MEM_HUGE_PAGES 指定時は大きなページを試み、失敗時は通常ページで確保する。
+ *			解放は必ず free_large_memory() で行うこと。
+ **************************************************************************/
+enum YmMemFlags
+{
+	YM_MEM_ZERO			= 1 << 0,	///< ゼロ初期化が必要
+	YM_MEM_HUGE_PAGES	= 1 << 1,	///< 大きなページ (Linux: 2MB HugeTLB / THP, Windows: Large Page) を使う
+};
+
+#define YM_LARGE_MEMORY_HEADER		64		///< 管理ヘッダ (返却アドレスのアライメントを兼ねる)
+#define YM_MEM_HUGE_PAGE_MIN_SIZE	((size_t)2 << 20)	///< YM_MEM_HUGE_PAGES を指定する目安 (これより小さいと端数の無駄が大きい)
+
+struct YmLargeMemoryHeader
+{
+	size_t		mappedSize;		// 0: alloc_memory 系で確保
+	YmUInt32	flags;
+};
+
+inline void* alloc_large_memory(YmMemAlloc * in_pAllocator, size_t size, YmUInt32 flags)
+{
+	const size_t total = size + YM_LARGE_MEMORY_HEADER;
+	YmUInt8* base = nullptr;
+	size_t mappedSize = 0;
+
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+	const bool useOs = (resolve_allocator(in_pAllocator) == nullptr);
+#elif defined(YM_TARGET_WWISE)
+	const bool useOs = false;	// Wwise ではメモリを必ずプラグインアロケータ経由で確保する
+#else
+	const bool useOs = true;
+#endif
+
+	if (useOs)
+	{
+#if defined(YM_MEM_USE_MMAP)
+		const size_t hugeSize = (size_t)2 << 20;
+		#if defined(MAP_HUGETLB)
+		if (flags & YM_MEM_HUGE_PAGES)
+		{
+			const size_t len = (total + hugeSize - 1) & ~(hugeSize - 1);
+			void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (p != MAP_FAILED) { base = static_cast<YmUInt8*>(p); mappedSize = len; }
+		}
+		#endif
+		if (base == nullptr)
+		{
+			const size_t len = (flags & YM_MEM_HUGE_PAGES) ? ((total + hugeSize - 1) & ~(hugeSize - 1)) : total;
+			void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p != MAP_FAILED)
+			{
+				base = static_cast<YmUInt8*>(p);
+				mappedSize = len;
+		#if defined(MADV_HUGEPAGE)
+				if (flags & YM_MEM_HUGE_PAGES) madvise(p, len, MADV_HUGEPAGE);	// Transparent Huge Pages
+		#endif
+			}
+		}
+#elif defined (_WIN32)||defined(_WIN64)
+		if (flags & YM_MEM_HUGE_PAGES)
+		{
+			const size_t large = GetLargePageMinimum();
+			if (large != 0)
+			{
+				const size_t len = (total + large - 1) & ~(large - 1);
+				base = static_cast<YmUInt8*>(VirtualAlloc(nullptr, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+				if (base != nullptr) mappedSize = len;
+			}
+		}
+		if (base == nullptr)
+		{
+			base = static_cast<YmUInt8*>(VirtualAlloc(nullptr, total, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+			if (base != nullptr) mappedSize = total;
+		}
+#endif
+	}
+
+	if (base == nullptr)
+	{
+		base = static_cast<YmUInt8*>(alloc_memory_nozero(in_pAllocator, total, YM_LARGE_MEMORY_HEADER));
+		if (base == nullptr) return nullptr;
+		if (flags & YM_MEM_ZERO) memset(base + YM_LARGE_MEMORY_HEADER, 0, size);
+		mappedSize = 0;
+	}
+
+	YmLargeMemoryHeader* header = reinterpret_cast<YmLargeMemoryHeader*>(base);
+	header->mappedSize = mappedSize;
+	header->flags = flags;
+	return base + YM_LARGE_MEMORY_HEADER;
+}
+
+inline void free_large_memory(YmMemAlloc * in_pAllocator, void* mem)
+{
+	if (mem == nullptr) return;
+	YmUInt8* base = static_cast<YmUInt8*>(mem) - YM_LARGE_MEMORY_HEADER;
+	const YmLargeMemoryHeader* header = reinterpret_cast<const YmLargeMemoryHeader*>(base);
+	if (header->mappedSize == 0)
+	{
+		free_memory(in_pAllocator, base);
+		return;
+	}
+#if defined(YM_MEM_USE_MMAP)
+	munmap(base, header->mappedSize);
+#elif defined (_WIN32)||defined(_WIN64)
+	VirtualFree(base, 0, MEM_RELEASE);
+#endif
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
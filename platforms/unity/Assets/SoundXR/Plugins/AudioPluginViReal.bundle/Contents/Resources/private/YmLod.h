@@ -0,0 +1,456 @@
+﻿/*****************************************************************************************//**
+ * @file			YmLod.h
+ * @brief			音源の描画段階 (LOD) の切替
+ * @attention		距離と音量 (ボリューム x 距離減衰ゲイン) からボイスごとに描画段階を選ぶ。
+ *
+ *					  YM_LOD_FULL	: HRTF 全長の畳込み
+ *					  YM_LOD_SHORT	: 最小位相化して短くした HRTF の畳込み (YmLod::MakeShortHrir())
+ *					  YM_LOD_PAN	: ITD / ILD パンニング (YmItdPanner, 畳込みなし)
+ *					  YM_LOD_CULLED	: 処理しない
+ *
+ *					・段階の上げ下げにはヒステリシスを持たせ、切替後 holdBlocks ブロックは段階を保つ。
+ *					・切替ブロックでは旧段階と新段階の両方を処理し、GetFadeGains() のゲインで
+ *					  1 ブロックかけてクロスフェードする。新段階の状態 (畳込みのオーバーラップ・遅延線) は
+ *					  IsEntering() のブロックでリセットしてから使う。
+ *					・段階ごとのボイス数は YmLodStats で集計し、任意のスレッドから参照できる (プロファイル用)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+
+#if YM_USE_LOD
+
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <atomic>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+#include "private/YmFft.h"
+
+#define YM_LOD_HEAD_RADIUS			0.0875f		///< ITD 計算の頭部半径 [m]
+#define YM_LOD_MAX_ILD				10.0f		///< 真横での反対側の耳の減衰 [dB]
+#define YM_LOD_SHADOW_MIN_FREQ		2000.0f		///< 真横での反対側の耳の遮断周波数 [Hz]
+#define YM_LOD_SHADOW_MAX_FREQ		18000.0f	///< 正面での遮断周波数 [Hz]
+#define YM_LOD_PAN_DELAY_SIZE		512			///< 遅延線の長さ (2 のべき乗, YM_LOD_PAN_CHUNK + 192kHz の最大 ITD 以上)
+#define YM_LOD_PAN_CHUNK			256			///< 遅延線に一度に書くサンプル数
+
+/***********************************************************************//**
+ * @brief			描画段階 (値が小さいほど高品質)
+ **************************************************************************/
+enum YmLodTier
+{
+	YM_LOD_FULL = 0,
+	YM_LOD_SHORT,
+	YM_LOD_PAN,
+	YM_LOD_CULLED,
+	YM_LOD_NUM_TIERS
+};
+
+/***********************************************************************//**
+ * @brief			段階選択の設定
+ * @note			FULL / SHORT / PAN の各段階は、音量が minLevel 以上かつ距離が maxDistance 以下の
+ *					ときに使える。使える段階のうち最も高品質なものを選び、どれも使えなければ CULLED。
+ **************************************************************************/
+struct YmLodConfig
+{
+	YmReal32	minLevel[YM_LOD_CULLED];		///< 各段階の最小音量 [dB]
+	YmReal32	maxDistance[YM_LOD_CULLED];		///< 各段階の最大距離 [m]
+	YmReal32	levelHysteresis;				///< 音量のヒステリシス [dB]
+	YmReal32	distanceHysteresis;				///< 距離のヒステリシス (比率)
+	YmUInt32	holdBlocks;						///< 切替後に段階を保つブロック数
+
+	YmLodConfig() : levelHysteresis(3.0f), distanceHysteresis(0.1f), holdBlocks(8)
+	{
+		minLevel[YM_LOD_FULL]     = -30.0f;
+		minLevel[YM_LOD_SHORT]    = -45.0f;
+		minLevel[YM_LOD_PAN]      = -70.0f;
+		maxDistance[YM_LOD_FULL]  = 15.0f;
+		maxDistance[YM_LOD_SHORT] = 40.0f;
+		maxDistance[YM_LOD_PAN]   = FLT_MAX;
+	}
+};
+
+/***********************************************************************//**
+ * @brief			ボイスごとの段階の状態
+ **************************************************************************/
+class YmLodVoice
+{
+public:
+	YmLodVoice() : m_tier(YM_LOD_CULLED), m_prevTier(YM_LOD_CULLED), m_hold(0), m_isFirst(true) {}
+
+	/// 次の Update() はフェードせずに段階を決める (音源の再生開始時など)
+	void Reset(void)
+	{
+		m_prevTier = m_tier = YM_LOD_CULLED;
+		m_hold = 0;
+		m_isFirst = true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		段階の更新 (1 ブロックに 1 回, 処理の前に呼ぶ)
+	 * @param[in]	distance	リスナーからの距離 [m] (UnityAudioSpatializerData::distance 等)
+	 * @param[in]	level		ボリューム x 距離減衰ゲイン (線形)
+	 * @return		このブロックの段階
+	 **************************************************************************/
+	YmLodTier Update(const YmLodConfig& config, YmReal32 distance, YmReal32 level)
+	{
+		m_prevTier = m_tier;
+		if (m_hold > 0) m_hold--;
+
+		const YmLodTier target = Select(config, distance, level);
+		if (m_isFirst)
+		{
+			m_prevTier = m_tier = target;
+			m_isFirst = false;
+		}
+		else if (target != m_tier && m_hold == 0)
+		{
+			m_tier = target;
+			m_hold = config.holdBlocks;
+		}
+		return m_tier;
+	}
+
+	/***********************************************************************//**
+	 * @brief		段階 tier の出力に掛けるブロック先頭・末尾のゲイン
+	 * @note		切替ブロックは旧段階 1 -> 0、新段階 0 -> 1。それ以外は現在の段階のみ 1 -> 1。
+	 **************************************************************************/
+	void GetFadeGains(YmLodTier tier, YmReal32& gainStart, YmReal32& gainEnd) const
+	{
+		gainStart = (tier == m_prevTier) ? 1.0f : 0.0f;
+		gainEnd   = (tier == m_tier) ? 1.0f : 0.0f;
+	}
+
+	/// このブロックで段階 tier の処理が必要か (CULLED は常に false)
+	bool IsActive(YmLodTier tier) const		{ return tier != YM_LOD_CULLED && (tier == m_tier || tier == m_prevTier); }
+	/// 段階 tier にこのブロックから入るか (状態をリセットしてから処理する)
+	bool IsEntering(YmLodTier tier) const	{ return tier == m_tier && m_prevTier != m_tier; }
+	bool IsFading(void) const				{ return m_prevTier != m_tier; }
+	YmLodTier GetTier(void) const			{ return m_tier; }
+	YmLodTier GetPreviousTier(void) const	{ return m_prevTier; }
+
+private:
+	// 現在の段階より高品質な段階はヒステリシス分厳しく、現在の段階は緩く判定する
+	YmLodTier Select(const YmLodConfig& config, YmReal32 distance, YmReal32 level) const
+	{
+		const YmReal32 levelDb = (level > 0.0f) ? YmMath::LinTodB(level) : -FLT_MAX;
+		for (int t = 0; t < YM_LOD_CULLED; t++)
+		{
+			YmReal32 minLevel = config.minLevel[t];
+			YmReal32 maxDistance = config.maxDistance[t];
+			if (!m_isFirst && t < m_tier)
+			{
+				minLevel += config.levelHysteresis;
+				maxDistance /= 1.0f + config.distanceHysteresis;
+			}
+			else if (!m_isFirst && t == m_tier)
+			{
+				minLevel -= config.levelHysteresis;
+				maxDistance *= 1.0f + config.distanceHysteresis;
+			}
+			if (levelDb >= minLevel && distance <= maxDistance) return (YmLodTier)t;
+		}
+		return YM_LOD_CULLED;
+	}
+
+	YmLodTier	m_tier;
+	YmLodTier	m_prevTier;		// 前ブロックの段階 (m_tier と異なればフェード中)
+	YmUInt32	m_hold;
+	bool		m_isFirst;
+};
+
+/***********************************************************************//**
+ * @brief			段階ごとのボイス数の集計 (プロファイル用)
+ * @note			Count() はオーディオスレッド (ワーカースレッドを含む) から並行して呼べる。
+ *					全ボイスの処理後 (次の DSP ティックの先頭など) に Publish() すると、
+ *					Get～() で直前のブロックの値を任意のスレッドから読める。
+ **************************************************************************/
+class YmLodStats
+{
+public:
+	YmLodStats()
+	{
+		for (int t = 0; t < YM_LOD_NUM_TIERS; t++)
+		{
+			m_count[t].store(0, std::memory_order_relaxed);
+			m_published[t].store(0, std::memory_order_relaxed);
+		}
+		m_transitions.store(0, std::memory_order_relaxed);
+		m_publishedTransitions.store(0, std::memory_order_relaxed);
+	}
+
+	YmLodStats(const YmLodStats&) = delete;
+	YmLodStats& operator=(const YmLodStats&) = delete;
+
+	void Count(const YmLodVoice& voice)
+	{
+		m_count[voice.GetTier()].fetch_add(1, std::memory_order_relaxed);
+		if (voice.IsFading()) m_transitions.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Publish(void)
+	{
+		for (int t = 0; t < YM_LOD_NUM_TIERS; t++)
+		{
+			m_published[t].store(m_count[t].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		m_publishedTransitions.store(m_transitions.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	YmUInt32 GetCount(YmLodTier tier) const		{ return m_published[tier].load(std::memory_order_relaxed); }
+	YmUInt32 GetNumTransitions(void) const		{ return m_publishedTransitions.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<YmUInt32>	m_count[YM_LOD_NUM_TIERS];
+	std::atomic<YmUInt32>	m_transitions;
+	std::atomic<YmUInt32>	m_published[YM_LOD_NUM_TIERS];
+	std::atomic<YmUInt32>	m_publishedTransitions;
+};
+
+/***********************************************************************//**
+ * @brief			ITD / ILD パンナー (YM_LOD_PAN 用)
+ * @attention		ITD は球頭モデル (Woodworth)、ILD は反対側の耳の減衰と 1 次ローパス (頭部陰影)。
+ *					遅延・ゲイン・フィルタ係数は前ブロックの値からブロック内で線形補間する。
+ **************************************************************************/
+class YmItdPanner
+{
+public:
+	YmItdPanner() : m_sampleRate(48000.0f), m_writePos(0), m_isFirst(true)
+	{
+		memset(m_delay, 0, sizeof(m_delay));
+		memset(m_gain, 0, sizeof(m_gain));
+		memset(m_pole, 0, sizeof(m_pole));
+		memset(m_state, 0, sizeof(m_state));
+		memset(m_buf, 0, sizeof(m_buf));
+	}
+
+	bool Init(YmUInt32 sampleRate)
+	{
+		if (sampleRate == 0 || sampleRate > 192000) return false;
+		m_sampleRate = (YmReal32)sampleRate;
+		Reset();
+		return true;
+	}
+
+	/// 遅延線・フィルタのクリア (段階に入るブロックで呼ぶ)
+	void Reset(void)
+	{
+		memset(m_state, 0, sizeof(m_state));
+		memset(m_buf, 0, sizeof(m_buf));
+		m_writePos = 0;
+		m_isFirst = true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		パンニングして出力に加算
+	 * @param[in]	in					入力 (numSamples サンプル, mono)
+	 * @param[in]	dir					リスナー座標の方向 (単位ベクトル)
+	 * @param[in]	gainStart, gainEnd	ブロック先頭・末尾のゲイン
+	 **************************************************************************/
+	void Process(const YmReal32* in, const YmVector3& dir, YmReal32 gainStart, YmReal32 gainEnd,
+		YmReal32* outLeft, YmReal32* outRight, YmUInt32 numSamples)
+	{
+		// 側方成分 (右が正) -> 側方角
+		const YmReal32 s = YmMath::Limit(dir.x, -1.0f, 1.0f);
+		const YmReal32 theta = asinf(s);
+		const YmReal32 itd = YM_LOD_HEAD_RADIUS / YMH_SONIC * (theta + s) * m_sampleRate;	// 正: 左耳が遅れる
+		const YmReal32 shadow = YmMath::dBToLin(-YM_LOD_MAX_ILD*fabsf(s));
+		const YmReal32 freq = YM_LOD_SHADOW_MAX_FREQ - (YM_LOD_SHADOW_MAX_FREQ - YM_LOD_SHADOW_MIN_FREQ)*fabsf(s);
+		const YmReal32 pole = expf(-2.0f*YMH_PI*YmMath::Min(freq, 0.45f*m_sampleRate) / m_sampleRate);
+
+		YmReal32 delay[2], gain[2], poles[2];
+		delay[0] = YmMath::Max(itd, 0.0f);
+		delay[1] = YmMath::Max(-itd, 0.0f);
+		gain[0] = (s > 0.0f) ? shadow : 1.0f;
+		gain[1] = (s < 0.0f) ? shadow : 1.0f;
+		poles[0] = (s > 0.0f) ? pole : 0.0f;
+		poles[1] = (s < 0.0f) ? pole : 0.0f;
+		if (m_isFirst)
+		{
+			memcpy(m_delay, delay, sizeof(delay));
+			memcpy(m_gain, gain, sizeof(gain));
+			memcpy(m_pole, poles, sizeof(poles));
+			m_isFirst = false;
+		}
+
+		const YmReal32 inv = 1.0f / (YmReal32)numSamples;
+		YmReal32* out[2] = { outLeft, outRight };
+		for (YmUInt32 done = 0; done < numSamples; done += YM_LOD_PAN_CHUNK)
+		{
+			// 入力を遅延線に書いてから耳ごとに読み出す
+			const YmUInt32 num = YmMath::Min(numSamples - done, (YmUInt32)YM_LOD_PAN_CHUNK);
+			const YmUInt32 pos = m_writePos + done;
+			for (YmUInt32 n = 0; n < num; n++) m_buf[(pos + n) & (YM_LOD_PAN_DELAY_SIZE - 1)] = in[done + n];
+			for (int ear = 0; ear < 2; ear++)
+			{
+				const YmReal32 t0 = (YmReal32)(done + 1);
+				const YmReal32 dStep = (delay[ear] - m_delay[ear])*inv;
+				const YmReal32 g0 = m_gain[ear]*gainStart;
+				const YmReal32 gStep = (gain[ear]*gainEnd - g0)*inv;
+				const YmReal32 pStep = (poles[ear] - m_pole[ear])*inv;
+				Read(out[ear] + done, pos, num, m_delay[ear] + dStep*t0, dStep, g0 + gStep*t0, gStep,
+					m_pole[ear] + pStep*t0, pStep, m_state[ear]);
+			}
+		}
+		m_writePos += numSamples;
+		memcpy(m_delay, delay, sizeof(delay));
+		memcpy(m_gain, gain, sizeof(gain));
+		memcpy(m_pole, poles, sizeof(poles));
+	}
+
+private:
+	// 遅延線の pos から num サンプルを読み、ローパスとゲインを掛けて加算 (値は 1 サンプル目のもの)
+	void Read(YmReal32* out, YmUInt32 pos, YmUInt32 num, YmReal32 d, YmReal32 dStep, YmReal32 g, YmReal32 gStep,
+		YmReal32 p, YmReal32 pStep, YmReal32& io_state) const
+	{
+		const YmUInt32 mask = YM_LOD_PAN_DELAY_SIZE - 1;
+		const YmReal32* buf = m_buf;
+		YmReal32 state = io_state;
+		const bool filter = (p != 0.0f || pStep != 0.0f);		// 近い側の耳は通さない
+		if (dStep == 0.0f)
+		{
+			// 遅延が変わらないブロック (大半) は補間位置を固定する
+			const YmUInt32 di = (YmUInt32)d;
+			const YmReal32 frac = d - (YmReal32)di;
+			for (YmUInt32 n = 0; n < num; n++, pos++)
+			{
+				const YmReal32 a = buf[(pos - di) & mask];
+				const YmReal32 b = buf[(pos - di - 1) & mask];
+				YmReal32 x = a + (b - a)*frac;
+				if (filter)
+				{
+					state = x + (state - x)*p;
+					x = state;
+					p += pStep;
+				}
+				out[n] += x*g;
+				g += gStep;
+			}
+			io_state = filter ? state : 0.0f;
+			return;
+		}
+		for (YmUInt32 n = 0; n < num; n++, pos++)
+		{
+			const YmUInt32 di = (YmUInt32)d;
+			const YmReal32 frac = d - (YmReal32)di;
+			const YmReal32 a = buf[(pos - di) & mask];
+			const YmReal32 b = buf[(pos - di - 1) & mask];
+			YmReal32 x = a + (b - a)*frac;
+			if (filter)
+			{
+				state = x + (state - x)*p;		// (1 - p) x + p y[n-1]
+				x = state;
+				p += pStep;
+			}
+			out[n] += x*g;
+			d += dStep;
+			g += gStep;
+		}
+		io_state = filter ? state : 0.0f;
+	}
+
+	YmReal32	m_sampleRate;
+	YmUInt32	m_writePos;
+	bool		m_isFirst;
+	YmReal32	m_delay[2];		// 前ブロック末尾の値 [ear]
+	YmReal32	m_gain[2];
+	YmReal32	m_pole[2];
+	YmReal32	m_state[2];		// ローパスの状態
+	YmReal32	m_buf[YM_LOD_PAN_DELAY_SIZE];
+};
+
+namespace YmLod {
+
+/***********************************************************************//**
+ * @brief		SHORT 段階用の短い HRIR (非オーディオスレッドで呼ぶこと)
+ * @param[in]	ir, irLength	元の HRIR (片耳)
+ * @param[out]	out				[outLength]
+ * @return		作業領域を確保できない場合 false
+ * @note		ケプストラムで最小位相化した応答を元の立上り位置 (ピークの -20dB) に置き、
+ *				末尾 1/4 をハン窓で落とす。振幅特性はほぼ保たれ、左右の立上りの差で ITD も残る。
+ **************************************************************************/
+inline bool MakeShortHrir(YmMemAlloc* in_pAllocator, const YmReal32* ir, YmUInt32 irLength, YmReal32* out, YmUInt32 outLength)
+{
+	if (ir == nullptr || irLength == 0 || outLength == 0) return false;
+
+	// 立上り
+	YmReal32 peak = 0.0f;
+	for (YmUInt32 n = 0; n < irLength; n++) peak = YmMath::Max(peak, fabsf(ir[n]));
+	memset(out, 0, sizeof(YmReal32)*outLength);
+	if (peak == 0.0f) return true;
+	YmUInt32 onset = 0;
+	while (fabsf(ir[onset]) < 0.1f*peak) onset++;
+	onset = YmMath::Min(onset, outLength/2);
+
+	// 巡回による時間折返しを抑えるため 4 倍長で変換する
+	YmUInt32 fftSize = 4;
+	while (fftSize < 4*YmMath::Max(irLength, outLength)) fftSize <<= 1;
+	YmFft fft;
+	YmReal32* time = alloc_array<YmReal32>(in_pAllocator, fftSize);
+	YmReal32* spec = alloc_array_nozero<YmReal32>(in_pAllocator, fftSize + 2);
+	if (time == nullptr || spec == nullptr || !fft.Init(in_pAllocator, fftSize))
+	{
+		free_memory(in_pAllocator, time);
+		free_memory(in_pAllocator, spec);
+		return false;
+	}
+	const YmUInt32 numBins = fft.GetNumBins();
+
+	// log|H| -> 実ケプストラム
+	memcpy(time, ir, sizeof(YmReal32)*irLength);
+	fft.Forward(time, spec);
+	const YmReal32 floor = 1.0e-5f*peak;
+	for (YmUInt32 k = 0; k < numBins; k++)
+	{
+		const YmReal32 mag = sqrtf(spec[2*k]*spec[2*k] + spec[2*k+1]*spec[2*k+1]);
+		spec[2*k] = logf(YmMath::Max(mag, floor));
+		spec[2*k+1] = 0.0f;
+	}
+	fft.Inverse(spec, time);
+
+	// 因果側に折り返す
+	for (YmUInt32 n = 1; n < fftSize/2; n++)
+	{
+		time[n] *= 2.0f;
+		time[fftSize - n] = 0.0f;
+	}
+
+	// exp -> 最小位相応答
+	fft.Forward(time, spec);
+	for (YmUInt32 k = 0; k < numBins; k++)
+	{
+		const YmReal32 mag = expf(spec[2*k]);
+		const YmReal32 ph = spec[2*k+1];
+		spec[2*k] = mag*cosf(ph);
+		spec[2*k+1] = mag*sinf(ph);
+	}
+	fft.Inverse(spec, time);
+
+	const YmUInt32 length = outLength - onset;
+	const YmUInt32 fade = YmMath::Max(length/4, 1u);
+	for (YmUInt32 n = 0; n < length; n++)
+	{
+		YmReal32 w = 1.0f;
+		if (n >= length - fade) w = 0.5f + 0.5f*cosf(YMH_PI*(YmReal32)(n - (length - fade) + 1) / (YmReal32)fade);
+		out[onset + n] = time[n]*w;
+	}
+
+	fft.Term();
+	free_memory(in_pAllocator, time);
+	free_memory(in_pAllocator, spec);
+	return true;
+}
+
+} // namespace YmLod
+
+#endif // YM_USE_LOD
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
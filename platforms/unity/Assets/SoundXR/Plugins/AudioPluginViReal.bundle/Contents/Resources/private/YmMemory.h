@@ -1,179 +1,336 @@
-﻿/*****************************************************************************************//**
- * @file			YmMemory.h
- * @brief
- * @attention
- *
- *                 (C) 2018 Yamaha Corporation
- *                  Confidential
- ********************************************************************************************/
-
-#pragma once
-
-#include <stdlib.h>
-#include <string.h>
-
-#ifdef YM_TARGET_WWISE
-	#include <AK/SoundEngine/Common/IAkPlugin.h>
-#endif
-
-#ifndef YM_USE_CUSTOM_ALLOCATOR
-	#define YM_USE_CUSTOM_ALLOCATOR 0
-#endif
-
-/***********************************************************************//**
- * custom allocator
- **************************************************************************/
-#if YM_USE_CUSTOM_ALLOCATOR
-	#ifdef YM_TARGET_WWISE
-		#define YmMemAlloc			AK::IAkPluginMemAlloc
-	#else
-		#error Custom allocator is not implemented.
-	#endif
-#else
-		#define YmMemAlloc			void
-#endif
-
-/***********************************************************************//**
- * delete
- **************************************************************************/
-template <class T> inline void YM_DELETE(YmMemAlloc * in_pAllocator, T * in_pObject)
-{
-#if !defined(YM_TARGET_WWISE)
-	(void)in_pAllocator;
-#endif
-	if (in_pObject)
-	{
-#if defined(YM_TARGET_WWISE)
-		AK_PLUGIN_DELETE(in_pAllocator, in_pObject);
-#else
-		delete in_pObject;
-#endif
-	}
-}
-
-template <class T> inline void checked_delete(T*& p)
-{
-	// 不完全な型はコンパイル時エラー
-	typedef char checked_type[sizeof(T)? 1 : -1];
-	(void)sizeof(checked_type);
-
-	if (p == nullptr)
-		return;
-
-	delete p;
-	p = nullptr;
-}
-
-template <class T> inline void checked_array_delete(T*& p)
-{
-	// 不完全な型はコンパイル時エラー
-	typedef char checked_type[sizeof(T)? 1 : -1];
-	(void)sizeof(checked_type);
-
-	if (p == nullptr)
-		return;
-
-	delete[] p;
-	p = nullptr;
-}
-
-/***********************************************************************//**
- * new
- **************************************************************************/
-#ifdef YM_TARGET_WWISE
-	#define YM_NEW(_allocator,_what)	AK_PLUGIN_NEW(_allocator,_what)
-#else
-	#define YM_NEW(_allocator,_what)	new _what
-#endif
-
-/***********************************************************************//**
- * aligned free
- **************************************************************************/
-inline void free_memory(YmMemAlloc * in_pAllocator, void* mem)
-{
-	if (mem == nullptr) return;
-#if defined(YM_TARGET_WWISE)
-	AK_PLUGIN_FREE(in_pAllocator, mem);
-#else
-	(void)in_pAllocator;
-	#if defined (_WIN32)||defined(_WIN64)
-	_aligned_free(mem);
-	#else
-	free(mem);
-	#endif
-#endif
-	mem = nullptr;
-}
-
-inline void free_memory(void* mem)
-{
-	if (mem == nullptr) return;
-#if defined (_WIN32)||defined(_WIN64)
-	_aligned_free(mem);
-#else
-	free(mem);
-#endif
-	mem = nullptr;
-}
-
-/***********************************************************************//**
- * aligned malloc
- **************************************************************************/
-// Visual Studio の警告レベルを /wall に指定すると以下の警告が出るが、無視する。
-//   「warning C4571: 情報: catch(...) の意味が Visual C++ 7.1 から変更されています。構造化例外 (SEH) はキャッチされません」
-// 
-// ざっくり言うと、SEH は Microsoft 固有の例外処理であり、ANSI/ISO C++標準の例外処理(std::exception)の使用を勧める警告。
-// ViReal にて実績のある現状維持とする。
-inline void* alloc_memory(YmMemAlloc * in_pAllocator, size_t size, size_t align)
-{
-	void* ptr = nullptr;
-	try
-	{
-#if defined(YM_TARGET_WWISE)
-		(void)align;
-		ptr = AK_PLUGIN_ALLOC(in_pAllocator, size);        // check 2017.01.17 align 指定できない？
-#else
-		(void)in_pAllocator;
-	#if defined (_WIN32)||defined(_WIN64)
-		ptr = _aligned_malloc(size, align);
-	#else
-		if (posix_memalign(&ptr, align, size) != 0) ptr = nullptr;
-	#endif
-#endif
-		if (ptr != nullptr)
-		{
-			memset(ptr, 0, size);
-		}
-	}
-	catch (...)
-	{
-		free_memory(in_pAllocator, ptr);
-	}
-	return ptr;
-}
-
-inline void* alloc_memory(size_t size, size_t align)
-{
-	void* ptr = nullptr;
-	try
-	{
-#if defined (_WIN32)||defined(_WIN64)
-		ptr = _aligned_malloc(size, align);
-#else
-		if (posix_memalign(&ptr, align, size) != 0) ptr = nullptr;
-#endif
-		if (ptr != nullptr)
-		{
-			memset(ptr, 0, size);
-		}
-	}
-	catch (...)
-	{
-		free_memory(ptr);
-	}
-	return ptr;
-}
-
-/*********************************************************************************************
-* EOF
-*********************************************************************************************/
+﻿/*****************************************************************************************//**
+ * @file			YmMemory.h
+ * @brief
+ * @attention
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <atomic>
+#include "private/YmTypes.h"
+
+#ifdef YM_TARGET_WWISE
+	#include <AK/SoundEngine/Common/IAkPlugin.h>
+#endif
+
+#ifndef YM_USE_CUSTOM_ALLOCATOR
+	#define YM_USE_CUSTOM_ALLOCATOR 0
+#endif
+
+/***********************************************************************//**
+ * custom allocator
+ **************************************************************************/
+#if YM_USE_CUSTOM_ALLOCATOR
+	#ifdef YM_TARGET_WWISE
+		#define YmMemAlloc			AK::IAkPluginMemAlloc
+	#else
+		/// Wwise 以外のターゲット用アロケータインタフェース。
+		/// エンジン側のアリーナやボイス単位のプールに振り向ける場合に実装する。
+		class YmAllocator
+		{
+		public:
+			virtual ~YmAllocator() {}
+			virtual void* Malloc(size_t size, size_t align) = 0;	///< 失敗時は nullptr を返すこと (例外は投げない)
+			virtual void  Free(void* ptr) = 0;
+		};
+		#define YmMemAlloc			YmAllocator
+	#endif
+#else
+		#define YmMemAlloc			void
+#endif
+
+#define YM_NEW_ALIGNMENT			16		///< YM_NEW で確保するオブジェクトのアライメント
+#define YM_SIMD_WIDE_ALIGNMENT		64		///< SIMD で読み書きするバッファのアライメント (AVX-512 の 1 ベクトル = キャッシュライン)
+
+/***********************************************************************//**
+ * system allocator
+ **************************************************************************/
+inline void* system_alloc(size_t size, size_t align)
+{
+	void* ptr = nullptr;
+#if defined (_WIN32)||defined(_WIN64)
+	ptr = _aligned_malloc(size, align);
+#else
+	if (posix_memalign(&ptr, align, size) != 0) ptr = nullptr;
+#endif
+	return ptr;
+}
+
+inline void system_free(void* mem)
+{
+#if defined (_WIN32)||defined(_WIN64)
+	_aligned_free(mem);
+#else
+	free(mem);
+#endif
+}
+
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+/***********************************************************************//**
+ * default allocator (Wwise 以外)
+ * @note	アロケータ未指定 (nullptr) の確保・解放はここで設定したものを使う。
+ *			確保済みメモリが残っている間に差し替えないこと。
+ *			未設定の場合はシステムのアロケータを使う。
+ **************************************************************************/
+inline std::atomic<YmAllocator*>& default_allocator_ref(void)
+{
+	static std::atomic<YmAllocator*> s_allocator(nullptr);
+	return s_allocator;
+}
+
+inline void set_default_allocator(YmAllocator* in_pAllocator)
+{
+	default_allocator_ref().store(in_pAllocator, std::memory_order_release);
+}
+
+inline YmAllocator* get_default_allocator(void)
+{
+	return default_allocator_ref().load(std::memory_order_acquire);
+}
+
+inline YmAllocator* resolve_allocator(YmAllocator* in_pAllocator)
+{
+	return (in_pAllocator != nullptr) ? in_pAllocator : get_default_allocator();
+}
+
+inline void* allocator_alloc(YmAllocator* in_pAllocator, size_t size, size_t align)
+{
+	YmAllocator* a = resolve_allocator(in_pAllocator);
+	return (a != nullptr) ? a->Malloc(size, align) : system_alloc(size, align);
+}
+
+inline void allocator_free(YmAllocator* in_pAllocator, void* mem)
+{
+	YmAllocator* a = resolve_allocator(in_pAllocator);
+	if (a != nullptr) a->Free(mem);
+	else system_free(mem);
+}
+
+/***********************************************************************//**
+ * YM_NEW 用の配置 new
+ * @note	アロケータが未指定かつ既定のアロケータも未設定の場合は通常の new と同じ
+ *			(::operator new で確保し、YM_DELETE は delete で解放する)。
+ *			通常の new と同じく、確保に失敗した場合は std::bad_alloc を投げる。
+ **************************************************************************/
+inline void* operator new(size_t size, YmAllocator* in_pAllocator)
+{
+	YmAllocator* a = resolve_allocator(in_pAllocator);
+	if (a == nullptr) return ::operator new(size);
+	void* mem = a->Malloc(size, YM_NEW_ALIGNMENT);
+	if (mem == nullptr) throw std::bad_alloc();
+	return mem;
+}
+
+/// コンストラクタが例外を投げた場合の解放
+inline void operator delete(void* mem, YmAllocator* in_pAllocator) noexcept
+{
+	YmAllocator* a = resolve_allocator(in_pAllocator);
+	if (a == nullptr) ::operator delete(mem);
+	else a->Free(mem);
+}
+#endif
+
+/***********************************************************************//**
+ * delete
+ * @note	YM_NEW で確保した最派生型のポインタを渡すこと (AK_PLUGIN_DELETE と同じ制約)。
+ *			カスタムアロケータ使用時、基底クラスのポインタでは解放するアドレスがずれる場合がある。
+ **************************************************************************/
+template <class T> inline void YM_DELETE(YmMemAlloc * in_pAllocator, T * in_pObject)
+{
+#if !defined(YM_TARGET_WWISE)
+	(void)in_pAllocator;
+#endif
+	if (in_pObject)
+	{
+#if defined(YM_TARGET_WWISE)
+		AK_PLUGIN_DELETE(in_pAllocator, in_pObject);
+#elif YM_USE_CUSTOM_ALLOCATOR
+		YmAllocator* a = resolve_allocator(in_pAllocator);
+		if (a == nullptr)
+		{
+			delete in_pObject;
+			return;
+		}
+		in_pObject->~T();
+		a->Free(in_pObject);
+#else
+		delete in_pObject;
+#endif
+	}
+}
+
+template <class T> inline void checked_delete(T*& p)
+{
+	// 不完全な型はコンパイル時エラー
+	typedef char checked_type[sizeof(T)? 1 : -1];
+	(void)sizeof(checked_type);
+
+	if (p == nullptr)
+		return;
+
+	delete p;
+	p = nullptr;
+}
+
+template <class T> inline void checked_array_delete(T*& p)
+{
+	// 不完全な型はコンパイル時エラー
+	typedef char checked_type[sizeof(T)? 1 : -1];
+	(void)sizeof(checked_type);
+
+	if (p == nullptr)
+		return;
+
+	delete[] p;
+	p = nullptr;
+}
+
+/***********************************************************************//**
+ * new
+ * @note	確保に失敗した場合
+ *			- Wwise: nullptr を返す (AK_PLUGIN_NEW)。呼び出し側で nullptr を確認すること。
+ *			- それ以外: 通常の new と同じく std::bad_alloc を投げる。
+ *			例外を無効にしたビルドで失敗を扱う必要がある場合は、alloc_memory() と配置 new を使うこと。
+ **************************************************************************/
+#ifdef YM_TARGET_WWISE
+	#define YM_NEW(_allocator,_what)	AK_PLUGIN_NEW(_allocator,_what)
+#elif YM_USE_CUSTOM_ALLOCATOR
+	#define YM_NEW(_allocator,_what)	new(static_cast<YmAllocator*>(_allocator)) _what
+#else
+	#define YM_NEW(_allocator,_what)	new _what
+#endif
+
+/***********************************************************************//**
+ * aligned free
+ **************************************************************************/
+inline void free_memory(YmMemAlloc * in_pAllocator, void* mem)
+{
+	if (mem == nullptr) return;
+#if defined(YM_TARGET_WWISE)
+	AK_PLUGIN_FREE(in_pAllocator, mem);
+#elif YM_USE_CUSTOM_ALLOCATOR
+	allocator_free(in_pAllocator, mem);
+#else
+	(void)in_pAllocator;
+	system_free(mem);
+#endif
+	mem = nullptr;
+}
+
+inline void free_memory(void* mem)
+{
+	if (mem == nullptr) return;
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+	allocator_free(nullptr, mem);
+#else
+	system_free(mem);
+#endif
+	mem = nullptr;
+}
+
+/***********************************************************************//**
+ * aligned malloc
+ **************************************************************************/
+// Visual Studio の警告レベルを /wall に指定すると以下の警告が出るが、無視する。
+//   「warning C4571: 情報: catch(...) の意味が Visual C++ 7.1 から変更されています。構造化例外 (SEH) はキャッチされません」
+// 
+// ざっくり言うと、SEH は Microsoft 固有の例外処理であり、ANSI/ISO C++標準の例外処理(std::exception)の使用を勧める警告。
+// ViReal にて実績のある現状維持とする。
+inline void* alloc_memory(YmMemAlloc * in_pAllocator, size_t size, size_t align)
+{
+	void* ptr = nullptr;
+	try
+	{
+#if defined(YM_TARGET_WWISE)
+		(void)align;
+		ptr = AK_PLUGIN_ALLOC(in_pAllocator, size);        // check 2017.01.17 align 指定できない？
+#elif YM_USE_CUSTOM_ALLOCATOR
+		ptr = allocator_alloc(in_pAllocator, size, align);
+#else
+		(void)in_pAllocator;
+		ptr = system_alloc(size, align);
+#endif
+		if (ptr != nullptr)
+		{
+			memset(ptr, 0, size);
+		}
+	}
+	catch (...)
+	{
+		free_memory(in_pAllocator, ptr);
+	}
+	return ptr;
+}
+
+inline void* alloc_memory(size_t size, size_t align)
+{
+	void* ptr = nullptr;
+	try
+	{
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+		ptr = allocator_alloc(nullptr, size, align);
+#else
+		ptr = system_alloc(size, align);
+#endif
+		if (ptr != nullptr)
+		{
+			memset(ptr, 0, size);
+		}
+	}
+	catch (...)
+	{
+		free_memory(ptr);
+	}
+	return ptr;
+}
+
+/***********************************************************************//**
+ * aligned malloc (ゼロクリアなし)
+ * @note	直後に全領域を上書きするバッファ (HRTF テーブル、FFT 作業領域等) 用。
+ *			memset による初期化コストとページの先行確保を省く。
+ **************************************************************************/
+inline void* alloc_memory_nozero(YmMemAlloc * in_pAllocator, size_t size, size_t align)
+{
+#if defined(YM_TARGET_WWISE)
+	(void)align;
+	return AK_PLUGIN_ALLOC(in_pAllocator, size);
+#elif YM_USE_CUSTOM_ALLOCATOR
+	return allocator_alloc(in_pAllocator, size, align);
+#else
+	(void)in_pAllocator;
+	return system_alloc(size, align);
+#endif
+}
+
+inline void* alloc_memory_nozero(size_t size, size_t align)
+{
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+	return allocator_alloc(nullptr, size, align);
+#else
+	return system_alloc(size, align);
+#endif
+}
+
+/***********************************************************************//**
+ * T[count] の確保 (YM_SIMD_WIDE_ALIGNMENT 境界、alloc_array はゼロクリアあり)
+ * @note	コンストラクタは呼ばない。float 等の配列と、配置 new で構築するオブジェクト用。
+ **************************************************************************/
+template <class T> inline T* alloc_array(YmMemAlloc * in_pAllocator, size_t count)
+{
+	return static_cast<T*>(alloc_memory(in_pAllocator, sizeof(T)*count, YM_SIMD_WIDE_ALIGNMENT));
+}
+
+template <class T> inline T* alloc_array_nozero(YmMemAlloc * in_pAllocator, size_t count)
+{
+	return static_cast<T*>(alloc_memory_nozero(in_pAllocator, sizeof(T)*count, YM_SIMD_WIDE_ALIGNMENT));
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
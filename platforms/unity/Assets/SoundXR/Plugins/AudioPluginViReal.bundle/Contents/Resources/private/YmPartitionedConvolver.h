@@ -0,0 +1,481 @@
+﻿/*****************************************************************************************//**
+ * @file			YmPartitionedConvolver.h
+ * @brief			分割畳込み (一様 / 非一様)。時間軸ヘッド + 周波数軸テール
+ * @attention		ホストのブロック長 B 以外の遅延は発生しない。
+ *
+ *					フィルタ [0, L) を次のように分割する。
+ *					  [0, H)        : 時間軸 FIR (ヘッド, H = headLength)
+ *					  [H, L)        : 周波数軸 Overlap-Save セグメント。
+ *					                  分割長 Bs は B から始まり、オフセット Os が Os >= Bs - B を
+ *					                  満たす範囲で maxPartitionSize まで倍々に大きくする。
+ *					maxPartitionSize == B とすると一様分割になる。
+ *
+ *					分割長 Bs のセグメントは Bs サンプル入力が溜まったブロックでまとめて計算するため、
+ *					大きなセグメントの処理はそのブロックに集中する (ブロックごとの負荷は一定ではない)。
+ *
+ *					入力は 1 系統、フィルタは複数チャンネル (HRTF の左右等) で、入力スペクトルを共有する。
+ *
+ *					UpdateFilters() はフィルタを別の面に書き込んで切り替え、各セグメント (とヘッド) の
+ *					次の計算 1 回だけ新旧両方の積和・逆 FFT を行って出力区間でクロスフェードする。
+ *					入力スペクトル (FDL) は新旧で共有するので、増えるのは積和と逆 FFT のみ。
+ *					フィルタが変わらないブロックでは従来どおり 1 系統分しか計算しない。
+ *					クロスフェード (線形ランプとの積) は周波数軸では畳込みになるため、スペクトルではなく
+ *					逆 FFT 後の出力区間で行う (ビンごとの重み付けでは区間内の滑らかなフェードにならない)。
+ *
+ *					フェード中の UpdateFilters() は 3 面目 (保留) に書き込み、フェードが終わったブロックで
+ *					次のフェードを始める。保留は 1 つだけで、フェード中に複数回呼ばれた場合は最後の更新が残る。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmFft.h"
+#include "private/YmSimdDispatch.h"
+
+#define YM_CONV_MAX_CHANNELS		4		///< フィルタチャンネル数の上限
+#define YM_CONV_MAX_SEGMENTS		16		///< 周波数軸セグメント数の上限
+
+class YmPartitionedConvolver
+{
+public:
+	YmPartitionedConvolver() : m_pAllocator(nullptr), m_blockSize(0), m_maxLength(0), m_headLength(0), m_numChannels(0),
+		m_numSegments(0), m_time(0), m_bank(0), m_prevBank(1), m_numFading(0), m_headFading(false), m_hasPending(false), m_pHeadCoef(nullptr), m_pHeadHist(nullptr),
+		m_pInRing(nullptr), m_inRingMask(0), m_pOutRing(nullptr), m_outRingMask(0) {}
+	~YmPartitionedConvolver() { Term(); }
+
+	YmPartitionedConvolver(const YmPartitionedConvolver&) = delete;
+	YmPartitionedConvolver& operator=(const YmPartitionedConvolver&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	blockSize			ホストのブロック長 B (2 のべき乗)
+	 * @param[in]	maxLength			フィルタ長の上限
+	 * @param[in]	numChannels			フィルタチャンネル数
+	 * @param[in]	headLength			時間軸ヘッドのタップ数 (0 可)
+	 * @param[in]	maxPartitionSize	周波数軸の最大分割長 (B の 2 のべき乗倍。B で一様分割)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 blockSize, YmUInt32 maxLength, YmUInt32 numChannels,
+		YmUInt32 headLength, YmUInt32 maxPartitionSize)
+	{
+		Term();
+		if (blockSize == 0 || (blockSize & (blockSize - 1)) != 0) return false;
+		if (maxLength == 0 || numChannels == 0 || numChannels > YM_CONV_MAX_CHANNELS) return false;
+		if (maxPartitionSize < blockSize) maxPartitionSize = blockSize;
+		if (headLength > maxLength) headLength = maxLength;
+
+		m_pAllocator = in_pAllocator;
+		m_blockSize = blockSize;
+		m_maxLength = maxLength;
+		m_headLength = headLength;
+		m_numChannels = numChannels;
+
+		if (!PlanSegments(maxPartitionSize) || !AllocBuffers())
+		{
+			Term();
+			return false;
+		}
+		YmSimd::InitKernels();
+		Reset();
+		return true;
+	}
+
+	void Term(void)
+	{
+		for (YmUInt32 s = 0; s < YM_CONV_MAX_SEGMENTS; s++)
+		{
+			Segment& seg = m_segments[s];
+			seg.fft.Term();
+			free_memory(m_pAllocator, seg.pFdl);
+			free_memory(m_pAllocator, seg.pFilter);
+			free_memory(m_pAllocator, seg.pAcc);
+			free_memory(m_pAllocator, seg.pTime);
+			free_memory(m_pAllocator, seg.pFadeAcc);
+			free_memory(m_pAllocator, seg.pFadeTime);
+			seg.pFdl = nullptr;
+			seg.pFilter = nullptr;
+			seg.pAcc = nullptr;
+			seg.pTime = nullptr;
+			seg.pFadeAcc = nullptr;
+			seg.pFadeTime = nullptr;
+			seg.fading = false;
+		}
+		free_memory(m_pAllocator, m_pHeadCoef);
+		free_memory(m_pAllocator, m_pHeadHist);
+		free_memory(m_pAllocator, m_pInRing);
+		free_memory(m_pAllocator, m_pOutRing);
+		m_pHeadCoef = nullptr;
+		m_pHeadHist = nullptr;
+		m_pInRing = nullptr;
+		m_pOutRing = nullptr;
+		m_numSegments = 0;
+		m_numChannels = 0;
+		m_bank = 0;
+		m_prevBank = 1;
+		m_numFading = 0;
+		m_headFading = false;
+		m_hasPending = false;
+	}
+
+	/***********************************************************************//**
+	 * @brief		フィルタの設定 (FFT を伴うため非オーディオスレッド推奨)
+	 * @param[in]	ch		チャンネル
+	 * @param[in]	ir		インパルス応答
+	 * @param[in]	length	長さ (maxLength を超える分は切り捨て)
+	 * @note		即座に置き換わる (初期設定用)。再生中の変更は UpdateFilters() を使う。
+	 **************************************************************************/
+	void SetFilter(YmUInt32 ch, const YmReal32* ir, YmUInt32 length)
+	{
+		if (ch >= m_numChannels) return;
+		WriteFilter(m_bank, ch, ir, length);
+	}
+
+	/***********************************************************************//**
+	 * @brief		全チャンネルのフィルタをクロスフェードで更新
+	 * @param[in]	irs		インパルス応答 [numChannels]
+	 * @param[in]	length	長さ (maxLength を超える分は切り捨て)
+	 * @return		未初期化なら false
+	 * @note		最大分割長のセグメントが一巡するまで (最大 maxPartitionSize / B ブロック) フェード中になる。
+	 *				フェード中は保留し、フェードが終わったブロックの Process() で次のフェードを始める
+	 *				(保留中に再度呼ばれたら保留分を置き換える)。
+	 **************************************************************************/
+	bool UpdateFilters(const YmReal32* const* irs, YmUInt32 length)
+	{
+		if (m_numChannels == 0) return false;
+		const YmUInt32 spare = GetSpareBank();
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++) WriteFilter(spare, ch, irs[ch], length);
+		m_hasPending = true;
+		if (!IsFading()) StartFade();
+		return true;
+	}
+
+	bool IsFading(void) const				{ return m_numFading != 0; }
+	/// フェード待ちの更新があるか (次の UpdateFilters() で置き換わる)
+	bool IsUpdatePending(void) const		{ return m_hasPending; }
+
+	/***********************************************************************//**
+	 * @brief		1 ブロック (blockSize サンプル) の処理
+	 * @param[in]	in		入力
+	 * @param[out]	out		出力 [numChannels][blockSize]
+	 **************************************************************************/
+	void Process(const YmReal32* in, YmReal32* const* out)
+	{
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		const YmUInt32 B = m_blockSize;
+
+		// 入力リングに追加
+		for (YmUInt32 n = 0; n < B; n++) m_pInRing[(m_time + n) & m_inRingMask] = in[n];
+		m_time += B;
+
+		// 周波数軸セグメント (入力が Bs 溜まったものだけ計算)
+		for (YmUInt32 s = 0; s < m_numSegments; s++)
+		{
+			Segment& seg = m_segments[s];
+			if ((m_time % seg.size) != 0) continue;
+			ProcessSegment(seg, k);
+		}
+
+		// 出力リングから取り出し
+		const YmUInt64 start = m_time - B;
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+		{
+			YmReal32* ring = GetOutRing(ch);
+			for (YmUInt32 n = 0; n < B; n++)
+			{
+				const YmUInt32 idx = (YmUInt32)((start + n) & m_outRingMask);
+				out[ch][n] = ring[idx];
+				ring[idx] = 0.0f;
+			}
+		}
+
+		// 時間軸ヘッド
+		if (m_headLength > 0)
+		{
+			const YmUInt32 hist = m_headLength - 1;
+			const YmReal32 step = 1.0f / (YmReal32)B;
+			memcpy(m_pHeadHist + hist, in, sizeof(YmReal32)*B);
+			for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+			{
+				YmReal32* tmp = m_segmentScratch;
+				YmReal32* old = m_fadeScratch;
+				for (YmUInt32 n0 = 0; n0 < B; n0 += YM_CONV_SCRATCH)
+				{
+					const YmUInt32 len = YmMinU(YM_CONV_SCRATCH, B - n0);
+					k.Fir(tmp, m_pHeadHist + n0, GetHeadCoef(m_bank, ch), len, m_headLength);
+					if (m_headFading)
+					{
+						k.Fir(old, m_pHeadHist + n0, GetHeadCoef(m_prevBank, ch), len, m_headLength);
+						for (YmUInt32 n = 0; n < len; n++) tmp[n] = old[n] + (tmp[n] - old[n])*(YmReal32)(n0 + n + 1)*step;
+					}
+					for (YmUInt32 n = 0; n < len; n++) out[ch][n0 + n] += tmp[n];
+				}
+			}
+			memmove(m_pHeadHist, m_pHeadHist + B, sizeof(YmReal32)*hist);
+			if (m_headFading)
+			{
+				m_headFading = false;
+				m_numFading--;
+			}
+		}
+
+		if (m_hasPending && !IsFading()) StartFade();
+	}
+
+	/***********************************************************************//**
+	 * @brief		内部状態のクリア
+	 **************************************************************************/
+	void Reset(void)
+	{
+		m_time = 0;
+		if (m_pInRing)   memset(m_pInRing, 0, sizeof(YmReal32)*(m_inRingMask + 1));
+		if (m_pOutRing)  memset(m_pOutRing, 0, sizeof(YmReal32)*(m_outRingMask + 1)*m_numChannels);
+		if (m_pHeadHist) memset(m_pHeadHist, 0, sizeof(YmReal32)*(m_headLength + m_blockSize));
+		for (YmUInt32 s = 0; s < m_numSegments; s++)
+		{
+			Segment& seg = m_segments[s];
+			memset(seg.pFdl, 0, sizeof(YmReal32)*seg.stride*seg.count);
+			seg.fdlPos = 0;
+			seg.fading = false;		// 履歴がないので新フィルタのみでよい
+		}
+		m_headFading = false;
+		m_numFading = 0;
+		if (m_hasPending)
+		{
+			const YmUInt32 next = GetSpareBank();
+			m_prevBank = m_bank;
+			m_bank = next;
+			m_hasPending = false;
+		}
+	}
+
+	YmUInt32 GetBlockSize(void) const		{ return m_blockSize; }
+	YmUInt32 GetMaxLength(void) const		{ return m_maxLength; }
+	YmUInt32 GetNumChannels(void) const		{ return m_numChannels; }
+	YmUInt32 GetNumSegments(void) const		{ return m_numSegments; }
+	YmUInt32 GetSegmentSize(YmUInt32 s) const	{ return m_segments[s].size; }
+	YmUInt32 GetSegmentCount(YmUInt32 s) const	{ return m_segments[s].count; }
+
+private:
+	enum { YM_CONV_SCRATCH = 256, YM_CONV_NUM_BANKS = 3 };
+
+	struct Segment
+	{
+		Segment() : size(0), offset(0), count(0), stride(0), fdlPos(0), fading(false), pFdl(nullptr), pFilter(nullptr), pAcc(nullptr), pTime(nullptr),
+			pFadeAcc(nullptr), pFadeTime(nullptr) {}
+		YmFft		fft;			// 2*size 点
+		YmUInt32	size;			// 分割長 Bs
+		YmUInt32	offset;			// フィルタ上の開始位置 Os
+		YmUInt32	count;			// 分割数
+		YmUInt32	stride;			// 1 スペクトルの float 数
+		YmUInt32	fdlPos;			// FDL の最新位置
+		bool		fading;			// 次の計算で旧フィルタからクロスフェードする
+		YmReal32*	pFdl;			// 入力スペクトル履歴 [count][stride]
+		YmReal32*	pFilter;		// フィルタスペクトル [bank(3)][ch][count][stride]
+		YmReal32*	pAcc;			// 積和結果 [stride]
+		YmReal32*	pTime;			// 時間信号 [2*size]
+		YmReal32*	pFadeAcc;		// 旧フィルタの積和結果 [stride]
+		YmReal32*	pFadeTime;		// 旧フィルタの時間信号 [2*size]
+	};
+
+	static YmUInt32 YmMinU(YmUInt32 a, YmUInt32 b)	{ return (a < b) ? a : b; }
+
+	// 現在・フェード元のどちらでもない面 (保留の書込み先)
+	YmUInt32 GetSpareBank(void) const	{ return 3 - m_bank - m_prevBank; }
+
+	// 保留中のフィルタへのフェードを始める
+	void StartFade(void)
+	{
+		const YmUInt32 next = GetSpareBank();
+		m_prevBank = m_bank;
+		m_bank = next;
+		m_hasPending = false;
+		for (YmUInt32 s = 0; s < m_numSegments; s++) m_segments[s].fading = true;
+		m_headFading = (m_headLength > 0);
+		m_numFading = m_numSegments + (m_headFading ? 1 : 0);
+	}
+
+	bool PlanSegments(YmUInt32 maxPartitionSize)
+	{
+		const YmUInt32 B = m_blockSize;
+		YmUInt32 offset = m_headLength;
+		YmUInt32 size = B;
+		m_numSegments = 0;
+		while (offset < m_maxLength)
+		{
+			if (m_numSegments >= YM_CONV_MAX_SEGMENTS) return false;
+			// Os >= Bs - B を満たす限り分割長を大きくする
+			while (size*2 <= maxPartitionSize && offset + B >= size*2) size *= 2;
+
+			const YmUInt32 remain = (m_maxLength - offset + size - 1) / size;
+			YmUInt32 count = remain;
+			if (size*2 <= maxPartitionSize && m_numSegments + 1 < YM_CONV_MAX_SEGMENTS)
+			{
+				// 次に大きくできるオフセットまで
+				const YmUInt32 need = size*2 - B - offset;
+				count = YmMinU(remain, (need + size - 1) / size);
+				if (count == 0) count = 1;
+			}
+			Segment& seg = m_segments[m_numSegments++];
+			seg.size = size;
+			seg.offset = offset;
+			seg.count = count;
+			seg.stride = ((size + 1)*2 + 15) & ~15u;
+			offset += count*size;
+		}
+		return true;
+	}
+
+	bool AllocBuffers(void)
+	{
+		const YmUInt32 B = m_blockSize;
+		YmUInt32 maxSize = B, maxEnd = B;
+		for (YmUInt32 s = 0; s < m_numSegments; s++)
+		{
+			Segment& seg = m_segments[s];
+			if (!seg.fft.Init(m_pAllocator, seg.size*2)) return false;
+			seg.pFdl    = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)seg.stride*seg.count);
+			seg.pFilter = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)seg.stride*seg.count*m_numChannels*YM_CONV_NUM_BANKS);
+			seg.pAcc    = alloc_array_nozero<YmReal32>(m_pAllocator, seg.stride);
+			seg.pTime   = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)seg.size*2);
+			seg.pFadeAcc  = alloc_array_nozero<YmReal32>(m_pAllocator, seg.stride);
+			seg.pFadeTime = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)seg.size*2);
+			if (!seg.pFdl || !seg.pFilter || !seg.pAcc || !seg.pTime || !seg.pFadeAcc || !seg.pFadeTime) return false;
+			memset(seg.pFilter, 0, sizeof(YmReal32)*seg.stride*seg.count*m_numChannels*YM_CONV_NUM_BANKS);
+			if (seg.size > maxSize) maxSize = seg.size;
+			if (seg.offset + seg.size > maxEnd) maxEnd = seg.offset + seg.size;
+		}
+
+		YmUInt32 inRing = 1;
+		while (inRing < maxSize*2) inRing <<= 1;
+		YmUInt32 outRing = 1;
+		while (outRing < maxEnd + B) outRing <<= 1;
+		m_inRingMask = inRing - 1;
+		m_outRingMask = outRing - 1;
+		m_pInRing  = alloc_array_nozero<YmReal32>(m_pAllocator, inRing);
+		m_pOutRing = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)outRing*m_numChannels);
+		if (!m_pInRing || !m_pOutRing) return false;
+
+		if (m_headLength > 0)
+		{
+			m_pHeadCoef = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_headLength*m_numChannels*YM_CONV_NUM_BANKS);
+			m_pHeadHist = alloc_array_nozero<YmReal32>(m_pAllocator, (size_t)m_headLength + B);
+			if (!m_pHeadCoef || !m_pHeadHist) return false;
+			memset(m_pHeadCoef, 0, sizeof(YmReal32)*m_headLength*m_numChannels*YM_CONV_NUM_BANKS);
+		}
+		return true;
+	}
+
+	void ProcessSegment(Segment& seg, const YmSimd::Kernels& k)
+	{
+		const YmUInt32 Bs = seg.size;
+		// 直近 2*Bs サンプル
+		const YmUInt64 begin = m_time - 2*(YmUInt64)Bs;
+		for (YmUInt32 n = 0; n < 2*Bs; n++) seg.pTime[n] = m_pInRing[(YmUInt32)((begin + n) & m_inRingMask)];
+
+		seg.fdlPos = (seg.fdlPos + 1) % seg.count;
+		seg.fft.Forward(seg.pTime, seg.pFdl + (size_t)seg.fdlPos*seg.stride);
+
+		// 出力位置: 局所時刻 [t-Bs, t) -> 絶対時刻 [t-Bs+Os, t+Os)
+		const YmUInt64 dst = m_time - Bs + seg.offset;
+		const YmReal32 step = 1.0f / (YmReal32)Bs;
+		for (YmUInt32 ch = 0; ch < m_numChannels; ch++)
+		{
+			Accumulate(seg, k, m_bank, ch, seg.pAcc);
+			seg.fft.Inverse(seg.pAcc, seg.pTime);
+			YmReal32* ring = GetOutRing(ch);
+			if (seg.fading)
+			{
+				// 新旧の出力を区間 Bs で線形クロスフェード
+				Accumulate(seg, k, m_prevBank, ch, seg.pFadeAcc);
+				seg.fft.Inverse(seg.pFadeAcc, seg.pFadeTime);
+				for (YmUInt32 n = 0; n < Bs; n++)
+				{
+					const YmReal32 prev = seg.pFadeTime[Bs + n];
+					ring[(YmUInt32)((dst + n) & m_outRingMask)] += prev + (seg.pTime[Bs + n] - prev)*(YmReal32)(n + 1)*step;
+				}
+				continue;
+			}
+			for (YmUInt32 n = 0; n < Bs; n++)
+			{
+				ring[(YmUInt32)((dst + n) & m_outRingMask)] += seg.pTime[Bs + n];
+			}
+		}
+		if (seg.fading)
+		{
+			seg.fading = false;
+			m_numFading--;
+		}
+	}
+
+	// FDL とフィルタ (bank) の積和
+	void Accumulate(Segment& seg, const YmSimd::Kernels& k, YmUInt32 bank, YmUInt32 ch, YmReal32* acc) const
+	{
+		memset(acc, 0, sizeof(YmReal32)*seg.stride);
+		for (YmUInt32 p = 0; p < seg.count; p++)
+		{
+			const YmUInt32 slot = (seg.fdlPos + seg.count - p) % seg.count;
+			k.ComplexMulAdd(acc, seg.pFdl + (size_t)slot*seg.stride, GetFilterSpec(seg, bank, ch, p), seg.size + 1);
+		}
+	}
+
+	void WriteFilter(YmUInt32 bank, YmUInt32 ch, const YmReal32* ir, YmUInt32 length)
+	{
+		if (length > m_maxLength) length = m_maxLength;
+
+		// ヘッド (逆順係数)
+		YmReal32* coef = GetHeadCoef(bank, ch);
+		for (YmUInt32 k = 0; k < m_headLength; k++)
+		{
+			coef[m_headLength - 1 - k] = (k < length) ? ir[k] : 0.0f;
+		}
+		// 周波数軸セグメント
+		for (YmUInt32 s = 0; s < m_numSegments; s++)
+		{
+			Segment& seg = m_segments[s];
+			for (YmUInt32 p = 0; p < seg.count; p++)
+			{
+				const YmUInt32 start = seg.offset + p*seg.size;
+				memset(seg.pTime, 0, sizeof(YmReal32)*seg.size*2);
+				if (start < length)
+				{
+					const YmUInt32 n = YmMinU(seg.size, length - start);
+					memcpy(seg.pTime, ir + start, sizeof(YmReal32)*n);
+				}
+				seg.fft.Forward(seg.pTime, GetFilterSpec(seg, bank, ch, p));
+			}
+		}
+	}
+
+	YmReal32* GetFilterSpec(Segment& seg, YmUInt32 bank, YmUInt32 ch, YmUInt32 p) const	{ return seg.pFilter + (((size_t)bank*m_numChannels + ch)*seg.count + p)*seg.stride; }
+	YmReal32* GetHeadCoef(YmUInt32 bank, YmUInt32 ch) const								{ return m_pHeadCoef + ((size_t)bank*m_numChannels + ch)*m_headLength; }
+	YmReal32* GetOutRing(YmUInt32 ch) const									{ return m_pOutRing + (size_t)ch*(m_outRingMask + 1); }
+
+	YmMemAlloc*		m_pAllocator;
+	YmUInt32		m_blockSize;
+	YmUInt32		m_maxLength;
+	YmUInt32		m_headLength;
+	YmUInt32		m_numChannels;
+	YmUInt32		m_numSegments;
+	YmUInt64		m_time;						// 処理済みサンプル数
+	YmUInt32		m_bank;						// 現在のフィルタ面
+	YmUInt32		m_prevBank;					// フェード中の旧フィルタの面 (残りの 1 面は保留用)
+	YmUInt32		m_numFading;				// フェードが残っているセグメント (+ヘッド) 数
+	bool			m_headFading;
+	bool			m_hasPending;				// 保留面にフェード待ちのフィルタがある
+	Segment			m_segments[YM_CONV_MAX_SEGMENTS];
+	YmReal32*		m_pHeadCoef;				// [bank(3)][ch][headLength] (逆順)
+	YmReal32*		m_pHeadHist;				// [headLength-1 + blockSize]
+	YmReal32*		m_pInRing;
+	YmUInt32		m_inRingMask;
+	YmReal32*		m_pOutRing;					// [ch][outRing]
+	YmUInt32		m_outRingMask;
+	YmReal32		m_segmentScratch[YM_CONV_SCRATCH];
+	YmReal32		m_fadeScratch[YM_CONV_SCRATCH];
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
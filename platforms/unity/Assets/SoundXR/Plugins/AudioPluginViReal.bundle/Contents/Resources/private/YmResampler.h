@@ -0,0 +1,267 @@
+﻿/*****************************************************************************************//**
+ * @file			YmResampler.h
+ * @brief			有理数比のポリフェーズ・サンプリング周波数変換
+ * @attention		変換比 outRate/inRate を既約分数 L/M にし、L 倍アップサンプル -> ローパス -> 1/M ダウンサンプルを
+ *					ポリフェーズ分解で行う (1 出力あたり 1 相分の積和のみ、Kernels::Dot で SIMD 化)。
+ *					フィルタはカイザー窓付き sinc (阻止域 約 70dB)、遮断は低い方のナイキストの手前。
+ *
+ *					・HRTF はロード時に ResampleIr() で一度だけ変換し、エンジンはホストの
+ *					  UnityAudioEffectState::samplerate のまま動かす (毎ブロックの変換コストも遅延もない)。
+ *					・ストリームの変換 (Process()) は入力ブロック長が可変で、ちょうど GetLatency() = taps/2 - 1
+ *					  入力サンプルの遅延がある (先頭に GetLatency() 個のゼロを足した入力の Resample() と同じ出力)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <math.h>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmSimdDispatch.h"
+
+#define YM_RESAMPLER_TAPS			32		///< 1 相あたりのタップ数 (ストリーム用の既定値, ダウンサンプル時は比に応じて増やす)
+#define YM_RESAMPLER_IR_TAPS		64		///< ResampleIr() / Resample() のタップ数
+#define YM_RESAMPLER_MAX_PHASES		1024	///< L の上限 (係数表 L*taps)
+#define YM_RESAMPLER_ATTENUATION	70.0f	///< 阻止域減衰量 [dB]
+
+class YmResampler
+{
+public:
+	YmResampler() : m_pAllocator(nullptr), m_pCoef(nullptr), m_pHist(nullptr), m_up(1), m_down(1), m_taps(0),
+		m_maxInput(0), m_phase(0), m_pos(0) {}
+	~YmResampler() { Term(); }
+
+	YmResampler(const YmResampler&) = delete;
+	YmResampler& operator=(const YmResampler&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (係数表を作るため非オーディオスレッドで呼ぶこと)
+	 * @param[in]	inRate, outRate		サンプリング周波数 [Hz]
+	 * @param[in]	maxInput			Process() 1 回の入力サンプル数の上限
+	 * @param[in]	taps				1 相あたりのタップ数
+	 * @return		比が既約で L > YM_RESAMPLER_MAX_PHASES になる場合は false
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 inRate, YmUInt32 outRate, YmUInt32 maxInput, YmUInt32 taps = YM_RESAMPLER_TAPS)
+	{
+		Term();
+		if (inRate == 0 || outRate == 0 || taps == 0) return false;
+		const YmUInt32 g = Gcd(inRate, outRate);
+		m_up = outRate / g;
+		m_down = inRate / g;
+		if (m_up > YM_RESAMPLER_MAX_PHASES) return false;
+
+		YmSimd::InitKernels();
+		m_pAllocator = in_pAllocator;
+		m_maxInput = maxInput;
+		if (IsBypass())
+		{
+			m_taps = 0;
+			return true;
+		}
+		// ダウンサンプル時は遮断が下がる分だけ長くして、出力側から見た遷移帯域幅を保つ
+		m_taps = taps*((m_down + m_up - 1)/m_up);
+		m_taps = (m_taps + 3) & ~3u;
+		m_pCoef = alloc_array_nozero<YmReal32>(in_pAllocator, (size_t)m_up*m_taps);
+		m_pHist = alloc_array<YmReal32>(in_pAllocator, (size_t)m_taps - 1 + maxInput);
+		if (!m_pCoef || !m_pHist)
+		{
+			Term();
+			return false;
+		}
+		Design(taps);
+		Reset();
+		return true;
+	}
+
+	void Term(void)
+	{
+		free_memory(m_pAllocator, m_pCoef);
+		free_memory(m_pAllocator, m_pHist);
+		m_pCoef = nullptr;
+		m_pHist = nullptr;
+		m_up = m_down = 1;
+		m_taps = 0;
+	}
+
+	void Reset(void)
+	{
+		if (m_pHist) memset(m_pHist, 0, sizeof(YmReal32)*((size_t)m_taps - 1 + m_maxInput));
+		// 最初の出力を相 L-1 から始め、遅延を入力サンプルの整数倍 (GetLatency()) にそろえる
+		m_phase = m_up - 1;
+		m_pos = (m_taps > 0) ? m_taps - 1 : 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ストリームの変換
+	 * @param[in]	in			入力 [numInput] (numInput <= maxInput)
+	 * @param[out]	out			出力 (GetMaxOutput(numInput) サンプル分の領域)
+	 * @return		出力サンプル数
+	 **************************************************************************/
+	YmUInt32 Process(const YmReal32* in, YmUInt32 numInput, YmReal32* out)
+	{
+		if (numInput > m_maxInput) numInput = m_maxInput;
+		if (IsBypass())
+		{
+			memcpy(out, in, sizeof(YmReal32)*numInput);
+			return numInput;
+		}
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		const YmUInt32 hist = m_taps - 1;
+		memcpy(m_pHist + hist, in, sizeof(YmReal32)*numInput);
+
+		// m_pos: 次の出力の最新入力サンプル (m_pHist 上の位置), m_phase: その相
+		const YmUInt32 end = hist + numInput;
+		YmUInt32 numOut = 0;
+		while (m_pos < end)
+		{
+			out[numOut++] = k.Dot(m_pHist + m_pos - hist, GetPhase(m_phase), m_taps);
+			m_phase += m_down;
+			m_pos += m_phase / m_up;
+			m_phase %= m_up;
+		}
+		m_pos -= numInput;
+		memmove(m_pHist, m_pHist + numInput, sizeof(YmReal32)*hist);
+		return numOut;
+	}
+
+	YmUInt32 GetMaxOutput(YmUInt32 numInput) const	{ return (YmUInt32)(((YmUInt64)numInput*m_up + m_down - 1)/m_down) + 1; }
+	YmUInt32 GetLatency(void) const					{ return (m_taps > 0) ? m_taps/2 - 1 : 0; }	///< 入力サンプル数換算 (端数なし)
+	bool IsBypass(void) const						{ return m_up == m_down; }
+
+	/***********************************************************************//**
+	 * @brief		変換後の長さ
+	 **************************************************************************/
+	static YmUInt32 GetResampledLength(YmUInt32 length, YmUInt32 inRate, YmUInt32 outRate)
+	{
+		if (inRate == 0 || outRate == 0 || inRate == outRate) return length;
+		return (YmUInt32)(((YmUInt64)length*outRate + inRate - 1)/inRate);
+	}
+
+	/***********************************************************************//**
+	 * @brief		バッファ全体の一括変換 (遅延補償あり, 非オーディオスレッド用)
+	 * @param[out]	out		出力 [GetResampledLength(length, inRate, outRate)]
+	 **************************************************************************/
+	static bool Resample(YmMemAlloc* in_pAllocator, const YmReal32* in, YmUInt32 length, YmUInt32 inRate,
+		YmReal32* out, YmUInt32 outRate, YmReal32 gain = 1.0f)
+	{
+		const YmUInt32 outLength = GetResampledLength(length, inRate, outRate);
+		YmResampler r;
+		if (!r.Init(in_pAllocator, inRate, outRate, 0, YM_RESAMPLER_IR_TAPS)) return false;
+		if (r.IsBypass())
+		{
+			for (YmUInt32 n = 0; n < outLength; n++) out[n] = in[n]*gain;
+			return true;
+		}
+		// 前後をゼロで埋めた入力上で、出力 n の中心が入力時刻 n*M/L に来るように読む
+		const YmUInt32 T = r.m_taps;
+		const size_t padded = (size_t)T - 1 + length + T + 1;
+		YmReal32* x = alloc_array<YmReal32>(in_pAllocator, padded);
+		if (x == nullptr) return false;
+		memcpy(x + T - 1, in, sizeof(YmReal32)*length);
+
+		const YmSimd::Kernels& k = YmSimd::GetKernels();
+		const YmUInt64 center = r.GetCenter();
+		for (YmUInt32 n = 0; n < outLength; n++)
+		{
+			const YmUInt64 t = (YmUInt64)n*r.m_down + center;
+			const YmUInt32 i = (YmUInt32)(t / r.m_up);
+			const YmUInt32 p = (YmUInt32)(t % r.m_up);
+			out[n] = k.Dot(x + i, r.GetPhase(p), T)*gain;
+		}
+		free_memory(in_pAllocator, x);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		インパルス応答の変換 (周波数特性の大きさを保つよう inRate/outRate 倍する)
+	 * @param[out]	out		出力 [GetResampledLength(length, inRate, outRate)]
+	 **************************************************************************/
+	static bool ResampleIr(YmMemAlloc* in_pAllocator, const YmReal32* in, YmUInt32 length, YmUInt32 inRate,
+		YmReal32* out, YmUInt32 outRate)
+	{
+		return Resample(in_pAllocator, in, length, inRate, out, outRate, (YmReal32)inRate/(YmReal32)outRate);
+	}
+
+private:
+	static YmUInt32 Gcd(YmUInt32 a, YmUInt32 b)
+	{
+		while (b != 0)
+		{
+			const YmUInt32 t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	// 第 1 種変形ベッセル関数 I0 (級数展開)
+	static YmReal64 BesselI0(YmReal64 x)
+	{
+		YmReal64 sum = 1.0, term = 1.0;
+		const YmReal64 q = 0.25*x*x;
+		for (int k = 1; k < 50; k++)
+		{
+			term *= q/((YmReal64)k*k);
+			sum += term;
+			if (term < sum*1e-12) break;
+		}
+		return sum;
+	}
+
+	// 原型の中心 (L 倍レートの整数サンプル位置)。原型は長さ L*taps - 1 の左右対称 (最後のタップは 0)
+	YmUInt32 GetCenter(void) const				{ return (m_up*m_taps)/2 - 1; }
+
+	// 原型を設計し、相ごとに逆順で格納する
+	void Design(YmUInt32 baseTaps)
+	{
+		const YmReal64 pi = 3.14159265358979323846;
+		const YmReal64 A = YM_RESAMPLER_ATTENUATION;
+		const YmReal64 beta = 0.1102*(A - 8.7);
+		const YmUInt32 N = m_up*m_taps;
+		const YmReal64 c = (YmReal64)GetCenter();
+		// 遷移帯域幅 (低い方のサンプリング周波数に対する比) から遮断を決める
+		const YmReal64 transition = (A - 8.0)/(2.285*2.0*pi)/(YmReal64)baseTaps;
+		const YmReal64 ratio = (m_up < m_down) ? (YmReal64)m_up/(YmReal64)m_down : 1.0;
+		const YmReal64 fc = (0.5 - 0.5*transition)*ratio/(YmReal64)m_up;		// L 倍レートでの正規化周波数
+		const YmReal64 i0beta = BesselI0(beta);
+		for (YmUInt32 n = 0; n < N; n++)
+		{
+			const YmReal64 x = (YmReal64)n - c;
+			const YmReal64 sinc = (x == 0.0) ? 2.0*fc : sin(2.0*pi*fc*x)/(pi*x);
+			const YmReal64 r = x/c;
+			const YmReal64 w = (fabs(r) <= 1.0) ? BesselI0(beta*sqrt(1.0 - r*r))/i0beta : 0.0;
+			// h[n] = 相 n % L の (n / L) 番目のタップ
+			const YmUInt32 p = n % m_up;
+			const YmUInt32 k = n / m_up;
+			GetPhase(p)[m_taps - 1 - k] = (YmReal32)(sinc*w);
+		}
+		// 相ごとに直流利得を 1 にそろえる (L 倍の補償を含む)
+		for (YmUInt32 p = 0; p < m_up; p++)
+		{
+			YmReal32* coef = GetPhase(p);
+			YmReal64 sum = 0.0;
+			for (YmUInt32 k = 0; k < m_taps; k++) sum += coef[k];
+			const YmReal32 scale = (sum != 0.0) ? (YmReal32)(1.0/sum) : 0.0f;
+			for (YmUInt32 k = 0; k < m_taps; k++) coef[k] *= scale;
+		}
+	}
+
+	YmReal32* GetPhase(YmUInt32 phase) const	{ return m_pCoef + (size_t)phase*m_taps; }
+
+	YmMemAlloc*		m_pAllocator;
+	YmReal32*		m_pCoef;		// [L][taps] (相ごとに逆順)
+	YmReal32*		m_pHist;		// [taps-1 + maxInput]
+	YmUInt32		m_up;			// L
+	YmUInt32		m_down;			// M
+	YmUInt32		m_taps;
+	YmUInt32		m_maxInput;
+	YmUInt32		m_phase;
+	YmUInt32		m_pos;
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
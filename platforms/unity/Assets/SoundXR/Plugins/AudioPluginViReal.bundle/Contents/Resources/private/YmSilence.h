@@ -0,0 +1,102 @@
+﻿/*****************************************************************************************//**
+ * @file			YmSilence.h
+ * @brief			無音検出と畳込みテールの省略
+ * @attention		入力ブロックのピークが閾値以下のブロックを無音とみなす。
+ *					無音が畳込みのテール長 (フィルタ長 - 1) 以上続くと出力も無音になるため、
+ *					YmSilenceGate はそれ以降のブロックの処理を省略 (バイパス) させる。
+ *					次に有音のブロックが来たら、状態をリセットしてそのブロックから処理を再開する
+ *					(バイパス中の状態はすべて無音なので、リセットしても出力は変わらない)。
+ *
+ *					既定の閾値 YM_SILENCE_THRESHOLD は 24bit の 1LSB 未満 (-160dB) で、
+ *					デジタル無音のみを対象とする。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <math.h>
+#include "private/YmTypes.h"
+
+#define YM_SILENCE_THRESHOLD		1.0e-8f		///< 無音とみなすピークの既定値 (線形, -160dB)
+
+namespace YmSilence
+{
+
+/***********************************************************************//**
+ * @brief		ブロックが無音か (ピークが threshold 以下か)
+ * @note		有音の信号は先頭付近で打ち切られるため、通常のブロックではほぼコストがかからない。
+ **************************************************************************/
+inline bool IsSilent(const YmReal32* in, YmUInt32 n, YmReal32 threshold = YM_SILENCE_THRESHOLD)
+{
+	for (YmUInt32 i = 0; i < n; i++)
+	{
+		if (fabsf(in[i]) > threshold) return false;
+	}
+	return true;
+}
+
+} // namespace YmSilence
+
+/***********************************************************************//**
+ * @brief			ボイスごとの無音の継続の追跡
+ * @note			1 ブロックに 1 回、処理の前に Update() を呼び、true ならそのブロックの処理を省略して
+ *					無音を出力する。IsResuming() のブロックは状態をリセットしてから処理する。
+ **************************************************************************/
+class YmSilenceGate
+{
+public:
+	explicit YmSilenceGate(YmUInt32 tailLength = 0, YmReal32 threshold = YM_SILENCE_THRESHOLD)
+		: m_tailLength(tailLength), m_threshold(threshold), m_silentSamples(0), m_isBypassed(false), m_isResuming(false) {}
+
+	/// 最後の有音サンプルが出力に影響するサンプル数 (FIR ならフィルタ長 - 1)
+	void SetTailLength(YmUInt32 tailLength)		{ m_tailLength = tailLength; }
+	/// 無音とみなすピーク (負の値でバイパスしない)
+	void SetThreshold(YmReal32 threshold)		{ m_threshold = threshold; }
+
+	void Reset(void)
+	{
+		m_silentSamples = 0;
+		m_isBypassed = false;
+		m_isResuming = false;
+	}
+
+	/***********************************************************************//**
+	 * @brief		入力ブロックの判定
+	 * @param[in]	in		入力 [n]
+	 * @return		true: このブロックは処理せず無音を出力してよい
+	 **************************************************************************/
+	bool Update(const YmReal32* in, YmUInt32 n)
+	{
+		m_isResuming = false;
+		if (m_threshold < 0.0f) return false;
+		if (!YmSilence::IsSilent(in, n, m_threshold))
+		{
+			m_isResuming = m_isBypassed;
+			m_isBypassed = false;
+			m_silentSamples = 0;
+			return false;
+		}
+		// このブロックを含めて tailLength + n サンプル無音ならこのブロックの出力は無音
+		const YmUInt32 limit = m_tailLength + n;
+		m_silentSamples = (m_silentSamples < limit - n) ? m_silentSamples + n : limit;
+		m_isBypassed = (m_silentSamples >= limit);
+		return m_isBypassed;
+	}
+
+	/// バイパスから戻ったブロックか (状態をリセットしてから処理する)
+	bool IsResuming(void) const		{ return m_isResuming; }
+	bool IsBypassed(void) const		{ return m_isBypassed; }
+
+private:
+	YmUInt32	m_tailLength;
+	YmReal32	m_threshold;
+	YmUInt32	m_silentSamples;	// 直近の連続した無音サンプル数 (tailLength + n で飽和)
+	bool		m_isBypassed;
+	bool		m_isResuming;
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
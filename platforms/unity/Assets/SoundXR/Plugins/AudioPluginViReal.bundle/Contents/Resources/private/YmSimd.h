@@ -1,154 +1,309 @@
-﻿/*****************************************************************************************//**
- * @file			YmSimd.h
- * @brief
- * @attention
- *
- *                 (C) 2018 Yamaha Corporation
- *                  Confidential
- ********************************************************************************************/
-
-#pragma once
-
-#include <string.h>
-#include <stdlib.h>
-#include <stdint.h>
-#include <wchar.h>
-#include <math.h>
-#include "private/YmTypes.h"
-
-#if defined(YM_TARGET_WWISE)
-	#include <AK/SoundEngine/Common/AkSimd.h>
-#endif
-#if defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
-#include <arm_neon.h>
-#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
-	#include <pmmintrin.h>
-#endif
-#define NUM_SIMD				4				///< SIMD命令で並列実行される数
-
-//--- SIMD DATA TYPE
-#if defined(YM_TARGET_WWISE)
-	typedef AKSIMD_V4F32		YmV4F32;		///< Vector of 4 32-bit floats
-	typedef AKSIMD_V4I32		YmV4I32;		///< Vector of 4 32-bit signed integers
-#elif defined(__ORBIS__)
-	typedef __m128				YmV4F32;		///< Vector of 4 32-bit floats
-	typedef __m128i				YmV4I32;		///< Vector of 4 32-bit signed integers
-#elif defined(NN_NINTENDO_SDK)
-	typedef float32x4_t			YmV4F32;		///< Vector of 4 32-bit floats
-	typedef int32x4_t			YmV4I32;		///< Vector of 4 32-bit signed integers
-#elif defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
-	typedef float32x4_t			YmV4F32;		///< Vector of 4 32-bit floats
-	typedef int32x4_t			YmV4I32;		///< Vector of 4 32-bit signed integers
-#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
-	typedef __m128				YmV4F32;		///< Vector of 4 32-bit floats
-	typedef __m128i				YmV4I32;		///< Vector of 4 32-bit signed integers
-#endif
-
-//--- INTRINSIC
-#if defined(YM_TARGET_WWISE)
-	#define YMSIMD_ADD_V4F32( a, b )					AKSIMD_ADD_V4F32( a, b )
-	#define YMSIMD_MUL_SS_V4F32( a, b )					AKSIMD_MUL_SS_V4F32( a, b )
-	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		AKSIMD_STORE_V4F32( __addr__, __vec__ )
-	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	AKSIMD_STOREU_V4F32( __addr__, __vec__ )
-	#define YMSIMD_SET_V4F32( __scalar__ )				AKSIMD_SET_V4F32( __scalar__ )
-	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	AKSIMD_MADD_V4F32( __a__, __b__, __c__ )
-	#define YMSIMD_MUL_V4F32( a, b )					AKSIMD_MUL_V4F32( a, b )
-	#define YMSIMD_LOAD_V4F32( __addr__ )				AKSIMD_LOAD_V4F32( __addr__ )
-	#define YMSIMD_LOADU_V4F32( __addr__ )				AKSIMD_LOADU_V4F32( __addr__ )
-	#define YMSIMD_LOAD1_V4F32( __scalar__ )			AKSIMD_LOAD1_V4F32( __scalar__ )
-	#define YMSIMD_COMPLEXMUL( a, b )					AKSIMD_COMPLEXMUL( a, b )
-	#define YMSIMD_SET1_EPI32_V4I32( a )				AKSIMD_SET_V4I32( a )
-	#if !defined(NN_NINTENDO_SDK)
-		#define YMSIMD_SET_EPI32_V4I32( a, b, c, d )	AKSIMD_SETV_V4I32( a, b, c, d )
-	#endif
-#elif defined(_M_ARM)||defined(_M_ARM64)||(__ARM_NEON)
-	#define YMSIMD_ADD_V4F32( a, b )					(vaddq_f32( ( a ), ( b ) ))
-	#define YMSIMD_MUL_SS_V4F32( a, b )					(vmulq_f32( a, b ))
-	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		(vst1q_f32( (YmReal32*)(__addr__), (__vec__) ))
-	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	(vst1q_f32( (YmReal32*)(__addr__), (__vec__) ))
-	#define YMSIMD_SET_V4F32( __scalar__ )				(vdupq_n_f32( (__scalar__) ))
-	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	(vmlaq_f32( (__c__), (__a__), (__b__)  ))
-	#define YMSIMD_MUL_V4F32( __a__, __b__ )			(vmulq_f32( ( __a__ ), ( __b__ ) ))
-	#define YMSIMD_LOAD_V4F32( __addr__ )				(vld1q_f32(__addr__))
-	#define YMSIMD_LOADU_V4F32( __addr__ )				(vld1q_f32( (YmReal32*)(__addr__) ))
-	#define YMSIMD_LOAD1_V4F32( __scalar__ )			(vld1q_dup_f32( &(__scalar__) ))
-	#define YMSIMD_SET1_EPI32_V4I32( a )				(vdupq_n_s32( a ))
-	#define YMSIMD_SET_EPI32_V4I32(a, b, c, d)			__extension__ ({ \
-		int32_t __attribute__((aligned(16))) data[4] = { (d), (c), (b), (a) }; \
-		int32x4_t __ret; \
-		__ret = (int32x4_t) (vld1q_s32(data)); \
-		__ret; \
-	})
-	static inline YmV4F32 YMSIMD_COMPLEXMUL(const YmV4F32 vCIn1, const YmV4F32 vCIn2)
-	{
-		constexpr YmV4F32 vSign = { 1.f, -1.f, 1.f, -1.f };
-		// SHUFFLE(2, 2, 0, 0)_V4F32
-		float32x2_t xx = vdup_lane_f32(vget_low_f32(vCIn1), 0);
-		float32x2_t cc = vdup_lane_f32(vget_high_f32(vCIn1), 0);
-		YmV4F32 v1 = vcombine_f32(xx, cc);
-
-		// SHUFFLE(3, 3, 1, 1)_V4F32
-		float32x2_t yy = vdup_lane_f32(vget_low_f32(vCIn1), 1);
-		float32x2_t dd = vdup_lane_f32(vget_high_f32(vCIn1), 1);
-		YmV4F32 v2 = vcombine_f32(yy, dd);
-
-		v2 = YMSIMD_MUL_V4F32(v2, vSign);
-		v2 = YMSIMD_MUL_V4F32(v2, vCIn2);
-		v2 = vrev64q_f32(v2);
-		return YMSIMD_ADD_V4F32(v2, YMSIMD_MUL_V4F32(v1, vCIn2));
-	}
-#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
-	#define YMSIMD_ADD_V4F32( a, b )					_mm_add_ps( a, b )
-	#define YMSIMD_MUL_SS_V4F32( a, b )					_mm_mul_ss( a, b )
-	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		_mm_store_ps( (YmReal32*)(__addr__), (__vec__) )
-	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	_mm_storeu_ps( (YmReal32*)(__addr__), (__vec__) )
-	#define YMSIMD_SET_V4F32( __scalar__ )				_mm_set_ps1( (__scalar__) )
-	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	_mm_add_ps( _mm_mul_ps( (__a__), (__b__) ), (__c__) )
-	#define YMSIMD_MUL_V4F32( a, b )					_mm_mul_ps( a, b )
-	#define YMSIMD_LOAD_V4F32( __addr__ )				_mm_load_ps( (YmReal32*)(__addr__) )
-	#define YMSIMD_LOADU_V4F32( __addr__ )				_mm_loadu_ps( (YmReal32*)(__addr__) )
-	#define YMSIMD_LOAD1_V4F32( __scalar__ )			_mm_load1_ps( &(__scalar__) )
-	#define YMSIMD_SET1_EPI32_V4I32( a )				_mm_set1_epi32( a )
-	#define YMSIMD_SET_EPI32_V4I32( a, b, c, d )		_mm_set_epi32( a, b, c, d )
-	static inline YmV4F32 YMSIMD_COMPLEXMUL(const YmV4F32 vCIn1, const YmV4F32 vCIn2)
-	{
-		YmV4F32 t1, t2, t3;
-		t1 = vCIn1;
-		t2 = vCIn2;
-		t3 = _mm_moveldup_ps(t2);
-		t3 = _mm_mul_ps(t1, t3);
-		t2 = _mm_movehdup_ps(t2);
-		t1 = _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(2, 3, 0, 1));
-		t2 = _mm_mul_ps(t1, t2);
-		return _mm_addsub_ps(t3, t2);
-	}
-#endif
-
-//--- INTRINSIC (not supported by Wwise)
-#if defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
-	#define YMSIMD_XOR_V4I32( a, b )					(veorq_s32( ( a ), ( b ) ))
-#else
-	#define YMSIMD_XOR_V4I32( a, b )					_mm_xor_si128( a, b )
-#endif
-
-#if defined(YM_TARGET_WWISE) && defined(NN_NINTENDO_SDK)
-	#define YMSIMD_SET_EPI32_V4I32(a, b, c, d)			__extension__ ({ \
-		int32_t __attribute__((aligned(16))) data[4] = { (d), (c), (b), (a) }; \
-		int32x4_t __ret; \
-		__ret = (int32x4_t) (vld1q_s32(data)); \
-		__ret; \
-	})
-#endif
-
-//--- MACRO
-#if defined(YM_TARGET_WWISE)
-	#define YM_ALIGN_SIMD( __Declaration__ )			AK_ALIGN_SIMD(__Declaration__)
-#elif defined (_WIN32)||defined(_WIN64)
-	#define YM_ALIGN_SIMD( __Declaration__ )			__declspec(align(16)) __Declaration__ ///< Platform-specific alignment requirement for SIMD data
-#else
-	#define YM_ALIGN_SIMD( __Declaration__ )			__attribute__ ((aligned (16))) __Declaration__ ///< Platform-specific alignment requirement for SIMD data
-#endif
-
-/*********************************************************************************************
-* EOF
-*********************************************************************************************/
+﻿/*****************************************************************************************//**
+ * @file			YmSimd.h
+ * @brief
+ * @attention
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <math.h>
+#include "private/YmTypes.h"
+#include "private/YmCpu.h"
+
+#if defined(YM_TARGET_WWISE)
+	#include <AK/SoundEngine/Common/AkSimd.h>
+#endif
+#if defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
+	#include <pmmintrin.h>
+#endif
+#if YM_CPU_X86
+	#include <immintrin.h>							// AVX2/FMA/AVX-512 (関数単位で target 指定して使用)
+#endif
+#define NUM_SIMD				4				///< SIMD命令で並列実行される数
+
+//--- SIMD DATA TYPE
+#if defined(YM_TARGET_WWISE)
+	typedef AKSIMD_V4F32		YmV4F32;		///< Vector of 4 32-bit floats
+	typedef AKSIMD_V4I32		YmV4I32;		///< Vector of 4 32-bit signed integers
+#elif defined(__ORBIS__)
+	typedef __m128				YmV4F32;		///< Vector of 4 32-bit floats
+	typedef __m128i				YmV4I32;		///< Vector of 4 32-bit signed integers
+#elif defined(NN_NINTENDO_SDK)
+	typedef float32x4_t			YmV4F32;		///< Vector of 4 32-bit floats
+	typedef int32x4_t			YmV4I32;		///< Vector of 4 32-bit signed integers
+#elif defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
+	typedef float32x4_t			YmV4F32;		///< Vector of 4 32-bit floats
+	typedef int32x4_t			YmV4I32;		///< Vector of 4 32-bit signed integers
+#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
+	typedef __m128				YmV4F32;		///< Vector of 4 32-bit floats
+	typedef __m128i				YmV4I32;		///< Vector of 4 32-bit signed integers
+#endif
+
+//--- INTRINSIC
+#if defined(YM_TARGET_WWISE)
+	#define YMSIMD_ADD_V4F32( a, b )					AKSIMD_ADD_V4F32( a, b )
+	#define YMSIMD_MUL_SS_V4F32( a, b )					AKSIMD_MUL_SS_V4F32( a, b )
+	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		AKSIMD_STORE_V4F32( __addr__, __vec__ )
+	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	AKSIMD_STOREU_V4F32( __addr__, __vec__ )
+	#define YMSIMD_SET_V4F32( __scalar__ )				AKSIMD_SET_V4F32( __scalar__ )
+	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	AKSIMD_MADD_V4F32( __a__, __b__, __c__ )
+	#define YMSIMD_MUL_V4F32( a, b )					AKSIMD_MUL_V4F32( a, b )
+	#define YMSIMD_LOAD_V4F32( __addr__ )				AKSIMD_LOAD_V4F32( __addr__ )
+	#define YMSIMD_LOADU_V4F32( __addr__ )				AKSIMD_LOADU_V4F32( __addr__ )
+	#define YMSIMD_LOAD1_V4F32( __scalar__ )			AKSIMD_LOAD1_V4F32( __scalar__ )
+	#define YMSIMD_COMPLEXMUL( a, b )					AKSIMD_COMPLEXMUL( a, b )
+	#define YMSIMD_SET1_EPI32_V4I32( a )				AKSIMD_SET_V4I32( a )
+	#if !defined(NN_NINTENDO_SDK)
+		#define YMSIMD_SET_EPI32_V4I32( a, b, c, d )	AKSIMD_SETV_V4I32( a, b, c, d )
+	#endif
+#elif defined(_M_ARM)||defined(_M_ARM64)||(__ARM_NEON)
+	#define YMSIMD_ADD_V4F32( a, b )					(vaddq_f32( ( a ), ( b ) ))
+	#define YMSIMD_MUL_SS_V4F32( a, b )					(vmulq_f32( a, b ))
+	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		(vst1q_f32( (YmReal32*)(__addr__), (__vec__) ))
+	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	(vst1q_f32( (YmReal32*)(__addr__), (__vec__) ))
+	#define YMSIMD_SET_V4F32( __scalar__ )				(vdupq_n_f32( (__scalar__) ))
+	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	(vmlaq_f32( (__c__), (__a__), (__b__)  ))
+	#define YMSIMD_MUL_V4F32( __a__, __b__ )			(vmulq_f32( ( __a__ ), ( __b__ ) ))
+	#define YMSIMD_LOAD_V4F32( __addr__ )				(vld1q_f32(__addr__))
+	#define YMSIMD_LOADU_V4F32( __addr__ )				(vld1q_f32( (YmReal32*)(__addr__) ))
+	#define YMSIMD_LOAD1_V4F32( __scalar__ )			(vld1q_dup_f32( &(__scalar__) ))
+	#define YMSIMD_SET1_EPI32_V4I32( a )				(vdupq_n_s32( a ))
+	#define YMSIMD_SET_EPI32_V4I32(a, b, c, d)			__extension__ ({ \
+		int32_t __attribute__((aligned(16))) data[4] = { (d), (c), (b), (a) }; \
+		int32x4_t __ret; \
+		__ret = (int32x4_t) (vld1q_s32(data)); \
+		__ret; \
+	})
+	static inline YmV4F32 YMSIMD_COMPLEXMUL(const YmV4F32 vCIn1, const YmV4F32 vCIn2)
+	{
+		constexpr YmV4F32 vSign = { 1.f, -1.f, 1.f, -1.f };
+		// SHUFFLE(2, 2, 0, 0)_V4F32
+		float32x2_t xx = vdup_lane_f32(vget_low_f32(vCIn1), 0);
+		float32x2_t cc = vdup_lane_f32(vget_high_f32(vCIn1), 0);
+		YmV4F32 v1 = vcombine_f32(xx, cc);
+
+		// SHUFFLE(3, 3, 1, 1)_V4F32
+		float32x2_t yy = vdup_lane_f32(vget_low_f32(vCIn1), 1);
+		float32x2_t dd = vdup_lane_f32(vget_high_f32(vCIn1), 1);
+		YmV4F32 v2 = vcombine_f32(yy, dd);
+
+		v2 = YMSIMD_MUL_V4F32(v2, vSign);
+		v2 = YMSIMD_MUL_V4F32(v2, vCIn2);
+		v2 = vrev64q_f32(v2);
+		return YMSIMD_ADD_V4F32(v2, YMSIMD_MUL_V4F32(v1, vCIn2));
+	}
+#elif defined(_WIN32)||defined(_WIN64)||defined(__linux__)||defined(_MAC)
+	#define YMSIMD_ADD_V4F32( a, b )					_mm_add_ps( a, b )
+	#define YMSIMD_MUL_SS_V4F32( a, b )					_mm_mul_ss( a, b )
+	#define YMSIMD_STORE_V4F32( __addr__, __vec__ )		_mm_store_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_STOREU_V4F32( __addr__, __vec__ )	_mm_storeu_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_SET_V4F32( __scalar__ )				_mm_set_ps1( (__scalar__) )
+	#if defined(__FMA__)
+	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	_mm_fmadd_ps( (__a__), (__b__), (__c__) )
+	#else
+	#define YMSIMD_MADD_V4F32( __a__, __b__, __c__ )	_mm_add_ps( _mm_mul_ps( (__a__), (__b__) ), (__c__) )
+	#endif
+	#define YMSIMD_MUL_V4F32( a, b )					_mm_mul_ps( a, b )
+	#define YMSIMD_LOAD_V4F32( __addr__ )				_mm_load_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOADU_V4F32( __addr__ )				_mm_loadu_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOAD1_V4F32( __scalar__ )			_mm_load1_ps( &(__scalar__) )
+	#define YMSIMD_SET1_EPI32_V4I32( a )				_mm_set1_epi32( a )
+	#define YMSIMD_SET_EPI32_V4I32( a, b, c, d )		_mm_set_epi32( a, b, c, d )
+	static inline YmV4F32 YMSIMD_COMPLEXMUL(const YmV4F32 vCIn1, const YmV4F32 vCIn2)
+	{
+		YmV4F32 t1, t2, t3;
+		t1 = vCIn1;
+		t2 = vCIn2;
+		t3 = _mm_moveldup_ps(t2);
+	#if defined(__FMA__)
+		t2 = _mm_movehdup_ps(t2);
+		t2 = _mm_mul_ps(_mm_shuffle_ps(t1, t1, _MM_SHUFFLE(2, 3, 0, 1)), t2);
+		return _mm_fmaddsub_ps(t1, t3, t2);
+	#else
+		t3 = _mm_mul_ps(t1, t3);
+		t2 = _mm_movehdup_ps(t2);
+		t1 = _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(2, 3, 0, 1));
+		t2 = _mm_mul_ps(t1, t2);
+		return _mm_addsub_ps(t3, t2);
+	#endif
+	}
+#endif
+
+//--- INTRINSIC (not supported by Wwise)
+#if defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
+	#define YMSIMD_XOR_V4I32( a, b )					(veorq_s32( ( a ), ( b ) ))
+#else
+	#define YMSIMD_XOR_V4I32( a, b )					_mm_xor_si128( a, b )
+#endif
+
+// 比較結果は全ビット 1/0 のマスク (YmV4F32 として扱う)。YMSIMD_SELECT_V4F32 で使う。
+#if defined(_M_ARM)||defined(_M_ARM64)||defined(__ARM_NEON)
+	#define YMSIMD_SUB_V4F32( a, b )					(vsubq_f32( ( a ), ( b ) ))
+	#define YMSIMD_MIN_V4F32( a, b )					(vminq_f32( ( a ), ( b ) ))
+	#define YMSIMD_MAX_V4F32( a, b )					(vmaxq_f32( ( a ), ( b ) ))
+	#define YMSIMD_ABS_V4F32( a )						(vabsq_f32( a ))
+	#define YMSIMD_CMPLT_V4F32( a, b )					(vreinterpretq_f32_u32(vcltq_f32( ( a ), ( b ) )))
+	#define YMSIMD_CMPLE_V4F32( a, b )					(vreinterpretq_f32_u32(vcleq_f32( ( a ), ( b ) )))
+	#define YMSIMD_AND_V4F32( a, b )					(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))))
+	#define YMSIMD_OR_V4F32( a, b )						(vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))))
+	#define YMSIMD_XOR_V4F32( a, b )					(vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))))
+	#define YMSIMD_SELECT_V4F32( mask, a, b )			(vbslq_f32(vreinterpretq_u32_f32(mask), ( a ), ( b )))	// mask ? a : b
+	#define YMSIMD_AND_V4I32( a, b )					(vandq_s32( ( a ), ( b ) ))
+	#define YMSIMD_ADD_V4I32( a, b )					(vaddq_s32( ( a ), ( b ) ))
+	#define YMSIMD_SLLI_V4I32( a, n )					(vshlq_n_s32( ( a ), ( n ) ))
+	#define YMSIMD_SRLI_V4I32( a, n )					(vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32( a ), ( n ))))
+	#define YMSIMD_CMPEQ_V4I32( a, b )					(vreinterpretq_s32_u32(vceqq_s32( ( a ), ( b ) )))
+	#define YMSIMD_CAST_V4I32_V4F32( a )				(vreinterpretq_f32_s32( a ))
+	#define YMSIMD_CAST_V4F32_V4I32( a )				(vreinterpretq_s32_f32( a ))
+	#define YMSIMD_CVTF_V4I32( a )						(vcvtq_f32_s32( a ))
+	#if defined(_M_ARM64)||defined(__aarch64__)
+		#define YMSIMD_DIV_V4F32( a, b )				(vdivq_f32( ( a ), ( b ) ))
+		#define YMSIMD_SQRT_V4F32( a )					(vsqrtq_f32( a ))
+		#define YMSIMD_CVTN_V4F32( a )					(vcvtnq_s32_f32( a ))		// 最近接丸め
+	#else
+		static inline YmV4F32 YMSIMD_DIV_V4F32(const YmV4F32 a, const YmV4F32 b)
+		{
+			YmV4F32 r = vrecpeq_f32(b);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			return vmulq_f32(a, r);
+		}
+		static inline YmV4F32 YMSIMD_SQRT_V4F32(const YmV4F32 a)
+		{
+			YmV4F32 r = vrsqrteq_f32(a);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+			const uint32x4_t zero = vceqq_f32(a, vdupq_n_f32(0.0f));
+			return vbslq_f32(zero, a, vmulq_f32(a, r));
+		}
+		static inline YmV4I32 YMSIMD_CVTN_V4F32(const YmV4F32 a)
+		{
+			const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(a), vdupq_n_u32(0x80000000u));
+			const YmV4F32 half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+			return vcvtq_s32_f32(vaddq_f32(a, half));
+		}
+	#endif
+#else
+	#define YMSIMD_SUB_V4F32( a, b )					_mm_sub_ps( a, b )
+	#define YMSIMD_DIV_V4F32( a, b )					_mm_div_ps( a, b )
+	#define YMSIMD_MIN_V4F32( a, b )					_mm_min_ps( a, b )
+	#define YMSIMD_MAX_V4F32( a, b )					_mm_max_ps( a, b )
+	#define YMSIMD_ABS_V4F32( a )						_mm_andnot_ps( _mm_set1_ps(-0.0f), ( a ) )
+	#define YMSIMD_SQRT_V4F32( a )						_mm_sqrt_ps( a )
+	#define YMSIMD_CMPLT_V4F32( a, b )					_mm_cmplt_ps( a, b )
+	#define YMSIMD_CMPLE_V4F32( a, b )					_mm_cmple_ps( a, b )
+	#define YMSIMD_AND_V4F32( a, b )					_mm_and_ps( a, b )
+	#define YMSIMD_OR_V4F32( a, b )						_mm_or_ps( a, b )
+	#define YMSIMD_XOR_V4F32( a, b )					_mm_xor_ps( a, b )
+	#define YMSIMD_SELECT_V4F32( mask, a, b )			_mm_or_ps( _mm_and_ps( ( mask ), ( a ) ), _mm_andnot_ps( ( mask ), ( b ) ) )	// mask ? a : b
+	#define YMSIMD_AND_V4I32( a, b )					_mm_and_si128( a, b )
+	#define YMSIMD_ADD_V4I32( a, b )					_mm_add_epi32( a, b )
+	#define YMSIMD_SLLI_V4I32( a, n )					_mm_slli_epi32( a, n )
+	#define YMSIMD_SRLI_V4I32( a, n )					_mm_srli_epi32( a, n )
+	#define YMSIMD_CMPEQ_V4I32( a, b )					_mm_cmpeq_epi32( a, b )
+	#define YMSIMD_CAST_V4I32_V4F32( a )				_mm_castsi128_ps( a )
+	#define YMSIMD_CAST_V4F32_V4I32( a )				_mm_castps_si128( a )
+	#define YMSIMD_CVTF_V4I32( a )						_mm_cvtepi32_ps( a )
+	#define YMSIMD_CVTN_V4F32( a )						_mm_cvtps_epi32( a )		// 最近接丸め (MXCSR 既定)
+#endif
+
+#if defined(YM_TARGET_WWISE) && defined(NN_NINTENDO_SDK)
+	#define YMSIMD_SET_EPI32_V4I32(a, b, c, d)			__extension__ ({ \
+		int32_t __attribute__((aligned(16))) data[4] = { (d), (c), (b), (a) }; \
+		int32x4_t __ret; \
+		__ret = (int32x4_t) (vld1q_s32(data)); \
+		__ret; \
+	})
+#endif
+
+//--- WIDE SIMD (x86 only: AVX2+FMA 8-lane / AVX-512 16-lane)
+// 使用する関数には YM_TARGET_AVX2 / YM_TARGET_AVX512 を付け、呼び出し前に
+// YmCpu::HasFeatures() で実行時判定すること (ビルド全体に -mavx2 等は付けない)。
+#if YM_CPU_X86
+	#define YM_USE_SIMD_WIDE			1
+	#define NUM_SIMD_V8				8				///< AVX2 で並列実行される数
+	#define NUM_SIMD_V16			16				///< AVX-512 で並列実行される数
+
+	#if defined(__GNUC__)||defined(__clang__)
+		#define YM_TARGET_AVX2			__attribute__((target("avx2,fma")))
+		#define YM_TARGET_AVX512		__attribute__((target("avx512f,avx2,fma")))
+	#else
+		#define YM_TARGET_AVX2
+		#define YM_TARGET_AVX512
+	#endif
+
+	typedef __m256				YmV8F32;		///< Vector of 8 32-bit floats
+	typedef __m512				YmV16F32;		///< Vector of 16 32-bit floats
+
+	#define YMSIMD_ADD_V8F32( a, b )					_mm256_add_ps( a, b )
+	#define YMSIMD_SUB_V8F32( a, b )					_mm256_sub_ps( a, b )
+	#define YMSIMD_MUL_V8F32( a, b )					_mm256_mul_ps( a, b )
+	#define YMSIMD_MADD_V8F32( __a__, __b__, __c__ )	_mm256_fmadd_ps( (__a__), (__b__), (__c__) )
+	#define YMSIMD_STORE_V8F32( __addr__, __vec__ )		_mm256_store_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_STOREU_V8F32( __addr__, __vec__ )	_mm256_storeu_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_SET_V8F32( __scalar__ )				_mm256_set1_ps( (__scalar__) )
+	#define YMSIMD_SETZERO_V8F32()						_mm256_setzero_ps()
+	#define YMSIMD_LOAD_V8F32( __addr__ )				_mm256_load_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOADU_V8F32( __addr__ )				_mm256_loadu_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOAD1_V8F32( __scalar__ )			_mm256_broadcast_ss( &(__scalar__) )
+
+	#define YMSIMD_ADD_V16F32( a, b )					_mm512_add_ps( a, b )
+	#define YMSIMD_SUB_V16F32( a, b )					_mm512_sub_ps( a, b )
+	#define YMSIMD_MUL_V16F32( a, b )					_mm512_mul_ps( a, b )
+	#define YMSIMD_MADD_V16F32( __a__, __b__, __c__ )	_mm512_fmadd_ps( (__a__), (__b__), (__c__) )
+	#define YMSIMD_STORE_V16F32( __addr__, __vec__ )	_mm512_store_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_STOREU_V16F32( __addr__, __vec__ )	_mm512_storeu_ps( (YmReal32*)(__addr__), (__vec__) )
+	#define YMSIMD_SET_V16F32( __scalar__ )				_mm512_set1_ps( (__scalar__) )
+	#define YMSIMD_SETZERO_V16F32()						_mm512_setzero_ps()
+	#define YMSIMD_LOAD_V16F32( __addr__ )				_mm512_load_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOADU_V16F32( __addr__ )				_mm512_loadu_ps( (YmReal32*)(__addr__) )
+	#define YMSIMD_LOAD1_V16F32( __scalar__ )			_mm512_set1_ps( (__scalar__) )
+
+	// 複素数 (re,im) x 4 組の乗算
+	static inline YM_TARGET_AVX2 YmV8F32 YMSIMD_COMPLEXMUL_V8F32(const YmV8F32 vCIn1, const YmV8F32 vCIn2)
+	{
+		const YmV8F32 re = _mm256_moveldup_ps(vCIn2);
+		const YmV8F32 im = _mm256_movehdup_ps(vCIn2);
+		const YmV8F32 sw = _mm256_permute_ps(vCIn1, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm256_fmaddsub_ps(vCIn1, re, _mm256_mul_ps(sw, im));
+	}
+
+	// 複素数 (re,im) x 8 組の乗算
+	static inline YM_TARGET_AVX512 YmV16F32 YMSIMD_COMPLEXMUL_V16F32(const YmV16F32 vCIn1, const YmV16F32 vCIn2)
+	{
+		const YmV16F32 re = _mm512_shuffle_ps(vCIn2, vCIn2, _MM_SHUFFLE(2, 2, 0, 0));
+		const YmV16F32 im = _mm512_shuffle_ps(vCIn2, vCIn2, _MM_SHUFFLE(3, 3, 1, 1));
+		const YmV16F32 sw = _mm512_shuffle_ps(vCIn1, vCIn1, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm512_fmaddsub_ps(vCIn1, re, _mm512_mul_ps(sw, im));
+	}
+#else
+	#define YM_USE_SIMD_WIDE			0
+#endif
+
+//--- MACRO
+#if defined(YM_TARGET_WWISE)
+	#define YM_ALIGN_SIMD( __Declaration__ )			AK_ALIGN_SIMD(__Declaration__)
+#elif defined (_WIN32)||defined(_WIN64)
+	#define YM_ALIGN_SIMD( __Declaration__ )			__declspec(align(16)) __Declaration__ ///< Platform-specific alignment requirement for SIMD data
+#else
+	#define YM_ALIGN_SIMD( __Declaration__ )			__attribute__ ((aligned (16))) __Declaration__ ///< Platform-specific alignment requirement for SIMD data
+#endif
+
+#if defined (_WIN32)||defined(_WIN64)
+	#define YM_ALIGN_SIMD_WIDE( __Declaration__ )		__declspec(align(64)) __Declaration__ ///< Alignment for AVX2/AVX-512 data
+#else
+	#define YM_ALIGN_SIMD_WIDE( __Declaration__ )		__attribute__ ((aligned (64))) __Declaration__ ///< Alignment for AVX2/AVX-512 data
+#endif
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,572 @@
+﻿/*****************************************************************************************//**
+ * @file			YmSimdDispatch.h
+ * @brief			SIMD カーネルの実行時選択 (SSE3 / AVX2 / AVX-512 / NEON)
+ * @attention		テーブルは初回の GetKernels() で一度だけ構築される。
+ *					オーディオスレッドでの初回構築を避けるため、プラグインロード時に
+ *					InitKernels() を呼ぶこと。
+ *
+ *					SSE4.1 の段は設けない (これらのカーネルで SSE3 より有効な命令がないため、
+ *					SSE4.1 対応 CPU でも SSE3 段として選択・表示する)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTypes.h"
+#include "private/YmCpu.h"
+#include "private/YmSimd.h"
+
+namespace YmSimd {
+
+/***********************************************************************//**
+ * @brief			SIMD 実装の段階
+ **************************************************************************/
+enum Tier
+{
+	TIER_SCALAR = 0,
+	TIER_NEON,
+	TIER_SSE3,
+	TIER_AVX2,
+	TIER_AVX512,
+	TIER_NUM
+};
+
+/***********************************************************************//**
+ * @brief			カーネルテーブル
+ * @note			複素数は (re,im) のインターリーブ配置。アライメントは不要。
+ **************************************************************************/
+struct Kernels
+{
+	Tier tier;
+
+	// dst[i] = a[i] * b[i]  (numComplex 組)
+	void (*ComplexMul)(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex);
+	// dst[i] += a[i] * b[i]  (周波数軸畳込の積和)
+	void (*ComplexMulAdd)(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex);
+	// 基数 2 FFT の 1 段。data を 2*half 組ごとに区切り、各区間の前半 a[j] と後半 b[j] を
+	// t = b[j]*twiddle[j] として (a[j] + t, a[j] - t) で置き換える (half は 2 のべき乗, numComplex は 2*half の倍数)
+	void (*FftRadix2)(YmReal32* data, const YmReal32* twiddle, YmUInt32 numComplex, YmUInt32 half);
+	// dst[n] = Σk src[n+k] * coefRev[k]  (時間軸畳込。src は numTaps-1 サンプルの履歴を先頭に含み、係数は逆順)
+	void (*Fir)(YmReal32* dst, const YmReal32* src, const YmReal32* coefRev, YmUInt32 numSamples, YmUInt32 numTaps);
+	// dst[n] += src[n] * gain  (ミキシング)
+	void (*MixGain)(YmReal32* dst, const YmReal32* src, YmReal32 gain, YmUInt32 numSamples);
+	// dst[n] += src[n] * (gainStart + (gainEnd - gainStart)*(n+1)/numSamples)  (ブロック内の線形ゲイン補間)
+	void (*MixGainRamp)(YmReal32* dst, const YmReal32* src, YmReal32 gainStart, YmReal32 gainEnd, YmUInt32 numSamples);
+	// Σn a[n] * b[n]  (ポリフェーズ FIR の 1 出力等)
+	YmReal32 (*Dot)(const YmReal32* a, const YmReal32* b, YmUInt32 numSamples);
+};
+
+namespace detail {
+
+/***********************************************************************//**
+ * @brief			スカラー実装 (端数処理にも使用)
+ **************************************************************************/
+inline void ComplexMul_Scalar(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	for (YmUInt32 i = 0; i < numComplex*2; i += 2)
+	{
+		const YmReal32 re = a[i]*b[i] - a[i+1]*b[i+1];
+		const YmReal32 im = a[i]*b[i+1] + a[i+1]*b[i];
+		dst[i] = re;
+		dst[i+1] = im;
+	}
+}
+
+inline void ComplexMulAdd_Scalar(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	for (YmUInt32 i = 0; i < numComplex*2; i += 2)
+	{
+		dst[i]   += a[i]*b[i] - a[i+1]*b[i+1];
+		dst[i+1] += a[i]*b[i+1] + a[i+1]*b[i];
+	}
+}
+
+inline void FftRadix2_Scalar(YmReal32* data, const YmReal32* twiddle, YmUInt32 numComplex, YmUInt32 half)
+{
+	for (YmUInt32 base = 0; base < numComplex; base += 2*half)
+	{
+		YmReal32* a = data + 2*base;
+		YmReal32* b = a + 2*half;
+		for (YmUInt32 i = 0; i < half*2; i += 2)
+		{
+			const YmReal32 tr = b[i]*twiddle[i] - b[i+1]*twiddle[i+1];
+			const YmReal32 ti = b[i]*twiddle[i+1] + b[i+1]*twiddle[i];
+			b[i] = a[i] - tr;	b[i+1] = a[i+1] - ti;
+			a[i] += tr;			a[i+1] += ti;
+		}
+	}
+}
+
+inline void Fir_Scalar(YmReal32* dst, const YmReal32* src, const YmReal32* coefRev, YmUInt32 numSamples, YmUInt32 numTaps)
+{
+	for (YmUInt32 n = 0; n < numSamples; n++)
+	{
+		YmReal32 acc = 0.0f;
+		for (YmUInt32 k = 0; k < numTaps; k++) acc += src[n+k]*coefRev[k];
+		dst[n] = acc;
+	}
+}
+
+inline void MixGain_Scalar(YmReal32* dst, const YmReal32* src, YmReal32 gain, YmUInt32 numSamples)
+{
+	for (YmUInt32 n = 0; n < numSamples; n++) dst[n] += src[n]*gain;
+}
+
+inline void MixGainRamp_Scalar(YmReal32* dst, const YmReal32* src, YmReal32 gainStart, YmReal32 gainEnd, YmUInt32 numSamples)
+{
+	if (numSamples == 0) return;
+	const YmReal32 step = (gainEnd - gainStart) / (YmReal32)numSamples;
+	for (YmUInt32 n = 0; n < numSamples; n++) dst[n] += src[n]*(gainStart + step*(YmReal32)(n + 1));
+}
+
+inline YmReal32 Dot_Scalar(const YmReal32* a, const YmReal32* b, YmUInt32 numSamples)
+{
+	YmReal32 acc = 0.0f;
+	for (YmUInt32 n = 0; n < numSamples; n++) acc += a[n]*b[n];
+	return acc;
+}
+
+// ランプ用のサンプル番号 (n+1)。端数は MixGainRamp_Xxx(dst+n, src+n, gainStart + step*n, gainEnd, ...) で続ける
+static const YmReal32 s_rampIndex[16] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 16.0f };
+
+/***********************************************************************//**
+ * @brief			4 並列実装 (SSE3 / NEON / Wwise AKSIMD 共通)
+ **************************************************************************/
+inline void ComplexMul_V4(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		YMSIMD_STOREU_V4F32(dst+i, YMSIMD_COMPLEXMUL(YMSIMD_LOADU_V4F32(a+i), YMSIMD_LOADU_V4F32(b+i)));
+	}
+	ComplexMul_Scalar(dst+i, a+i, b+i, (n-i)/2);
+}
+
+inline void ComplexMulAdd_V4(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const YmV4F32 m = YMSIMD_COMPLEXMUL(YMSIMD_LOADU_V4F32(a+i), YMSIMD_LOADU_V4F32(b+i));
+		YMSIMD_STOREU_V4F32(dst+i, YMSIMD_ADD_V4F32(YMSIMD_LOADU_V4F32(dst+i), m));
+	}
+	ComplexMulAdd_Scalar(dst+i, a+i, b+i, (n-i)/2);
+}
+
+// half < 2 の段 (1 区間が 1 ベクトルに満たない) はスカラーで処理する
+inline void FftRadix2_V4(YmReal32* data, const YmReal32* twiddle, YmUInt32 numComplex, YmUInt32 half)
+{
+	if (half < 2)
+	{
+		FftRadix2_Scalar(data, twiddle, numComplex, half);
+		return;
+	}
+	for (YmUInt32 base = 0; base < numComplex; base += 2*half)
+	{
+		YmReal32* a = data + 2*base;
+		YmReal32* b = a + 2*half;
+		for (YmUInt32 i = 0; i < half*2; i += 4)
+		{
+			const YmV4F32 va = YMSIMD_LOADU_V4F32(a+i);
+			const YmV4F32 t = YMSIMD_COMPLEXMUL(YMSIMD_LOADU_V4F32(b+i), YMSIMD_LOADU_V4F32(twiddle+i));
+			YMSIMD_STOREU_V4F32(b+i, YMSIMD_SUB_V4F32(va, t));
+			YMSIMD_STOREU_V4F32(a+i, YMSIMD_ADD_V4F32(va, t));
+		}
+	}
+}
+
+inline void Fir_V4(YmReal32* dst, const YmReal32* src, const YmReal32* coefRev, YmUInt32 numSamples, YmUInt32 numTaps)
+{
+	YmUInt32 n = 0;
+	for (; n + 4 <= numSamples; n += 4)
+	{
+		YmV4F32 acc = YMSIMD_SET_V4F32(0.0f);
+		for (YmUInt32 k = 0; k < numTaps; k++)
+		{
+			acc = YMSIMD_MADD_V4F32(YMSIMD_LOADU_V4F32(src+n+k), YMSIMD_SET_V4F32(coefRev[k]), acc);
+		}
+		YMSIMD_STOREU_V4F32(dst+n, acc);
+	}
+	Fir_Scalar(dst+n, src+n, coefRev, numSamples-n, numTaps);
+}
+
+inline void MixGain_V4(YmReal32* dst, const YmReal32* src, YmReal32 gain, YmUInt32 numSamples)
+{
+	const YmV4F32 g = YMSIMD_SET_V4F32(gain);
+	YmUInt32 n = 0;
+	for (; n + 4 <= numSamples; n += 4)
+	{
+		YMSIMD_STOREU_V4F32(dst+n, YMSIMD_MADD_V4F32(YMSIMD_LOADU_V4F32(src+n), g, YMSIMD_LOADU_V4F32(dst+n)));
+	}
+	MixGain_Scalar(dst+n, src+n, gain, numSamples-n);
+}
+
+inline void MixGainRamp_V4(YmReal32* dst, const YmReal32* src, YmReal32 gainStart, YmReal32 gainEnd, YmUInt32 numSamples)
+{
+	if (numSamples == 0) return;
+	const YmReal32 step = (gainEnd - gainStart) / (YmReal32)numSamples;
+	const YmV4F32 g0 = YMSIMD_SET_V4F32(gainStart);
+	const YmV4F32 vs = YMSIMD_SET_V4F32(step);
+	const YmV4F32 inc = YMSIMD_SET_V4F32(4.0f);
+	YmV4F32 idx = YMSIMD_LOADU_V4F32(s_rampIndex);
+	YmUInt32 n = 0;
+	for (; n + 4 <= numSamples; n += 4)
+	{
+		const YmV4F32 g = YMSIMD_MADD_V4F32(idx, vs, g0);
+		YMSIMD_STOREU_V4F32(dst+n, YMSIMD_MADD_V4F32(YMSIMD_LOADU_V4F32(src+n), g, YMSIMD_LOADU_V4F32(dst+n)));
+		idx = YMSIMD_ADD_V4F32(idx, inc);
+	}
+	MixGainRamp_Scalar(dst+n, src+n, gainStart + step*(YmReal32)n, gainEnd, numSamples-n);
+}
+
+inline YmReal32 Dot_V4(const YmReal32* a, const YmReal32* b, YmUInt32 numSamples)
+{
+	YmV4F32 acc = YMSIMD_SET_V4F32(0.0f);
+	YmUInt32 n = 0;
+	for (; n + 4 <= numSamples; n += 4)
+	{
+		acc = YMSIMD_MADD_V4F32(YMSIMD_LOADU_V4F32(a+n), YMSIMD_LOADU_V4F32(b+n), acc);
+	}
+	YmReal32 lane[4];
+	YMSIMD_STOREU_V4F32(lane, acc);
+	return (lane[0] + lane[1]) + (lane[2] + lane[3]) + Dot_Scalar(a+n, b+n, numSamples-n);
+}
+
+#if YM_USE_SIMD_WIDE
+/***********************************************************************//**
+ * @brief			8 並列実装 (AVX2 + FMA)
+ **************************************************************************/
+inline YM_TARGET_AVX2 void ComplexMul_V8(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		YMSIMD_STOREU_V8F32(dst+i, YMSIMD_COMPLEXMUL_V8F32(YMSIMD_LOADU_V8F32(a+i), YMSIMD_LOADU_V8F32(b+i)));
+	}
+	ComplexMul_Scalar(dst+i, a+i, b+i, (n-i)/2);
+}
+
+inline YM_TARGET_AVX2 void ComplexMulAdd_V8(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const YmV8F32 m = YMSIMD_COMPLEXMUL_V8F32(YMSIMD_LOADU_V8F32(a+i), YMSIMD_LOADU_V8F32(b+i));
+		YMSIMD_STOREU_V8F32(dst+i, YMSIMD_ADD_V8F32(YMSIMD_LOADU_V8F32(dst+i), m));
+	}
+	ComplexMulAdd_Scalar(dst+i, a+i, b+i, (n-i)/2);
+}
+
+inline YM_TARGET_AVX2 void FftRadix2_V8(YmReal32* data, const YmReal32* twiddle, YmUInt32 numComplex, YmUInt32 half)
+{
+	if (half < 4)
+	{
+		FftRadix2_V4(data, twiddle, numComplex, half);
+		return;
+	}
+	for (YmUInt32 base = 0; base < numComplex; base += 2*half)
+	{
+		YmReal32* a = data + 2*base;
+		YmReal32* b = a + 2*half;
+		for (YmUInt32 i = 0; i < half*2; i += 8)
+		{
+			const YmV8F32 va = YMSIMD_LOADU_V8F32(a+i);
+			const YmV8F32 t = YMSIMD_COMPLEXMUL_V8F32(YMSIMD_LOADU_V8F32(b+i), YMSIMD_LOADU_V8F32(twiddle+i));
+			YMSIMD_STOREU_V8F32(b+i, YMSIMD_SUB_V8F32(va, t));
+			YMSIMD_STOREU_V8F32(a+i, YMSIMD_ADD_V8F32(va, t));
+		}
+	}
+}
+
+inline YM_TARGET_AVX2 void Fir_V8(YmReal32* dst, const YmReal32* src, const YmReal32* coefRev, YmUInt32 numSamples, YmUInt32 numTaps)
+{
+	YmUInt32 n = 0;
+	for (; n + 8 <= numSamples; n += 8)
+	{
+		YmV8F32 acc = YMSIMD_SETZERO_V8F32();
+		for (YmUInt32 k = 0; k < numTaps; k++)
+		{
+			acc = YMSIMD_MADD_V8F32(YMSIMD_LOADU_V8F32(src+n+k), YMSIMD_SET_V8F32(coefRev[k]), acc);
+		}
+		YMSIMD_STOREU_V8F32(dst+n, acc);
+	}
+	Fir_Scalar(dst+n, src+n, coefRev, numSamples-n, numTaps);
+}
+
+inline YM_TARGET_AVX2 void MixGain_V8(YmReal32* dst, const YmReal32* src, YmReal32 gain, YmUInt32 numSamples)
+{
+	const YmV8F32 g = YMSIMD_SET_V8F32(gain);
+	YmUInt32 n = 0;
+	for (; n + 8 <= numSamples; n += 8)
+	{
+		YMSIMD_STOREU_V8F32(dst+n, YMSIMD_MADD_V8F32(YMSIMD_LOADU_V8F32(src+n), g, YMSIMD_LOADU_V8F32(dst+n)));
+	}
+	MixGain_Scalar(dst+n, src+n, gain, numSamples-n);
+}
+
+inline YM_TARGET_AVX2 void MixGainRamp_V8(YmReal32* dst, const YmReal32* src, YmReal32 gainStart, YmReal32 gainEnd, YmUInt32 numSamples)
+{
+	if (numSamples == 0) return;
+	const YmReal32 step = (gainEnd - gainStart) / (YmReal32)numSamples;
+	const YmV8F32 g0 = YMSIMD_SET_V8F32(gainStart);
+	const YmV8F32 vs = YMSIMD_SET_V8F32(step);
+	const YmV8F32 inc = YMSIMD_SET_V8F32(8.0f);
+	YmV8F32 idx = YMSIMD_LOADU_V8F32(s_rampIndex);
+	YmUInt32 n = 0;
+	for (; n + 8 <= numSamples; n += 8)
+	{
+		const YmV8F32 g = YMSIMD_MADD_V8F32(idx, vs, g0);
+		YMSIMD_STOREU_V8F32(dst+n, YMSIMD_MADD_V8F32(YMSIMD_LOADU_V8F32(src+n), g, YMSIMD_LOADU_V8F32(dst+n)));
+		idx = YMSIMD_ADD_V8F32(idx, inc);
+	}
+	MixGainRamp_Scalar(dst+n, src+n, gainStart + step*(YmReal32)n, gainEnd, numSamples-n);
+}
+
+inline YM_TARGET_AVX2 YmReal32 Dot_V8(const YmReal32* a, const YmReal32* b, YmUInt32 numSamples)
+{
+	YmV8F32 acc = YMSIMD_SETZERO_V8F32();
+	YmUInt32 n = 0;
+	for (; n + 8 <= numSamples; n += 8)
+	{
+		acc = YMSIMD_MADD_V8F32(YMSIMD_LOADU_V8F32(a+n), YMSIMD_LOADU_V8F32(b+n), acc);
+	}
+	YmReal32 lane[8];
+	YMSIMD_STOREU_V8F32(lane, acc);
+	return ((lane[0] + lane[1]) + (lane[2] + lane[3])) + ((lane[4] + lane[5]) + (lane[6] + lane[7])) + Dot_Scalar(a+n, b+n, numSamples-n);
+}
+
+/***********************************************************************//**
+ * @brief			16 並列実装 (AVX-512F)
+ **************************************************************************/
+inline YM_TARGET_AVX512 void ComplexMul_V16(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		YMSIMD_STOREU_V16F32(dst+i, YMSIMD_COMPLEXMUL_V16F32(YMSIMD_LOADU_V16F32(a+i), YMSIMD_LOADU_V16F32(b+i)));
+	}
+	ComplexMul_V8(dst+i, a+i, b+i, (n-i)/2);
+}
+
+inline YM_TARGET_AVX512 void ComplexMulAdd_V16(YmReal32* dst, const YmReal32* a, const YmReal32* b, YmUInt32 numComplex)
+{
+	const YmUInt32 n = numComplex*2;
+	YmUInt32 i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		const YmV16F32 m = YMSIMD_COMPLEXMUL_V16F32(YMSIMD_LOADU_V16F32(a+i), YMSIMD_LOADU_V16F32(b+i));
+		YMSIMD_STOREU_V16F32(dst+i, YMSIMD_ADD_V16F32(YMSIMD_LOADU_V16F32(dst+i), m));
+	}
+	ComplexMulAdd_V8(dst+i, a+i, b+i, (n-i)/2);
+}
+
+inline YM_TARGET_AVX512 void FftRadix2_V16(YmReal32* data, const YmReal32* twiddle, YmUInt32 numComplex, YmUInt32 half)
+{
+	if (half < 8)
+	{
+		FftRadix2_V8(data, twiddle, numComplex, half);
+		return;
+	}
+	for (YmUInt32 base = 0; base < numComplex; base += 2*half)
+	{
+		YmReal32* a = data + 2*base;
+		YmReal32* b = a + 2*half;
+		for (YmUInt32 i = 0; i < half*2; i += 16)
+		{
+			const YmV16F32 va = YMSIMD_LOADU_V16F32(a+i);
+			const YmV16F32 t = YMSIMD_COMPLEXMUL_V16F32(YMSIMD_LOADU_V16F32(b+i), YMSIMD_LOADU_V16F32(twiddle+i));
+			YMSIMD_STOREU_V16F32(b+i, YMSIMD_SUB_V16F32(va, t));
+			YMSIMD_STOREU_V16F32(a+i, YMSIMD_ADD_V16F32(va, t));
+		}
+	}
+}
+
+inline YM_TARGET_AVX512 void Fir_V16(YmReal32* dst, const YmReal32* src, const YmReal32* coefRev, YmUInt32 numSamples, YmUInt32 numTaps)
+{
+	YmUInt32 n = 0;
+	for (; n + 16 <= numSamples; n += 16)
+	{
+		YmV16F32 acc = YMSIMD_SETZERO_V16F32();
+		for (YmUInt32 k = 0; k < numTaps; k++)
+		{
+			acc = YMSIMD_MADD_V16F32(YMSIMD_LOADU_V16F32(src+n+k), YMSIMD_SET_V16F32(coefRev[k]), acc);
+		}
+		YMSIMD_STOREU_V16F32(dst+n, acc);
+	}
+	Fir_V8(dst+n, src+n, coefRev, numSamples-n, numTaps);
+}
+
+inline YM_TARGET_AVX512 void MixGain_V16(YmReal32* dst, const YmReal32* src, YmReal32 gain, YmUInt32 numSamples)
+{
+	const YmV16F32 g = YMSIMD_SET_V16F32(gain);
+	YmUInt32 n = 0;
+	for (; n + 16 <= numSamples; n += 16)
+	{
+		YMSIMD_STOREU_V16F32(dst+n, YMSIMD_MADD_V16F32(YMSIMD_LOADU_V16F32(src+n), g, YMSIMD_LOADU_V16F32(dst+n)));
+	}
+	MixGain_V8(dst+n, src+n, gain, numSamples-n);
+}
+
+inline YM_TARGET_AVX512 void MixGainRamp_V16(YmReal32* dst, const YmReal32* src, YmReal32 gainStart, YmReal32 gainEnd, YmUInt32 numSamples)
+{
+	if (numSamples == 0) return;
+	const YmReal32 step = (gainEnd - gainStart) / (YmReal32)numSamples;
+	const YmV16F32 g0 = YMSIMD_SET_V16F32(gainStart);
+	const YmV16F32 vs = YMSIMD_SET_V16F32(step);
+	const YmV16F32 inc = YMSIMD_SET_V16F32(16.0f);
+	YmV16F32 idx = YMSIMD_LOADU_V16F32(s_rampIndex);
+	YmUInt32 n = 0;
+	for (; n + 16 <= numSamples; n += 16)
+	{
+		const YmV16F32 g = YMSIMD_MADD_V16F32(idx, vs, g0);
+		YMSIMD_STOREU_V16F32(dst+n, YMSIMD_MADD_V16F32(YMSIMD_LOADU_V16F32(src+n), g, YMSIMD_LOADU_V16F32(dst+n)));
+		idx = YMSIMD_ADD_V16F32(idx, inc);
+	}
+	MixGainRamp_V8(dst+n, src+n, gainStart + step*(YmReal32)n, gainEnd, numSamples-n);
+}
+
+inline YM_TARGET_AVX512 YmReal32 Dot_V16(const YmReal32* a, const YmReal32* b, YmUInt32 numSamples)
+{
+	YmV16F32 acc = YMSIMD_SETZERO_V16F32();
+	YmUInt32 n = 0;
+	for (; n + 16 <= numSamples; n += 16)
+	{
+		acc = YMSIMD_MADD_V16F32(YMSIMD_LOADU_V16F32(a+n), YMSIMD_LOADU_V16F32(b+n), acc);
+	}
+	YmReal32 lane[16];
+	YMSIMD_STOREU_V16F32(lane, acc);
+	YmReal32 sum = 0.0f;
+	for (int i = 0; i < 16; i++) sum += lane[i];
+	return sum + Dot_V8(a+n, b+n, numSamples-n);
+}
+#endif
+
+} // namespace detail
+
+/***********************************************************************//**
+ * @brief			段階の名称
+ **************************************************************************/
+inline const char* GetTierName(Tier tier)
+{
+	switch (tier)
+	{
+	case TIER_SCALAR:	return "scalar";
+	case TIER_NEON:		return "neon";
+	case TIER_SSE3:		return "sse3";
+	case TIER_AVX2:		return "avx2";
+	case TIER_AVX512:	return "avx512";
+	default:			return "unknown";
+	}
+}
+
+/***********************************************************************//**
+ * @brief			実行中の CPU で使用可能か
+ **************************************************************************/
+inline bool IsTierSupported(Tier tier)
+{
+	switch (tier)
+	{
+	case TIER_SCALAR:	return true;
+	case TIER_NEON:		return YmCpu::HasFeatures(YmCpu::FEATURE_NEON);
+	case TIER_SSE3:		return YmCpu::HasFeatures(YmCpu::FEATURE_SSE3);
+#if YM_USE_SIMD_WIDE
+	case TIER_AVX2:		return YmCpu::HasFeatures(YmCpu::FEATURE_AVX2 | YmCpu::FEATURE_FMA);
+	case TIER_AVX512:	return YmCpu::HasFeatures(YmCpu::FEATURE_AVX512F | YmCpu::FEATURE_AVX2 | YmCpu::FEATURE_FMA);
+#endif
+	default:			return false;
+	}
+}
+
+/***********************************************************************//**
+ * @brief			指定段階のカーネルテーブル (ベンチマーク・検証用)
+ * @return			未対応の段階なら nullptr
+ **************************************************************************/
+inline const Kernels* GetKernels(Tier tier)
+{
+	static const Kernels s_scalar = { TIER_SCALAR, detail::ComplexMul_Scalar, detail::ComplexMulAdd_Scalar, detail::FftRadix2_Scalar, detail::Fir_Scalar, detail::MixGain_Scalar, detail::MixGainRamp_Scalar, detail::Dot_Scalar };
+	static const Kernels s_neon   = { TIER_NEON,   detail::ComplexMul_V4, detail::ComplexMulAdd_V4, detail::FftRadix2_V4, detail::Fir_V4, detail::MixGain_V4, detail::MixGainRamp_V4, detail::Dot_V4 };
+	static const Kernels s_sse3   = { TIER_SSE3,   detail::ComplexMul_V4, detail::ComplexMulAdd_V4, detail::FftRadix2_V4, detail::Fir_V4, detail::MixGain_V4, detail::MixGainRamp_V4, detail::Dot_V4 };
+#if YM_USE_SIMD_WIDE
+	static const Kernels s_avx2   = { TIER_AVX2,   detail::ComplexMul_V8, detail::ComplexMulAdd_V8, detail::FftRadix2_V8, detail::Fir_V8, detail::MixGain_V8, detail::MixGainRamp_V8, detail::Dot_V8 };
+	static const Kernels s_avx512 = { TIER_AVX512, detail::ComplexMul_V16, detail::ComplexMulAdd_V16, detail::FftRadix2_V16, detail::Fir_V16, detail::MixGain_V16, detail::MixGainRamp_V16, detail::Dot_V16 };
+#endif
+
+	if (!IsTierSupported(tier)) return nullptr;
+	switch (tier)
+	{
+	case TIER_SCALAR:	return &s_scalar;
+	case TIER_NEON:		return &s_neon;
+	case TIER_SSE3:		return &s_sse3;
+#if YM_USE_SIMD_WIDE
+	case TIER_AVX2:		return &s_avx2;
+	case TIER_AVX512:	return &s_avx512;
+#endif
+	default:			return nullptr;
+	}
+}
+
+/***********************************************************************//**
+ * @brief			使用可能な最上位の段階を選択
+ **************************************************************************/
+inline Tier SelectTier(void)
+{
+	for (int t = TIER_NUM - 1; t > TIER_SCALAR; t--)
+	{
+		if (IsTierSupported((Tier)t)) return (Tier)t;
+	}
+	return TIER_SCALAR;
+}
+
+namespace detail {
+
+inline const Kernels*& SelectedKernels(void)
+{
+	static const Kernels* s_kernels = GetKernels(SelectTier());
+	return s_kernels;
+}
+
+} // namespace detail
+
+/***********************************************************************//**
+ * @brief			選択済みカーネルテーブル
+ **************************************************************************/
+inline const Kernels& GetKernels(void)
+{
+	return *detail::SelectedKernels();
+}
+
+/***********************************************************************//**
+ * @brief			段階の強制切替 (ベンチマーク・検証用)
+ * @attention		処理中のスレッドがない状態で呼ぶこと
+ * @return			未対応の段階なら false (切替なし)
+ **************************************************************************/
+inline bool ForceTier(Tier tier)
+{
+	const Kernels* kernels = GetKernels(tier);
+	if (kernels == nullptr) return false;
+	detail::SelectedKernels() = kernels;
+	return true;
+}
+
+inline void InitKernels(void)
+{
+	(void)GetKernels();
+}
+
+inline Tier GetTier(void)
+{
+	return GetKernels().tier;
+}
+
+} // namespace YmSimd
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
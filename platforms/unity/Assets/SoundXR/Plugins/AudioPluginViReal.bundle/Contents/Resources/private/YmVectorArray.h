@@ -0,0 +1,428 @@
+﻿/*****************************************************************************************//**
+ * @file			YmVectorArray.h
+ * @brief			YmVector3 / YmPolar3 の SoA 配列と一括演算
+ * @attention		x[], y[], z[] (azim[], elev[], dist[]) を 64 バイト境界の別ストリームとして持つ。
+ *					各ストリームは NUM_SIMD の倍数に切り上げて確保するため、
+ *					一括演算は端数処理なしで 4 要素ずつ回る (詰め物の要素も計算する)。
+ *
+ *					音源ごとの YmVector3 演算をブロック単位で以下のようにまとめる想定:
+ *					  pos.Set(i, ...)                          // 音源位置を書き込む
+ *					  YmMath::ToLocal(rel, pos, listener, rot) // リスナー座標系へ
+ *					  YmMath::RectToPolar(dir, rel)            // 方向・距離
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+#include "private/YmMathBatch.h"
+#if YM_USE_SIMD
+	#include "private/YmSimd.h"
+#endif
+
+#define YM_VECTOR_ARRAY_ALIGNMENT	64		///< ストリーム境界のアライメント (キャッシュライン)
+
+/***********************************************************************//**
+ * @brief			3 ストリームの SoA 配列 (YmVector3Array / YmPolar3Array の共通部)
+ **************************************************************************/
+class YmReal32x3Array
+{
+public:
+	YmReal32x3Array() : m_pAllocator(nullptr), m_pBlock(nullptr), m_count(0), m_capacity(0)
+	{
+		m_pStream[0] = m_pStream[1] = m_pStream[2] = nullptr;
+	}
+	~YmReal32x3Array() { Term(); }
+
+	YmReal32x3Array(const YmReal32x3Array&) = delete;
+	YmReal32x3Array& operator=(const YmReal32x3Array&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	capacity	最大要素数
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 capacity)
+	{
+		Term();
+		if (capacity == 0) return false;
+
+		const size_t stride = ((size_t)capacity*sizeof(YmReal32) + YM_VECTOR_ARRAY_ALIGNMENT - 1) & ~(size_t)(YM_VECTOR_ARRAY_ALIGNMENT - 1);
+		m_pBlock = static_cast<YmReal32*>(alloc_memory(in_pAllocator, stride*3, YM_VECTOR_ARRAY_ALIGNMENT));
+		if (m_pBlock == nullptr) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_capacity = (YmUInt32)(stride / sizeof(YmReal32));
+		for (int k = 0; k < 3; k++) m_pStream[k] = m_pBlock + m_capacity*k;
+		m_count = 0;
+		return true;
+	}
+
+	void Term(void)
+	{
+		if (m_pBlock == nullptr) return;
+		free_memory(m_pAllocator, m_pBlock);
+		m_pAllocator = nullptr;
+		m_pBlock = nullptr;
+		m_pStream[0] = m_pStream[1] = m_pStream[2] = nullptr;
+		m_count = 0;
+		m_capacity = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		要素数の変更 (増えた分はゼロ)
+	 * @note		端数の詰め物 [GetCount(), GetPaddedCount()) も一括演算で書き換わるため値は不定
+	 **************************************************************************/
+	void Resize(YmUInt32 count)
+	{
+		if (count > m_capacity) count = m_capacity;
+		if (count > m_count)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				for (YmUInt32 i = m_count; i < count; i++) m_pStream[k][i] = 0.0f;
+			}
+		}
+		m_count = count;
+	}
+
+	YmUInt32 GetCount(void) const		{ return m_count; }
+	YmUInt32 GetCapacity(void) const	{ return m_capacity; }
+	YmUInt32 GetPaddedCount(void) const	{ return Padded(m_count); }	///< 一括演算が処理する要素数
+
+	YmReal32* GetStream(int k)				{ return m_pStream[k]; }
+	const YmReal32* GetStream(int k) const	{ return m_pStream[k]; }
+
+protected:
+	static YmUInt32 Padded(YmUInt32 n)	{ return (n + 3) & ~3u; }
+
+	YmMemAlloc*		m_pAllocator;
+	YmReal32*		m_pBlock;
+	YmReal32*		m_pStream[3];
+	YmUInt32		m_count;
+	YmUInt32		m_capacity;		// NUM_SIMD の倍数
+};
+
+/***********************************************************************//**
+ * @brief			YmVector3 の SoA 配列
+ **************************************************************************/
+class YmVector3Array : public YmReal32x3Array
+{
+public:
+	YmReal32* X(void)				{ return m_pStream[0]; }
+	YmReal32* Y(void)				{ return m_pStream[1]; }
+	YmReal32* Z(void)				{ return m_pStream[2]; }
+	const YmReal32* X(void) const	{ return m_pStream[0]; }
+	const YmReal32* Y(void) const	{ return m_pStream[1]; }
+	const YmReal32* Z(void) const	{ return m_pStream[2]; }
+
+	YmVector3 Get(YmUInt32 i) const				{ return YmVector3(m_pStream[0][i], m_pStream[1][i], m_pStream[2][i]); }
+	void Set(YmUInt32 i, const YmVector3& v)	{ m_pStream[0][i] = v.x; m_pStream[1][i] = v.y; m_pStream[2][i] = v.z; }
+
+	/// AoS から読み込む (要素数は count になる)
+	void Load(const YmVector3* src, YmUInt32 count)
+	{
+		Resize(count);
+		for (YmUInt32 i = 0; i < m_count; i++) Set(i, src[i]);
+	}
+	/// AoS へ書き出す
+	void Store(YmVector3* dst) const
+	{
+		for (YmUInt32 i = 0; i < m_count; i++) dst[i] = Get(i);
+	}
+};
+
+/***********************************************************************//**
+ * @brief			YmPolar3 の SoA 配列
+ **************************************************************************/
+class YmPolar3Array : public YmReal32x3Array
+{
+public:
+	YmReal32* Azim(void)				{ return m_pStream[0]; }
+	YmReal32* Elev(void)				{ return m_pStream[1]; }
+	YmReal32* Dist(void)				{ return m_pStream[2]; }
+	const YmReal32* Azim(void) const	{ return m_pStream[0]; }
+	const YmReal32* Elev(void) const	{ return m_pStream[1]; }
+	const YmReal32* Dist(void) const	{ return m_pStream[2]; }
+
+	YmPolar3 Get(YmUInt32 i) const				{ return YmPolar3(m_pStream[0][i], m_pStream[1][i], m_pStream[2][i]); }
+	void Set(YmUInt32 i, const YmPolar3& p)		{ m_pStream[0][i] = p.azim; m_pStream[1][i] = p.elev; m_pStream[2][i] = p.dist; }
+
+	void Load(const YmPolar3* src, YmUInt32 count)
+	{
+		Resize(count);
+		for (YmUInt32 i = 0; i < m_count; i++) Set(i, src[i]);
+	}
+	void Store(YmPolar3* dst) const
+	{
+		for (YmUInt32 i = 0; i < m_count; i++) dst[i] = Get(i);
+	}
+};
+
+/***********************************************************************//**
+ * @brief			一括演算
+ * @note			dst は入力と同じ配列でもよい。dst の要素数は入力に合わせる。
+ *					スカラー版 YmVector3 の演算子と同じ意味:
+ *					  Add/Sub/Mul = operator+ - *, Cross = operator^, Inner = x*x'+y*y'+z*z'
+ **************************************************************************/
+#if YM_USE_SIMD
+	#define YM_VA_LOOP(n)		for (YmUInt32 i = 0; i < (n); i += NUM_SIMD)
+#endif
+
+namespace YmMath {
+
+namespace detail {
+
+template<typename Op> inline void Apply3(YmVector3Array& dst, const YmVector3Array& a, const YmVector3Array& b, Op op)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	for (int k = 0; k < 3; k++)
+	{
+		const YmReal32* pa = a.GetStream(k);
+		const YmReal32* pb = b.GetStream(k);
+		YmReal32* pd = dst.GetStream(k);
+#if YM_USE_SIMD
+		YM_VA_LOOP(n) YMSIMD_STORE_V4F32(pd+i, op(YMSIMD_LOAD_V4F32(pa+i), YMSIMD_LOAD_V4F32(pb+i)));
+#else
+		for (YmUInt32 i = 0; i < n; i++) pd[i] = op(pa[i], pb[i]);
+#endif
+	}
+}
+
+} // namespace detail
+
+/// dst = a + b
+inline void Add(YmVector3Array& dst, const YmVector3Array& a, const YmVector3Array& b)
+{
+#if YM_USE_SIMD
+	detail::Apply3(dst, a, b, [](YmV4F32 u, YmV4F32 v) { return YMSIMD_ADD_V4F32(u, v); });
+#else
+	detail::Apply3(dst, a, b, [](YmReal32 u, YmReal32 v) { return u + v; });
+#endif
+}
+
+/// dst = a - b
+inline void Sub(YmVector3Array& dst, const YmVector3Array& a, const YmVector3Array& b)
+{
+#if YM_USE_SIMD
+	detail::Apply3(dst, a, b, [](YmV4F32 u, YmV4F32 v) { return YMSIMD_SUB_V4F32(u, v); });
+#else
+	detail::Apply3(dst, a, b, [](YmReal32 u, YmReal32 v) { return u - v; });
+#endif
+}
+
+/// dst = a * b (要素ごと)
+inline void Mul(YmVector3Array& dst, const YmVector3Array& a, const YmVector3Array& b)
+{
+#if YM_USE_SIMD
+	detail::Apply3(dst, a, b, [](YmV4F32 u, YmV4F32 v) { return YMSIMD_MUL_V4F32(u, v); });
+#else
+	detail::Apply3(dst, a, b, [](YmReal32 u, YmReal32 v) { return u * v; });
+#endif
+}
+
+/// dst = a + v (全要素に同じベクトルを足す)
+inline void Add(YmVector3Array& dst, const YmVector3Array& a, const YmVector3& v)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	for (int k = 0; k < 3; k++)
+	{
+		const YmReal32* pa = a.GetStream(k);
+		YmReal32* pd = dst.GetStream(k);
+#if YM_USE_SIMD
+		const YmV4F32 s = YMSIMD_SET_V4F32(v[k]);
+		YM_VA_LOOP(n) YMSIMD_STORE_V4F32(pd+i, YMSIMD_ADD_V4F32(YMSIMD_LOAD_V4F32(pa+i), s));
+#else
+		for (YmUInt32 i = 0; i < n; i++) pd[i] = pa[i] + v[k];
+#endif
+	}
+}
+
+/// dst = a - v
+inline void Sub(YmVector3Array& dst, const YmVector3Array& a, const YmVector3& v)
+{
+	Add(dst, a, -v);
+}
+
+/// dst = a * s
+inline void Scale(YmVector3Array& dst, const YmVector3Array& a, YmReal32 s)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	for (int k = 0; k < 3; k++)
+	{
+		const YmReal32* pa = a.GetStream(k);
+		YmReal32* pd = dst.GetStream(k);
+#if YM_USE_SIMD
+		const YmV4F32 vs = YMSIMD_SET_V4F32(s);
+		YM_VA_LOOP(n) YMSIMD_STORE_V4F32(pd+i, YMSIMD_MUL_V4F32(YMSIMD_LOAD_V4F32(pa+i), vs));
+#else
+		for (YmUInt32 i = 0; i < n; i++) pd[i] = pa[i] * s;
+#endif
+	}
+}
+
+/// dst[i] = a[i] * s[i] (要素ごとのスカラー倍)
+inline void Scale(YmVector3Array& dst, const YmVector3Array& a, const YmReal32* s)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	const YmUInt32 m = a.GetCount();
+	for (int k = 0; k < 3; k++)
+	{
+		const YmReal32* pa = a.GetStream(k);
+		YmReal32* pd = dst.GetStream(k);
+		YmUInt32 i = 0;
+#if YM_USE_SIMD
+		for (; i + NUM_SIMD <= m; i += NUM_SIMD) YMSIMD_STORE_V4F32(pd+i, YMSIMD_MUL_V4F32(YMSIMD_LOAD_V4F32(pa+i), YMSIMD_LOADU_V4F32(s+i)));
+#endif
+		for (; i < m; i++) pd[i] = pa[i] * s[i];
+		for (; i < n; i++) pd[i] = 0.0f;
+	}
+}
+
+/// dst[i] = a[i].b[i] (内積、dst は GetPaddedCount() 要素分の領域が必要)
+inline void Inner(YmReal32* dst, const YmVector3Array& a, const YmVector3Array& b)
+{
+	const YmUInt32 n = a.GetPaddedCount();
+	const YmReal32 *ax = a.X(), *ay = a.Y(), *az = a.Z();
+	const YmReal32 *bx = b.X(), *by = b.Y(), *bz = b.Z();
+#if YM_USE_SIMD
+	YM_VA_LOOP(n)
+	{
+		YmV4F32 acc = YMSIMD_MUL_V4F32(YMSIMD_LOAD_V4F32(ax+i), YMSIMD_LOAD_V4F32(bx+i));
+		acc = YMSIMD_MADD_V4F32(YMSIMD_LOAD_V4F32(ay+i), YMSIMD_LOAD_V4F32(by+i), acc);
+		acc = YMSIMD_MADD_V4F32(YMSIMD_LOAD_V4F32(az+i), YMSIMD_LOAD_V4F32(bz+i), acc);
+		YMSIMD_STOREU_V4F32(dst+i, acc);
+	}
+#else
+	for (YmUInt32 i = 0; i < n; i++) dst[i] = ax[i]*bx[i] + ay[i]*by[i] + az[i]*bz[i];
+#endif
+}
+
+/// dst = a ^ b (外積)
+inline void Cross(YmVector3Array& dst, const YmVector3Array& a, const YmVector3Array& b)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	const YmReal32 *ax = a.X(), *ay = a.Y(), *az = a.Z();
+	const YmReal32 *bx = b.X(), *by = b.Y(), *bz = b.Z();
+	YmReal32 *dx = dst.X(), *dy = dst.Y(), *dz = dst.Z();
+#if YM_USE_SIMD
+	YM_VA_LOOP(n)
+	{
+		const YmV4F32 vax = YMSIMD_LOAD_V4F32(ax+i), vay = YMSIMD_LOAD_V4F32(ay+i), vaz = YMSIMD_LOAD_V4F32(az+i);
+		const YmV4F32 vbx = YMSIMD_LOAD_V4F32(bx+i), vby = YMSIMD_LOAD_V4F32(by+i), vbz = YMSIMD_LOAD_V4F32(bz+i);
+		YMSIMD_STORE_V4F32(dx+i, YMSIMD_SUB_V4F32(YMSIMD_MUL_V4F32(vay, vbz), YMSIMD_MUL_V4F32(vaz, vby)));
+		YMSIMD_STORE_V4F32(dy+i, YMSIMD_SUB_V4F32(YMSIMD_MUL_V4F32(vaz, vbx), YMSIMD_MUL_V4F32(vax, vbz)));
+		YMSIMD_STORE_V4F32(dz+i, YMSIMD_SUB_V4F32(YMSIMD_MUL_V4F32(vax, vby), YMSIMD_MUL_V4F32(vay, vbx)));
+	}
+#else
+	for (YmUInt32 i = 0; i < n; i++)
+	{
+		const YmReal32 x = ay[i]*bz[i] - az[i]*by[i];
+		const YmReal32 y = az[i]*bx[i] - ax[i]*bz[i];
+		const YmReal32 z = ax[i]*by[i] - ay[i]*bx[i];
+		dx[i] = x; dy[i] = y; dz[i] = z;
+	}
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			正規化
+ * @param[out]		len		正規化前の長さ (nullptr 可、GetPaddedCount() 要素分)
+ * @note			長さ 0 の要素は 0 ベクトルのまま
+ **************************************************************************/
+inline void Normalize(YmVector3Array& dst, const YmVector3Array& a, YmReal32* len = nullptr)
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	const YmReal32 *ax = a.X(), *ay = a.Y(), *az = a.Z();
+	YmReal32 *dx = dst.X(), *dy = dst.Y(), *dz = dst.Z();
+#if YM_USE_SIMD
+	const YmV4F32 tiny = YMSIMD_SET_V4F32(1.e-37f);
+	const YmV4F32 one = YMSIMD_SET_V4F32(1.0f);
+	YM_VA_LOOP(n)
+	{
+		const YmV4F32 x = YMSIMD_LOAD_V4F32(ax+i), y = YMSIMD_LOAD_V4F32(ay+i), z = YMSIMD_LOAD_V4F32(az+i);
+		const YmV4F32 l = YMSIMD_SQRT_V4F32(YMSIMD_MADD_V4F32(x, x, YMSIMD_MADD_V4F32(y, y, YMSIMD_MUL_V4F32(z, z))));
+		const YmV4F32 r = YMSIMD_DIV_V4F32(one, YMSIMD_MAX_V4F32(l, tiny));
+		YMSIMD_STORE_V4F32(dx+i, YMSIMD_MUL_V4F32(x, r));
+		YMSIMD_STORE_V4F32(dy+i, YMSIMD_MUL_V4F32(y, r));
+		YMSIMD_STORE_V4F32(dz+i, YMSIMD_MUL_V4F32(z, r));
+		if (len != nullptr) YMSIMD_STOREU_V4F32(len+i, l);
+	}
+#else
+	for (YmUInt32 i = 0; i < n; i++)
+	{
+		const YmReal32 l = sqrtf(ax[i]*ax[i] + ay[i]*ay[i] + az[i]*az[i]);
+		const YmReal32 r = 1.0f / Max(l, 1.e-37f);
+		dx[i] = ax[i]*r; dy[i] = ay[i]*r; dz[i] = az[i]*r;
+		if (len != nullptr) len[i] = l;
+	}
+#endif
+}
+
+/***********************************************************************//**
+ * @brief			リスナー座標系への変換  dst = R * (a - origin)
+ * @param[in]		rot		回転行列 (行優先 3x3、行がリスナーの right/up/front 軸)
+ **************************************************************************/
+inline void ToLocal(YmVector3Array& dst, const YmVector3Array& a, const YmVector3& origin, const YmReal32 rot[9])
+{
+	dst.Resize(a.GetCount());
+	const YmUInt32 n = a.GetPaddedCount();
+	const YmReal32 *ax = a.X(), *ay = a.Y(), *az = a.Z();
+	YmReal32 *dx = dst.X(), *dy = dst.Y(), *dz = dst.Z();
+#if YM_USE_SIMD
+	const YmV4F32 ox = YMSIMD_SET_V4F32(origin.x), oy = YMSIMD_SET_V4F32(origin.y), oz = YMSIMD_SET_V4F32(origin.z);
+	YmV4F32 m[9];
+	for (int k = 0; k < 9; k++) m[k] = YMSIMD_SET_V4F32(rot[k]);
+	YM_VA_LOOP(n)
+	{
+		const YmV4F32 x = YMSIMD_SUB_V4F32(YMSIMD_LOAD_V4F32(ax+i), ox);
+		const YmV4F32 y = YMSIMD_SUB_V4F32(YMSIMD_LOAD_V4F32(ay+i), oy);
+		const YmV4F32 z = YMSIMD_SUB_V4F32(YMSIMD_LOAD_V4F32(az+i), oz);
+		YMSIMD_STORE_V4F32(dx+i, YMSIMD_MADD_V4F32(m[0], x, YMSIMD_MADD_V4F32(m[1], y, YMSIMD_MUL_V4F32(m[2], z))));
+		YMSIMD_STORE_V4F32(dy+i, YMSIMD_MADD_V4F32(m[3], x, YMSIMD_MADD_V4F32(m[4], y, YMSIMD_MUL_V4F32(m[5], z))));
+		YMSIMD_STORE_V4F32(dz+i, YMSIMD_MADD_V4F32(m[6], x, YMSIMD_MADD_V4F32(m[7], y, YMSIMD_MUL_V4F32(m[8], z))));
+	}
+#else
+	for (YmUInt32 i = 0; i < n; i++)
+	{
+		const YmReal32 x = ax[i] - origin.x, y = ay[i] - origin.y, z = az[i] - origin.z;
+		dx[i] = rot[0]*x + rot[1]*y + rot[2]*z;
+		dy[i] = rot[3]*x + rot[4]*y + rot[5]*z;
+		dz[i] = rot[6]*x + rot[7]*y + rot[8]*z;
+	}
+#endif
+}
+
+/// 直交座標 -> 極座標 (YmMathBatch.h の一括版)
+inline void RectToPolar(YmPolar3Array& dst, const YmVector3Array& src)
+{
+	dst.Resize(src.GetCount());
+	RectToPolar(src.X(), src.Y(), src.Z(), dst.Azim(), dst.Elev(), dst.Dist(), src.GetPaddedCount());
+}
+
+/// 極座標 -> 直交座標
+inline void PolarToRect(YmVector3Array& dst, const YmPolar3Array& src)
+{
+	dst.Resize(src.GetCount());
+	PolarToRect(src.Azim(), src.Elev(), src.Dist(), dst.X(), dst.Y(), dst.Z(), src.GetPaddedCount());
+}
+
+} // namespace YmMath
+
+#if YM_USE_SIMD
+	#undef YM_VA_LOOP
+#endif
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
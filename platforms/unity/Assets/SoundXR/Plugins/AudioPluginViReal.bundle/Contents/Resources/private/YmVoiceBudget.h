@@ -0,0 +1,430 @@
+﻿/*****************************************************************************************//**
+ * @file			YmVoiceBudget.h
+ * @brief			全ボイスの処理量の上限と優先度による仮想化
+ * @attention		生きている全スペーシャライザのボイスを 1 つの YmVoiceBudget に登録し、
+ *					ブロックごとに可聴度 (ボリューム x 距離減衰ゲイン x 優先度) で順位を付ける。
+ *					上位から、実ボイス数の上限と処理時間の上限 (ブロック時間に対する割合) に収まる
+ *					ところまでを実ボイスとし、残りは仮想ボイスとする。
+ *
+ *					・仮想ボイスは状態 (パラメータ・方向など) を保ったまま DSP を飛ばし、無音を出す。
+ *					・実 / 仮想の切替は YmVirtualVoice で 1 ブロックかけてフェードする。
+ *					  仮想から戻るブロックでは畳込みのオーバーラップなどをリセットしてから処理する。
+ *					・処理時間はボイスごとに実測 (AddCost()) し、指数平均を順位付けに使う。
+ *					・順位付けはそのティックで最初に Update() を呼んだボイスのスレッドで行う (ロックなし)。
+ *					  ティックが前回の順位付けと異なれば順位付けするので、ホスト側でティックが
+ *					  巻き戻っても (再生の再開など) 止まらない。報告の途絶えたボイスの判定も
+ *					  ティックではなく順位付けの回数で行う。
+ *					・スロットは登録ごとに世代を進め、順位付けの結果は同じ世代のままの場合のみ書き込む
+ *					  (順位付け中に解放・再登録されたスロットに前のボイスの結果を残さない)。
+ *
+ *					GetAttenuation() は Unity の distanceattenuationcallback からそのまま返せる値で、
+ *					Unity 側のボイスの優先度付けにもこのライブラリの距離減衰を反映できる。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+
+#if YM_USE_VOICE_BUDGET
+
+#include <math.h>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+#include "private/YmMath.h"
+
+#define YM_VOICE_BUDGET_ALIGNMENT		64		///< スロット境界のアライメント (キャッシュライン)
+#define YM_VOICE_BUDGET_STALE_BLOCKS	4		///< この回数の順位付けの間 Update() のないボイスは順位付けから外す (一時停止など)
+#define YM_VOICE_BUDGET_COST_SMOOTHING	0.1f	///< 処理時間の指数平均の係数
+
+/***********************************************************************//**
+ * @brief			上限の設定
+ **************************************************************************/
+struct YmVoiceBudgetConfig
+{
+	YmUInt32	maxRealVoices;		///< 実ボイス数の上限 (0: 無制限)
+	YmReal32	cpuFraction;		///< 実ボイスの処理時間の合計の上限 (ブロック時間に対する割合, 0: 無制限)
+	YmReal32	minAudibility;		///< これ未満の可聴度のボイスは常に仮想化する (線形)
+	YmReal32	hysteresis;			///< 実ボイスの可聴度に掛ける倍率 (順位の入替わりによるばたつき防止)
+
+	YmVoiceBudgetConfig() : maxRealVoices(64), cpuFraction(0.5f), minAudibility(YmMath::dBToLin(-80.0f)), hysteresis(1.25f) {}
+};
+
+/***********************************************************************//**
+ * @brief			ボイス数・処理時間の管理 (全インスタンスで共有)
+ * @note			Register() / Unregister() は Unity の create / release コールバックから、
+ *					Update() / AddCost() はボイスの process コールバックから呼ぶ。
+ *					1 つのハンドルの Update() / AddCost() は同時に 1 スレッドからのみ呼ぶこと。
+ **************************************************************************/
+class YmVoiceBudget
+{
+public:
+	YmVoiceBudget() : m_pAllocator(nullptr), m_pSlots(nullptr), m_pOrder(nullptr), m_pScore(nullptr), m_pGeneration(nullptr),
+		m_numSlots(0), m_blockSize(0), m_budgetNs(0.0f), m_rankedTick(NO_TICK), m_rankCount(0), m_numReal(0), m_numVirtual(0), m_totalCost(0.0f)
+	{
+		m_ranking.clear();
+	}
+	~YmVoiceBudget() { Term(); }
+
+	YmVoiceBudget(const YmVoiceBudget&) = delete;
+	YmVoiceBudget& operator=(const YmVoiceBudget&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	maxVoices	登録できる最大ボイス数
+	 * @param[in]	sampleRate	サンプリング周波数 [Hz]
+	 * @param[in]	blockSize	1 ブロックのサンプル数 (処理時間の上限の計算に使う)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 maxVoices, YmUInt32 sampleRate, YmUInt32 blockSize,
+		const YmVoiceBudgetConfig& config = YmVoiceBudgetConfig())
+	{
+		Term();
+		if (maxVoices == 0 || sampleRate == 0 || blockSize == 0) return false;
+
+		m_pSlots = static_cast<Slot*>(alloc_memory(in_pAllocator, sizeof(Slot)*maxVoices, YM_VOICE_BUDGET_ALIGNMENT));
+		m_pOrder = static_cast<YmUInt32*>(alloc_memory(in_pAllocator, sizeof(YmUInt32)*maxVoices, 16));
+		m_pScore = static_cast<YmReal32*>(alloc_memory(in_pAllocator, sizeof(YmReal32)*maxVoices, 16));
+		m_pGeneration = static_cast<YmUInt32*>(alloc_memory(in_pAllocator, sizeof(YmUInt32)*maxVoices, 16));
+		if (m_pSlots == nullptr || m_pOrder == nullptr || m_pScore == nullptr || m_pGeneration == nullptr)
+		{
+			free_memory(in_pAllocator, m_pSlots);
+			free_memory(in_pAllocator, m_pOrder);
+			free_memory(in_pAllocator, m_pScore);
+			free_memory(in_pAllocator, m_pGeneration);
+			m_pSlots = nullptr;
+			m_pOrder = nullptr;
+			m_pScore = nullptr;
+			m_pGeneration = nullptr;
+			return false;
+		}
+		for (YmUInt32 i = 0; i < maxVoices; i++) new (&m_pSlots[i]) Slot();
+
+		m_pAllocator = in_pAllocator;
+		m_numSlots = maxVoices;
+		m_blockSize = blockSize;
+		m_config = config;
+		m_budgetNs = (config.cpuFraction > 0.0f) ? config.cpuFraction*1.0e9f*(YmReal32)blockSize / (YmReal32)sampleRate : 0.0f;
+		m_rankedTick.store(NO_TICK, std::memory_order_relaxed);
+		m_rankCount.store(0, std::memory_order_relaxed);
+		m_numReal.store(0, std::memory_order_relaxed);
+		m_numVirtual.store(0, std::memory_order_relaxed);
+		m_totalCost.store(0.0f, std::memory_order_relaxed);
+		return true;
+	}
+
+	void Term(void)
+	{
+		if (m_pSlots == nullptr) return;
+		for (YmUInt32 i = 0; i < m_numSlots; i++) m_pSlots[i].~Slot();
+		free_memory(m_pAllocator, m_pSlots);
+		free_memory(m_pAllocator, m_pOrder);
+		free_memory(m_pAllocator, m_pScore);
+		free_memory(m_pAllocator, m_pGeneration);
+		m_pAllocator = nullptr;
+		m_pSlots = nullptr;
+		m_pOrder = nullptr;
+		m_pScore = nullptr;
+		m_pGeneration = nullptr;
+		m_numSlots = 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		ボイスの登録
+	 * @param[in]	priority	可聴度に掛ける優先度 (1.0 が標準, 大きいほど実ボイスに残りやすい)
+	 * @return		ハンドル。空きがなければ -1 (そのボイスは常に実ボイスとして扱うこと)
+	 * @note		発音の頭を欠かさないよう、次の順位付けまでは実ボイスとして扱う。
+	 **************************************************************************/
+	YmInt32 Register(YmReal32 priority = 1.0f)
+	{
+		for (YmUInt32 i = 0; i < m_numSlots; i++)
+		{
+			Slot& slot = m_pSlots[i];
+			YmUInt32 state = SLOT_FREE;
+			if (!slot.state.compare_exchange_strong(state, SLOT_RESERVED, std::memory_order_acquire)) continue;
+
+			slot.audibility.store(0.0f, std::memory_order_relaxed);
+			slot.attenuation.store(1.0f, std::memory_order_relaxed);
+			slot.priority.store(YmMath::Max(priority, 0.0f), std::memory_order_relaxed);
+			slot.cost.store(0.0f, std::memory_order_relaxed);
+			slot.lastRank.store(m_rankCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			slot.real.store(NextGeneration(slot) | REAL_BIT, std::memory_order_relaxed);
+			slot.hasUpdate.store(false, std::memory_order_relaxed);
+			slot.state.store(SLOT_ACTIVE, std::memory_order_release);
+			return (YmInt32)i;
+		}
+		return -1;
+	}
+
+	void Unregister(YmInt32 handle)
+	{
+		if (!IsValid(handle)) return;
+		Slot& slot = m_pSlots[handle];
+		slot.real.store(NextGeneration(slot), std::memory_order_relaxed);
+		slot.state.store(SLOT_FREE, std::memory_order_release);
+	}
+
+	void SetPriority(YmInt32 handle, YmReal32 priority)
+	{
+		if (!IsValid(handle)) return;
+		m_pSlots[handle].priority.store(YmMath::Max(priority, 0.0f), std::memory_order_relaxed);
+	}
+
+	/***********************************************************************//**
+	 * @brief		ブロック先頭の報告と実 / 仮想の判定 (1 ブロックに 1 回, 処理の前に呼ぶ)
+	 * @param[in]	tick		DSP ティック (UnityAudioEffectState::currdsptick など, 全ボイスで共通の値)
+	 * @param[in]	volume		ボリューム (線形)
+	 * @param[in]	attenuation	距離減衰ゲイン (線形)
+	 * @return		true: 実ボイス (DSP を行う), false: 仮想ボイス
+	 * @note		ティックが進んで最初に呼んだボイスが全ボイスの順位付けを行う。
+	 *				順位付けには前ブロックまでに報告された値を使う。
+ *				tick は前回の順位付けと異なれば進んだものとみなす (減っても順位付けする)。
+	 **************************************************************************/
+	bool Update(YmInt32 handle, YmUInt64 tick, YmReal32 volume, YmReal32 attenuation)
+	{
+		if (!IsValid(handle)) return true;
+		Slot& slot = m_pSlots[handle];
+		slot.attenuation.store(attenuation, std::memory_order_relaxed);
+		slot.audibility.store(fabsf(volume*attenuation), std::memory_order_relaxed);
+		slot.lastRank.store(m_rankCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		slot.hasUpdate.store(true, std::memory_order_release);
+
+		YmUInt64 ranked = m_rankedTick.load(std::memory_order_relaxed);
+		if (tick != ranked && m_rankedTick.compare_exchange_strong(ranked, tick, std::memory_order_relaxed))
+		{
+			if (!m_ranking.test_and_set(std::memory_order_acquire))
+			{
+				Rank();
+				m_ranking.clear(std::memory_order_release);
+			}
+		}
+		return (slot.real.load(std::memory_order_acquire) & REAL_BIT) != 0;
+	}
+
+	/***********************************************************************//**
+	 * @brief		このブロックの処理時間の報告 (DSP を行ったブロックのみ)
+	 * @param[in]	ns		処理時間 [ns] (Now() の差分)
+	 **************************************************************************/
+	void AddCost(YmInt32 handle, YmUInt64 ns)
+	{
+		if (!IsValid(handle)) return;
+		Slot& slot = m_pSlots[handle];
+		const YmReal32 cost = slot.cost.load(std::memory_order_relaxed);
+		const YmReal32 sample = (YmReal32)ns;
+		slot.cost.store((cost > 0.0f) ? cost + YM_VOICE_BUDGET_COST_SMOOTHING*(sample - cost) : sample, std::memory_order_relaxed);
+	}
+
+	/***********************************************************************//**
+	 * @brief		distanceattenuationcallback の attenuationOut に返す値
+	 * @param[in]	attenuationIn	Unity が AudioSource のカーブから計算した減衰
+	 * @note		最後に Update() で報告された距離減衰ゲイン。未報告なら attenuationIn をそのまま返す。
+	 *				仮想ボイスでも 0 にはしない (Unity にボイスを止められると Update() が呼ばれず復帰できない)。
+	 *
+	 *				UNITY_AUDIODSP_RESULT UNITY_AUDIODSP_CALLBACK DistanceAttenuationCallback(
+	 *					UnityAudioEffectState* state, float distanceIn, float attenuationIn, float* attenuationOut)
+	 *				{
+	 *					EffectData* data = state->GetEffectData<EffectData>();
+	 *					*attenuationOut = g_budget.GetAttenuation(data->budgetHandle, attenuationIn);
+	 *					return UNITY_AUDIODSP_OK;
+	 *				}
+	 **************************************************************************/
+	YmReal32 GetAttenuation(YmInt32 handle, YmReal32 attenuationIn) const
+	{
+		if (!IsValid(handle)) return attenuationIn;
+		const Slot& slot = m_pSlots[handle];
+		if (!slot.hasUpdate.load(std::memory_order_acquire)) return attenuationIn;
+		return slot.attenuation.load(std::memory_order_relaxed);
+	}
+
+	bool IsReal(YmInt32 handle) const			{ return !IsValid(handle) || (m_pSlots[handle].real.load(std::memory_order_relaxed) & REAL_BIT) != 0; }
+	YmUInt32 GetMaxVoices(void) const			{ return m_numSlots; }
+	/// 直前の順位付けの結果 (プロファイル用, 任意のスレッドから読める)
+	YmUInt32 GetNumReal(void) const				{ return m_numReal.load(std::memory_order_relaxed); }
+	YmUInt32 GetNumVirtual(void) const			{ return m_numVirtual.load(std::memory_order_relaxed); }
+	/// 直前の順位付けで実ボイスとした処理時間の見積りの合計 [ns]
+	YmReal32 GetEstimatedCost(void) const		{ return m_totalCost.load(std::memory_order_relaxed); }
+	YmReal32 GetBudget(void) const				{ return m_budgetNs; }
+
+	/// 処理時間の計測用の時刻 [ns]
+	static YmUInt64 Now(void)
+	{
+		return (YmUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	static const YmUInt64 NO_TICK = 0xFFFFFFFFFFFFFFFFull;
+	static const YmUInt32 REAL_BIT = 1u;		// Slot::real の最下位ビット (上位は世代)
+
+	enum
+	{
+		SLOT_FREE = 0,
+		SLOT_RESERVED,		// Register() の初期化中
+		SLOT_ACTIVE
+	};
+
+	struct alignas(YM_VOICE_BUDGET_ALIGNMENT) Slot
+	{
+		std::atomic<YmUInt32>	state;
+		std::atomic<YmReal32>	audibility;		// ボリューム x 距離減衰ゲイン
+		std::atomic<YmReal32>	attenuation;	// 距離減衰ゲイン (GetAttenuation() 用)
+		std::atomic<YmReal32>	priority;
+		std::atomic<YmReal32>	cost;			// 処理時間の指数平均 [ns] (0: 未計測)
+		std::atomic<YmUInt32>	lastRank;		// 最後の Update() 時点の順位付けの回数
+		std::atomic<YmUInt32>	real;			// [世代:31 | 実ボイス:1] (登録・解放ごとに世代を進める)
+		std::atomic<bool>		hasUpdate;
+
+		Slot() : state(SLOT_FREE), audibility(0.0f), attenuation(1.0f), priority(1.0f), cost(0.0f), lastRank(0), real(0), hasUpdate(false) {}
+	};
+
+	bool IsValid(YmInt32 handle) const { return handle >= 0 && (YmUInt32)handle < m_numSlots; }
+
+	// 次の世代 (実ボイスのビットは 0)
+	static YmUInt32 NextGeneration(const Slot& slot)
+	{
+		return (slot.real.load(std::memory_order_relaxed) & ~REAL_BIT) + 2u;
+	}
+
+	// 順位付けの結果の書込み (順位付け中に解放・再登録されて世代が変わっていれば書かない)
+	static void StoreReal(Slot& slot, YmUInt32 generation, bool isReal)
+	{
+		YmUInt32 expected = slot.real.load(std::memory_order_relaxed);
+		while ((expected & ~REAL_BIT) == generation
+			&& !slot.real.compare_exchange_weak(expected, generation | (isReal ? REAL_BIT : 0u), std::memory_order_release, std::memory_order_relaxed)) {}
+	}
+
+	// 可聴度の高い順に、上限に収まるところまでを実ボイスにする
+	void Rank(void)
+	{
+		const YmUInt32 rankCount = m_rankCount.fetch_add(1, std::memory_order_relaxed) + 1;
+		YmUInt32 numVoices = 0;
+		YmReal32 measuredCost = 0.0f;
+		YmUInt32 numMeasured = 0;
+		for (YmUInt32 i = 0; i < m_numSlots; i++)
+		{
+			Slot& slot = m_pSlots[i];
+			if (slot.state.load(std::memory_order_acquire) != SLOT_ACTIVE) continue;
+			const YmUInt32 real = slot.real.load(std::memory_order_acquire);
+			// 登録直後でまだ報告のないボイスは Register() の状態 (実ボイス) のまま
+			if (!slot.hasUpdate.load(std::memory_order_acquire)) continue;
+			if (rankCount - slot.lastRank.load(std::memory_order_relaxed) > YM_VOICE_BUDGET_STALE_BLOCKS)
+			{
+				StoreReal(slot, real & ~REAL_BIT, false);
+				continue;
+			}
+			YmReal32 score = slot.audibility.load(std::memory_order_relaxed)*slot.priority.load(std::memory_order_relaxed);
+			if ((real & REAL_BIT) != 0) score *= m_config.hysteresis;
+			m_pGeneration[i] = real & ~REAL_BIT;
+			m_pScore[i] = score;
+			m_pOrder[numVoices++] = i;
+
+			const YmReal32 cost = slot.cost.load(std::memory_order_relaxed);
+			if (cost > 0.0f)
+			{
+				measuredCost += cost;
+				numMeasured++;
+			}
+		}
+
+		const YmReal32* score = m_pScore;
+		std::sort(m_pOrder, m_pOrder + numVoices, [score](YmUInt32 a, YmUInt32 b) { return score[a] > score[b]; });
+
+		// 未計測のボイスは計測済みボイスの平均で見積もる
+		const YmReal32 defaultCost = (numMeasured > 0) ? measuredCost / (YmReal32)numMeasured : 0.0f;
+		YmUInt32 numReal = 0;
+		YmReal32 totalCost = 0.0f;
+		bool isFull = false;
+		for (YmUInt32 n = 0; n < numVoices; n++)
+		{
+			const YmUInt32 i = m_pOrder[n];
+			Slot& slot = m_pSlots[i];
+			YmReal32 cost = slot.cost.load(std::memory_order_relaxed);
+			if (cost <= 0.0f) cost = defaultCost;
+
+			if (!isFull && m_config.maxRealVoices > 0 && numReal >= m_config.maxRealVoices) isFull = true;
+			// 1 ボイスで上限を超える場合も、最上位のボイスは鳴らす
+			if (!isFull && m_budgetNs > 0.0f && numReal > 0 && totalCost + cost > m_budgetNs) isFull = true;
+
+			const bool isReal = !isFull && m_pScore[i] >= m_config.minAudibility;
+			if (isReal)
+			{
+				numReal++;
+				totalCost += cost;
+			}
+			StoreReal(slot, m_pGeneration[i], isReal);
+		}
+
+		m_numReal.store(numReal, std::memory_order_relaxed);
+		m_numVirtual.store(numVoices - numReal, std::memory_order_relaxed);
+		m_totalCost.store(totalCost, std::memory_order_relaxed);
+	}
+
+	YmMemAlloc*				m_pAllocator;
+	Slot*					m_pSlots;
+	YmUInt32*				m_pOrder;		// 順位付けの作業領域 (順位付け中のスレッドのみ触る)
+	YmReal32*				m_pScore;
+	YmUInt32*				m_pGeneration;	// 順位付け対象にしたときのスロットの世代
+	YmUInt32				m_numSlots;
+	YmUInt32				m_blockSize;
+	YmReal32				m_budgetNs;		// 実ボイスの処理時間の上限 [ns] (0: 無制限)
+	YmVoiceBudgetConfig		m_config;
+	std::atomic<YmUInt64>	m_rankedTick;	// 最後に順位付けしたティック
+	std::atomic<YmUInt32>	m_rankCount;	// 順位付けの回数 (ボイスの報告の途絶えの判定用)
+	std::atomic_flag		m_ranking;		// 順位付け中
+	std::atomic<YmUInt32>	m_numReal;
+	std::atomic<YmUInt32>	m_numVirtual;
+	std::atomic<YmReal32>	m_totalCost;
+};
+
+/***********************************************************************//**
+ * @brief			ボイスごとの実 / 仮想の切替の状態
+ * @note			YmVoiceBudget::Update() の結果を渡し、IsProcessing() のブロックだけ DSP を行う。
+ *					出力には GetFadeGains() のゲインを掛ける (実になるブロック 0 -> 1, 仮想になるブロック 1 -> 0)。
+ **************************************************************************/
+class YmVirtualVoice
+{
+public:
+	YmVirtualVoice() : m_isReal(false), m_wasReal(false), m_isFirst(true) {}
+
+	/// 次の Update() はフェードせずに状態を決める (音源の再生開始時など)
+	void Reset(void)
+	{
+		m_isReal = m_wasReal = false;
+		m_isFirst = true;
+	}
+
+	void Update(bool isReal)
+	{
+		m_wasReal = m_isFirst ? isReal : m_isReal;
+		m_isReal = isReal;
+		m_isFirst = false;
+	}
+
+	void GetFadeGains(YmReal32& gainStart, YmReal32& gainEnd) const
+	{
+		gainStart = m_wasReal ? 1.0f : 0.0f;
+		gainEnd   = m_isReal ? 1.0f : 0.0f;
+	}
+
+	/// このブロックで DSP が必要か (仮想になるブロックはフェードアウトのため処理する)
+	bool IsProcessing(void) const	{ return m_isReal || m_wasReal; }
+	/// 仮想から実に戻るブロックか (DSP の履歴をリセットしてから処理する)
+	bool IsRealizing(void) const	{ return m_isReal && !m_wasReal; }
+	bool IsFading(void) const		{ return m_isReal != m_wasReal; }
+	bool IsReal(void) const			{ return m_isReal; }
+
+private:
+	bool	m_isReal;
+	bool	m_wasReal;		// 前ブロックの状態 (m_isReal と異なればフェード中)
+	bool	m_isFirst;
+};
+
+#endif // YM_USE_VOICE_BUDGET
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
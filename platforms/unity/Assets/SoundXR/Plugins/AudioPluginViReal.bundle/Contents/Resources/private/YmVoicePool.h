@@ -0,0 +1,191 @@
+﻿/*****************************************************************************************//**
+ * @file			YmVoicePool.h
+ * @brief			ボイス単位の固定長スロットプール (ロックフリー) とスロット内アリーナ
+ * @attention		Init() でスロット N 個分を連続領域として一括確保する。
+ *					Acquire() / Release() はシステムヒープに触れず、複数スレッドから呼べる。
+ *
+ *					Unity の create コールバックで Acquire()、release コールバックで Release() し、
+ *					スロット内の HRTF 状態・FFT 作業領域・オーバーラップバッファは
+ *					YmSlotArena で切り出して使う想定。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include "private/YmTypes.h"
+#include "private/YmMemory.h"
+
+#define YM_VOICE_POOL_ALIGNMENT		64		///< スロット境界のアライメント (キャッシュライン)
+
+/***********************************************************************//**
+ * @brief			固定長スロットプール
+ * @note			空きリストはタグ付きインデックスの Treiber スタック (ABA 対策済み)
+ **************************************************************************/
+class YmVoicePool
+{
+public:
+	YmVoicePool() : m_pAllocator(nullptr), m_pBlock(nullptr), m_pNext(nullptr), m_pSlots(nullptr),
+		m_numSlots(0), m_slotSize(0), m_head(EMPTY_HEAD), m_numUsed(0) {}
+	~YmVoicePool() { Term(); }
+
+	YmVoicePool(const YmVoicePool&) = delete;
+	YmVoicePool& operator=(const YmVoicePool&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		初期化 (非オーディオスレッドで呼ぶこと)
+	 * @param[in]	numSlots	スロット数 (最大ボイス数)
+	 * @param[in]	slotSize	1 スロットのバイト数 (キャッシュライン単位に切り上げる)
+	 **************************************************************************/
+	bool Init(YmMemAlloc* in_pAllocator, YmUInt32 numSlots, size_t slotSize)
+	{
+		Term();
+		if (numSlots == 0 || slotSize == 0) return false;
+
+		m_slotSize = (slotSize + YM_VOICE_POOL_ALIGNMENT - 1) & ~(size_t)(YM_VOICE_POOL_ALIGNMENT - 1);
+		const size_t nextSize = (sizeof(std::atomic<YmUInt32>)*numSlots + YM_VOICE_POOL_ALIGNMENT - 1) & ~(size_t)(YM_VOICE_POOL_ALIGNMENT - 1);
+		m_pBlock = static_cast<YmUInt8*>(alloc_memory(in_pAllocator, nextSize + m_slotSize*numSlots, YM_VOICE_POOL_ALIGNMENT));
+		if (m_pBlock == nullptr) return false;
+
+		m_pAllocator = in_pAllocator;
+		m_numSlots = numSlots;
+		m_pNext = reinterpret_cast<std::atomic<YmUInt32>*>(m_pBlock);
+		m_pSlots = m_pBlock + nextSize;
+		for (YmUInt32 i = 0; i < numSlots; i++)
+		{
+			new (&m_pNext[i]) std::atomic<YmUInt32>((i + 1 < numSlots) ? i + 1 : EMPTY_INDEX);
+		}
+		m_head.store(0, std::memory_order_release);
+		m_numUsed.store(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	/***********************************************************************//**
+	 * @brief		解放 (非オーディオスレッドで呼ぶこと)
+	 * @note		取得中のスロットが残っていないこと (GetNumUsed() == 0) を確認してから呼ぶこと。
+	 *				スロット領域はまとめて解放されるため、返却前のスロットのポインタはすべて無効になる。
+	 **************************************************************************/
+	void Term(void)
+	{
+		if (m_pBlock == nullptr) return;
+		free_memory(m_pAllocator, m_pBlock);
+		m_pAllocator = nullptr;
+		m_pBlock = nullptr;
+		m_pNext = nullptr;
+		m_pSlots = nullptr;
+		m_numSlots = 0;
+		m_slotSize = 0;
+		m_head.store(EMPTY_HEAD, std::memory_order_relaxed);
+		m_numUsed.store(0, std::memory_order_relaxed);
+	}
+
+	/***********************************************************************//**
+	 * @brief		スロット取得 (ロックフリー)
+	 * @return		空きがなければ nullptr。中身はゼロクリアしない。
+	 **************************************************************************/
+	void* Acquire(void)
+	{
+		YmUInt64 head = m_head.load(std::memory_order_acquire);
+		for (;;)
+		{
+			const YmUInt32 index = (YmUInt32)(head & 0xFFFFFFFFu);
+			if (index == EMPTY_INDEX) return nullptr;
+			const YmUInt32 next = m_pNext[index].load(std::memory_order_relaxed);
+			const YmUInt64 newHead = (((head >> 32) + 1) << 32) | next;
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+			{
+				m_numUsed.fetch_add(1, std::memory_order_relaxed);
+				return m_pSlots + m_slotSize*index;
+			}
+		}
+	}
+
+	/***********************************************************************//**
+	 * @brief		スロット返却 (ロックフリー)
+	 **************************************************************************/
+	void Release(void* slot)
+	{
+		if (slot == nullptr) return;
+		const YmUInt32 index = GetSlotIndex(slot);
+		YmUInt64 head = m_head.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			m_pNext[index].store((YmUInt32)(head & 0xFFFFFFFFu), std::memory_order_relaxed);
+			const YmUInt64 newHead = (((head >> 32) + 1) << 32) | index;
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+			{
+				m_numUsed.fetch_sub(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+	}
+
+	bool Contains(const void* slot) const
+	{
+		const YmUInt8* p = static_cast<const YmUInt8*>(slot);
+		return (p >= m_pSlots) && (p < m_pSlots + m_slotSize*m_numSlots);
+	}
+
+	YmUInt32 GetSlotIndex(const void* slot) const	{ return (YmUInt32)((static_cast<const YmUInt8*>(slot) - m_pSlots) / m_slotSize); }
+	YmUInt32 GetNumSlots(void) const				{ return m_numSlots; }
+	YmUInt32 GetNumUsed(void) const					{ return m_numUsed.load(std::memory_order_relaxed); }
+	size_t GetSlotSize(void) const					{ return m_slotSize; }
+
+private:
+	static const YmUInt32 EMPTY_INDEX = 0xFFFFFFFFu;
+	static const YmUInt64 EMPTY_HEAD = 0xFFFFFFFFull;
+
+	YmMemAlloc*					m_pAllocator;
+	YmUInt8*					m_pBlock;		// 空きリスト + スロット領域
+	std::atomic<YmUInt32>*		m_pNext;		// スロットごとの次の空きインデックス
+	YmUInt8*					m_pSlots;
+	YmUInt32					m_numSlots;
+	size_t						m_slotSize;
+	std::atomic<YmUInt64>		m_head;			// [tag:32 | index:32]
+	std::atomic<YmUInt32>		m_numUsed;
+};
+
+/***********************************************************************//**
+ * @brief			スロット内のバンプアロケータ
+ * @note			個別の解放は行わず、スロット返却時に Reset() でまとめて戻す。
+ *					カスタムアロケータ有効時は YmAllocator として alloc_memory() / YM_NEW に渡せる。
+ *					単一ボイス専用 (スレッドセーフではない)。
+ **************************************************************************/
+class YmSlotArena
+#if YM_USE_CUSTOM_ALLOCATOR && !defined(YM_TARGET_WWISE)
+	: public YmAllocator
+#endif
+{
+public:
+	YmSlotArena() : m_pBase(nullptr), m_size(0), m_offset(0) {}
+	YmSlotArena(void* base, size_t size) : m_pBase(static_cast<YmUInt8*>(base)), m_size(size), m_offset(0) {}
+
+	void Init(void* base, size_t size)	{ m_pBase = static_cast<YmUInt8*>(base); m_size = size; m_offset = 0; }
+	void Reset(void)					{ m_offset = 0; }
+
+	void* Malloc(size_t size, size_t align)
+	{
+		if (align == 0) align = 1;
+		const uintptr_t base = (uintptr_t)m_pBase;
+		const uintptr_t p = (base + m_offset + align - 1) & ~(uintptr_t)(align - 1);
+		if (p + size > base + m_size) return nullptr;
+		m_offset = (size_t)(p + size - base);
+		return (void*)p;
+	}
+
+	void Free(void* ptr)				{ (void)ptr; }
+
+	size_t GetUsed(void) const			{ return m_offset; }
+	size_t GetRemaining(void) const		{ return m_size - m_offset; }
+
+private:
+	YmUInt8*	m_pBase;
+	size_t		m_size;
+	size_t		m_offset;
+};
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,245 @@
+﻿/*****************************************************************************************//**
+ * @file			YmWorkerPool.h
+ * @brief			ボイス並列レンダリング用ワーカープール (ワークスティーリング)
+ * @attention		ParallelFor() は 1 スレッド (オーディオスレッド) からのみ呼ぶこと。
+ *
+ *					・タスクは 0..N-1 のインデックスで、参加者 (呼び出し元 + ワーカー) ごとの
+ *					  区間 [begin,end) に分配される。区間は 64bit の atomic 1 語で表し、
+ *					  所有者は先頭から、他の参加者は末尾から 1 つずつ CAS で取る (ロックフリー)。
+ *					・呼び出し元も処理に参加するため、ワーカーが起床しなくても完了する
+ *					  (最悪でも呼び出し元 1 スレッドでの処理時間で終わる)。
+ *					・各タスクは自分の出力バッファにのみ書き込み、ミックスは join 後に
+ *					  インデックス順で行うこと。スケジューリングによらず結果が一致する。
+ *					・ワーカーは spinMicroseconds の間ビジーウェイトし、その後スリープする。
+ *					  スリープ中のワーカーを起こす場合のみ呼び出し元で短いロックが発生する。
+ *					・呼び出し元は未着手のタスクをすべて自分で引き取ってから、ワーカーが実行中の
+ *					  タスクの完了を待つ。待ちは YM_WORKER_POOL_JOIN_SPIN 回のスピンの後は
+ *					  yield に切り替え、ワーカーが横取りされている間 CPU を占有し続けない。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include "private/YmTarget.h"
+
+#if YM_USE_WORKER_POOL
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include "private/YmTypes.h"
+#include "private/YmCpu.h"
+
+#if YM_CPU_X86
+	#include <emmintrin.h>
+#endif
+
+#define YM_WORKER_POOL_MAX_THREADS		63		///< ワーカー数の上限 (呼び出し元を除く)
+#define YM_WORKER_POOL_JOIN_SPIN		2000	///< 完了待ちで yield に切り替えるまでのスピン回数
+
+class YmWorkerPool
+{
+public:
+	typedef void (*TaskFunc)(void* context, YmUInt32 index);
+
+	YmWorkerPool() : m_numWorkers(0), m_spinMicroseconds(0), m_func(nullptr), m_pContext(nullptr),
+		m_epoch(0), m_remaining(0), m_numSleeping(0), m_quit(false) {}
+	~YmWorkerPool() { Term(); }
+
+	YmWorkerPool(const YmWorkerPool&) = delete;
+	YmWorkerPool& operator=(const YmWorkerPool&) = delete;
+
+	/***********************************************************************//**
+	 * @brief		ワーカースレッドの起動
+	 * @param[in]	numWorkers			ワーカー数 (0 なら呼び出し元のみで処理)
+	 * @param[in]	spinMicroseconds	スリープに入るまでのビジーウェイト時間
+	 **************************************************************************/
+	bool Init(YmUInt32 numWorkers, YmUInt32 spinMicroseconds = 500)
+	{
+		Term();
+		if (numWorkers > YM_WORKER_POOL_MAX_THREADS) numWorkers = YM_WORKER_POOL_MAX_THREADS;
+		m_quit.store(false, std::memory_order_relaxed);
+		m_spinMicroseconds = spinMicroseconds;
+		for (YmUInt32 i = 0; i <= YM_WORKER_POOL_MAX_THREADS; i++) m_ranges[i].value.store(0, std::memory_order_relaxed);
+		for (YmUInt32 i = 0; i < numWorkers; i++)
+		{
+			m_threads[i] = std::thread(&YmWorkerPool::WorkerMain, this, i + 1);
+		}
+		m_numWorkers = numWorkers;
+		return true;
+	}
+
+	void Term(void)
+	{
+		if (m_numWorkers == 0) return;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit.store(true, std::memory_order_release);
+			m_epoch.fetch_add(1, std::memory_order_release);
+		}
+		m_cv.notify_all();
+		for (YmUInt32 i = 0; i < m_numWorkers; i++) m_threads[i].join();
+		m_numWorkers = 0;
+	}
+
+	YmUInt32 GetNumWorkers(void) const	{ return m_numWorkers; }
+
+	/***********************************************************************//**
+	 * @brief		タスク 0..numTasks-1 を並列実行し、全て完了するまで待つ
+	 **************************************************************************/
+	void ParallelFor(YmUInt32 numTasks, TaskFunc func, void* context)
+	{
+		if (numTasks == 0) return;
+		if (m_numWorkers == 0 || numTasks == 1)
+		{
+			for (YmUInt32 i = 0; i < numTasks; i++) func(context, i);
+			return;
+		}
+
+		// 参加者ごとに連続区間を分配
+		const YmUInt32 numParticipants = m_numWorkers + 1;
+		m_func = func;
+		m_pContext = context;
+		m_remaining.store(numTasks, std::memory_order_relaxed);
+		for (YmUInt32 p = 0; p < numParticipants; p++)
+		{
+			const YmUInt32 begin = (YmUInt32)(((YmUInt64)numTasks*p) / numParticipants);
+			const YmUInt32 end   = (YmUInt32)(((YmUInt64)numTasks*(p + 1)) / numParticipants);
+			m_ranges[p].value.store(Pack(begin, end), std::memory_order_release);
+		}
+		// epoch と m_numSleeping は seq_cst (ワーカーのスリープ判定と対になる)
+		m_epoch.fetch_add(1);
+		if (m_numSleeping.load() != 0)
+		{
+			{ std::lock_guard<std::mutex> lock(m_mutex); }
+			m_cv.notify_all();
+		}
+
+		// 未着手のタスクは自分の区間・他の区間とも呼び出し元が引き取る
+		while (RunOne(0)) {}
+		// 残りはワーカーが実行中のもののみ。短時間はスピンし、その後は yield する
+		for (YmUInt32 spin = 0; m_remaining.load(std::memory_order_acquire) != 0; spin++)
+		{
+			if (spin < YM_WORKER_POOL_JOIN_SPIN) CpuRelax();
+			else std::this_thread::yield();
+		}
+	}
+
+private:
+	struct Range
+	{
+		alignas(64) std::atomic<YmUInt64>	value;		// [begin:32 | end:32]
+	};
+
+	static YmUInt64 Pack(YmUInt32 begin, YmUInt32 end)	{ return ((YmUInt64)begin << 32) | end; }
+	static YmUInt32 Begin(YmUInt64 v)					{ return (YmUInt32)(v >> 32); }
+	static YmUInt32 End(YmUInt64 v)						{ return (YmUInt32)(v & 0xFFFFFFFFu); }
+
+	static inline void CpuRelax(void)
+	{
+#if YM_CPU_X86
+		_mm_pause();
+#elif defined(__aarch64__)||defined(__arm__)
+		__asm__ __volatile__("yield");
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	// 自分の区間の先頭から 1 つ取る
+	bool PopOwn(YmUInt32 self, YmUInt32& index)
+	{
+		std::atomic<YmUInt64>& r = m_ranges[self].value;
+		YmUInt64 v = r.load(std::memory_order_acquire);
+		while (Begin(v) < End(v))
+		{
+			if (r.compare_exchange_weak(v, Pack(Begin(v) + 1, End(v)), std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				index = Begin(v);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// 他の参加者の区間の末尾から 1 つ奪う
+	// (奪った残りを自分の区間へ移すと、次のジョブで割り当てられた区間を上書きする恐れがあるため行わない)
+	bool Steal(YmUInt32 victim, YmUInt32& index)
+	{
+		std::atomic<YmUInt64>& r = m_ranges[victim].value;
+		YmUInt64 v = r.load(std::memory_order_acquire);
+		while (Begin(v) < End(v))
+		{
+			if (r.compare_exchange_weak(v, Pack(Begin(v), End(v) - 1), std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				index = End(v) - 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool RunOne(YmUInt32 self)
+	{
+		YmUInt32 index = 0;
+		bool found = PopOwn(self, index);
+		const YmUInt32 numParticipants = m_numWorkers + 1;
+		for (YmUInt32 i = 1; !found && i < numParticipants; i++)
+		{
+			found = Steal((self + i) % numParticipants, index);
+		}
+		if (!found) return false;
+		m_func(m_pContext, index);
+		m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+	void WorkerMain(YmUInt32 self)
+	{
+		YmUInt32 lastEpoch = m_epoch.load(std::memory_order_acquire);
+		for (;;)
+		{
+			// 新しいジョブを待つ (一定時間スピン後スリープ)
+			const std::chrono::steady_clock::time_point spinEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(m_spinMicroseconds);
+			while (m_epoch.load(std::memory_order_acquire) == lastEpoch)
+			{
+				if (std::chrono::steady_clock::now() < spinEnd)
+				{
+					CpuRelax();
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_numSleeping.fetch_add(1);
+				m_cv.wait(lock, [&]{ return m_epoch.load() != lastEpoch; });
+				m_numSleeping.fetch_sub(1, std::memory_order_acq_rel);
+			}
+			lastEpoch = m_epoch.load(std::memory_order_acquire);
+			if (m_quit.load(std::memory_order_acquire)) return;
+
+			while (RunOne(self)) {}
+		}
+	}
+
+	YmUInt32					m_numWorkers;
+	YmUInt32					m_spinMicroseconds;
+	TaskFunc					m_func;
+	void*						m_pContext;
+	std::atomic<YmUInt32>		m_epoch;
+	std::atomic<YmUInt32>		m_remaining;
+	std::atomic<YmUInt32>		m_numSleeping;
+	std::atomic<bool>			m_quit;
+	std::mutex					m_mutex;
+	std::condition_variable		m_cv;
+	Range						m_ranges[YM_WORKER_POOL_MAX_THREADS + 1];	// [0] は呼び出し元
+	std::thread					m_threads[YM_WORKER_POOL_MAX_THREADS];
+};
+
+#endif // YM_USE_WORKER_POOL
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,537 @@
+﻿/*****************************************************************************************//**
+ * @file			YmBench.cpp
+ * @brief			YmSimd / YmMath / 畳込カーネルのマイクロベンチマーク
+ * @attention		結果は 1 サンプル (複素数は 1 ビン) あたりの ns。
+ *					既定は JSON 配列、-csv で CSV を標準出力に出す。
+ *
+ *					ビルド (リポジトリのルートで):
+ *					  g++ -std=c++14 -O2 -msse3 \
+ *					      -Iplatforms/unity/Assets/SoundXR/Plugins/AudioPluginViReal.bundle/Contents/Resources \
+ *					      tools/YmBench/YmBench.cpp -o ymbench
+ *
+ *					使い方:
+ *					  ymbench [-csv] [-t seconds] [-f filter]
+ *
+ *					段階 (tier) ごとに YmSimd::ForceTier() で切り替えて計測する。
+ *					NEON 段は V4 カーネル (SSE3 段と同じ実装) を使うため、x86 上では
+ *					sse3 の結果が命令数の目安になる。NEON 実機の値は ARM 上で計測すること
+ *					(x86 上では unsupported として出力しない)。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "private/YmBase.h"
+#include "private/YmFft.h"
+#include "private/YmConvolver.h"
+#include "private/YmHrtfGrid.h"
+#include "private/YmCommandQueue.h"
+#include "private/YmResampler.h"
+#include "private/YmAmbisonic.h"
+#include "private/YmLod.h"
+#include "private/YmVoiceBudget.h"
+#include "private/YmBatchSpatializer.h"
+#include "private/YmWorkerPool.h"
+#include <thread>
+
+namespace {
+
+struct Result
+{
+	std::string	name;
+	std::string	tier;
+	YmUInt32	size;
+	double		nsPerSample;
+};
+
+struct Context
+{
+	double				minSeconds;
+	const char*			filter;
+	std::vector<Result>	results;
+};
+
+volatile YmReal32 g_sink;
+
+/***********************************************************************//**
+ * @brief			計測 (minSeconds 以上回して、5 回中の最良値)
+ * @param[in]		samplesPerCall	1 回の呼び出しで処理するサンプル数
+ **************************************************************************/
+template <class F> void Measure(Context& ctx, const char* name, const char* tier, YmUInt32 size, YmUInt32 samplesPerCall, F func)
+{
+	char label[256];
+	snprintf(label, sizeof(label), "%s/%s/%u", name, tier, size);
+	if (ctx.filter && strstr(label, ctx.filter) == nullptr) return;
+
+	typedef std::chrono::steady_clock Clock;
+	// 回数の決定
+	YmUInt64 iterations = 1;
+	for (;;)
+	{
+		const Clock::time_point t0 = Clock::now();
+		for (YmUInt64 i = 0; i < iterations; i++) func();
+		const double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		if (sec >= ctx.minSeconds/5.0 || iterations >= (1ull << 40)) break;
+		iterations *= 2;
+	}
+	double best = 1e30;
+	for (int r = 0; r < 5; r++)
+	{
+		const Clock::time_point t0 = Clock::now();
+		for (YmUInt64 i = 0; i < iterations; i++) func();
+		const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+		if (ns < best) best = ns;
+	}
+	Result res;
+	res.name = name;
+	res.tier = tier;
+	res.size = size;
+	res.nsPerSample = best / ((double)iterations * samplesPerCall);
+	ctx.results.push_back(res);
+	fprintf(stderr, "%-40s %10.4f ns/sample\n", label, res.nsPerSample);
+}
+
+void Fill(std::vector<YmReal32>& v, YmUInt32 seed)
+{
+	for (size_t i = 0; i < v.size(); i++)
+	{
+		seed = seed*1664525u + 1013904223u;
+		v[i] = (YmReal32)(seed >> 8)/(YmReal32)(1u << 24) - 0.5f;
+	}
+}
+
+/***********************************************************************//**
+ * @brief			YMSIMD マクロ単体 (ADD / MUL / MADD / COMPLEXMUL)
+ **************************************************************************/
+#define YM_BENCH_MACRO_SIZE		1024
+
+void BenchMacrosV4(Context& ctx, const char* tier)
+{
+	std::vector<YmReal32> a(YM_BENCH_MACRO_SIZE), b(YM_BENCH_MACRO_SIZE), c(YM_BENCH_MACRO_SIZE);
+	Fill(a, 1); Fill(b, 2);
+	const YmUInt32 N = YM_BENCH_MACRO_SIZE;
+	Measure(ctx, "YMSIMD_ADD", tier, N, N, [&]() {
+		for (YmUInt32 i = 0; i < N; i += 4) YMSIMD_STOREU_V4F32(&c[i], YMSIMD_ADD_V4F32(YMSIMD_LOADU_V4F32(&a[i]), YMSIMD_LOADU_V4F32(&b[i])));
+		g_sink = c[0];
+	});
+	Measure(ctx, "YMSIMD_MUL", tier, N, N, [&]() {
+		for (YmUInt32 i = 0; i < N; i += 4) YMSIMD_STOREU_V4F32(&c[i], YMSIMD_MUL_V4F32(YMSIMD_LOADU_V4F32(&a[i]), YMSIMD_LOADU_V4F32(&b[i])));
+		g_sink = c[0];
+	});
+	Measure(ctx, "YMSIMD_MADD", tier, N, N, [&]() {
+		for (YmUInt32 i = 0; i < N; i += 4) YMSIMD_STOREU_V4F32(&c[i], YMSIMD_MADD_V4F32(YMSIMD_LOADU_V4F32(&a[i]), YMSIMD_LOADU_V4F32(&b[i]), YMSIMD_LOADU_V4F32(&c[i])));
+		g_sink = c[0];
+	});
+	Measure(ctx, "YMSIMD_COMPLEXMUL", tier, N/2, N/2, [&]() {
+		for (YmUInt32 i = 0; i < N; i += 4) YMSIMD_STOREU_V4F32(&c[i], YMSIMD_COMPLEXMUL(YMSIMD_LOADU_V4F32(&a[i]), YMSIMD_LOADU_V4F32(&b[i])));
+		g_sink = c[0];
+	});
+}
+
+#if YM_USE_SIMD_WIDE
+YM_TARGET_AVX2 void MacroLoopV8(int op, const YmReal32* a, const YmReal32* b, YmReal32* c, YmUInt32 n)
+{
+	for (YmUInt32 i = 0; i < n; i += 8)
+	{
+		const YmV8F32 va = YMSIMD_LOADU_V8F32(a + i), vb = YMSIMD_LOADU_V8F32(b + i);
+		YmV8F32 r;
+		switch (op)
+		{
+		case 0:		r = YMSIMD_ADD_V8F32(va, vb); break;
+		case 1:		r = YMSIMD_MUL_V8F32(va, vb); break;
+		case 2:		r = YMSIMD_MADD_V8F32(va, vb, YMSIMD_LOADU_V8F32(c + i)); break;
+		default:	r = YMSIMD_COMPLEXMUL_V8F32(va, vb); break;
+		}
+		YMSIMD_STOREU_V8F32(c + i, r);
+	}
+}
+
+YM_TARGET_AVX512 void MacroLoopV16(int op, const YmReal32* a, const YmReal32* b, YmReal32* c, YmUInt32 n)
+{
+	for (YmUInt32 i = 0; i < n; i += 16)
+	{
+		const YmV16F32 va = YMSIMD_LOADU_V16F32(a + i), vb = YMSIMD_LOADU_V16F32(b + i);
+		YmV16F32 r;
+		switch (op)
+		{
+		case 0:		r = YMSIMD_ADD_V16F32(va, vb); break;
+		case 1:		r = YMSIMD_MUL_V16F32(va, vb); break;
+		case 2:		r = YMSIMD_MADD_V16F32(va, vb, YMSIMD_LOADU_V16F32(c + i)); break;
+		default:	r = YMSIMD_COMPLEXMUL_V16F32(va, vb); break;
+		}
+		YMSIMD_STOREU_V16F32(c + i, r);
+	}
+}
+
+void BenchMacrosWide(Context& ctx, const char* tier, void (*loop)(int, const YmReal32*, const YmReal32*, YmReal32*, YmUInt32))
+{
+	static const char* s_names[] = { "YMSIMD_ADD", "YMSIMD_MUL", "YMSIMD_MADD", "YMSIMD_COMPLEXMUL" };
+	std::vector<YmReal32> a(YM_BENCH_MACRO_SIZE), b(YM_BENCH_MACRO_SIZE), c(YM_BENCH_MACRO_SIZE);
+	Fill(a, 1); Fill(b, 2);
+	const YmUInt32 N = YM_BENCH_MACRO_SIZE;
+	for (int op = 0; op < 4; op++)
+	{
+		const YmUInt32 count = (op == 3) ? N/2 : N;
+		Measure(ctx, s_names[op], tier, count, count, [&]() { loop(op, &a[0], &b[0], &c[0], N); g_sink = c[0]; });
+	}
+}
+#endif
+
+/***********************************************************************//**
+ * @brief			カーネルテーブル (選択中の段階)
+ **************************************************************************/
+void BenchKernels(Context& ctx, const char* tier)
+{
+	const YmSimd::Kernels& k = YmSimd::GetKernels();
+	const YmUInt32 numBins = 513;		// 1024 点 FFT
+	std::vector<YmReal32> a(numBins*2), b(numBins*2), c(numBins*2);
+	Fill(a, 3); Fill(b, 4);
+	Measure(ctx, "ComplexMul", tier, numBins, numBins, [&]() { k.ComplexMul(&c[0], &a[0], &b[0], numBins); g_sink = c[0]; });
+	Measure(ctx, "ComplexMulAdd", tier, numBins, numBins, [&]() { k.ComplexMulAdd(&c[0], &a[0], &b[0], numBins); g_sink = c[0]; });
+
+	YmFft fft;
+	for (YmUInt32 size = 256; size <= 4096; size *= 4)
+	{
+		if (!fft.Init(nullptr, size)) continue;
+		std::vector<YmReal32> x(size), spec(size + 2);
+		Fill(x, 10);
+		Measure(ctx, "FftForward", tier, size, size, [&]() { fft.Forward(&x[0], &spec[0]); g_sink = spec[0]; });
+		Measure(ctx, "FftInverse", tier, size, size, [&]() { fft.Inverse(&spec[0], &x[0]); g_sink = x[0]; });
+	}
+
+	const YmUInt32 block = 256;
+	std::vector<YmReal32> dst(block);
+	for (YmUInt32 taps = 128; taps <= 1024; taps *= 2)
+	{
+		std::vector<YmReal32> src(block + taps - 1), coef(taps);
+		Fill(src, 5); Fill(coef, 6);
+		Measure(ctx, "Fir", tier, taps, block, [&]() { k.Fir(&dst[0], &src[0], &coef[0], block, taps); g_sink = dst[0]; });
+	}
+	std::vector<YmReal32> src(block);
+	Fill(src, 7);
+	Measure(ctx, "MixGain", tier, block, block, [&]() { k.MixGain(&dst[0], &src[0], 0.5f, block); g_sink = dst[0]; });
+	Measure(ctx, "MixGainRamp", tier, block, block, [&]() { k.MixGainRamp(&dst[0], &src[0], 0.5f, 0.25f, block); g_sink = dst[0]; });
+	Measure(ctx, "Dot", tier, 64, 64, [&]() { g_sink = k.Dot(&src[0], &dst[0], 64); });
+}
+
+/***********************************************************************//**
+ * @brief			畳込 (HRTF 左右 2ch, ブロック長 256)
+ **************************************************************************/
+void BenchConvolution(Context& ctx, const char* tier)
+{
+	const YmUInt32 block = 256;
+	std::vector<YmReal32> in(block), outL(block), outR(block);
+	Fill(in, 8);
+	YmReal32* out[2] = { &outL[0], &outR[0] };
+	for (YmUInt32 length = 128; length <= 2048; length *= 2)
+	{
+		std::vector<YmReal32> ir(length);
+		Fill(ir, 9);
+		for (int m = 0; m < 2; m++)
+		{
+			const YmConvolver::Mode mode = (m == 0) ? YmConvolver::MODE_TIME : YmConvolver::MODE_FREQ;
+			YmConvolver conv;
+			if (!conv.Init(nullptr, block, length, 2, mode)) continue;
+			conv.SetFilter(0, &ir[0], length);
+			conv.SetFilter(1, &ir[0], length);
+			Measure(ctx, (m == 0) ? "ConvTime" : "ConvFreq", tier, length, block, [&]() { conv.Process(&in[0], out); g_sink = outL[0]; });
+			// 毎ブロック方向が変わる場合 (フィルタ更新 + クロスフェード)
+			// フェード中の更新は保留され、次の更新で置き換わったものは出力に反映されない。反映された割合も表示する
+			const YmReal32* irs[2] = { &ir[0], &ir[0] };
+			YmUInt64 numUpdates = 0, numReplaced = 0;
+			Measure(ctx, (m == 0) ? "ConvTimeFade" : "ConvFreqFade", tier, length, block, [&]() {
+				if (conv.IsUpdatePending()) numReplaced++;
+				conv.UpdateFilters(irs, length);
+				numUpdates++;
+				conv.Process(&in[0], out);
+				g_sink = outL[0];
+			});
+			if (numUpdates > 0)
+			{
+				char label[128];
+				snprintf(label, sizeof(label), "%s/%s/%u", (m == 0) ? "ConvTimeFade" : "ConvFreqFade", tier, length);
+				fprintf(stderr, "%-40s %9.1f %% of updates applied\n", label, 100.0*(double)(numUpdates - numReplaced)/(double)numUpdates);
+			}
+			// 無音入力 (テールが尽きた後は YM_USE_SILENCE_BYPASS で畳込みを省略)
+			const std::vector<YmReal32> silence(block, 0.0f);
+			Measure(ctx, (m == 0) ? "ConvTimeSilent" : "ConvFreqSilent", tier, length, block, [&]() { conv.Process(&silence[0], out); g_sink = outL[0]; });
+		}
+	}
+
+}
+
+/***********************************************************************//**
+ * @brief			YmMath (スカラー実装)
+ **************************************************************************/
+void BenchScalar(Context& ctx)
+{
+	const YmUInt32 N = 1024;
+	std::vector<YmReal32> x(N), y(N), z(N);
+	Fill(x, 11); Fill(y, 12); Fill(z, 13);
+	Measure(ctx, "RectToPolar", "scalar", N, N, [&]() {
+		YmReal32 acc = 0.0f;
+		for (YmUInt32 i = 0; i < N; i++) acc += YmMath::RectToPolar(x[i], y[i], z[i]).azim;
+		g_sink = acc;
+	});
+	Measure(ctx, "PolarToRect", "scalar", N, N, [&]() {
+		YmReal32 acc = 0.0f;
+		for (YmUInt32 i = 0; i < N; i++) acc += YmMath::PolarToRect(x[i], y[i], z[i]).x;
+		g_sink = acc;
+	});
+	std::vector<YmReal32> a(N), e(N), d(N);
+	Measure(ctx, "RectToPolarBatch", "V4", N, N, [&]() {
+		YmMath::RectToPolar(&x[0], &y[0], &z[0], &a[0], &e[0], &d[0], N);
+		g_sink = a[N-1];
+	});
+	Measure(ctx, "PolarToRectBatch", "V4", N, N, [&]() {
+		YmMath::PolarToRect(&x[0], &y[0], &z[0], &a[0], &e[0], &d[0], N);
+		g_sink = a[N-1];
+	});
+	Measure(ctx, "dBToLin", "scalar", N, N, [&]() {
+		YmReal32 acc = 0.0f;
+		for (YmUInt32 i = 0; i < N; i++) acc += YmMath::dBToLin(x[i]*60.0f);
+		g_sink = acc;
+	});
+	for (YmUInt32 i = 0; i < N; i++) e[i] = x[i]*60.0f;
+	Measure(ctx, "dBToLinBatch", "V4", N, N, [&]() {
+		YmMath::dBToLin(&e[0], &d[0], N);
+		g_sink = d[N-1];
+	});
+	Measure(ctx, "LinTodBBatch", "V4", N, N, [&]() {
+		YmMath::LinTodB(&d[0], &a[0], N);
+		g_sink = a[N-1];
+	});
+
+	// 10°間隔 (仰角 -40～90°) の測定方向に対する 3 点補間の探索
+	std::vector<YmPolar3> grid;
+	for (int elev = -40; elev <= 90; elev += 10)
+	{
+		for (int azim = -180; azim < 180; azim += (elev == 90) ? 360 : 10)
+		{
+			grid.push_back(YmPolar3((YmReal32)azim*YMH_DEG2RAD, (YmReal32)elev*YMH_DEG2RAD, 1.0f));
+		}
+	}
+	YmHrtfGrid hrtfGrid;
+	if (hrtfGrid.Init(nullptr, &grid[0], (YmUInt32)grid.size()))
+	{
+		std::vector<YmVector3> dirs(N);
+		for (YmUInt32 i = 0; i < N; i++) dirs[i] = YmVector3(x[i], y[i], z[i]);
+		Measure(ctx, "HrtfGridLookup", "scalar", (YmUInt32)grid.size(), N, [&]() {
+			YmHrtfWeights w;
+			YmReal32 acc = 0.0f;
+			for (YmUInt32 i = 0; i < N; i++) { hrtfGrid.Lookup(dirs[i], w); acc += w.weight[0]; }
+			g_sink = acc;
+		});
+		hrtfGrid.Term();
+	}
+
+	// 44.1kHz -> 48kHz のストリーム変換
+	YmResampler resampler;
+	if (resampler.Init(nullptr, 44100, 48000, N))
+	{
+		std::vector<YmReal32> rs(resampler.GetMaxOutput(N));
+		Measure(ctx, "Resample44to48", YmSimd::GetTierName(YmSimd::GetTier()), N, N, [&]() { g_sink = (YmReal32)resampler.Process(&x[0], N, &rs[0]); });
+		resampler.Term();
+	}
+
+	// 1 フレーム分のパラメータ / 位置更新をまとめて公開し、オーディオスレッド側で適用
+	YmCommandQueue queue;
+	if (queue.Init(nullptr, N))
+	{
+		Measure(ctx, "CommandQueue", "scalar", N, N, [&]() {
+			for (YmUInt32 i = 0; i < N; i++)
+			{
+				YmCommand* c = queue.Reserve();
+				c->tick = i;
+				c->type = YM_COMMAND_SET_POSITION;
+				c->param = 0;
+				c->target = i;
+				c->value[0] = x[i]; c->value[1] = y[i]; c->value[2] = z[i];
+			}
+			queue.Publish();
+			YmReal32 acc = 0.0f;
+			queue.Drain(N, [&](const YmCommand& c) { acc += c.value[0]; });
+			g_sink = acc;
+		});
+		queue.Term();
+	}
+
+#if YM_USE_AMBISONIC
+	// 3 次アンビソニックバス: 音源 1 つのエンコード (係数補間あり) と、バス 1 本のバイノーラルデコード
+	const YmUInt32 irLength = 256;
+	std::vector<YmVector3> ambiDirs(grid.size());
+	for (size_t i = 0; i < grid.size(); i++) ambiDirs[i] = YmMath::PolarToRect(grid[i].azim, grid[i].elev, 1.0f);
+	std::vector<YmReal32> irs(grid.size()*irLength);
+	Fill(irs, 14);
+	YmAmbisonicDecoder decoder;
+	YmAmbisonicEncoder encoder;
+	if (decoder.Init(nullptr, 3, N, (YmUInt32)grid.size(), irLength, &irs[0], &irs[0], &ambiDirs[0]) && encoder.Init(3))
+	{
+		YmUInt32 i = 0;
+		Measure(ctx, "AmbisonicEncode3", YmSimd::GetTierName(YmSimd::GetTier()), N, N, [&]() {
+			const YmVector3 dir = YmMath::PolarToRect(x[i & (N-1)]*YMH_PI, y[i & (N-1)]*0.5f*YMH_PI, 1.0f);
+			i++;
+			encoder.Encode(&x[0], dir, 0.5f, decoder.GetChannels(), N);
+		});
+		Measure(ctx, "AmbisonicDecode3", YmSimd::GetTierName(YmSimd::GetTier()), N, N, [&]() { decoder.Render(&y[0], &z[0]); });
+		decoder.Term();
+	}
+#endif
+
+#if YM_USE_LOD
+	// LOD の PAN 段階 (ブロックごとに方向を変えて補間させる)
+	YmItdPanner panner;
+	if (panner.Init(48000))
+	{
+		std::vector<YmReal32> outLeft(N), outRight(N);
+		YmUInt32 i = 0;
+		Measure(ctx, "ItdPanner", "scalar", N, N, [&]() {
+			const YmVector3 dir = YmMath::PolarToRect(x[i & (N-1)]*YMH_PI, 0.0f, 1.0f);
+			i++;
+			panner.Process(&y[0], dir, 0.5f, 0.5f, &outLeft[0], &outRight[0], N);
+			g_sink = outLeft[N-1];
+		});
+	}
+#endif
+
+#if YM_USE_VOICE_BUDGET
+	// 256 ボイスの報告と順位付け (結果は 1 ボイスあたり)
+	const YmUInt32 numVoices = 256;
+	YmVoiceBudgetConfig budgetConfig;
+	budgetConfig.maxRealVoices = 32;
+	YmVoiceBudget budget;
+	if (budget.Init(nullptr, numVoices, 48000, N, budgetConfig))
+	{
+		std::vector<YmInt32> handles(numVoices);
+		for (YmUInt32 v = 0; v < numVoices; v++) handles[v] = budget.Register();
+		YmUInt64 tick = 0;
+		Measure(ctx, "VoiceBudget", "scalar", numVoices, numVoices, [&]() {
+			tick += N;
+			YmUInt32 numReal = 0;
+			for (YmUInt32 v = 0; v < numVoices; v++)
+			{
+				if (budget.Update(handles[v], tick, 1.0f, 0.5f + 0.5f*x[(v + tick) & (N-1)])) numReal++;
+				budget.AddCost(handles[v], 1000);
+			}
+			g_sink = (YmReal32)numReal;
+		});
+		budget.Term();
+	}
+#endif
+}
+
+#if YM_USE_WORKER_POOL
+/***********************************************************************//**
+ * @brief			YmBatchSpatializer (32 方向, HRIR 512, ブロック 256) の直列処理とワーカープール
+ * @note			tier はワーカー数 (workers0 は直列)。結果は出力 1 サンプルあたり。
+ **************************************************************************/
+void BenchWorkerPool(Context& ctx)
+{
+	const YmUInt32 block = 256, irLength = 512, numDirections = 32;
+	std::vector<YmReal32> irs((size_t)numDirections*irLength), in(block), outL(block), outR(block);
+	Fill(irs, 15);
+	Fill(in, 16);
+	YmBatchSpatializer spatializer;
+	if (!spatializer.Init(nullptr, block, numDirections, numDirections, irLength, &irs[0], &irs[0])) return;
+
+	const YmUInt32 maxWorkers = YmMath::Min(std::thread::hardware_concurrency(), 8u);
+	for (YmUInt32 numWorkers = 0; numWorkers < maxWorkers; numWorkers = (numWorkers == 0) ? 1 : numWorkers*2)
+	{
+		YmWorkerPool pool;
+		if (numWorkers > 0 && (!pool.Init(numWorkers) || !spatializer.SetWorkerPool(&pool))) break;
+		char tier[32];
+		snprintf(tier, sizeof(tier), "workers%u", numWorkers);
+		Measure(ctx, "BatchSpatializer", tier, numDirections, block, [&]() {
+			spatializer.BeginBlock();
+			for (YmUInt32 d = 0; d < numDirections; d++) spatializer.AddSource(&in[0], d, 0.5f);
+			spatializer.Render(&outL[0], &outR[0]);
+			g_sink = outL[0];
+		});
+		spatializer.SetWorkerPool(nullptr);
+	}
+}
+#endif
+
+void Print(const Context& ctx, bool csv)
+{
+	if (csv)
+	{
+		printf("name,tier,size,ns_per_sample\n");
+		for (size_t i = 0; i < ctx.results.size(); i++)
+		{
+			const Result& r = ctx.results[i];
+			printf("%s,%s,%u,%.6f\n", r.name.c_str(), r.tier.c_str(), r.size, r.nsPerSample);
+		}
+		return;
+	}
+	printf("[\n");
+	for (size_t i = 0; i < ctx.results.size(); i++)
+	{
+		const Result& r = ctx.results[i];
+		printf("  {\"name\": \"%s\", \"tier\": \"%s\", \"size\": %u, \"ns_per_sample\": %.6f}%s\n",
+			r.name.c_str(), r.tier.c_str(), r.size, r.nsPerSample, (i + 1 < ctx.results.size()) ? "," : "");
+	}
+	printf("]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Context ctx;
+	ctx.minSeconds = 0.2;
+	ctx.filter = nullptr;
+	bool csv = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-csv") == 0)						csv = true;
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)	ctx.minSeconds = atof(argv[++i]);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)	ctx.filter = argv[++i];
+		else
+		{
+			fprintf(stderr, "usage: ymbench [-csv] [-t seconds] [-f filter]\n");
+			return 2;
+		}
+	}
+
+	const YmSimd::Tier selected = YmSimd::GetTier();
+#if YM_CPU_X86
+	BenchMacrosV4(ctx, "sse3");
+#else
+	BenchMacrosV4(ctx, "neon");
+#endif
+#if YM_USE_SIMD_WIDE
+	if (YmSimd::IsTierSupported(YmSimd::TIER_AVX2))		BenchMacrosWide(ctx, "avx2", MacroLoopV8);
+	if (YmSimd::IsTierSupported(YmSimd::TIER_AVX512))	BenchMacrosWide(ctx, "avx512", MacroLoopV16);
+#endif
+
+	for (int t = YmSimd::TIER_SCALAR; t < YmSimd::TIER_NUM; t++)
+	{
+		const YmSimd::Tier tier = (YmSimd::Tier)t;
+		if (!YmSimd::ForceTier(tier))
+		{
+			fprintf(stderr, "%-40s unsupported\n", YmSimd::GetTierName(tier));
+			continue;
+		}
+		BenchKernels(ctx, YmSimd::GetTierName(tier));
+		BenchConvolution(ctx, YmSimd::GetTierName(tier));
+	}
+	YmSimd::ForceTier(selected);
+	BenchScalar(ctx);
+#if YM_USE_WORKER_POOL
+	BenchWorkerPool(ctx);
+#endif
+
+	Print(ctx, csv);
+	return 0;
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
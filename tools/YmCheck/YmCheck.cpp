@@ -0,0 +1,1418 @@
+﻿/*****************************************************************************************//**
+ * @file			YmCheck.cpp
+ * @brief			private/ のコンポーネントの自己診断 (回帰チェック)
+ * @attention		チェックごとに ok / FAIL を標準エラーに出し、失敗が 1 つでもあれば終了コード 1。
+ *
+ *					ビルド (リポジトリのルートで):
+ *					  g++ -std=c++14 -O2 -msse3 -pthread \
+ *					      -Iplatforms/unity/Assets/SoundXR/Plugins/AudioPluginViReal.bundle/Contents/Resources \
+ *					      tools/YmCheck/YmCheck.cpp -o ymcheck
+ *
+ *					使い方:
+ *					  ymcheck [-f filter]
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include "private/YmBase.h"
+#include "private/YmCommandQueue.h"
+#include "private/YmConvolver.h"
+#include "private/YmFft.h"
+#include "private/YmHrtfPack.h"
+#include "private/YmHrtfSelector.h"
+#include "private/YmResampler.h"
+#include "private/YmVoiceBudget.h"
+#include "private/YmVoicePool.h"
+#include "private/YmWorkerPool.h"
+
+namespace {
+
+struct Context
+{
+	const char*	filter;
+	YmUInt32	numChecks;
+	YmUInt32	numFailed;
+};
+
+/***********************************************************************//**
+ * @brief			チェックの実行と結果の表示
+ **************************************************************************/
+template <class F> void Check(Context& ctx, const char* name, F func)
+{
+	if (ctx.filter && strstr(name, ctx.filter) == nullptr) return;
+	ctx.numChecks++;
+	const bool ok = func();
+	if (!ok) ctx.numFailed++;
+	fprintf(stderr, "%-48s %s\n", name, ok ? "ok" : "FAIL");
+}
+
+void Fill(std::vector<YmReal32>& v, YmUInt32 seed)
+{
+	for (size_t i = 0; i < v.size(); i++)
+	{
+		seed = seed*1664525u + 1013904223u;
+		v[i] = (YmReal32)(seed >> 8)/(YmReal32)(1u << 24) - 0.5f;
+	}
+}
+
+/***********************************************************************//**
+ * @brief			YmFft の順変換と倍精度の DFT、逆変換との往復の比較 (カーネルの段階を指定)
+ **************************************************************************/
+bool CheckFft(const YmSimd::Kernels& kernels, YmUInt32 size)
+{
+	YmFft fft;
+	if (!fft.Init(nullptr, size)) return false;
+	const YmUInt32 numBins = fft.GetNumBins();
+	std::vector<YmReal32> x(size), y(size), spec(numBins*2), work(size);
+	Fill(x, 3);
+	fft.Forward(&x[0], &spec[0], &work[0], kernels);
+
+	double maxError = 0.0;
+	for (YmUInt32 k = 0; k < numBins; k++)
+	{
+		double re = 0.0, im = 0.0;
+		for (YmUInt32 n = 0; n < size; n++)
+		{
+			const double w = -2.0*3.14159265358979323846*(double)((YmUInt64)k*n % size)/size;
+			re += x[n]*cos(w);
+			im += x[n]*sin(w);
+		}
+		maxError = YmMath::Max(maxError, fabs(spec[2*k] - re));
+		maxError = YmMath::Max(maxError, fabs(spec[2*k+1] - im));
+	}
+	fft.Inverse(&spec[0], &y[0], kernels);
+	double roundTrip = 0.0;
+	for (YmUInt32 n = 0; n < size; n++) roundTrip = YmMath::Max(roundTrip, (double)fabsf(y[n] - x[n]));
+
+	// 順変換の誤差は N とともに増える (入力は ±0.5 で、N = 4096 でも 1e-5 程度)
+	if (maxError > 1.0e-6 + 1.0e-8*size || roundTrip > 1.0e-6)
+	{
+		fprintf(stderr, "  size %u (%s): max error %g, round trip %g\n", size, YmSimd::GetTierName(kernels.tier), maxError, roundTrip);
+		return false;
+	}
+	return true;
+}
+
+void CheckFftTiers(Context& ctx)
+{
+	static const YmUInt32 sizes[] = { 4, 8, 16, 32, 64, 1024, 4096 };
+	for (int t = YmSimd::TIER_SCALAR; t < YmSimd::TIER_NUM; t++)
+	{
+		const YmSimd::Kernels* kernels = YmSimd::GetKernels((YmSimd::Tier)t);
+		if (kernels == nullptr) continue;
+		for (size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "Fft/%s/%u", YmSimd::GetTierName(kernels->tier), sizes[i]);
+			Check(ctx, name, [&]() { return CheckFft(*kernels, sizes[i]); });
+		}
+	}
+}
+
+/***********************************************************************//**
+ * @brief			YmConvolver (MODE_AUTO) の出力と直接畳込みの比較
+ * @note			Unity の dspbuffersize は 2 のべき乗とは限らない (192, 240, 441, 480, 960 等)。
+ **************************************************************************/
+bool CheckConvolver(YmUInt32 blockSize, YmUInt32 length)
+{
+	const YmUInt32 numBlocks = (length + blockSize - 1)/blockSize + 2;
+	std::vector<YmReal32> ir(length), in((size_t)blockSize*numBlocks), outL(blockSize), outR(blockSize);
+	Fill(ir, 1);
+	Fill(in, 2);
+	YmConvolver conv;
+	if (!conv.Init(nullptr, blockSize, length, 2))
+	{
+		fprintf(stderr, "  Init failed (block %u, length %u)\n", blockSize, length);
+		return false;
+	}
+	conv.SetFilter(0, &ir[0], length);
+	conv.SetFilter(1, &ir[0], length);
+
+	YmReal32* out[2] = { &outL[0], &outR[0] };
+	double maxError = 0.0;
+	for (YmUInt32 b = 0; b < numBlocks; b++)
+	{
+		conv.Process(&in[(size_t)b*blockSize], out);
+		for (YmUInt32 n = 0; n < blockSize; n++)
+		{
+			const size_t t = (size_t)b*blockSize + n;
+			double ref = 0.0;
+			for (YmUInt32 k = 0; k < length && k <= t; k++) ref += (double)ir[k]*in[t - k];
+			maxError = YmMath::Max(maxError, fabs(outL[n] - ref));
+			maxError = YmMath::Max(maxError, fabs(outR[n] - ref));
+		}
+	}
+	if (maxError > 1.0e-4)
+	{
+		fprintf(stderr, "  block %u, length %u (%s): max error %g\n", blockSize, length,
+			(conv.GetMode() == YmConvolver::MODE_FREQ) ? "freq" : "time", maxError);
+		return false;
+	}
+	return true;
+}
+
+void CheckConvolution(Context& ctx)
+{
+	static const YmUInt32 blockSizes[] = { 192, 240, 256, 441, 480, 960, 1024 };
+	for (size_t i = 0; i < sizeof(blockSizes)/sizeof(blockSizes[0]); i++)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "ConvolverAuto/%u/2048", blockSizes[i]);
+		Check(ctx, name, [&]() { return CheckConvolver(blockSizes[i], 2048); });
+	}
+}
+
+/***********************************************************************//**
+ * @brief			UpdateFilters() のクロスフェード後の出力が、新フィルタだけで処理した出力と一致するか
+ * @note			フェード中の連続した更新 (保留の置換え) を含め、最後の更新が再試行なしで反映されること。
+ *					入力スペクトル・フィルタスペクトルの計算は同じなので、フェードが終われば出力はビット単位で一致する。
+ **************************************************************************/
+bool CheckFilterUpdate(YmConvolver::Mode mode, YmUInt32 blockSize, YmUInt32 length)
+{
+	const YmUInt32 numIrs = 4, firstUpdate = 4, numBlocks = firstUpdate + numIrs + (2*length + blockSize*YM_CONV_MAX_PARTITION_BLOCKS)/blockSize + 4;
+	std::vector<YmReal32> irs((size_t)numIrs*length), in((size_t)blockSize*numBlocks);
+	std::vector<YmReal32> outL(blockSize), outR(blockSize), refL(blockSize), refR(blockSize);
+	Fill(irs, 4);
+	Fill(in, 5);
+	YmConvolver conv, ref;
+	if (!conv.Init(nullptr, blockSize, length, 2, mode) || !ref.Init(nullptr, blockSize, length, 2, mode)) return false;
+	const YmReal32* last = &irs[(size_t)(numIrs - 1)*length];
+	conv.SetFilter(0, &irs[0], length);
+	conv.SetFilter(1, &irs[0], length);
+	ref.SetFilter(0, last, length);
+	ref.SetFilter(1, last, length);
+
+	YmReal32* out[2] = { &outL[0], &outR[0] };
+	YmReal32* refOut[2] = { &refL[0], &refR[0] };
+	YmUInt32 numMatched = 0;
+	for (YmUInt32 b = 0; b < numBlocks; b++)
+	{
+		// 1 ブロックごとに ir[1], ir[2], ir[3] へ更新 (MODE_FREQ ではフェード中なので保留が置き換わる)
+		if (b >= firstUpdate && b < firstUpdate + numIrs - 1)
+		{
+			const YmReal32* ir = &irs[(size_t)(b - firstUpdate + 1)*length];
+			const YmReal32* pair[2] = { ir, ir };
+			if (!conv.UpdateFilters(pair, length))
+			{
+				fprintf(stderr, "  update rejected at block %u\n", b);
+				return false;
+			}
+		}
+		conv.Process(&in[(size_t)b*blockSize], out);
+		ref.Process(&in[(size_t)b*blockSize], refOut);
+		const bool same = memcmp(&outL[0], &refL[0], sizeof(YmReal32)*blockSize) == 0 && memcmp(&outR[0], &refR[0], sizeof(YmReal32)*blockSize) == 0;
+		numMatched = same ? numMatched + 1 : 0;
+	}
+	// 最後の数ブロックはフェードが終わって完全に新フィルタの出力になっていること
+	if (numMatched < 4 || conv.IsFading() || conv.IsUpdatePending())
+	{
+		fprintf(stderr, "  %s block %u, length %u: matched %u trailing blocks\n",
+			(conv.GetMode() == YmConvolver::MODE_FREQ) ? "freq" : "time", blockSize, length, numMatched);
+		return false;
+	}
+	return true;
+}
+
+void CheckFilterUpdates(Context& ctx)
+{
+	Check(ctx, "FilterUpdate/time/256/512", []() { return CheckFilterUpdate(YmConvolver::MODE_TIME, 256, 512); });
+	Check(ctx, "FilterUpdate/time/240/512", []() { return CheckFilterUpdate(YmConvolver::MODE_TIME, 240, 512); });
+	Check(ctx, "FilterUpdate/freq/256/2048", []() { return CheckFilterUpdate(YmConvolver::MODE_FREQ, 256, 2048); });
+	Check(ctx, "FilterUpdate/freq/128/4096", []() { return CheckFilterUpdate(YmConvolver::MODE_FREQ, 128, 4096); });
+}
+
+#if YM_USE_SILENCE_BYPASS
+/***********************************************************************//**
+ * @brief			YmSilenceGate による畳込みの省略が出力を変えないか (省略しない YmConvolver との比較)
+ * @param[in]		gap		入力の無音の長さ [サンプル] (ブロックの途中から始まる)
+ * @note			無音のブロックがフィルタ長 - 1 + blockSize サンプル続いたときだけ省略され、
+ *					次の有音ブロックで履歴をリセットして再開する。
+ **************************************************************************/
+bool CheckSilenceGap(YmConvolver::Mode mode, YmUInt32 blockSize, YmUInt32 length, YmUInt32 gap)
+{
+	const YmUInt32 gapStart = 3*blockSize + blockSize/3, gapEnd = gapStart + gap;
+	const YmUInt32 numBlocks = (gapEnd + 3*blockSize + length)/blockSize + 3;
+	std::vector<YmReal32> ir(length), in((size_t)blockSize*numBlocks, 0.0f);
+	std::vector<YmReal32> outL(blockSize), outR(blockSize), refL(blockSize), refR(blockSize);
+	Fill(ir, 8);
+	Fill(in, 9);
+	// 無音の区間と、再開後 3 ブロック以降の末尾 (テールの消える最後も省略の対象)
+	std::fill(in.begin() + gapStart, in.begin() + gapEnd, 0.0f);
+	std::fill(in.begin() + gapEnd + 3*blockSize, in.end(), 0.0f);
+
+	YmConvolver conv, ref;
+	if (!conv.Init(nullptr, blockSize, length, 2, mode) || !ref.Init(nullptr, blockSize, length, 2, mode)) return false;
+	ref.SetSilenceThreshold(-1.0f);
+	conv.SetFilter(0, &ir[0], length);
+	conv.SetFilter(1, &ir[0], length);
+	ref.SetFilter(0, &ir[0], length);
+	ref.SetFilter(1, &ir[0], length);
+
+	// 区間内の無音ブロックの連続がテール + 1 ブロックに届けば省略されるはず
+	const YmUInt32 firstSilent = (gapStart + blockSize - 1)/blockSize, endSilent = gapEnd/blockSize;
+	const YmUInt32 silentBlocks = (endSilent > firstSilent) ? endSilent - firstSilent : 0;
+	const bool expectBypass = (YmUInt64)silentBlocks*blockSize >= (YmUInt64)length - 1 + blockSize;
+
+	YmReal32* out[2] = { &outL[0], &outR[0] };
+	YmReal32* refOut[2] = { &refL[0], &refR[0] };
+	double maxError = 0.0, peak = 0.0;
+	bool bypassedInGap = false, bypassedAtEnd = false;
+	for (YmUInt32 b = 0; b < numBlocks; b++)
+	{
+		conv.Process(&in[(size_t)b*blockSize], out);
+		ref.Process(&in[(size_t)b*blockSize], refOut);
+		if (b < endSilent) bypassedInGap = bypassedInGap || conv.IsBypassed();
+		bypassedAtEnd = conv.IsBypassed();
+		for (YmUInt32 n = 0; n < blockSize; n++)
+		{
+			maxError = YmMath::Max(maxError, (double)YmMath::Max(fabsf(outL[n] - refL[n]), fabsf(outR[n] - refR[n])));
+			peak = YmMath::Max(peak, (double)fabsf(refL[n]));
+		}
+	}
+	if (maxError > 1.0e-6*peak || bypassedInGap != expectBypass || !bypassedAtEnd)
+	{
+		fprintf(stderr, "  %s block %u, length %u, gap %u: max error %g (peak %g), bypassed in gap %d (expected %d), at end %d\n",
+			(conv.GetMode() == YmConvolver::MODE_FREQ) ? "freq" : "time", blockSize, length, gap, maxError, peak,
+			bypassedInGap, expectBypass, bypassedAtEnd);
+		return false;
+	}
+	return true;
+}
+
+void CheckSilenceGate(Context& ctx)
+{
+	struct Case { YmConvolver::Mode mode; YmUInt32 blockSize, length; const char* name; };
+	static const Case cases[] = {
+		{ YmConvolver::MODE_TIME, 240, 512,  "time/240/512" },
+		{ YmConvolver::MODE_FREQ, 256, 2048, "freq/256/2048" },
+	};
+	for (size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); i++)
+	{
+		const Case& c = cases[i];
+		// テールより短い無音、省略の閾値 (テール + 1 ブロック) ちょうどの無音ブロック数とその 1 サンプル手前、十分長い無音。
+		// 無音はブロックの 1/3 から始まるので、先頭の端数 blockSize - blockSize/3 を足す
+		const YmUInt32 head = c.blockSize - c.blockSize/3;
+		const YmUInt32 need = (c.length - 1 + c.blockSize + c.blockSize - 1)/c.blockSize;
+		const YmUInt32 gaps[4] = { c.length/2, head + need*c.blockSize - 1, head + need*c.blockSize, 3*(c.length + c.blockSize) };
+		const char* labels[4] = { "short", "below", "at", "long" };
+		for (int g = 0; g < 4; g++)
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "SilenceGate/%s/%s", c.name, labels[g]);
+			Check(ctx, name, [&]() { return CheckSilenceGap(c.mode, c.blockSize, c.length, gaps[g]); });
+		}
+	}
+}
+#endif // YM_USE_SILENCE_BYPASS
+
+#if YM_USE_HRTF_PACK
+/***********************************************************************//**
+ * @brief			HRTF パックの生成 (方向 numDirections, fftSize 64, スペクトルはゼロ)
+ * @note			headerHash はフィールドを書き換えるたびに SealPack() で付け直す。
+ **************************************************************************/
+void SealPack(std::vector<YmUInt8>& pack)
+{
+	YmHrtfPackHeader* h = reinterpret_cast<YmHrtfPackHeader*>(&pack[0]);
+	YmUInt32 hash = 2166136261u;
+	for (size_t i = 0; i < offsetof(YmHrtfPackHeader, headerHash); i++) hash = (hash ^ pack[i])*16777619u;
+	h->headerHash = hash;
+}
+
+YmHrtfPackHeader* MakePack(std::vector<YmUInt8>& pack, YmUInt32 numDirections)
+{
+	YmHrtfPackHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = YM_HRTF_PACK_MAGIC;
+	header.version = YM_HRTF_PACK_VERSION;
+	header.headerSize = (YmUInt16)sizeof(YmHrtfPackHeader);
+	header.sampleRate = 48000;
+	header.numDirections = numDirections;
+	header.irLength = 32;
+	header.fftSize = 64;
+	header.numBins = 33;
+	header.specStride = 80;
+	header.directionOffset = sizeof(YmHrtfPackHeader);
+	header.spectrumOffset = (header.directionOffset + sizeof(YmReal32)*3*numDirections + YM_HRTF_PACK_ALIGN - 1) & ~(YmUInt64)(YM_HRTF_PACK_ALIGN - 1);
+	header.fileSize = header.spectrumOffset + sizeof(YmReal32)*header.specStride*2*numDirections;
+	// 64 バイト境界に置くため先頭を読み飛ばせる分だけ余分に確保する
+	pack.assign((size_t)header.fileSize + YM_HRTF_PACK_ALIGN, 0);
+	memcpy(&pack[0], &header, sizeof(header));
+	SealPack(pack);
+	return reinterpret_cast<YmHrtfPackHeader*>(&pack[0]);
+}
+
+/***********************************************************************//**
+ * @brief			不正なヘッダ (切り詰め・範囲外・オーバーフローする値) を Attach() が拒否するか
+ **************************************************************************/
+bool CheckPackHeader(void (*corrupt)(YmHrtfPackHeader&, size_t&), bool expected)
+{
+	std::vector<YmUInt8> pack;
+	MakePack(pack, 4);
+	size_t size = (size_t)reinterpret_cast<YmHrtfPackHeader*>(&pack[0])->fileSize;
+	corrupt(*reinterpret_cast<YmHrtfPackHeader*>(&pack[0]), size);
+	SealPack(pack);
+
+	// Attach() は 64 バイト境界を要求するのでアラインした位置にコピーする
+	void* data = alloc_memory(nullptr, pack.size(), YM_HRTF_PACK_ALIGN);
+	if (data == nullptr) return false;
+	memcpy(data, &pack[0], pack.size());
+	YmHrtfPack hrtfPack;
+	const bool attached = hrtfPack.Attach(data, size);
+	hrtfPack.Close();
+	free_memory(nullptr, data);
+	return attached == expected;
+}
+
+void CheckHrtfPack(Context& ctx)
+{
+	Check(ctx, "HrtfPack/Valid", []() {
+		return CheckPackHeader([](YmHrtfPackHeader&, size_t&) {}, true); });
+	Check(ctx, "HrtfPack/TruncatedHeader", []() {
+		return CheckPackHeader([](YmHrtfPackHeader&, size_t& size) { size = sizeof(YmHrtfPackHeader) - 1; }, false); });
+	Check(ctx, "HrtfPack/TruncatedSpectra", []() {
+		return CheckPackHeader([](YmHrtfPackHeader&, size_t& size) { size -= 4; }, false); });
+	Check(ctx, "HrtfPack/FileSizeBeyondData", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.fileSize += YM_HRTF_PACK_ALIGN; }, false); });
+	Check(ctx, "HrtfPack/HugeNumDirections", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.numDirections = 0xFFFFFFFFu; }, false); });
+	Check(ctx, "HrtfPack/HugeSpecStride", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.specStride = 0xFFFFFFF0u; }, false); });
+	Check(ctx, "HrtfPack/HugeStrideTimesDirections", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.specStride = 0x80000000u; h.numDirections = 0x80000000u; }, false); });
+	Check(ctx, "HrtfPack/WrappingSpectrumOffset", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.spectrumOffset = ~(YmUInt64)(YM_HRTF_PACK_ALIGN - 1); }, false); });
+	Check(ctx, "HrtfPack/WrappingDirectionOffset", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.directionOffset = ~(YmUInt64)(YM_HRTF_PACK_ALIGN - 1); }, false); });
+	Check(ctx, "HrtfPack/OverlappingSections", []() {
+		return CheckPackHeader([](YmHrtfPackHeader& h, size_t&) { h.spectrumOffset = h.directionOffset; }, false); });
+}
+#endif // YM_USE_HRTF_PACK
+
+#if YM_USE_HRTF_SELECTOR
+/***********************************************************************//**
+ * @brief			6 方向 (±x, ±y, ±z) の HRIR セット (方向 d の左耳はタップ d、右耳は末尾から d に scale)
+ **************************************************************************/
+struct TestHrirs
+{
+	YmUInt32				irLength;
+	YmVector3				directions[6];
+	std::vector<YmReal32>	left, right;		// [dir][irLength]
+
+	TestHrirs() : irLength(0) {}
+	TestHrirs(YmUInt32 length, YmReal32 scale) : irLength(length), left(6*length, 0.0f), right(6*length, 0.0f)
+	{
+		for (YmUInt32 d = 0; d < 6; d++)
+		{
+			const YmReal32 sign = (d & 1) ? -1.0f : 1.0f;
+			directions[d] = YmVector3((d/2 == 0) ? sign : 0.0f, (d/2 == 1) ? sign : 0.0f, (d/2 == 2) ? sign : 0.0f);
+			left[(size_t)d*length + d] = scale;
+			right[(size_t)d*length + length - 1 - d] = scale;
+		}
+	}
+
+	// ホストの周波数に変換した HRIR
+	bool Resample(YmUInt32 inRate, YmUInt32 outRate, TestHrirs& out) const
+	{
+		const YmUInt32 length = YmResampler::GetResampledLength(irLength, inRate, outRate);
+		out.irLength = length;
+		out.left.assign(6*length, 0.0f);
+		out.right.assign(6*length, 0.0f);
+		for (YmUInt32 d = 0; d < 6; d++)
+		{
+			out.directions[d] = directions[d];
+			if (!YmResampler::ResampleIr(nullptr, &left[(size_t)d*irLength], irLength, inRate, &out.left[(size_t)d*length], outRate)
+				|| !YmResampler::ResampleIr(nullptr, &right[(size_t)d*irLength], irLength, inRate, &out.right[(size_t)d*length], outRate))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	YmUInt32 Request(YmHrtfSelector& selector, YmUInt32 sampleRate = 0) const
+	{
+		return selector.RequestIr(6, irLength, directions, &left[0], &right[0], sampleRate);
+	}
+};
+
+// ローダースレッドの処理を待つ (上限 5 秒)
+template <class F> bool WaitFor(F cond)
+{
+	for (int i = 0; i < 5000 && !cond(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	return cond();
+}
+
+// 公開されたセットのスペクトルと、同じ HRIR から直接作ったテーブルの比較
+bool MatchesTable(const YmHrtfSet* set, YmUInt32 fftSize, const TestHrirs& hrirs)
+{
+	YmFft fft;
+	YmHrtfTable table;
+	if (set == nullptr || set->GetNumDirections() != 6 || set->GetIrLength() != hrirs.irLength
+		|| !fft.Init(nullptr, fftSize) || !table.Init(nullptr, fft, 6, hrirs.irLength, &hrirs.left[0], &hrirs.right[0]))
+	{
+		return false;
+	}
+	double maxError = 0.0;
+	for (YmUInt32 i = 0; i < 6*2; i++)
+	{
+		const YmReal32* a = set->GetTable().GetSpectrum(i/2, i & 1);
+		const YmReal32* b = table.GetSpectrum(i/2, i & 1);
+		for (YmUInt32 k = 0; k < table.GetNumBins()*2; k++) maxError = std::max(maxError, (double)fabsf(a[k] - b[k]));
+	}
+	return maxError < 1e-5;
+}
+
+/***********************************************************************//**
+ * @brief			要求 -> 公開 -> 切替、旧セットが切替ブロックだけ previous に出て返却・解放されるか
+ **************************************************************************/
+bool CheckSelectorSwitch(void)
+{
+	const TestHrirs a(16, 1.0f), b(16, 2.0f);
+	YmHrtfSelector selector;
+	if (!selector.Init(nullptr, 32, 64)) return false;
+	const YmHrtfSet* cur = nullptr;
+	const YmHrtfSet* prev = nullptr;
+	bool ok = !selector.Update(cur, prev) && cur == nullptr && prev == nullptr;
+
+	const YmUInt32 idA = a.Request(selector);
+	ok = ok && idA != 0 && WaitFor([&]() { return selector.IsReady(idA); });
+	ok = ok && selector.Update(cur, prev) && cur != nullptr && cur->GetId() == idA && prev == nullptr && MatchesTable(cur, 64, a);
+
+	const YmUInt32 idB = b.Request(selector);
+	ok = ok && idB != 0 && WaitFor([&]() { return selector.IsReady(idB); });
+	ok = ok && selector.Update(cur, prev) && cur != nullptr && cur->GetId() == idB
+		&& prev != nullptr && prev->GetId() == idA && MatchesTable(cur, 64, b);
+	for (int n = 0; ok && n < 4; n++)
+	{
+		ok = !selector.Update(cur, prev) && cur->GetId() == idB && prev == nullptr;
+	}
+	// 返却した旧セットはローダースレッドが解放する
+	ok = ok && WaitFor([&]() { return selector.GetNumSets() == 1; });
+	selector.Term();
+	return ok && selector.GetNumSets() == 0;
+}
+
+/***********************************************************************//**
+ * @brief			続けて出した要求は最後のものだけが公開されるか
+ * @note			途中の要求は処理前に置き換わる (失敗扱い) か、準備後に未受取のまま破棄される。
+ **************************************************************************/
+bool CheckSelectorSupersede(void)
+{
+	const TestHrirs a(16, 1.0f), b(16, 2.0f);
+	YmHrtfSelector selector;
+	if (!selector.Init(nullptr, 32, 64)) return false;
+	YmUInt32 id = 0;
+	for (int n = 0; n < 8; n++) id = ((n & 1) ? b : a).Request(selector);
+	const YmUInt32 last = id;
+	bool ok = last != 0 && WaitFor([&]() { return selector.IsReady(last); }) && selector.GetNumSets() == 1;
+	const YmHrtfSet* cur = nullptr;
+	const YmHrtfSet* prev = nullptr;
+	ok = ok && selector.Update(cur, prev) && cur != nullptr && cur->GetId() == last && prev == nullptr && MatchesTable(cur, 64, b);
+	ok = ok && !selector.Update(cur, prev) && cur->GetId() == last;
+	selector.Term();
+	return ok && selector.GetNumSets() == 0;
+}
+
+/***********************************************************************//**
+ * @brief			要求の処理中・公開待ち・返却待ちのまま Term() しても全セットを解放するか
+ **************************************************************************/
+bool CheckSelectorTerm(void)
+{
+	const TestHrirs a(16, 1.0f), b(16, 2.0f);
+	YmHrtfSelector selector;
+	const YmHrtfSet* cur = nullptr;
+	const YmHrtfSet* prev = nullptr;
+
+	// 処理中・未処理の要求
+	bool ok = selector.Init(nullptr, 32, 64) && a.Request(selector) != 0 && b.Request(selector) != 0;
+	selector.Term();
+	ok = ok && selector.GetNumSets() == 0 && a.Request(selector) == 0;
+
+	// 公開済み・未受取
+	YmUInt32 id = 0;
+	ok = ok && selector.Init(nullptr, 32, 64) && (id = a.Request(selector)) != 0 && WaitFor([&]() { return selector.IsReady(id); });
+	selector.Term();
+	ok = ok && selector.GetNumSets() == 0;
+
+	// 切替直後 (旧セットが返却前)
+	ok = ok && selector.Init(nullptr, 32, 64) && (id = a.Request(selector)) != 0 && WaitFor([&]() { return selector.IsReady(id); })
+		&& selector.Update(cur, prev) && (id = b.Request(selector)) != 0 && WaitFor([&]() { return selector.IsReady(id); })
+		&& selector.Update(cur, prev) && prev != nullptr && selector.GetNumSets() == 2;
+	selector.Term();
+	return ok && selector.GetNumSets() == 0;
+}
+
+/***********************************************************************//**
+ * @brief			周波数の異なる HRIR をローダースレッドで変換するか (ResampleIr() と同じ結果)
+ **************************************************************************/
+bool CheckSelectorResampledIr(YmUInt32 irRate, YmUInt32 hostRate)
+{
+	const TestHrirs ir(16, 1.0f);
+	TestHrirs ref;
+	YmHrtfSelector selector;
+	if (!ir.Resample(irRate, hostRate, ref) || !selector.Init(nullptr, 32, 128, hostRate)) return false;
+	const YmUInt32 id = ir.Request(selector, irRate);
+	const YmHrtfSet* cur = nullptr;
+	const YmHrtfSet* prev = nullptr;
+	const bool ok = id != 0 && WaitFor([&]() { return selector.IsReady(id); })
+		&& selector.Update(cur, prev) && MatchesTable(cur, 128, ref);
+	selector.Term();
+	return ok;
+}
+
+#if YM_USE_HRTF_PACK
+/***********************************************************************//**
+ * @brief			パックの公開 (周波数が同じならマップしたスペクトルを共有、異なれば HRIR に戻して変換)
+ * @note			カレントディレクトリに一時ファイルを書き出す。
+ **************************************************************************/
+bool CheckSelectorPack(YmUInt32 hostRate)
+{
+	const char* path = "ymcheck_selector.ymhp";
+	const TestHrirs ir(32, 1.0f);
+	TestHrirs ref;
+	YmFft fft;
+	YmHrtfTable table;
+	if (!ir.Resample(48000, hostRate, ref) || !fft.Init(nullptr, 64) || !table.Init(nullptr, fft, 6, 32, &ir.left[0], &ir.right[0])
+		|| !YmHrtfPack::Write(path, table, ir.directions, 32, 64, 48000))
+	{
+		return false;
+	}
+	YmHrtfSelector selector;
+	YmUInt32 id = 0;
+	const YmHrtfSet* cur = nullptr;
+	const YmHrtfSet* prev = nullptr;
+	const bool ok = selector.Init(nullptr, 32, 64, hostRate) && (id = selector.RequestPack(path)) != 0
+		&& WaitFor([&]() { return selector.IsReady(id) || selector.IsFailed(id); }) && selector.IsReady(id)
+		&& selector.Update(cur, prev) && MatchesTable(cur, 64, ref);
+	selector.Term();
+	remove(path);
+	return ok;
+}
+#endif
+
+void CheckHrtfSelector(Context& ctx)
+{
+	Check(ctx, "HrtfSelector/Switch", []() { return CheckSelectorSwitch(); });
+	Check(ctx, "HrtfSelector/Supersede", []() { return CheckSelectorSupersede(); });
+	Check(ctx, "HrtfSelector/TermWhilePending", []() { return CheckSelectorTerm(); });
+	Check(ctx, "HrtfSelector/ResampledIr/24000/48000", []() { return CheckSelectorResampledIr(24000, 48000); });
+	Check(ctx, "HrtfSelector/ResampledIr/44100/48000", []() { return CheckSelectorResampledIr(44100, 48000); });
+#if YM_USE_HRTF_PACK
+	Check(ctx, "HrtfSelector/Pack", []() { return CheckSelectorPack(48000); });
+	Check(ctx, "HrtfSelector/ResampledPack", []() { return CheckSelectorPack(44100); });
+#endif
+}
+#endif // YM_USE_HRTF_SELECTOR
+
+#if YM_USE_VOICE_BUDGET
+/***********************************************************************//**
+ * @brief			実ボイス 1 つの上限で、ブロックごとに大きい方のボイスが実ボイスになるか
+ * @param[in]		ticks		ブロックごとのティック (巻き戻りを含めてよい)
+ **************************************************************************/
+bool CheckVoiceBudgetTicks(const std::vector<YmUInt64>& ticks)
+{
+	const YmUInt32 B = 256;
+	YmVoiceBudgetConfig config;
+	config.maxRealVoices = 1;
+	config.cpuFraction = 0.0f;
+	config.hysteresis = 1.0f;
+	YmVoiceBudget budget;
+	if (!budget.Init(nullptr, 2, 48000, B, config)) return false;
+	const YmInt32 a = budget.Register(), b = budget.Register();
+	for (size_t n = 0; n < ticks.size(); n++)
+	{
+		// 途中で音量を入れ替える (順位付けは前ブロックの値を使うので 2 ブロック後に反映)
+		const bool aLouder = (n < ticks.size()/2);
+		budget.Update(a, ticks[n], aLouder ? 1.0f : 0.1f, 1.0f);
+		budget.Update(b, ticks[n], aLouder ? 0.1f : 1.0f, 1.0f);
+	}
+	const bool ok = !budget.IsReal(a) && budget.IsReal(b) && budget.GetNumReal() == 1;
+	budget.Term();
+	return ok;
+}
+
+void CheckVoiceBudget(Context& ctx)
+{
+	Check(ctx, "VoiceBudget/TickAdvance", []() {
+		std::vector<YmUInt64> ticks;
+		for (YmUInt64 n = 0; n < 16; n++) ticks.push_back(n*256);
+		return CheckVoiceBudgetTicks(ticks);
+	});
+	// ホスト側でティックが巻き戻った後も順位付けが続くか
+	Check(ctx, "VoiceBudget/TickReset", []() {
+		std::vector<YmUInt64> ticks;
+		for (YmUInt64 n = 0; n < 8; n++) ticks.push_back(1000000 + n*256);
+		for (YmUInt64 n = 0; n < 8; n++) ticks.push_back(n*256);
+		return CheckVoiceBudgetTicks(ticks);
+	});
+	// 解放・再登録したスロットは次の順位付けまで実ボイス
+	Check(ctx, "VoiceBudget/Reregister", []() {
+		YmVoiceBudgetConfig config;
+		config.maxRealVoices = 1;
+		config.cpuFraction = 0.0f;
+		YmVoiceBudget budget;
+		if (!budget.Init(nullptr, 2, 48000, 256, config)) return false;
+		const YmInt32 a = budget.Register(), b = budget.Register();
+		for (YmUInt64 n = 0; n < 4; n++)
+		{
+			budget.Update(a, n*256, 1.0f, 1.0f);
+			budget.Update(b, n*256, 0.1f, 1.0f);
+		}
+		const bool wasVirtual = !budget.IsReal(b);
+		budget.Unregister(b);
+		const YmInt32 c = budget.Register();
+		const bool ok = wasVirtual && c == b && budget.IsReal(c);
+		budget.Term();
+		return ok;
+	});
+}
+#endif // YM_USE_VOICE_BUDGET
+
+/***********************************************************************//**
+ * @brief			複数スレッドからの Acquire() / Release() で同じスロットが二重に渡らず、失われないか
+ * @param[in]		numThreads		スレッド数 (各スレッドが最大 3 スロットを保持するので、numSlots 未満なら枯渇も起きる)
+ **************************************************************************/
+bool CheckVoicePoolStress(YmUInt32 numSlots, YmUInt32 numThreads)
+{
+	const YmUInt32 iterations = 100000;
+	YmVoicePool pool;
+	if (!pool.Init(nullptr, numSlots, 40)) return false;
+	std::vector<std::atomic<YmUInt32> > owner(numSlots);
+	for (YmUInt32 i = 0; i < numSlots; i++) owner[i].store(0);
+	std::atomic<YmUInt32> numErrors(0);
+	std::atomic<bool> start(false);
+	std::vector<std::thread> threads;
+	for (YmUInt32 t = 0; t < numThreads; t++)
+	{
+		threads.push_back(std::thread([&, t]() {
+			void* held[3] = {};
+			YmUInt32 seed = t + 1;
+			while (!start.load()) std::this_thread::yield();
+			for (YmUInt32 n = 0; n < iterations; n++)
+			{
+				// コア数が少なくても操作が交互になるよう、ときどき譲る
+				if ((n & 63) == 0) std::this_thread::yield();
+				seed = seed*1664525u + 1013904223u;
+				const YmUInt32 k = (seed >> 16) % 3;
+				if (held[k] == nullptr)
+				{
+					held[k] = pool.Acquire();
+					if (held[k] == nullptr) continue;
+					const YmUInt32 index = pool.GetSlotIndex(held[k]);
+					YmUInt32 expected = 0;
+					// 取得したスロットを他のスレッドが保持していれば二重取得
+					if (!pool.Contains(held[k]) || ((uintptr_t)held[k] & (YM_VOICE_POOL_ALIGNMENT - 1)) != 0
+						|| !owner[index].compare_exchange_strong(expected, t + 1))
+					{
+						numErrors++;
+						held[k] = nullptr;
+						continue;
+					}
+					memset(held[k], (int)t, pool.GetSlotSize());
+				}
+				else
+				{
+					const YmUInt8* p = static_cast<const YmUInt8*>(held[k]);
+					if (p[0] != (YmUInt8)t || p[pool.GetSlotSize() - 1] != (YmUInt8)t) numErrors++;
+					owner[pool.GetSlotIndex(held[k])].store(0);
+					pool.Release(held[k]);
+					held[k] = nullptr;
+				}
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				if (held[k] == nullptr) continue;
+				owner[pool.GetSlotIndex(held[k])].store(0);
+				pool.Release(held[k]);
+			}
+		}));
+	}
+	start.store(true);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+	// 全スロットが空きリストに戻っていれば、ちょうど numSlots 個を重複なく取得でき、次は nullptr
+	bool ok = numErrors.load() == 0 && pool.GetNumUsed() == 0;
+	std::vector<void*> slots;
+	std::vector<bool> seen(numSlots, false);
+	for (YmUInt32 i = 0; ok && i < numSlots; i++)
+	{
+		void* slot = pool.Acquire();
+		ok = slot != nullptr && !seen[pool.GetSlotIndex(slot)];
+		if (ok) seen[pool.GetSlotIndex(slot)] = true;
+		slots.push_back(slot);
+	}
+	ok = ok && pool.Acquire() == nullptr && pool.GetNumUsed() == numSlots;
+	for (size_t i = 0; i < slots.size(); i++) pool.Release(slots[i]);
+	ok = ok && pool.GetNumUsed() == 0;
+	pool.Term();
+	return ok;
+}
+
+void CheckVoicePool(Context& ctx)
+{
+	Check(ctx, "VoicePool/Stress/8/1", []() { return CheckVoicePoolStress(8, 1); });
+	Check(ctx, "VoicePool/Stress/8/4", []() { return CheckVoicePoolStress(8, 4); });
+	Check(ctx, "VoicePool/Stress/64/8", []() { return CheckVoicePoolStress(64, 8); });
+}
+
+#if YM_USE_WORKER_POOL
+/***********************************************************************//**
+ * @brief			YmWorkerPool の ParallelFor() で各タスクがちょうど 1 回実行され、戻った時点で完了しているか
+ * @note			タスクごとの実行回数は累積で数え、join 後に遅れて実行されたタスクも次の照合で見つける。
+ *					spinMicroseconds = 0 ではワーカーが毎回スリープするので、起床の経路を通る。
+ **************************************************************************/
+struct PoolTasks
+{
+	std::vector<std::atomic<YmUInt32> >	counts;
+	std::vector<YmUInt32>				expected;
+
+	explicit PoolTasks(YmUInt32 maxTasks) : counts(maxTasks), expected(maxTasks, 0)
+	{
+		for (YmUInt32 i = 0; i < maxTasks; i++) counts[i].store(0);
+	}
+
+	static void Run(void* context, YmUInt32 index)
+	{
+		PoolTasks* self = static_cast<PoolTasks*>(context);
+		// コア数が少なくてもワーカーと呼び出し元が交互に取り合うよう、ときどき譲る
+		if ((index & 7) == 3) std::this_thread::yield();
+		self->counts[index].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool RunAndVerify(YmWorkerPool& pool, YmUInt32 numTasks)
+	{
+		pool.ParallelFor(numTasks, &PoolTasks::Run, this);
+		for (YmUInt32 i = 0; i < numTasks; i++) expected[i]++;
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			if (counts[i].load(std::memory_order_relaxed) != expected[i])
+			{
+				fprintf(stderr, "  task %u of %u: ran %u times, expected %u\n", (YmUInt32)i, numTasks, counts[i].load(), expected[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+bool CheckWorkerPoolRepeat(YmUInt32 numWorkers, YmUInt32 spinMicroseconds)
+{
+	const YmUInt32 maxTasks = 97, iterations = 3000;
+	YmWorkerPool pool;
+	PoolTasks tasks(maxTasks);
+	bool ok = pool.Init(numWorkers, spinMicroseconds);
+	YmUInt32 seed = numWorkers*31 + spinMicroseconds;
+	for (YmUInt32 n = 0; ok && n < iterations; n++)
+	{
+		// 参加者数より少ない・0・1 タスクのジョブも混ぜる
+		seed = seed*1664525u + 1013904223u;
+		ok = tasks.RunAndVerify(pool, (seed >> 16) % (maxTasks + 1));
+	}
+	pool.Term();
+	return ok;
+}
+
+bool CheckWorkerPoolTermAfterWake(YmUInt32 numWorkers)
+{
+	const YmUInt32 numTasks = 33, iterations = 200;
+	YmWorkerPool pool;
+	PoolTasks tasks(numTasks);
+	bool ok = true;
+	for (YmUInt32 n = 0; ok && n < iterations; n++)
+	{
+		// 半分はワーカーがスリープに入ってから起こし、起床の途中で Term() する
+		ok = pool.Init(numWorkers, 0);
+		if (n & 1) std::this_thread::sleep_for(std::chrono::microseconds(200));
+		ok = ok && tasks.RunAndVerify(pool, numTasks);
+		pool.Term();
+		ok = ok && pool.GetNumWorkers() == 0;
+	}
+	return ok;
+}
+
+void CheckWorkerPool(Context& ctx)
+{
+	Check(ctx, "WorkerPool/Repeat/1/spin", []() { return CheckWorkerPoolRepeat(1, 50); });
+	Check(ctx, "WorkerPool/Repeat/1/sleep", []() { return CheckWorkerPoolRepeat(1, 0); });
+	Check(ctx, "WorkerPool/Repeat/7/spin", []() { return CheckWorkerPoolRepeat(7, 50); });
+	Check(ctx, "WorkerPool/Repeat/7/sleep", []() { return CheckWorkerPoolRepeat(7, 0); });
+	Check(ctx, "WorkerPool/TermAfterWake/1", []() { return CheckWorkerPoolTermAfterWake(1); });
+	Check(ctx, "WorkerPool/TermAfterWake/7", []() { return CheckWorkerPoolTermAfterWake(7); });
+}
+#endif // YM_USE_WORKER_POOL
+
+/***********************************************************************//**
+ * @brief			容量を何周もしながら、公開した順にすべて読み出せるか
+ **************************************************************************/
+bool CheckCommandWrapAround(void)
+{
+	YmCommandQueue queue;
+	if (!queue.Init(nullptr, 8)) return false;
+	YmUInt32 written = 0, read = 0;
+	bool ok = true;
+	for (YmUInt32 round = 0; ok && round < 100; round++)
+	{
+		const YmUInt32 count = round % queue.GetCapacity() + 1;
+		for (YmUInt32 i = 0; i < count; i++) ok = ok && queue.PushFloat(YM_COMMAND_IMMEDIATE, written++, 0, 0.0f);
+		queue.Drain(0, [&](const YmCommand& c) { ok = ok && c.target == read++; });
+		ok = ok && read == written && queue.GetNumPending() == 0;
+	}
+	return ok;
+}
+
+/***********************************************************************//**
+ * @brief			満杯で Reserve() が nullptr を返し、読み出すとまた確保できるか
+ **************************************************************************/
+bool CheckCommandFull(void)
+{
+	YmCommandQueue queue;
+	if (!queue.Init(nullptr, 5) || queue.GetCapacity() != 8) return false;
+	bool ok = true;
+	for (YmUInt32 i = 0; i < 8; i++) ok = ok && queue.Reserve() != nullptr;
+	ok = ok && queue.Reserve() == nullptr;
+	queue.Publish();
+	ok = ok && !queue.PushFloat(YM_COMMAND_IMMEDIATE, 0, 0, 0.0f) && queue.GetNumPending() == 8;
+	ok = ok && queue.Peek() != nullptr;
+	queue.Pop();
+	ok = ok && queue.Reserve() != nullptr && queue.Reserve() == nullptr;
+	return ok;
+}
+
+/***********************************************************************//**
+ * @brief			Reserve() したコマンドは Publish() まで見えず、公開後はまとめて順に見えるか
+ **************************************************************************/
+bool CheckCommandPublish(void)
+{
+	YmCommandQueue queue;
+	if (!queue.Init(nullptr, 16)) return false;
+	for (YmUInt32 i = 0; i < 3; i++)
+	{
+		YmCommand* c = queue.Reserve();
+		if (c == nullptr) return false;
+		c->tick = YM_COMMAND_IMMEDIATE;
+		c->target = i;
+	}
+	bool ok = queue.Peek() == nullptr && queue.GetNumPending() == 0 && queue.GetNextOffset(0, 256) == 256;
+	queue.Publish();
+	YmUInt32 next = 0;
+	ok = ok && queue.GetNumPending() == 3
+		&& queue.Drain(0, [&](const YmCommand& c) { ok = ok && c.target == next++; }) == 3 && queue.Peek() == nullptr;
+	return ok;
+}
+
+/***********************************************************************//**
+ * @brief			ブロック内の適用位置 (IMMEDIATE・過去の tick はブロック先頭、先の tick は次のブロック)
+ **************************************************************************/
+bool CheckCommandOffsets(void)
+{
+	const YmUInt32 B = 256;
+	YmCommandQueue queue;
+	if (!queue.Init(nullptr, 16)) return false;
+	const YmUInt64 ticks[] = { YM_COMMAND_IMMEDIATE, 900, 1000, 1100, 1100, 1255, 1300 };
+	for (YmUInt32 i = 0; i < 7; i++) queue.PushFloat(ticks[i], i, 0, 0.0f);
+
+	// オーディオスレッドの処理: 適用位置まで進めてから Drain() する
+	std::vector<YmUInt32> offsets, targets;
+	for (YmUInt64 blockTick = 1000; blockTick < 1000 + 2*B; blockTick += B)
+	{
+		for (YmUInt32 offset = queue.GetNextOffset(blockTick, B); offset < B; offset = queue.GetNextOffset(blockTick, B))
+		{
+			queue.Drain(blockTick + offset, [&](const YmCommand& c) {
+				offsets.push_back((YmUInt32)(blockTick - 1000) + offset);
+				targets.push_back(c.target);
+			});
+		}
+	}
+	// ブロック 0: 0 (IMMEDIATE, 900, 1000), 100 (1100 x 2), 255 / ブロック 1: 44 (1300)
+	const YmUInt32 expectedOffsets[] = { 0, 0, 0, 100, 100, 255, 300 };
+	bool ok = offsets.size() == 7 && queue.Peek() == nullptr;
+	for (YmUInt32 i = 0; ok && i < 7; i++) ok = offsets[i] == expectedOffsets[i] && targets[i] == i;
+	return ok;
+}
+
+/***********************************************************************//**
+ * @brief			書込み・読出しの 2 スレッドで、全コマンドが欠けず順序どおり、値も揃って届くか
+ **************************************************************************/
+bool CheckCommandSpsc(void)
+{
+	const YmUInt32 count = 200000;
+	YmCommandQueue queue;
+	if (!queue.Init(nullptr, 64)) return false;
+	std::thread producer([&]() {
+		YmUInt32 seq = 0, seed = 1;
+		while (seq < count)
+		{
+			// 1..16 件ずつまとめて公開する (満杯なら読出しを待つ)
+			seed = seed*1664525u + 1013904223u;
+			const YmUInt32 batch = (seed >> 16) % 16 + 1;
+			YmUInt32 n = 0;
+			for (; n < batch && seq < count; n++, seq++)
+			{
+				YmCommand* c = queue.Reserve();
+				if (c == nullptr) break;
+				c->tick = seq;
+				c->type = YM_COMMAND_SET_POSITION;
+				c->target = seq;
+				for (int k = 0; k < 4; k++) c->value[k] = (YmReal32)(seq*4 + k);
+			}
+			queue.Publish();
+			if (n < batch) std::this_thread::yield();
+		}
+	});
+	YmUInt32 next = 0, numErrors = 0;
+	while (next < count)
+	{
+		const YmCommand* c = queue.Peek();
+		if (c == nullptr)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		bool ok = c->tick == next && c->target == next && c->type == YM_COMMAND_SET_POSITION;
+		for (int k = 0; k < 4; k++) ok = ok && c->value[k] == (YmReal32)(next*4 + k);
+		if (!ok) numErrors++;
+		queue.Pop();
+		next++;
+	}
+	producer.join();
+	return numErrors == 0 && queue.Peek() == nullptr;
+}
+
+void CheckCommandQueue(Context& ctx)
+{
+	Check(ctx, "CommandQueue/WrapAround", []() { return CheckCommandWrapAround(); });
+	Check(ctx, "CommandQueue/Full", []() { return CheckCommandFull(); });
+	Check(ctx, "CommandQueue/Publish", []() { return CheckCommandPublish(); });
+	Check(ctx, "CommandQueue/Offsets", []() { return CheckCommandOffsets(); });
+	Check(ctx, "CommandQueue/Spsc", []() { return CheckCommandSpsc(); });
+}
+
+/***********************************************************************//**
+ * @brief			YmMathBatch / YmVectorArray の一括版とスカラー版 YmMath の比較
+ * @note			参照値はスカラー版と同じ式を倍精度で計算したもの。許容誤差は YmMathBatch.h の記載値。
+ *					要素数は端数 (ゼロ詰めの経路) と AoS のチャンク境界 (YM_MATH_BATCH_CHUNK) をまたぐものを選ぶ。
+ **************************************************************************/
+YmReal32 Uniform(YmUInt32& seed, YmReal32 lo, YmReal32 hi)
+{
+	seed = seed*1664525u + 1013904223u;
+	return lo + (hi - lo)*((YmReal32)(seed >> 8)/(YmReal32)(1u << 24));
+}
+
+const double PI_D = 3.14159265358979323846;
+
+// YmMath::RectToPolar を倍精度で
+void RectToPolarRef(double x, double y, double z, double& azim, double& elev, double& dist)
+{
+	dist = sqrt(x*x + y*y + z*z);
+	if (dist < 1.e-37) { azim = elev = 0.0; return; }
+	elev = asin(y/dist);
+	if (z == 0.0) azim = (x == 0.0) ? 0.0 : (x < 0.0 ? 0.5*PI_D : 1.5*PI_D);
+	else if (z < 0.0) azim = PI_D - atan(x/z);
+	else azim = -atan(x/z);
+}
+
+// 3π/2 と -π/2 は同じ向きなので、方位角の差は 2π の剰余で測る
+double AngleError(double a, double b)
+{
+	double d = fmod(fabs(a - b), 2.0*PI_D);
+	return YmMath::Min(d, 2.0*PI_D - d);
+}
+
+// 音源位置を模した点 (軸上・原点を含む)
+void FillPoints(std::vector<YmVector3>& v, YmUInt32 seed)
+{
+	static const YmVector3 special[] = {
+		YmVector3(0.0f, 0.0f, 0.0f), YmVector3(1.0f, 0.0f, 0.0f), YmVector3(-1.0f, 0.0f, 0.0f), YmVector3(0.0f, 1.0f, 0.0f),
+		YmVector3(0.0f, -1.0f, 0.0f), YmVector3(0.0f, 0.0f, 1.0f), YmVector3(0.0f, 0.0f, -1.0f), YmVector3(2.0f, 0.0f, -3.0f),
+	};
+	for (size_t i = 0; i < v.size(); i++)
+	{
+		if (i < sizeof(special)/sizeof(special[0])) { v[i] = special[i]; continue; }
+		const YmReal32 scale = powf(10.0f, Uniform(seed, -3.0f, 3.0f));
+		v[i] = YmVector3(Uniform(seed, -1.0f, 1.0f), Uniform(seed, -1.0f, 1.0f), Uniform(seed, -1.0f, 1.0f))*scale;
+	}
+}
+
+bool CheckRectToPolarBatch(YmUInt32 count)
+{
+	std::vector<YmVector3> points(count);
+	FillPoints(points, count);
+	// 要素数の直後に番兵を置き、端数処理が範囲外に書かないことも確かめる
+	std::vector<YmReal32> x(count), y(count), z(count), azim(count + 4, 99.0f), elev(count + 4, 99.0f), dist(count + 4, 99.0f);
+	for (YmUInt32 i = 0; i < count; i++) { x[i] = points[i].x; y[i] = points[i].y; z[i] = points[i].z; }
+	YmMath::RectToPolar(&x[0], &y[0], &z[0], &azim[0], &elev[0], &dist[0], count);
+
+	double azimError = 0.0, elevError = 0.0, distError = 0.0;
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		double a, e, d;
+		RectToPolarRef(x[i], y[i], z[i], a, e, d);
+		azimError = YmMath::Max(azimError, AngleError(azim[i], a));
+		elevError = YmMath::Max(elevError, fabs(elev[i] - e));
+		distError = YmMath::Max(distError, (d > 0.0) ? fabs(dist[i] - d)/d : fabs(dist[i]));
+	}
+	bool ok = (azimError < 5.0e-7 && elevError < 2.0e-7 && distError < 1.5e-7);
+	for (YmUInt32 i = count; i < count + 4; i++) ok = ok && (azim[i] == 99.0f && elev[i] == 99.0f && dist[i] == 99.0f);
+
+	// AoS 版は SoA 版と要素ごとに同じ値
+	std::vector<YmPolar3> polars(count);
+	YmMath::RectToPolar(&points[0], &polars[0], count);
+	bool same = true;
+	for (YmUInt32 i = 0; i < count; i++) same = same && (polars[i].azim == azim[i] && polars[i].elev == elev[i] && polars[i].dist == dist[i]);
+
+	if (!ok || !same)
+	{
+		fprintf(stderr, "  count %u: azim %g, elev %g, dist %g, AoS %s\n", count, azimError, elevError, distError, same ? "same" : "differs");
+		return false;
+	}
+	return true;
+}
+
+bool CheckPolarToRectBatch(YmUInt32 count)
+{
+	YmUInt32 seed = count;
+	std::vector<YmReal32> azim(count), elev(count), dist(count), x(count + 4, 99.0f), y(count + 4, 99.0f), z(count + 4, 99.0f);
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		// 1/8 は範囲縮小の確認のため |azim| <= 8192 まで広げる
+		azim[i] = (i % 8 == 7) ? Uniform(seed, -8192.0f, 8192.0f) : Uniform(seed, -0.5f*YMH_PI, 1.5f*YMH_PI);
+		elev[i] = Uniform(seed, -0.5f*YMH_PI, 0.5f*YMH_PI);
+		dist[i] = Uniform(seed, 0.0f, 100.0f);
+	}
+	YmMath::PolarToRect(&azim[0], &elev[0], &dist[0], &x[0], &y[0], &z[0], count);
+
+	double maxError = 0.0;
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		const double h = (double)dist[i]*cos((double)elev[i]);
+		const double e = YmMath::Max(YmMath::Max(fabs(x[i] + h*sin((double)azim[i])), fabs(y[i] - dist[i]*sin((double)elev[i]))), fabs(z[i] - h*cos((double)azim[i])));
+		if (dist[i] > 0.0f) maxError = YmMath::Max(maxError, e/dist[i]);
+	}
+	bool ok = (maxError < 2.0e-7);
+	for (YmUInt32 i = count; i < count + 4; i++) ok = ok && (x[i] == 99.0f && y[i] == 99.0f && z[i] == 99.0f);
+
+	std::vector<YmPolar3> polars(count);
+	std::vector<YmVector3> rects(count);
+	for (YmUInt32 i = 0; i < count; i++) polars[i].Set(azim[i], elev[i], dist[i]);
+	YmMath::PolarToRect(&polars[0], &rects[0], count);
+	bool same = true;
+	for (YmUInt32 i = 0; i < count; i++) same = same && (rects[i].x == x[i] && rects[i].y == y[i] && rects[i].z == z[i]);
+
+	if (!ok || !same)
+	{
+		fprintf(stderr, "  count %u: error %g * dist, AoS %s\n", count, maxError, same ? "same" : "differs");
+		return false;
+	}
+	return true;
+}
+
+bool CheckGainBatch(YmUInt32 count)
+{
+	YmUInt32 seed = count;
+	std::vector<YmReal32> dB(count), lin(count), linIn(count), dBOut(count);
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		dB[i] = Uniform(seed, -120.0f, 120.0f);
+		linIn[i] = powf(2.0f, Uniform(seed, -40.0f, 10.0f));
+	}
+	YmMath::dBToLin(&dB[0], &lin[0], count);
+	YmMath::LinTodB(&linIn[0], &dBOut[0], count);
+
+	double linError = 0.0, dBError = 0.0, scalarError = 0.0;
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		const double ref = pow(10.0, dB[i]/20.0);
+		linError = YmMath::Max(linError, fabs(lin[i] - ref)/ref);
+		scalarError = YmMath::Max(scalarError, fabs(YmMath::dBToLin(dB[i]) - ref)/ref);
+		dBError = YmMath::Max(dBError, fabs(dBOut[i] - 20.0*log10((double)linIn[i])));
+	}
+
+	// lin <= 0 はスカラー版の -inf ではなく約 -758 dB
+	const YmReal32 nonPositive[] = { 0.0f, -1.0f, -0.0f, 1.17549435e-38f };
+	YmReal32 floor[4];
+	YmMath::LinTodB(nonPositive, floor, 4);
+	bool floorOk = true;
+	for (int k = 0; k < 4; k++) floorOk = floorOk && (floor[k] > -760.0f && floor[k] < -755.0f);
+
+	if (linError >= 8.0e-7 || dBError >= 3.0e-5 || !floorOk)
+	{
+		fprintf(stderr, "  count %u: dBToLin %g (scalar %g), LinTodB %g dB, floor %g %g %g %g\n",
+			count, linError, scalarError, dBError, floor[0], floor[1], floor[2], floor[3]);
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************************//**
+ * @brief			YmVectorArray の ToLocal / Normalize / RectToPolar (YmRender の音源更新と同じ並び)
+ **************************************************************************/
+bool CheckVectorArray(YmUInt32 count)
+{
+	std::vector<YmVector3> points(count);
+	FillPoints(points, count + 1);
+	YmVector3Array pos, local, dir;
+	YmPolar3Array polar;
+	if (!pos.Init(nullptr, count) || !local.Init(nullptr, count) || !dir.Init(nullptr, count) || !polar.Init(nullptr, count)) return false;
+	pos.Load(&points[0], count);
+
+	// yaw 0.3, pitch -0.2 を向いたリスナー (行が right/up/front)
+	const YmVector3 origin(1.5f, -0.25f, 2.0f);
+	const YmVector3 front = YmMath::PolarToRect(0.3f, -0.2f, 1.0f);
+	const YmVector3 up = YmMath::PolarToRect(0.3f, -0.2f + 0.5f*YMH_PI, 1.0f);
+	const YmVector3 right = YmMath::CrossProduct(up, front);
+	const YmReal32 rot[9] = { right.x, right.y, right.z, up.x, up.y, up.z, front.x, front.y, front.z };
+	std::vector<YmReal32> len(pos.GetPaddedCount());
+	YmMath::ToLocal(local, pos, origin, rot);
+	YmMath::Normalize(dir, local, &len[0]);
+	YmMath::RectToPolar(polar, local);
+
+	double localError = 0.0, dirError = 0.0, lenError = 0.0;
+	bool same = true;
+	for (YmUInt32 i = 0; i < count; i++)
+	{
+		const double d[3] = { (double)points[i].x - origin.x, (double)points[i].y - origin.y, (double)points[i].z - origin.z };
+		const double scale = YmMath::Abs(points[i]) + YmMath::Abs(origin);
+		double r[3], norm = 0.0;
+		for (int k = 0; k < 3; k++)
+		{
+			r[k] = rot[k*3]*d[0] + rot[k*3 + 1]*d[1] + rot[k*3 + 2]*d[2];
+			norm += r[k]*r[k];
+		}
+		norm = sqrt(norm);
+		const YmVector3 l = local.Get(i), u = dir.Get(i);
+		const double e[3] = { l.x - r[0], l.y - r[1], l.z - r[2] };
+		localError = YmMath::Max(localError, sqrt(e[0]*e[0] + e[1]*e[1] + e[2]*e[2])/scale);
+		if (norm > 1.e-6*scale)
+		{
+			const double f[3] = { u.x - l.x/(double)len[i], u.y - l.y/(double)len[i], u.z - l.z/(double)len[i] };
+			dirError = YmMath::Max(dirError, sqrt(f[0]*f[0] + f[1]*f[1] + f[2]*f[2]));
+			const double ln = sqrt((double)l.x*l.x + (double)l.y*l.y + (double)l.z*l.z);
+			lenError = YmMath::Max(lenError, fabs(len[i] - ln)/ln);
+		}
+
+		// 配列版の RectToPolar は SoA 版そのもの
+		const YmReal32 lx = l.x, ly = l.y, lz = l.z;
+		YmReal32 a, el, di;
+		YmMath::RectToPolar(&lx, &ly, &lz, &a, &el, &di, 1);
+		same = same && (polar.Azim()[i] == a && polar.Elev()[i] == el && polar.Dist()[i] == di);
+	}
+	if (localError >= 5.0e-7 || dirError >= 5.0e-7 || lenError >= 3.0e-7 || !same)
+	{
+		fprintf(stderr, "  count %u: ToLocal %g, Normalize %g (length %g), RectToPolar %s\n",
+			count, localError, dirError, lenError, same ? "same" : "differs");
+		return false;
+	}
+	return true;
+}
+
+void CheckMathBatch(Context& ctx)
+{
+	static const YmUInt32 counts[] = { 1, 3, 4, 5, 63, 64, 65, 1027 };
+	for (size_t i = 0; i < sizeof(counts)/sizeof(counts[0]); i++)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "MathBatch/RectToPolar/%u", counts[i]);
+		Check(ctx, name, [&]() { return CheckRectToPolarBatch(counts[i]); });
+		snprintf(name, sizeof(name), "MathBatch/PolarToRect/%u", counts[i]);
+		Check(ctx, name, [&]() { return CheckPolarToRectBatch(counts[i]); });
+		snprintf(name, sizeof(name), "MathBatch/Gain/%u", counts[i]);
+		Check(ctx, name, [&]() { return CheckGainBatch(counts[i]); });
+		snprintf(name, sizeof(name), "MathBatch/VectorArray/%u", counts[i]);
+		Check(ctx, name, [&]() { return CheckVectorArray(counts[i]); });
+	}
+}
+
+/***********************************************************************//**
+ * @brief			YmResampler のストリーム変換の正弦波の振幅・位相 (GetLatency() で遅延を補償)
+ **************************************************************************/
+bool CheckResamplerSine(YmUInt32 inRate, YmUInt32 outRate, YmReal64 freq)
+{
+	const YmUInt32 length = inRate/4, maxInput = 512;
+	YmResampler r;
+	if (!r.Init(nullptr, inRate, outRate, maxInput)) return false;
+	std::vector<YmReal32> in(length), out(r.GetMaxOutput(length) + maxInput);
+	for (YmUInt32 n = 0; n < length; n++) in[n] = (YmReal32)sin(2.0*PI_D*freq*n/inRate);
+	YmUInt32 numOut = 0;
+	for (YmUInt32 i = 0; i < length; i += maxInput) numOut += r.Process(&in[i], YmMath::Min(maxInput, length - i), &out[numOut]);
+
+	// 出力 m は入力時刻 m*inRate/outRate - GetLatency() に当たる。前後のフィルタ長分を除いて振幅と位相を最小二乗で求める
+	const YmReal64 latency = (YmReal64)r.GetLatency()/inRate;
+	const YmUInt32 margin = 2*YM_RESAMPLER_IR_TAPS*outRate/inRate + 2*YM_RESAMPLER_IR_TAPS;
+	YmReal64 ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+	for (YmUInt32 m = margin; m + margin < numOut; m++)
+	{
+		const YmReal64 w = 2.0*PI_D*freq*((YmReal64)m/outRate - latency);
+		const YmReal64 s = sin(w), c = cos(w);
+		ss += s*s; sc += s*c; cc += c*c;
+		ys += out[m]*s; yc += out[m]*c;
+	}
+	// out ≒ a sin(w) + b cos(w) = A sin(w + φ)。遅延が入力サンプルの整数倍ちょうどなら φ = 0
+	const YmReal64 det = ss*cc - sc*sc;
+	const YmReal64 a = (ys*cc - yc*sc)/det, b = (yc*ss - ys*sc)/det;
+	const YmReal64 amplitude = sqrt(a*a + b*b), phase = atan2(b, a);
+	if (fabs(amplitude - 1.0) > 5.0e-4 || fabs(phase) > 1.0e-5)
+	{
+		fprintf(stderr, "  %u -> %u, %g Hz: amplitude %.6f, phase %.6f rad (latency %u)\n", inRate, outRate, freq, amplitude, phase, r.GetLatency());
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************************//**
+ * @brief			ResampleIr() の振幅特性が元の IR と通過域でそろうか
+ **************************************************************************/
+bool CheckResampleIrMagnitude(YmUInt32 inRate, YmUInt32 outRate)
+{
+	// HRIR と同じく先頭に無音 (到達遅延) を置き、末尾までに減衰させる。
+	// 前後を切り捨てる分の誤差 (フィルタのプリリンギング・テール) が出ないようにするため
+	const YmUInt32 onset = YM_RESAMPLER_IR_TAPS, length = onset + 256;
+	std::vector<YmReal32> ir(length, 0.0f), noise(length - onset);
+	Fill(noise, 7);
+	for (YmUInt32 n = 0; n < length - onset; n++) ir[onset + n] = noise[n]*expf(-(YmReal32)n/24.0f);
+	std::vector<YmReal32> out(YmResampler::GetResampledLength(length, inRate, outRate));
+	if (!YmResampler::ResampleIr(nullptr, &ir[0], length, inRate, &out[0], outRate)) return false;
+
+	// 低い方のナイキストの 0.8 倍までを比べる (遷移帯域はその上)
+	const YmReal64 maxFreq = 0.4*YmMath::Min(inRate, outRate);
+	YmReal64 maxError = 0.0, peak = 0.0;
+	for (YmReal64 f = 0.0; f <= maxFreq; f += maxFreq/200.0)
+	{
+		YmReal64 mag[2];
+		const std::vector<YmReal32>* h[2] = { &ir, &out };
+		const YmUInt32 rates[2] = { inRate, outRate };
+		for (int k = 0; k < 2; k++)
+		{
+			YmReal64 re = 0.0, im = 0.0;
+			for (size_t n = 0; n < h[k]->size(); n++)
+			{
+				const YmReal64 w = 2.0*PI_D*f*n/rates[k];
+				re += (*h[k])[n]*cos(w);
+				im -= (*h[k])[n]*sin(w);
+			}
+			mag[k] = sqrt(re*re + im*im);
+		}
+		peak = YmMath::Max(peak, mag[0]);
+		maxError = YmMath::Max(maxError, fabs(mag[1] - mag[0]));
+	}
+	// 通過域のリップル (阻止域 70dB の設計で 3e-4 程度) を、IR のピーク振幅に対する比で見る
+	if (maxError > 5.0e-4*peak)
+	{
+		fprintf(stderr, "  %u -> %u: magnitude error %g (peak %g)\n", inRate, outRate, maxError, peak);
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************************//**
+ * @brief			可変長ブロックの Process() が、先頭に GetLatency() 個のゼロを足した一括 Resample() と一致するか
+ **************************************************************************/
+bool CheckResamplerBlocks(YmUInt32 inRate, YmUInt32 outRate)
+{
+	static const YmUInt32 blockSizes[] = { 1, 7, 64, 441, 0, 13, 512, 256, 3 };
+	const YmUInt32 length = 4000, maxInput = 512;
+	YmResampler r;
+	if (!r.Init(nullptr, inRate, outRate, maxInput, YM_RESAMPLER_IR_TAPS)) return false;
+	const YmUInt32 latency = r.GetLatency();
+	std::vector<YmReal32> in(latency + length, 0.0f), stream(r.GetMaxOutput(length) + (YmUInt32)(sizeof(blockSizes)/sizeof(blockSizes[0])));
+	Fill(in, 11);
+	std::fill(in.begin(), in.begin() + latency, 0.0f);
+
+	YmUInt32 numOut = 0, i = 0;
+	for (YmUInt32 b = 0; i < length; b++)
+	{
+		const YmUInt32 n = YmMath::Min(blockSizes[b % (sizeof(blockSizes)/sizeof(blockSizes[0]))], length - i);
+		numOut += r.Process(&in[latency + i], n, &stream[numOut]);
+		i += n;
+	}
+	std::vector<YmReal32> oneShot(YmResampler::GetResampledLength(latency + length, inRate, outRate));
+	if (!YmResampler::Resample(nullptr, &in[0], latency + length, inRate, &oneShot[0], outRate)) return false;
+
+	const YmUInt32 count = YmMath::Min(numOut, (YmUInt32)oneShot.size());
+	YmReal64 maxError = 0.0;
+	for (YmUInt32 m = 0; m < count; m++) maxError = YmMath::Max(maxError, (YmReal64)fabsf(stream[m] - oneShot[m]));
+	// ストリームは入力の終わりまでしか出さないので、一括版より遅延分だけ短い
+	if (maxError > 1.0e-6 || count + (YmUInt64)latency*outRate/inRate + 2 < oneShot.size())
+	{
+		fprintf(stderr, "  %u -> %u: max error %g over %u outputs (one-shot %u)\n", inRate, outRate, maxError, count, (YmUInt32)oneShot.size());
+		return false;
+	}
+	return true;
+}
+
+void CheckResampler(Context& ctx)
+{
+	static const YmUInt32 rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 24000, 48000 } };
+	for (size_t i = 0; i < sizeof(rates)/sizeof(rates[0]); i++)
+	{
+		const YmUInt32 inRate = rates[i][0], outRate = rates[i][1];
+		char name[64];
+		snprintf(name, sizeof(name), "Resampler/Sine/%u/%u/1000", inRate, outRate);
+		Check(ctx, name, [&]() { return CheckResamplerSine(inRate, outRate, 1000.0); });
+		const YmUInt32 high = (YmUInt32)(0.35*YmMath::Min(inRate, outRate));
+		snprintf(name, sizeof(name), "Resampler/Sine/%u/%u/%u", inRate, outRate, high);
+		Check(ctx, name, [&]() { return CheckResamplerSine(inRate, outRate, (YmReal64)high); });
+		snprintf(name, sizeof(name), "Resampler/IrMagnitude/%u/%u", inRate, outRate);
+		Check(ctx, name, [&]() { return CheckResampleIrMagnitude(inRate, outRate); });
+		snprintf(name, sizeof(name), "Resampler/Blocks/%u/%u", inRate, outRate);
+		Check(ctx, name, [&]() { return CheckResamplerBlocks(inRate, outRate); });
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Context ctx;
+	ctx.filter = nullptr;
+	ctx.numChecks = 0;
+	ctx.numFailed = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)	ctx.filter = argv[++i];
+		else
+		{
+			fprintf(stderr, "usage: ymcheck [-f filter]\n");
+			return 2;
+		}
+	}
+
+	CheckFftTiers(ctx);
+	CheckConvolution(ctx);
+	CheckFilterUpdates(ctx);
+#if YM_USE_SILENCE_BYPASS
+	CheckSilenceGate(ctx);
+#endif
+#if YM_USE_HRTF_PACK
+	CheckHrtfPack(ctx);
+#endif
+#if YM_USE_HRTF_SELECTOR
+	CheckHrtfSelector(ctx);
+#endif
+#if YM_USE_VOICE_BUDGET
+	CheckVoiceBudget(ctx);
+#endif
+	CheckVoicePool(ctx);
+#if YM_USE_WORKER_POOL
+	CheckWorkerPool(ctx);
+#endif
+	CheckCommandQueue(ctx);
+	CheckMathBatch(ctx);
+	CheckResampler(ctx);
+
+	fprintf(stderr, "%u/%u checks passed\n", ctx.numChecks - ctx.numFailed, ctx.numChecks);
+	return (ctx.numFailed == 0) ? 0 : 1;
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,326 @@
+﻿/*****************************************************************************************//**
+ * @file			YmPluginBench.cpp
+ * @brief			スペーシャライザプラグインの E2E ベンチマーク (ヘッドレス)
+ * @attention		ビルド済みのネイティブオーディオプラグインを dlopen し、
+ *					UnityAudioEffectDefinition のコールバック (create / setfloatparameter /
+ *					process / release) を合成した UnityAudioEffectState で直接呼ぶ。
+ *
+ *					出力 (dspbuffersize ごと):
+ *					  ・1 コアあたりの最大ボイス数 (48kHz, process 時間の平均から算出)
+ *					  ・process コールバック 1 回の最悪値 / 99 パーセンタイル
+ *					  ・create / process / setfloatparameter 中のヒープ確保回数
+ *
+ *					ヒープ確保は malloc 系を実行ファイル側で差し替えて数える (glibc 前提, Linux のみ)。
+ *
+ *					ビルド (リポジトリのルートで):
+ *					  g++ -std=c++14 -O2 -pthread \
+ *					      -Iplatforms/unity/Assets/SoundXR/Plugins/iOS \
+ *					      tools/YmPluginBench/YmPluginBench.cpp -o ympluginbench -ldl
+ *
+ *					使い方:
+ *					  ympluginbench [-e effectName] [-v voices] [-s seconds] [-csv] plugin.so
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dlfcn.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "AudioPluginInterface.h"
+
+#define YM_BENCH_SAMPLE_RATE		48000
+#define YM_BENCH_CHANNELS			2
+
+/***************************************************************************
+ * ヒープ確保の計数 (glibc の実体へ転送)
+ **************************************************************************/
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+std::atomic<bool>		g_countEnabled(false);
+std::atomic<UInt64>		g_numAllocs(0);
+
+inline void CountAlloc(void)
+{
+	if (g_countEnabled.load(std::memory_order_relaxed)) g_numAllocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+extern "C" {
+void* malloc(size_t size)							{ CountAlloc(); return __libc_malloc(size); }
+void* calloc(size_t count, size_t size)				{ CountAlloc(); return __libc_calloc(count, size); }
+void* realloc(void* ptr, size_t size)				{ CountAlloc(); return __libc_realloc(ptr, size); }
+void* memalign(size_t align, size_t size)			{ CountAlloc(); return __libc_memalign(align, size); }
+void* aligned_alloc(size_t align, size_t size)		{ CountAlloc(); return __libc_memalign(align, size); }
+int posix_memalign(void** ptr, size_t align, size_t size)
+{
+	CountAlloc();
+	*ptr = __libc_memalign(align, size);
+	return (*ptr != nullptr) ? 0 : 12;	// ENOMEM
+}
+void free(void* ptr)								{ __libc_free(ptr); }
+}
+
+namespace {
+
+/***********************************************************************//**
+ * @brief			区間内のヒープ確保回数
+ **************************************************************************/
+class AllocScope
+{
+public:
+	AllocScope() : m_start(g_numAllocs.load())	{ g_countEnabled.store(true); }
+	~AllocScope()								{ g_countEnabled.store(false); }
+	UInt64 GetCount(void) const					{ return g_numAllocs.load() - m_start; }
+private:
+	UInt64	m_start;
+};
+
+struct Voice
+{
+	UnityAudioEffectState		state;
+	UnityAudioSpatializerData	spatializer;
+	float						angle;
+};
+
+struct Result
+{
+	UInt32	blockSize;
+	UInt32	numVoices;
+	double	avgVoiceUs;			// ボイス 1 つの process 平均 [us]
+	double	maxCallUs;			// process 1 回の最悪値 [us]
+	double	p99CallUs;
+	double	voicesPerCore;
+	UInt64	createAllocs;
+	UInt64	processAllocs;
+	UInt64	paramAllocs;
+};
+
+int g_internalDummy;
+
+void SetIdentity(float* m)
+{
+	memset(m, 0, sizeof(float)*16);
+	m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+void InitVoice(Voice& v, UInt32 blockSize, float angle)
+{
+	memset(&v.state, 0, sizeof(v.state));
+	memset(&v.spatializer, 0, sizeof(v.spatializer));
+	SetIdentity(v.spatializer.listenermatrix);
+	SetIdentity(v.spatializer.sourcematrix);
+	v.spatializer.spatialblend = 1.0f;
+	v.spatializer.minDistance = 1.0f;
+	v.spatializer.maxDistance = 500.0f;
+	v.state.structsize = sizeof(UnityAudioEffectState);
+	v.state.samplerate = YM_BENCH_SAMPLE_RATE;
+	v.state.flags = UnityAudioEffectStateFlags_IsPlaying;
+	v.state.internal = &g_internalDummy;
+	v.state.spatializerdata = &v.spatializer;
+	v.state.dspbuffersize = blockSize;
+	v.state.hostapiversion = UNITY_AUDIO_PLUGIN_API_VERSION;
+	v.angle = angle;
+}
+
+// 音源をリスナーの周囲 2m で回転させる
+void MoveVoice(Voice& v, UInt32 blockSize)
+{
+	v.angle += 2.0f*3.14159265f*0.25f*blockSize/(float)YM_BENCH_SAMPLE_RATE;	// 0.25 回転/秒
+	v.spatializer.sourcematrix[12] = 2.0f*sinf(v.angle);
+	v.spatializer.sourcematrix[13] = 0.0f;
+	v.spatializer.sourcematrix[14] = 2.0f*cosf(v.angle);
+	v.state.prevdsptick = v.state.currdsptick;
+	v.state.currdsptick += blockSize;
+}
+
+// 作成済みの先頭 count 個のボイスを解放する
+void ReleaseVoices(UnityAudioEffectDefinition* def, std::vector<Voice>& voices, UInt32 count)
+{
+	for (UInt32 i = 0; i < count; i++)
+	{
+		if (def->release) def->release(&voices[i].state);
+	}
+}
+
+bool Run(UnityAudioEffectDefinition* def, UInt32 blockSize, UInt32 numVoices, double seconds, Result& res)
+{
+	typedef std::chrono::steady_clock Clock;
+	std::vector<Voice> voices(numVoices);
+	std::vector<float> in((size_t)blockSize*YM_BENCH_CHANNELS), out((size_t)blockSize*YM_BENCH_CHANNELS);
+	for (size_t i = 0; i < in.size(); i++) in[i] = 0.25f*sinf(0.01f*(float)i);
+
+	res.blockSize = blockSize;
+	res.numVoices = numVoices;
+	{
+		AllocScope scope;
+		for (UInt32 i = 0; i < numVoices; i++)
+		{
+			InitVoice(voices[i], blockSize, 2.0f*3.14159265f*i/numVoices);
+			if (def->create && def->create(&voices[i].state) != UNITY_AUDIODSP_OK)
+			{
+				fprintf(stderr, "error: create failed\n");
+				ReleaseVoices(def, voices, i);
+				return false;
+			}
+			for (UInt32 p = 0; p < def->numparameters && def->setfloatparameter; p++)
+			{
+				def->setfloatparameter(&voices[i].state, (int)p, def->paramdefs[p].defaultval);
+			}
+		}
+		res.createAllocs = scope.GetCount();
+	}
+
+	const UInt32 numBlocks = (UInt32)(seconds*YM_BENCH_SAMPLE_RATE/blockSize) + 1;
+	const UInt32 warmup = numBlocks/10 + 1;
+	std::vector<double> callUs;
+	callUs.reserve((size_t)numBlocks*numVoices);
+	double totalUs = 0.0;
+	res.processAllocs = 0;
+	res.paramAllocs = 0;
+	for (UInt32 b = 0; b < warmup + numBlocks; b++)
+	{
+		const bool measure = (b >= warmup);
+		// 時々パラメータを設定し直す (GUI 操作相当)
+		if ((b % 64) == 0 && def->setfloatparameter)
+		{
+			AllocScope scope;
+			for (UInt32 i = 0; i < numVoices; i++)
+			{
+				for (UInt32 p = 0; p < def->numparameters; p++)
+				{
+					def->setfloatparameter(&voices[i].state, (int)p, def->paramdefs[p].defaultval);
+				}
+			}
+			if (measure) res.paramAllocs += scope.GetCount();
+		}
+		AllocScope scope;
+		for (UInt32 i = 0; i < numVoices; i++)
+		{
+			MoveVoice(voices[i], blockSize);
+			const Clock::time_point t0 = Clock::now();
+			def->process(&voices[i].state, &in[0], &out[0], blockSize, YM_BENCH_CHANNELS, YM_BENCH_CHANNELS);
+			const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+			if (measure)
+			{
+				callUs.push_back(us);
+				totalUs += us;
+			}
+		}
+		if (measure) res.processAllocs += scope.GetCount();
+	}
+
+	ReleaseVoices(def, voices, numVoices);
+
+	std::sort(callUs.begin(), callUs.end());
+	res.avgVoiceUs = totalUs / (double)callUs.size();
+	res.maxCallUs = callUs.back();
+	res.p99CallUs = callUs[(size_t)(0.99*(callUs.size() - 1))];
+	const double blockUs = 1e6*blockSize/(double)YM_BENCH_SAMPLE_RATE;
+	res.voicesPerCore = blockUs / res.avgVoiceUs;
+	return true;
+}
+
+UnityAudioEffectDefinition* FindEffect(UnityAudioEffectDefinition** defs, int num, const char* name)
+{
+	for (int i = 0; i < num; i++)
+	{
+		if (name ? (strcmp(defs[i]->name, name) == 0) : ((defs[i]->flags & UnityAudioEffectDefinitionFlags_IsSpatializer) != 0)) return defs[i];
+	}
+	return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const char* pluginPath = nullptr;
+	const char* effectName = nullptr;
+	UInt32 numVoices = 32;
+	double seconds = 2.0;
+	bool csv = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)			effectName = argv[++i];
+		else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc)	numVoices = (UInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)	seconds = atof(argv[++i]);
+		else if (strcmp(argv[i], "-csv") == 0)					csv = true;
+		else if (argv[i][0] != '-' && pluginPath == nullptr)	pluginPath = argv[i];
+		else													pluginPath = nullptr, i = argc;
+	}
+	if (pluginPath == nullptr || numVoices == 0)
+	{
+		fprintf(stderr, "usage: ympluginbench [-e effectName] [-v voices] [-s seconds] [-csv] plugin.so\n");
+		return 2;
+	}
+
+	void* lib = dlopen(pluginPath, RTLD_NOW | RTLD_LOCAL);
+	if (lib == nullptr)
+	{
+		fprintf(stderr, "error: %s\n", dlerror());
+		return 1;
+	}
+	typedef int (*GetDefinitionsFunc)(UnityAudioEffectDefinition***);
+	GetDefinitionsFunc getDefinitions = (GetDefinitionsFunc)dlsym(lib, "UnityGetAudioEffectDefinitions");
+	UnityAudioEffectDefinition** defs = nullptr;
+	const int numDefs = getDefinitions ? getDefinitions(&defs) : 0;
+	UnityAudioEffectDefinition* def = FindEffect(defs, numDefs, effectName);
+	if (def == nullptr || def->process == nullptr)
+	{
+		fprintf(stderr, "error: no %s effect in %s\n", effectName ? effectName : "spatializer", pluginPath);
+		dlclose(lib);
+		return 1;
+	}
+	fprintf(stderr, "effect: %s (%u parameters)\n", def->name, def->numparameters);
+
+	static const UInt32 s_blockSizes[] = { 256, 512, 1024 };
+	std::vector<Result> results;
+	for (size_t i = 0; i < sizeof(s_blockSizes)/sizeof(s_blockSizes[0]); i++)
+	{
+		Result res;
+		if (!Run(def, s_blockSizes[i], numVoices, seconds, res)) break;
+		results.push_back(res);
+	}
+	dlclose(lib);
+
+	if (csv) printf("dspbuffersize,voices,avg_voice_us,max_call_us,p99_call_us,voices_per_core,create_allocs,process_allocs,param_allocs\n");
+	else printf("[\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		if (csv)
+		{
+			printf("%u,%u,%.3f,%.3f,%.3f,%.1f,%llu,%llu,%llu\n", r.blockSize, r.numVoices, r.avgVoiceUs, r.maxCallUs, r.p99CallUs,
+				r.voicesPerCore, (unsigned long long)r.createAllocs, (unsigned long long)r.processAllocs, (unsigned long long)r.paramAllocs);
+		}
+		else
+		{
+			printf("  {\"dspbuffersize\": %u, \"voices\": %u, \"avg_voice_us\": %.3f, \"max_call_us\": %.3f, \"p99_call_us\": %.3f, "
+				"\"voices_per_core\": %.1f, \"create_allocs\": %llu, \"process_allocs\": %llu, \"param_allocs\": %llu}%s\n",
+				r.blockSize, r.numVoices, r.avgVoiceUs, r.maxCallUs, r.p99CallUs, r.voicesPerCore,
+				(unsigned long long)r.createAllocs, (unsigned long long)r.processAllocs, (unsigned long long)r.paramAllocs,
+				(i + 1 < results.size()) ? "," : "");
+		}
+	}
+	if (!csv) printf("]\n");
+	return results.empty() ? 1 : 0;
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
@@ -0,0 +1,1014 @@
+﻿/*****************************************************************************************//**
+ * @file			YmRender.cpp
+ * @brief			オフライン一括バイノーラルレンダラ (汎用 Linux ターゲット)
+ * @attention		シーン記述ファイルごとに 1 本のステレオ WAV を出力する。
+ *					シーンはスレッドに分配して並列処理する (-j)。
+ *
+ *					ビルド (リポジトリのルートで):
+ *					  g++ -std=c++14 -O2 -msse3 -pthread \
+ *					      -Iplatforms/unity/Assets/SoundXR/Plugins/AudioPluginViReal.bundle/Contents/Resources \
+ *					      -Itools/common tools/YmRender/YmRender.cpp -o ymrender
+ *
+ *					使い方:
+ *					  ymrender -h hrtf.txt [-j threads] [-b blockSize] [-r rate] [-n] [-a order | -l length | -c degrees] [-v voices] [-p workers] [-16] scene1.txt [scene2.txt ...]
+ *					  ymrender -h hrtf.txt [-b blockSize] [-r rate] -w hrtf.ymhp	(HRTF パックの書出し)
+ *					  ymrender -h hrtf.ymhp [...] scene1.txt [...]					(HRTF パックで描画)
+ *
+ *					HRTF リスト (1 行 1 方向, 角度は度, IR はステレオ WAV):
+ *					  <azim> <elev> <ir.wav>
+ *					-h にパック (YmHrtfPack.h) を渡した場合はマップしたスペクトルを全スレッドで共有する。
+ *					パックは -w 時のブロックサイズ以下でのみ使える。
+ *
+ *					シーン記述 (# 以降はコメント, 時刻は秒, 座標は m, 角度は度):
+ *					  output   <out.wav>
+ *					  listener <x> <y> <z> <yaw> <pitch> <roll>
+ *					  source   <in.wav> [gain_dB]
+ *					  key      <t> <x> <y> <z>		(直前の source の軌跡, 線形補間)
+ *					  hrtf     <t> <hrtf.txt|hrtf.ymhp>	(t 秒以降のブロックで HRTF セットを切り替える)
+ *
+ *					座標系は YmVector3 に従う (x:右, y:上, z:前)。yaw は左回り、pitch は上向きが正。
+ *					サンプリング周波数は -r で指定する (既定 48kHz)。周波数の異なる HRTF (WAV・パック) と
+ *					入力 WAV は読込時に YmResampler で変換する。方向は YmHrtfGrid による測定方向 3 点の補間
+ *					(-n で最近傍) とし、前ブロックからの重みとゲインをブロック内で線形補間する。
+ *					-a では音源を指定次数のアンビソニックバスにエンコードし、バス 1 本をバイノーラルデコードする
+ *					(YmAmbisonic.h。音源数によらず畳込み回数が一定になる)。
+ *					-l では音源ごとに距離と音量から描画段階を選ぶ (YmLod.h)。SHORT 段階は最小位相化した
+ *					length サンプルの HRIR を使う。シーンごとに段階別のボイス数 (ボイス x ブロック) を表示する。
+ *					-v では実ボイスを可聴度の上位 voices 個に制限し、残りを仮想化する (YmVoiceBudget.h)。
+ *					シーンごとに実 / 仮想のボイス数 (ボイス x ブロック) を表示する。-a とは併用できない。
+ *					-p ではシーンごとに workers 個のワーカースレッド (YmWorkerPool.h) を起動し、
+ *					YmBatchSpatializer の方向ごとの FFT を並列に行う。出力は -p なしと一致する。
+ *					シーン数がコア数より少ない場合に使う (-j と合わせてコア数以下にすること)。
+ *					-c では音源ごとに YmConvolver で畳み込み、方向が degrees 度を超えて変わったブロックだけ
+ *					補間した HRIR で UpdateFilters() する (YmDirectionGate)。フィルタの更新はクロスフェードする。
+ *					シーンごとに更新回数と閾値で省いた回数を表示する。-a / -l / -v / -p とは併用できない。
+ *					シーンに hrtf を書くと、-h のセットと切替先を YmHrtfSelector のローダースレッドで準備し、
+ *					切替ブロックで旧セットの方向 (BANK_PREVIOUS) から新セットの方向へクロスフェードする。
+ *					切替先のサンプリング周波数・方向数・HRIR 長は -h と異なってよい。-a / -l / -v / -c / -n とは併用できない。
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "private/YmBase.h"
+#include "private/YmBatchSpatializer.h"
+#include "private/YmConvolver.h"
+#include "private/YmHrtfGrid.h"
+#include "private/YmHrtfPack.h"
+#include "private/YmHrtfSelector.h"
+#include "private/YmResampler.h"
+#include "private/YmAmbisonic.h"
+#include "private/YmLod.h"
+#include "private/YmVoiceBudget.h"
+#include "private/YmWorkerPool.h"
+#include "YmWav.h"
+
+#define YM_RENDER_SAMPLE_RATE		48000		///< 既定のサンプリング周波数 [Hz]
+#define YM_RENDER_MIN_DISTANCE		1.0f		///< これより近い音源は距離減衰しない [m]
+
+namespace {
+
+struct HrtfSet
+{
+	YmUInt32				numDirections;
+	YmUInt32				irLength;
+	std::vector<YmVector3>	directions;		// 単位ベクトル
+	std::vector<YmReal32>	irLeft;			// [dir][irLength]
+	std::vector<YmReal32>	irRight;
+	YmHrtfGrid				grid;			// 3 点補間 (構築できなければ最近傍)
+	bool					hasGrid;
+	YmHrtfPack				pack;			// 開いていれば irLeft/irRight は空
+	YmUInt32				shortLength;	// SHORT 段階の HRIR (-l のみ)
+	std::vector<YmReal32>	shortLeft;		// [dir][shortLength]
+	std::vector<YmReal32>	shortRight;
+
+	HrtfSet() : numDirections(0), irLength(0), hasGrid(false), shortLength(0) {}
+
+	YmUInt32 FindNearest(const YmVector3& dir) const
+	{
+		YmUInt32 best = 0;
+		YmReal32 bestDot = -2.0f;
+		for (YmUInt32 d = 0; d < numDirections; d++)
+		{
+			const YmReal32 dot = YmMath::InnerProduct(directions[d], dir);
+			if (dot > bestDot) { bestDot = dot; best = d; }
+		}
+		return best;
+	}
+};
+
+struct Key
+{
+	YmReal32	time;
+	YmVector3	position;
+};
+
+struct Source
+{
+	std::string			path;
+	YmReal32			gain;
+	std::vector<Key>	keys;
+	YmWav				wav;
+
+	YmVector3 GetPosition(YmReal32 t) const
+	{
+		if (keys.empty()) return YmVector3(0.0f, 0.0f, 1.0f);
+		if (t <= keys.front().time) return keys.front().position;
+		for (size_t i = 1; i < keys.size(); i++)
+		{
+			if (t < keys[i].time)
+			{
+				const Key& a = keys[i - 1];
+				const Key& b = keys[i];
+				const YmReal32 r = (t - a.time) / (b.time - a.time);
+				return a.position + (b.position - a.position) * r;
+			}
+		}
+		return keys.back().position;
+	}
+};
+
+struct HrtfSwitch
+{
+	YmReal32	time;
+	std::string	path;
+};
+
+struct Scene
+{
+	std::string				path;
+	std::string				output;
+	YmVector3				listenerPosition;
+	YmVector3				listenerRight;
+	YmVector3				listenerUp;
+	YmVector3				listenerFront;
+	std::vector<Source>		sources;
+	std::vector<HrtfSwitch>	hrtfSwitches;
+
+	Scene() : listenerRight(1.0f, 0.0f, 0.0f), listenerUp(0.0f, 1.0f, 0.0f), listenerFront(0.0f, 0.0f, 1.0f) {}
+
+	void SetOrientation(YmReal32 yaw, YmReal32 pitch, YmReal32 roll)
+	{
+		const YmVector3 front = YmMath::PolarToRect(yaw, pitch, 1.0f);
+		const YmVector3 up0 = YmMath::PolarToRect(yaw, pitch + 0.5f*YMH_PI, 1.0f);
+		const YmVector3 right0 = YmMath::CrossProduct(up0, front);
+		listenerFront = front;
+		listenerUp = up0*cosf(roll) + right0*sinf(roll);
+		listenerRight = right0*cosf(roll) - up0*sinf(roll);
+	}
+
+	// ワールド座標 -> リスナー座標の回転行列 (YmMath::ToLocal 用、行が right/up/front)
+	void GetRotation(YmReal32 rot[9]) const
+	{
+		const YmVector3* axes[3] = { &listenerRight, &listenerUp, &listenerFront };
+		for (int k = 0; k < 3; k++)
+		{
+			rot[k*3 + 0] = axes[k]->x;
+			rot[k*3 + 1] = axes[k]->y;
+			rot[k*3 + 2] = axes[k]->z;
+		}
+	}
+};
+
+struct Options
+{
+	const char*	hrtfPath;
+	YmUInt32	blockSize;
+	YmUInt32	numThreads;
+	YmUInt32	sampleRate;
+	YmUInt32	ambisonicOrder;		// 0: 音源ごとの HRTF
+	YmUInt32	lodLength;			// 0: LOD なし (SHORT 段階の HRIR 長)
+	YmUInt32	maxRealVoices;		// 0: 仮想化なし
+	YmUInt32	numWorkers;			// 0: シーン内は直列処理
+	YmReal32	convThreshold;		// 負: バッチ畳込み (-c なし) [deg]
+	bool		nearest;
+	bool		pcm16;
+};
+
+void ToMono(const YmWav& wav, std::vector<YmReal32>& mono)
+{
+	const YmUInt32 frames = wav.GetNumFrames();
+	mono.assign(frames, 0.0f);
+	const YmReal32 scale = 1.0f / (YmReal32)wav.numChannels;
+	for (YmUInt32 n = 0; n < frames; n++)
+	{
+		for (YmUInt32 ch = 0; ch < wav.numChannels; ch++) mono[n] += wav.samples[(size_t)n*wav.numChannels + ch];
+		mono[n] *= scale;
+	}
+}
+
+// サンプリング周波数の変換 (同じなら何もしない)
+void Resample(std::vector<YmReal32>& x, YmUInt32 inRate, YmUInt32 outRate, bool isIr)
+{
+	if (inRate == outRate) return;
+	std::vector<YmReal32> y(YmResampler::GetResampledLength((YmUInt32)x.size(), inRate, outRate));
+	if (isIr)	YmResampler::ResampleIr(nullptr, &x[0], (YmUInt32)x.size(), inRate, &y[0], outRate);
+	else		YmResampler::Resample(nullptr, &x[0], (YmUInt32)x.size(), inRate, &y[0], outRate);
+	x.swap(y);
+}
+
+// 方向ごとの HRIR を変換して [dir][irLength] に詰め直す
+void SetIrs(HrtfSet& hrtf, std::vector<std::vector<YmReal32> >& left, std::vector<std::vector<YmReal32> >& right,
+	const std::vector<YmUInt32>& rates, YmUInt32 sampleRate)
+{
+	hrtf.numDirections = (YmUInt32)left.size();
+	hrtf.irLength = 0;
+	for (YmUInt32 d = 0; d < hrtf.numDirections; d++)
+	{
+		Resample(left[d], rates[d], sampleRate, true);
+		Resample(right[d], rates[d], sampleRate, true);
+		if (left[d].size() > hrtf.irLength) hrtf.irLength = (YmUInt32)left[d].size();
+	}
+	hrtf.irLeft.assign((size_t)hrtf.numDirections*hrtf.irLength, 0.0f);
+	hrtf.irRight.assign((size_t)hrtf.numDirections*hrtf.irLength, 0.0f);
+	for (YmUInt32 d = 0; d < hrtf.numDirections; d++)
+	{
+		std::copy(left[d].begin(), left[d].end(), hrtf.irLeft.begin() + (size_t)d*hrtf.irLength);
+		std::copy(right[d].begin(), right[d].end(), hrtf.irRight.begin() + (size_t)d*hrtf.irLength);
+	}
+}
+
+bool LoadHrtf(const char* listPath, HrtfSet& hrtf, YmUInt32 sampleRate)
+{
+	if (hrtf.pack.Open(listPath))
+	{
+		hrtf.numDirections = hrtf.pack.GetNumDirections();
+		hrtf.irLength = hrtf.pack.GetIrLength();
+		for (YmUInt32 d = 0; d < hrtf.numDirections; d++) hrtf.directions.push_back(hrtf.pack.GetDirection(d));
+		if (hrtf.pack.GetSampleRate() != sampleRate)
+		{
+			// スペクトルを HRIR に戻して変換する (パックは共有せず閉じる)
+			YmFft fft;
+			if (!fft.Init(nullptr, hrtf.pack.GetFftSize())) return false;
+			std::vector<std::vector<YmReal32> > left(hrtf.numDirections), right(hrtf.numDirections);
+			std::vector<YmUInt32> rates(hrtf.numDirections, hrtf.pack.GetSampleRate());
+			std::vector<YmReal32> time(hrtf.pack.GetFftSize());
+			for (YmUInt32 d = 0; d < hrtf.numDirections; d++)
+			{
+				for (YmUInt32 ear = 0; ear < 2; ear++)
+				{
+					fft.Inverse(hrtf.pack.GetSpectra() + ((size_t)d*2 + ear)*hrtf.pack.GetSpecStride(), &time[0]);
+					(ear == 0 ? left : right)[d].assign(time.begin(), time.begin() + hrtf.irLength);
+				}
+			}
+			hrtf.pack.Close();
+			SetIrs(hrtf, left, right, rates, sampleRate);
+		}
+		hrtf.hasGrid = hrtf.grid.Init(nullptr, &hrtf.directions[0], hrtf.numDirections);
+		if (!hrtf.hasGrid) fprintf(stderr, "warning: %s: directions do not span the sphere, using the nearest HRTF\n", listPath);
+		return true;
+	}
+
+	FILE* fp = fopen(listPath, "r");
+	if (fp == nullptr)
+	{
+		fprintf(stderr, "error: cannot open %s\n", listPath);
+		return false;
+	}
+	std::vector<std::vector<YmReal32> > left, right;
+	std::vector<YmUInt32> rates;
+	char line[1024], path[1024];
+	while (fgets(line, sizeof(line), fp))
+	{
+		float azim, elev;
+		if (line[0] == '#' || sscanf(line, "%f %f %1023s", &azim, &elev, path) != 3) continue;
+		YmWav wav;
+		if (!YmWavIo::Read(path, wav) || wav.numChannels != 2 || wav.GetNumFrames() == 0)
+		{
+			fprintf(stderr, "error: %s must be a stereo WAV\n", path);
+			fclose(fp);
+			return false;
+		}
+		hrtf.directions.push_back(YmMath::PolarToRect(azim*YMH_DEG2RAD, elev*YMH_DEG2RAD, 1.0f));
+		const YmUInt32 frames = wav.GetNumFrames();
+		left.push_back(std::vector<YmReal32>(frames));
+		right.push_back(std::vector<YmReal32>(frames));
+		for (YmUInt32 n = 0; n < frames; n++)
+		{
+			left.back()[n]  = wav.samples[2*n];
+			right.back()[n] = wav.samples[2*n + 1];
+		}
+		rates.push_back(wav.sampleRate);
+	}
+	fclose(fp);
+	if (left.empty())
+	{
+		fprintf(stderr, "error: no HRTF in %s\n", listPath);
+		return false;
+	}
+	SetIrs(hrtf, left, right, rates, sampleRate);
+	hrtf.hasGrid = hrtf.grid.Init(nullptr, &hrtf.directions[0], hrtf.numDirections);
+	if (!hrtf.hasGrid) fprintf(stderr, "warning: %s: directions do not span the sphere, using the nearest HRTF\n", listPath);
+	return true;
+}
+
+// パックのスペクトルを HRIR [dir][irLength] に戻す
+bool UnpackIrs(const HrtfSet& hrtf, std::vector<YmReal32>& left, std::vector<YmReal32>& right)
+{
+	YmFft fft;
+	if (!fft.Init(nullptr, hrtf.pack.GetFftSize())) return false;
+	std::vector<YmReal32> time(hrtf.pack.GetFftSize());
+	left.resize((size_t)hrtf.numDirections*hrtf.irLength);
+	right.resize((size_t)hrtf.numDirections*hrtf.irLength);
+	for (YmUInt32 i = 0; i < hrtf.numDirections*2; i++)
+	{
+		fft.Inverse(hrtf.pack.GetSpectra() + (size_t)i*hrtf.pack.GetSpecStride(), &time[0]);
+		std::copy(time.begin(), time.begin() + hrtf.irLength, ((i & 1) ? right : left).begin() + (size_t)(i/2)*hrtf.irLength);
+	}
+	return true;
+}
+
+// SHORT 段階用の短い HRIR を作る (パックはスペクトルを HRIR に戻してから)
+bool MakeShortIrs(HrtfSet& hrtf, YmUInt32 length)
+{
+	std::vector<YmReal32> irLeft, irRight;
+	if (hrtf.pack.IsOpen() && !UnpackIrs(hrtf, irLeft, irRight)) return false;
+	hrtf.shortLength = length;
+	hrtf.shortLeft.assign((size_t)hrtf.numDirections*length, 0.0f);
+	hrtf.shortRight.assign((size_t)hrtf.numDirections*length, 0.0f);
+	for (YmUInt32 d = 0; d < hrtf.numDirections; d++)
+	{
+		const YmReal32* left  = irLeft.empty()  ? &hrtf.irLeft[(size_t)d*hrtf.irLength]  : &irLeft[(size_t)d*hrtf.irLength];
+		const YmReal32* right = irRight.empty() ? &hrtf.irRight[(size_t)d*hrtf.irLength] : &irRight[(size_t)d*hrtf.irLength];
+		if (!YmLod::MakeShortHrir(nullptr, left,  hrtf.irLength, &hrtf.shortLeft[(size_t)d*length],  length)
+			|| !YmLod::MakeShortHrir(nullptr, right, hrtf.irLength, &hrtf.shortRight[(size_t)d*length], length))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WritePack(const char* packPath, const HrtfSet& hrtf, YmUInt32 blockSize, YmUInt32 sampleRate)
+{
+	YmUInt32 fftSize = 4;
+	while (fftSize < blockSize + hrtf.irLength - 1) fftSize <<= 1;	// YmBatchSpatializer と同じ
+	YmFft fft;
+	YmHrtfTable table;
+	if (!fft.Init(nullptr, fftSize) || !table.Init(nullptr, fft, hrtf.numDirections, hrtf.irLength, &hrtf.irLeft[0], &hrtf.irRight[0])
+		|| !YmHrtfPack::Write(packPath, table, &hrtf.directions[0], hrtf.irLength, fftSize, sampleRate))
+	{
+		fprintf(stderr, "error: cannot write %s\n", packPath);
+		return false;
+	}
+	return true;
+}
+
+bool LoadScene(const std::string& path, Scene& scene)
+{
+	FILE* fp = fopen(path.c_str(), "r");
+	if (fp == nullptr)
+	{
+		fprintf(stderr, "error: cannot open %s\n", path.c_str());
+		return false;
+	}
+	scene.path = path;
+	char line[1024], arg[1024];
+	int lineNo = 0;
+	bool ok = true;
+	while (ok && fgets(line, sizeof(line), fp))
+	{
+		lineNo++;
+		char* comment = strchr(line, '#');
+		if (comment) *comment = '\0';
+		char cmd[32];
+		if (sscanf(line, "%31s", cmd) != 1) continue;
+		float v[6];
+		if (strcmp(cmd, "output") == 0 && sscanf(line, "%*s %1023s", arg) == 1)
+		{
+			scene.output = arg;
+		}
+		else if (strcmp(cmd, "listener") == 0 && sscanf(line, "%*s %f %f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6)
+		{
+			scene.listenerPosition.Set(v[0], v[1], v[2]);
+			scene.SetOrientation(v[3]*YMH_DEG2RAD, v[4]*YMH_DEG2RAD, v[5]*YMH_DEG2RAD);
+		}
+		else if (strcmp(cmd, "source") == 0 && sscanf(line, "%*s %1023s", arg) == 1)
+		{
+			Source src;
+			src.path = arg;
+			src.gain = (sscanf(line, "%*s %*s %f", &v[0]) == 1) ? YmMath::dBToLin(v[0]) : 1.0f;
+			scene.sources.push_back(src);
+		}
+		else if (strcmp(cmd, "key") == 0 && !scene.sources.empty() && sscanf(line, "%*s %f %f %f %f", &v[0], &v[1], &v[2], &v[3]) == 4)
+		{
+			Key key;
+			key.time = v[0];
+			key.position.Set(v[1], v[2], v[3]);
+			std::vector<Key>& keys = scene.sources.back().keys;
+			if (!keys.empty() && key.time <= keys.back().time)
+			{
+				fprintf(stderr, "error: %s:%d: key times must increase\n", path.c_str(), lineNo);
+				ok = false;
+			}
+			keys.push_back(key);
+		}
+		else if (strcmp(cmd, "hrtf") == 0 && sscanf(line, "%*s %f %1023s", &v[0], arg) == 2)
+		{
+			HrtfSwitch sw;
+			sw.time = v[0];
+			sw.path = arg;
+			if (!scene.hrtfSwitches.empty() && sw.time <= scene.hrtfSwitches.back().time)
+			{
+				fprintf(stderr, "error: %s:%d: hrtf times must increase\n", path.c_str(), lineNo);
+				ok = false;
+			}
+			scene.hrtfSwitches.push_back(sw);
+		}
+		else
+		{
+			fprintf(stderr, "error: %s:%d: cannot parse '%s'\n", path.c_str(), lineNo, cmd);
+			ok = false;
+		}
+	}
+	fclose(fp);
+	if (ok && scene.output.empty())
+	{
+		fprintf(stderr, "error: %s: no output\n", path.c_str());
+		ok = false;
+	}
+	return ok;
+}
+
+// 前ブロックと今回の重みを方向ごとにまとめ、ブロック内でゲインを補間して加算する
+// (方向が変わると旧方向はフェードアウト、新方向はフェードインになる)
+void AddWeighted(YmBatchSpatializer& spatializer, const YmReal32* in,
+	const YmHrtfWeights& prev, YmReal32 prevGain, const YmHrtfWeights& cur, YmReal32 gain)
+{
+	YmUInt32 dir[6];
+	YmReal32 g0[6], g1[6];
+	YmUInt32 num = 0;
+	for (int k = 0; k < 6; k++)
+	{
+		const bool isPrev = (k < 3);
+		const YmUInt32 d = isPrev ? prev.index[k] : cur.index[k - 3];
+		const YmReal32 g = isPrev ? prev.weight[k]*prevGain : cur.weight[k - 3]*gain;
+		if (g == 0.0f) continue;
+		YmUInt32 j = 0;
+		while (j < num && dir[j] != d) j++;
+		if (j == num)
+		{
+			dir[num] = d;
+			g0[num] = g1[num] = 0.0f;
+			num++;
+		}
+		if (isPrev) g0[j] += g;
+		else g1[j] += g;
+	}
+	for (YmUInt32 j = 0; j < num; j++) spatializer.AddSource(in, dir[j], g0[j], g1[j]);
+}
+
+// セット切替ブロック: 旧セットの方向は BANK_PREVIOUS で prevGain -> 0、新セットの方向は 0 -> gain
+void AddSwitched(YmBatchSpatializer& spatializer, const YmReal32* in,
+	const YmHrtfWeights& prev, YmReal32 prevGain, const YmHrtfWeights& cur, YmReal32 gain)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		if (prev.weight[k] != 0.0f) spatializer.AddSource(in, prev.index[k], prev.weight[k]*prevGain, 0.0f, YmBatchSpatializer::BANK_PREVIOUS);
+		if (cur.weight[k] != 0.0f) spatializer.AddSource(in, cur.index[k], 0.0f, cur.weight[k]*gain);
+	}
+}
+
+// シーン中の HRTF セット切替 (hrtf)。-h のセットと切替先を YmHrtfSelector で準備する
+struct HrtfSwitcher
+{
+	YmHrtfSelector							selector;
+	std::vector<std::string>				paths;			// [0]: -h
+	std::vector<YmReal32>					times;			// [0]: 0
+	std::vector<const HrtfSet*>				sets;
+	std::vector<std::unique_ptr<HrtfSet> >	loaded;			// 切替先 (sets[1..])
+	YmUInt32								fftSize;		// 全セット共通
+	YmUInt32								maxDirections;
+	YmUInt32								maxIrLength;
+	size_t									next;			// 次に要求するセット
+	YmUInt32								numSwitches;	// 最初のセット以降の切替回数
+	const YmHrtfSet*						current;
+	const YmHrtfSet*						previous;
+
+	HrtfSwitcher() : fftSize(0), maxDirections(0), maxIrLength(0), next(0), numSwitches(0), current(nullptr), previous(nullptr) {}
+
+	// 切替先を読み込み、FFT サイズとテーブルの上限を決めてローダースレッドを起動する
+	bool Init(const Scene& scene, const HrtfSet& hrtf, const Options& opt)
+	{
+		paths.push_back(opt.hrtfPath);
+		times.push_back(0.0f);
+		sets.push_back(&hrtf);
+		for (size_t i = 0; i < scene.hrtfSwitches.size(); i++)
+		{
+			loaded.push_back(std::unique_ptr<HrtfSet>(new HrtfSet()));
+			if (!LoadHrtf(scene.hrtfSwitches[i].path.c_str(), *loaded.back(), opt.sampleRate)) return false;
+			paths.push_back(scene.hrtfSwitches[i].path);
+			times.push_back(scene.hrtfSwitches[i].time);
+			sets.push_back(loaded.back().get());
+		}
+		for (size_t i = 0; i < sets.size(); i++)
+		{
+			maxDirections = std::max(maxDirections, sets[i]->numDirections);
+			maxIrLength = std::max(maxIrLength, sets[i]->irLength);
+		}
+		fftSize = 4;
+		while (fftSize < opt.blockSize + maxIrLength - 1) fftSize <<= 1;	// YmBatchSpatializer と同じ
+		// 周波数が同じパックはスペクトルをそのまま共有するので、パックの FFT サイズに揃える
+		for (size_t i = 0; i < sets.size(); i++)
+		{
+			if (sets[i]->pack.IsOpen()) fftSize = std::max(fftSize, sets[i]->pack.GetFftSize());
+		}
+		return selector.Init(nullptr, opt.blockSize, fftSize, opt.sampleRate);
+	}
+
+	// セットを要求し、公開されるまで待つ (オフラインなので切替ブロックを時刻どおりにする)
+	bool Request(size_t i)
+	{
+		const HrtfSet& set = *sets[i];
+		const YmUInt32 id = set.pack.IsOpen()
+			? selector.RequestPack(paths[i].c_str())
+			: selector.RequestIr(set.numDirections, set.irLength, &set.directions[0], &set.irLeft[0], &set.irRight[0]);
+		if (id == 0) return false;
+		while (!selector.IsReady(id) && !selector.IsFailed(id)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return selector.IsReady(id);
+	}
+
+	// ブロック先頭 (t: ブロック先頭の時刻) での切替とテーブルの指定
+	bool BeginBlock(YmReal32 t, YmBatchSpatializer& spatializer)
+	{
+		// 前に返却したセットが解放されるまで待つ (返却先が空かないと、旧セットの返却と次の切替が遅れる)
+		const YmUInt32 held = (current != nullptr ? 1 : 0) + (previous != nullptr ? 1 : 0);
+		while (selector.GetNumSets() != held) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		// 同じブロックで複数の時刻を過ぎた場合は最後のセットだけを要求する
+		size_t i = next;
+		while (i < times.size() && times[i] <= t) i++;
+		if (i > next)
+		{
+			next = i;
+			if (!Request(i - 1))
+			{
+				fprintf(stderr, "error: cannot prepare the HRTF set %s (FFT size %u)\n", paths[i - 1].c_str(), fftSize);
+				return false;
+			}
+		}
+		selector.Update(current, previous);
+		if (previous != nullptr) numSwitches++;
+		return current != nullptr && spatializer.BeginBlock(&current->GetTable(), (previous != nullptr) ? &previous->GetTable() : nullptr);
+	}
+};
+
+// 音源ごとの畳込み (-c)
+struct ConvVoice
+{
+	YmConvolver			conv;
+	YmDirectionGate		gate;
+};
+
+/***********************************************************************//**
+ * @brief			方向が閾値を超えて変わったときだけ、重みで補間した HRIR でフィルタを更新する (-c)
+ * @return			フィルタを更新した (受け付けられた) か
+ **************************************************************************/
+bool UpdateConvFilter(ConvVoice& voice, const YmVector3& dir, const YmHrtfWeights& weights, bool isFirst,
+	const YmReal32* irLeft, const YmReal32* irRight, YmUInt32 irLength, std::vector<YmReal32>& work)
+{
+	if (!isFirst && !voice.gate.IsChanged(dir)) return false;
+	work.assign((size_t)irLength*2, 0.0f);
+	for (int k = 0; k < 3; k++)
+	{
+		const YmReal32 w = weights.weight[k];
+		if (w == 0.0f) continue;
+		const size_t offset = (size_t)weights.index[k]*irLength;
+		for (YmUInt32 n = 0; n < irLength; n++)
+		{
+			work[n]            += w*irLeft[offset + n];
+			work[irLength + n] += w*irRight[offset + n];
+		}
+	}
+	const YmReal32* irs[2] = { &work[0], &work[irLength] };
+	if (isFirst)
+	{
+		voice.conv.SetFilter(0, irs[0], irLength);
+		voice.conv.SetFilter(1, irs[1], irLength);
+	}
+	else if (!voice.conv.UpdateFilters(irs, irLength))
+	{
+		return false;
+	}
+	voice.gate.Commit(dir);
+	return true;
+}
+
+bool RenderScene(Scene& scene, const HrtfSet& hrtf, const Options& opt)
+{
+	const YmUInt32 B = opt.blockSize;
+	const bool isConv = (opt.convThreshold >= 0.0f);
+	const bool isSwitching = !scene.hrtfSwitches.empty();
+	if (isSwitching && (isConv || opt.ambisonicOrder > 0 || opt.lodLength > 0 || opt.maxRealVoices > 0 || opt.nearest))
+	{
+		fprintf(stderr, "error: %s: hrtf cannot be used with -a, -l, -v, -c or -n\n", scene.path.c_str());
+		return false;
+	}
+	HrtfSwitcher switcher;
+	if (isSwitching && !switcher.Init(scene, hrtf, opt))
+	{
+		fprintf(stderr, "error: %s: cannot load the HRTF sets\n", scene.path.c_str());
+		return false;
+	}
+	std::vector<std::vector<YmReal32> > inputs(scene.sources.size());
+	YmUInt32 numFrames = 0;
+	for (size_t s = 0; s < scene.sources.size(); s++)
+	{
+		Source& src = scene.sources[s];
+		if (!YmWavIo::Read(src.path.c_str(), src.wav) || src.wav.GetNumFrames() == 0)
+		{
+			fprintf(stderr, "error: %s: cannot read %s\n", scene.path.c_str(), src.path.c_str());
+			return false;
+		}
+		ToMono(src.wav, inputs[s]);
+		Resample(inputs[s], src.wav.sampleRate, opt.sampleRate, false);
+		if (inputs[s].size() > numFrames) numFrames = (YmUInt32)inputs[s].size();
+	}
+	numFrames += (isSwitching ? switcher.maxIrLength : hrtf.irLength) - 1;		// 残響テール
+	const YmUInt32 numBlocks = (numFrames + B - 1) / B;
+
+	YmBatchSpatializer spatializer;
+	YmBatchSpatializer shortSpatializer;	// -l の SHORT 段階
+	YmAmbisonicDecoder decoder;
+	std::vector<YmAmbisonicEncoder> encoders(scene.sources.size());
+	std::vector<ConvVoice> convVoices(scene.sources.size());
+	std::vector<YmReal32> convLeft, convRight;	// -c でパックを開いている場合の HRIR
+	const YmUInt32 maxDirections = (YmUInt32)scene.sources.size()*6;
+	bool ok;
+	if (isConv)
+	{
+		ok = !hrtf.pack.IsOpen() || UnpackIrs(hrtf, convLeft, convRight);
+		for (size_t s = 0; s < convVoices.size(); s++)
+		{
+			ok = ok && convVoices[s].conv.Init(nullptr, B, hrtf.irLength, 2);
+			convVoices[s].gate.SetThreshold(opt.convThreshold);
+		}
+	}
+	else if (opt.ambisonicOrder > 0)
+	{
+		ok = hrtf.pack.IsOpen()
+			? decoder.Init(nullptr, opt.ambisonicOrder, B, hrtf.pack)
+			: decoder.Init(nullptr, opt.ambisonicOrder, B, hrtf.numDirections, hrtf.irLength, &hrtf.irLeft[0], &hrtf.irRight[0], &hrtf.directions[0]);
+		for (size_t s = 0; s < encoders.size(); s++) ok = ok && encoders[s].Init(opt.ambisonicOrder);
+	}
+	else if (isSwitching)
+	{
+		ok = spatializer.Init(nullptr, B, maxDirections, switcher.maxDirections, switcher.fftSize);
+	}
+	else
+	{
+		ok = hrtf.pack.IsOpen()
+			? spatializer.Init(nullptr, B, maxDirections, hrtf.pack)
+			: spatializer.Init(nullptr, B, maxDirections, hrtf.numDirections, hrtf.irLength, &hrtf.irLeft[0], &hrtf.irRight[0]);
+		if (opt.lodLength > 0)
+		{
+			ok = ok && shortSpatializer.Init(nullptr, B, maxDirections, hrtf.numDirections, hrtf.shortLength, &hrtf.shortLeft[0], &hrtf.shortRight[0]);
+		}
+	}
+	YmWorkerPool workerPool;
+	if (ok && opt.numWorkers > 0 && opt.ambisonicOrder == 0)
+	{
+		ok = workerPool.Init(opt.numWorkers) && spatializer.SetWorkerPool(&workerPool)
+			&& (opt.lodLength == 0 || shortSpatializer.SetWorkerPool(&workerPool));
+	}
+	if (maxDirections == 0 || !ok)
+	{
+		fprintf(stderr, "error: %s: cannot initialize the spatializer%s\n", scene.path.c_str(),
+			(hrtf.pack.IsOpen() && !hrtf.pack.IsUsableFor(B)) ? " (block size too large for the HRTF pack)" : "");
+		return false;
+	}
+
+	YmWav out;
+	out.sampleRate = opt.sampleRate;
+	out.numChannels = 2;
+	out.samples.assign((size_t)numBlocks*B*2, 0.0f);
+	std::vector<YmHrtfWeights> prevWeights(scene.sources.size());
+	std::vector<YmReal32> prevGain(scene.sources.size(), -1.0f);	// 負: 最初のブロック
+	std::vector<YmReal32> block(B), left(B), right(B);
+	const YmReal32* irLeft  = convLeft.empty()  ? (hrtf.irLeft.empty()  ? nullptr : &hrtf.irLeft[0])  : &convLeft[0];
+	const YmReal32* irRight = convRight.empty() ? (hrtf.irRight.empty() ? nullptr : &hrtf.irRight[0]) : &convRight[0];
+	std::vector<YmReal32> convIr, convOutLeft(B), convOutRight(B);
+	YmUInt32 numFilterUpdates = 0, numGatedUpdates = 0;
+
+	const YmLodConfig lodConfig;
+	std::vector<YmLodVoice> lods(scene.sources.size());
+	std::vector<YmItdPanner> panners(scene.sources.size());
+	for (size_t s = 0; s < panners.size(); s++) panners[s].Init(opt.sampleRate);
+	YmLodStats lodStats;
+	YmUInt32 lodCount[YM_LOD_NUM_TIERS] = {}, lodTransitions = 0;
+	std::vector<YmReal32> panLeft(B), panRight(B), shortLeft(B), shortRight(B);
+
+	// 音源位置の更新はブロックごとに SoA 配列でまとめて行う
+	YmVector3Array positions, locals, dirs;
+	YmPolar3Array polars;
+	const YmUInt32 numSources = (YmUInt32)scene.sources.size();
+	if (!positions.Init(nullptr, numSources) || !locals.Init(nullptr, numSources) || !dirs.Init(nullptr, numSources) || !polars.Init(nullptr, numSources))
+	{
+		fprintf(stderr, "error: %s: cannot allocate the source arrays\n", scene.path.c_str());
+		return false;
+	}
+	positions.Resize(numSources);
+	YmReal32 rot[9];
+	scene.GetRotation(rot);
+
+	// 処理時間はシーン間・バッチ畳込みで共有されるため上限にせず、ボイス数のみで制限する
+	YmVoiceBudgetConfig budgetConfig;
+	budgetConfig.maxRealVoices = opt.maxRealVoices;
+	budgetConfig.cpuFraction = 0.0f;
+	YmVoiceBudget budget;
+	std::vector<YmInt32> budgetHandles(scene.sources.size(), -1);
+	std::vector<YmVirtualVoice> virtualVoices(scene.sources.size());
+	YmUInt32 numRealBlocks = 0, numVirtualBlocks = 0;
+	if (opt.maxRealVoices > 0)
+	{
+		if (!budget.Init(nullptr, (YmUInt32)scene.sources.size(), opt.sampleRate, B, budgetConfig))
+		{
+			fprintf(stderr, "error: %s: cannot initialize the voice budget\n", scene.path.c_str());
+			return false;
+		}
+		for (size_t s = 0; s < budgetHandles.size(); s++) budgetHandles[s] = budget.Register();
+	}
+
+	for (YmUInt32 b = 0; b < numBlocks; b++)
+	{
+		const YmUInt32 start = b*B;
+		const YmReal32 t = (start + 0.5f*B) / (YmReal32)opt.sampleRate;
+		if (isConv)
+		{
+			std::fill(left.begin(), left.end(), 0.0f);
+			std::fill(right.begin(), right.end(), 0.0f);
+		}
+		else if (opt.ambisonicOrder > 0) decoder.BeginBlock();
+		else if (!isSwitching) spatializer.BeginBlock();
+		else if (!switcher.BeginBlock(start / (YmReal32)opt.sampleRate, spatializer))
+		{
+			fprintf(stderr, "error: %s: cannot switch the HRTF set at %.3f s\n", scene.path.c_str(), start / (YmReal32)opt.sampleRate);
+			return false;
+		}
+		if (opt.lodLength > 0)
+		{
+			shortSpatializer.BeginBlock();
+			std::fill(panLeft.begin(), panLeft.end(), 0.0f);
+			std::fill(panRight.begin(), panRight.end(), 0.0f);
+		}
+		for (YmUInt32 s = 0; s < numSources; s++) positions.Set(s, scene.sources[s].GetPosition(t));
+		YmMath::ToLocal(locals, positions, scene.listenerPosition, rot);
+		YmMath::RectToPolar(polars, locals);
+		YmMath::Normalize(dirs, locals);
+		for (size_t s = 0; s < scene.sources.size(); s++)
+		{
+			const std::vector<YmReal32>& in = inputs[s];
+			for (YmUInt32 n = 0; n < B; n++) block[n] = (start + n < in.size()) ? in[start + n] : 0.0f;
+
+			const YmReal32 dist = polars.Dist()[s];
+			const YmVector3 dir = (dist > 0.0f) ? dirs.Get((YmUInt32)s) : YmVector3(0.0f, 0.0f, 1.0f);
+			const YmReal32 attenuation = 1.0f / YmMath::Max(dist, YM_RENDER_MIN_DISTANCE);
+			const YmReal32 gain = scene.sources[s].gain*attenuation;
+			if (opt.ambisonicOrder > 0)
+			{
+				decoder.AddSource(&block[0], encoders[s], dir, gain);
+				continue;
+			}
+
+			YmHrtfWeights weights;
+			if (isSwitching)
+			{
+				switcher.current->Lookup(dir, weights);
+			}
+			else if (hrtf.hasGrid && !opt.nearest)
+			{
+				hrtf.grid.Lookup(dir, weights);
+			}
+			else
+			{
+				weights.index[0] = weights.index[1] = weights.index[2] = hrtf.FindNearest(dir);
+				weights.weight[0] = 1.0f;
+				weights.weight[1] = weights.weight[2] = 0.0f;
+			}
+			const bool isFirst = (prevGain[s] < 0.0f);
+			if (isFirst)
+			{
+				prevWeights[s] = weights;
+				prevGain[s] = gain;
+			}
+
+			if (isConv)
+			{
+				ConvVoice& voice = convVoices[s];
+				if (UpdateConvFilter(voice, dir, weights, isFirst, irLeft, irRight, hrtf.irLength, convIr)) numFilterUpdates++;
+				else numGatedUpdates++;
+				const YmReal32 step = (gain - prevGain[s]) / (YmReal32)B;
+				for (YmUInt32 n = 0; n < B; n++) block[n] *= prevGain[s] + step*(YmReal32)(n + 1);
+				YmReal32* out[2] = { &convOutLeft[0], &convOutRight[0] };
+				voice.conv.Process(&block[0], out);
+				for (YmUInt32 n = 0; n < B; n++)
+				{
+					left[n]  += convOutLeft[n];
+					right[n] += convOutRight[n];
+				}
+				prevGain[s] = gain;
+				continue;
+			}
+
+			// 仮想ボイスは重み・ゲインだけ更新して DSP を飛ばす
+			YmReal32 voiceStart = 1.0f, voiceEnd = 1.0f;
+			if (opt.maxRealVoices > 0)
+			{
+				YmVirtualVoice& voice = virtualVoices[s];
+				voice.Update(budget.Update(budgetHandles[s], (YmUInt64)start + B, scene.sources[s].gain, attenuation));
+				if (voice.IsReal()) numRealBlocks++;
+				else numVirtualBlocks++;
+				if (!voice.IsProcessing())
+				{
+					prevWeights[s] = weights;
+					prevGain[s] = gain;
+					continue;
+				}
+				if (voice.IsRealizing()) panners[s].Reset();
+				voice.GetFadeGains(voiceStart, voiceEnd);
+			}
+
+			if (opt.lodLength > 0)
+			{
+				// 旧段階と新段階を 1 ブロックでクロスフェード
+				YmLodVoice& lod = lods[s];
+				lod.Update(lodConfig, dist, gain);
+				lodStats.Count(lod);
+				for (int k = 0; k < YM_LOD_CULLED; k++)
+				{
+					const YmLodTier tier = (YmLodTier)k;
+					if (!lod.IsActive(tier)) continue;
+					YmReal32 fadeStart, fadeEnd;
+					lod.GetFadeGains(tier, fadeStart, fadeEnd);
+					if (tier == YM_LOD_PAN)
+					{
+						if (lod.IsEntering(tier)) panners[s].Reset();
+						panners[s].Process(&block[0], dir, prevGain[s]*fadeStart*voiceStart, gain*fadeEnd*voiceEnd, &panLeft[0], &panRight[0], B);
+					}
+					else
+					{
+						AddWeighted((tier == YM_LOD_FULL) ? spatializer : shortSpatializer, &block[0],
+							prevWeights[s], prevGain[s]*fadeStart*voiceStart, weights, gain*fadeEnd*voiceEnd);
+					}
+				}
+			}
+			else if (switcher.previous != nullptr)
+			{
+				AddSwitched(spatializer, &block[0], prevWeights[s], prevGain[s], weights, gain);
+			}
+			else
+			{
+				AddWeighted(spatializer, &block[0], prevWeights[s], prevGain[s]*voiceStart, weights, gain*voiceEnd);
+			}
+			prevWeights[s] = weights;
+			prevGain[s] = gain;
+		}
+		if (opt.ambisonicOrder > 0) decoder.Render(&left[0], &right[0]);
+		else if (!isConv) spatializer.Render(&left[0], &right[0]);
+		if (opt.lodLength > 0)
+		{
+			shortSpatializer.Render(&shortLeft[0], &shortRight[0]);
+			for (YmUInt32 n = 0; n < B; n++)
+			{
+				left[n]  += shortLeft[n] + panLeft[n];
+				right[n] += shortRight[n] + panRight[n];
+			}
+			lodStats.Publish();
+			for (int k = 0; k < YM_LOD_NUM_TIERS; k++) lodCount[k] += lodStats.GetCount((YmLodTier)k);
+			lodTransitions += lodStats.GetNumTransitions();
+		}
+		for (YmUInt32 n = 0; n < B; n++)
+		{
+			out.samples[2*((size_t)start + n)]     = left[n];
+			out.samples[2*((size_t)start + n) + 1] = right[n];
+		}
+	}
+	out.samples.resize((size_t)numFrames*2);
+	if (opt.lodLength > 0)
+	{
+		fprintf(stderr, "%s: LOD full %u, short %u, pan %u, culled %u, transitions %u\n", scene.path.c_str(),
+			lodCount[YM_LOD_FULL], lodCount[YM_LOD_SHORT], lodCount[YM_LOD_PAN], lodCount[YM_LOD_CULLED], lodTransitions);
+	}
+	if (opt.maxRealVoices > 0)
+	{
+		fprintf(stderr, "%s: voices real %u, virtual %u\n", scene.path.c_str(), numRealBlocks, numVirtualBlocks);
+	}
+	if (isSwitching)
+	{
+		fprintf(stderr, "%s: HRTF switches %u\n", scene.path.c_str(), switcher.numSwitches);
+	}
+	if (isConv)
+	{
+		fprintf(stderr, "%s: filter updates %u, skipped by the direction gate %u\n", scene.path.c_str(), numFilterUpdates, numGatedUpdates);
+	}
+
+	if (!YmWavIo::Write(scene.output.c_str(), out, opt.pcm16))
+	{
+		fprintf(stderr, "error: %s: cannot write %s\n", scene.path.c_str(), scene.output.c_str());
+		return false;
+	}
+	return true;
+}
+
+void Usage(void)
+{
+	fprintf(stderr, "usage: ymrender -h hrtf.txt|hrtf.ymhp [-j threads] [-b blockSize] [-r rate] [-n] [-a order | -l length | -c degrees] [-v voices] [-p workers] [-16] [-w hrtf.ymhp] scene.txt [...]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options opt;
+	opt.hrtfPath = nullptr;
+	opt.blockSize = 1024;
+	opt.numThreads = std::thread::hardware_concurrency();
+	opt.sampleRate = YM_RENDER_SAMPLE_RATE;
+	opt.ambisonicOrder = 0;
+	opt.lodLength = 0;
+	opt.maxRealVoices = 0;
+	opt.numWorkers = 0;
+	opt.convThreshold = -1.0f;
+	opt.nearest = false;
+	opt.pcm16 = false;
+	const char* packPath = nullptr;
+	std::vector<std::string> scenePaths;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-h") == 0 && i + 1 < argc)			opt.hrtfPath = argv[++i];
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)	opt.numThreads = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)	opt.blockSize = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)	opt.sampleRate = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc)	opt.ambisonicOrder = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)	opt.lodLength = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc)	opt.maxRealVoices = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)	opt.numWorkers = (YmUInt32)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)	opt.convThreshold = (YmReal32)atof(argv[++i]);
+		else if (strcmp(argv[i], "-n") == 0)					opt.nearest = true;
+		else if (strcmp(argv[i], "-16") == 0)					opt.pcm16 = true;
+		else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)	packPath = argv[++i];
+		else if (argv[i][0] == '-')								{ Usage(); return 2; }
+		else													scenePaths.push_back(argv[i]);
+	}
+	if (opt.hrtfPath == nullptr || (scenePaths.empty() && packPath == nullptr) || opt.blockSize == 0 || opt.sampleRate == 0
+		|| opt.ambisonicOrder > YM_AMBISONIC_MAX_ORDER || (opt.ambisonicOrder > 0 && (opt.lodLength > 0 || opt.maxRealVoices > 0))
+		|| (opt.convThreshold >= 0.0f && (opt.ambisonicOrder > 0 || opt.lodLength > 0 || opt.maxRealVoices > 0 || opt.numWorkers > 0)))
+	{
+		Usage();
+		return 2;
+	}
+	if (opt.numThreads == 0) opt.numThreads = 1;
+	if (opt.numThreads > scenePaths.size()) opt.numThreads = (YmUInt32)scenePaths.size();
+
+	YmSimd::InitKernels();
+	HrtfSet hrtf;
+	if (!LoadHrtf(opt.hrtfPath, hrtf, opt.sampleRate)) return 1;
+	if (opt.lodLength > 0 && !MakeShortIrs(hrtf, opt.lodLength))
+	{
+		fprintf(stderr, "error: cannot make the short HRIRs\n");
+		return 1;
+	}
+	if (packPath != nullptr)
+	{
+		if (hrtf.pack.IsOpen())
+		{
+			fprintf(stderr, "error: %s is already an HRTF pack\n", opt.hrtfPath);
+			return 1;
+		}
+		if (!WritePack(packPath, hrtf, opt.blockSize, opt.sampleRate)) return 1;
+		if (scenePaths.empty()) return 0;
+	}
+
+	// シーン単位でスレッドに分配
+	std::atomic<size_t> next(0);
+	std::atomic<YmUInt32> numFailed(0);
+	std::vector<std::thread> threads;
+	for (YmUInt32 i = 0; i < opt.numThreads; i++)
+	{
+		threads.push_back(std::thread([&]() {
+			for (size_t s = next++; s < scenePaths.size(); s = next++)
+			{
+				Scene scene;
+				if (!LoadScene(scenePaths[s], scene) || !RenderScene(scene, hrtf, opt)) numFailed++;
+			}
+		}));
+	}
+	for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+	fprintf(stderr, "%u/%u scenes rendered\n", (unsigned)(scenePaths.size() - numFailed), (unsigned)scenePaths.size());
+	return (numFailed == 0) ? 0 : 1;
+}
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/
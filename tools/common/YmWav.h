@@ -0,0 +1,161 @@
+﻿/*****************************************************************************************//**
+ * @file			YmWav.h
+ * @brief			WAV ファイル入出力 (ツール用)
+ * @attention		読込: PCM 16/24/32bit, IEEE float 32bit
+ *					書出: IEEE float 32bit または PCM 16bit
+ *					サンプルはチャンネルインターリーブの float [-1,1]
+ *
+ *                 (C) 2018 Yamaha Corporation
+ *                  Confidential
+ ********************************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "private/YmTypes.h"
+
+struct YmWav
+{
+	YmUInt32				sampleRate;
+	YmUInt32				numChannels;
+	std::vector<YmReal32>	samples;		// [frame][ch]
+
+	YmWav() : sampleRate(0), numChannels(0) {}
+
+	YmUInt32 GetNumFrames(void) const	{ return numChannels ? (YmUInt32)(samples.size() / numChannels) : 0; }
+};
+
+namespace YmWavIo {
+
+namespace detail {
+
+inline YmUInt32 ReadU32(const YmUInt8* p)	{ return (YmUInt32)p[0] | ((YmUInt32)p[1] << 8) | ((YmUInt32)p[2] << 16) | ((YmUInt32)p[3] << 24); }
+inline YmUInt16 ReadU16(const YmUInt8* p)	{ return (YmUInt16)(p[0] | (p[1] << 8)); }
+
+inline void WriteU32(FILE* fp, YmUInt32 v)
+{
+	const YmUInt8 b[4] = { (YmUInt8)v, (YmUInt8)(v >> 8), (YmUInt8)(v >> 16), (YmUInt8)(v >> 24) };
+	fwrite(b, 1, 4, fp);
+}
+
+inline void WriteU16(FILE* fp, YmUInt16 v)
+{
+	const YmUInt8 b[2] = { (YmUInt8)v, (YmUInt8)(v >> 8) };
+	fwrite(b, 1, 2, fp);
+}
+
+} // namespace detail
+
+/***********************************************************************//**
+ * @brief			読込
+ * @return			未対応形式・読込失敗時は false
+ **************************************************************************/
+inline bool Read(const char* path, YmWav& wav)
+{
+	FILE* fp = fopen(path, "rb");
+	if (fp == nullptr) return false;
+	std::vector<YmUInt8> data;
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size > 0)
+	{
+		data.resize((size_t)size);
+		if (fread(&data[0], 1, data.size(), fp) != data.size()) data.clear();
+	}
+	fclose(fp);
+	if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) return false;
+
+	YmUInt16 format = 0, bits = 0;
+	const YmUInt8* pcm = nullptr;
+	YmUInt32 pcmSize = 0;
+	wav.numChannels = 0;
+	for (size_t pos = 12; pos + 8 <= data.size(); )
+	{
+		const YmUInt8* chunk = &data[pos];
+		const YmUInt32 chunkSize = detail::ReadU32(chunk + 4);
+		const size_t body = pos + 8;
+		if (body + chunkSize > data.size()) break;
+		if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+		{
+			format = detail::ReadU16(chunk + 8);
+			wav.numChannels = detail::ReadU16(chunk + 10);
+			wav.sampleRate = detail::ReadU32(chunk + 12);
+			bits = detail::ReadU16(chunk + 22);
+			if (format == 0xFFFE && chunkSize >= 40) format = detail::ReadU16(chunk + 32);	// WAVE_FORMAT_EXTENSIBLE
+		}
+		else if (memcmp(chunk, "data", 4) == 0)
+		{
+			pcm = chunk + 8;
+			pcmSize = chunkSize;
+		}
+		pos = body + chunkSize + (chunkSize & 1);
+	}
+	if (pcm == nullptr || wav.numChannels == 0) return false;
+
+	const YmUInt32 bytes = bits / 8;
+	if (!((format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32))) return false;
+	const YmUInt32 count = pcmSize / bytes;
+	wav.samples.resize(count - count % wav.numChannels);
+	for (size_t i = 0; i < wav.samples.size(); i++)
+	{
+		const YmUInt8* p = pcm + i*bytes;
+		YmReal32 v;
+		if (format == 3)			memcpy(&v, p, 4);
+		else if (bits == 16)		v = (YmInt16)detail::ReadU16(p) / 32768.0f;
+		else if (bits == 24)		v = (YmInt32)(((YmUInt32)p[0] << 8) | ((YmUInt32)p[1] << 16) | ((YmUInt32)p[2] << 24)) / 2147483648.0f;
+		else						v = (YmInt32)detail::ReadU32(p) / 2147483648.0f;
+		wav.samples[i] = v;
+	}
+	return true;
+}
+
+/***********************************************************************//**
+ * @brief			書出
+ * @param[in]		pcm16	true で PCM 16bit (クリップあり)、false で float 32bit
+ **************************************************************************/
+inline bool Write(const char* path, const YmWav& wav, bool pcm16 = false)
+{
+	FILE* fp = fopen(path, "wb");
+	if (fp == nullptr) return false;
+	const YmUInt16 bits = pcm16 ? 16 : 32;
+	const YmUInt32 dataSize = (YmUInt32)(wav.samples.size() * (bits / 8));
+	fwrite("RIFF", 1, 4, fp);
+	detail::WriteU32(fp, 36 + dataSize);
+	fwrite("WAVEfmt ", 1, 8, fp);
+	detail::WriteU32(fp, 16);
+	detail::WriteU16(fp, pcm16 ? 1 : 3);
+	detail::WriteU16(fp, (YmUInt16)wav.numChannels);
+	detail::WriteU32(fp, wav.sampleRate);
+	detail::WriteU32(fp, wav.sampleRate * wav.numChannels * (bits / 8));
+	detail::WriteU16(fp, (YmUInt16)(wav.numChannels * (bits / 8)));
+	detail::WriteU16(fp, bits);
+	fwrite("data", 1, 4, fp);
+	detail::WriteU32(fp, dataSize);
+	if (pcm16)
+	{
+		std::vector<YmInt16> buf(wav.samples.size());
+		for (size_t i = 0; i < buf.size(); i++)
+		{
+			YmReal32 v = wav.samples[i] * 32768.0f;
+			v = (v > 32767.0f) ? 32767.0f : (v < -32768.0f) ? -32768.0f : v;
+			buf[i] = (YmInt16)v;
+		}
+		if (!buf.empty()) fwrite(&buf[0], sizeof(YmInt16), buf.size(), fp);		// リトルエンディアン前提
+	}
+	else if (!wav.samples.empty())
+	{
+		fwrite(&wav.samples[0], sizeof(YmReal32), wav.samples.size(), fp);
+	}
+	const bool ok = (ferror(fp) == 0);
+	fclose(fp);
+	return ok;
+}
+
+} // namespace YmWavIo
+
+/*********************************************************************************************
+* EOF
+*********************************************************************************************/